@@ -0,0 +1,54 @@
+#!/bin/sh
+# Decode generated CCH and TCH channel by tetrapol_batch, check channel type
+# detection (CCH probe, rewind and decoding as TCH) and resume of failed run.
+#
+# Usage: test_batch.sh <DIR WITH TETRAPOL APPS>
+
+set -e
+
+APPS="$1"
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+fail() {
+    echo "FAIL: $*" >&2
+    exit 1
+}
+
+mkdir "$TMP/in"
+"$APPS/tetrapol_sim" -o "$TMP/in/cch.bits" -n 1000 -s 5 > /dev/null 2>&1
+"$APPS/tetrapol_gen" -t VOICE -s 7 -n 1000 -o "$TMP/in/tch.bits"
+
+# output of TCH can not be written, file fails
+mkdir -p "$TMP/out/tch.json.tmp"
+if "$APPS/tetrapol_batch" -j 2 -o "$TMP/out" "$TMP/in" > "$TMP/run1"; then
+    fail "failed file not reported"
+fi
+grep -q 'cch.bits: CCH SCR=5 CELL=' "$TMP/run1" || fail "CCH not detected"
+grep -q 'cch.bits", "radio_ch_type": "CCH", "scr": 5,' "$TMP/out/cch.summary" ||
+    fail "CCH summary"
+grep -q 'tch.bits: failed' "$TMP/run1" || fail "TCH not failed"
+grep -q 'tch.bits", "error": true }' "$TMP/out/tch.summary" ||
+    fail "TCH error summary"
+[ -s "$TMP/out/cch.json" ] || fail "CCH events not written"
+
+# CCH is done, failed TCH is decoded again
+rmdir "$TMP/out/tch.json.tmp"
+"$APPS/tetrapol_batch" -j 2 -o "$TMP/out" "$TMP/in" > "$TMP/run2" ||
+    fail "resumed run failed"
+grep -q 'cch.bits: done by previous run' "$TMP/run2" || fail "CCH not skipped"
+grep -q 'tch.bits: TCH SCR=7 ' "$TMP/run2" || fail "TCH not detected"
+grep -q 'tch.bits", "radio_ch_type": "TCH", "scr": 7,' "$TMP/out/tch.summary" ||
+    fail "TCH summary"
+[ $(wc -l < "$TMP/out/summary.jsonl") -eq 2 ] || fail "summary.jsonl"
+# output of CCH probe is discarded
+[ $(grep -c '"event": "frame"' "$TMP/out/tch.json") -eq 1000 ] ||
+    fail "CCH probe not discarded"
+
+# all done
+"$APPS/tetrapol_batch" -j 2 -o "$TMP/out" "$TMP/in" > "$TMP/run3" ||
+    fail "third run failed"
+[ $(grep -c 'done by previous run' "$TMP/run3") -eq 2 ] ||
+    fail "files not skipped"
+
+exit 0
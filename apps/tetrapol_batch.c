@@ -0,0 +1,913 @@
+/**
+  Decode directories of recorded channels (.bits files or recordings written
+  by tetrapol_dump -w) by pool of in-process decoders, one file per worker.
+
+  Each file is decoded once. Recordings carry channel type in header, other
+  files are decoded as CCH first, when no D_SYSTEM_INFO is received during
+  probe the output is discarded and file is decoded as TCH from the start.
+
+  For input NAME.bits (or NAME.tprc) output directory gets NAME.json
+  (or NAME.bin) with events, NAME.log with decoder log and NAME.summary with
+  single JSON line (channel type, SCR, cell ID, frame yield). Outputs are
+  renamed into place when file is finished, summary as the last one, so
+  interrupted run is resumed by skipping files with summary newer than the
+  input. Failed files get summary with error flag only and they are decoded
+  again by the next run. summary.jsonl collects summaries of all inputs in
+  order.
+ */
+#define _DEFAULT_SOURCE 1
+
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_out.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/recording.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tsdu.h>
+#include <tetrapol/tsdu_print.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <glob.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum {
+    PROBE_FRAMES_DEFAULT = 600,     ///< 2 BCH blocks are sent each 100 frames
+    WORKERS_MAX = 256,
+};
+
+enum {
+    JOB_PENDING,
+    JOB_DONE,           ///< decoded by this run
+    JOB_SKIPPED,        ///< decoded by previous run
+    JOB_FAILED,
+};
+
+enum {
+    DECODE_OK = 0,
+    DECODE_NOT_CCH = 1,     ///< probe did not find BCH
+    DECODE_ERR = -1,
+    DECODE_INTERRUPTED = -2,
+};
+
+// set on SIGINT or SIGTERM
+static atomic_bool do_exit;
+
+// log of file decoded by current thread, NULL for main thread
+static __thread FILE *worker_log;
+
+typedef struct {
+    int band;
+    int dir;
+    int radio_ch_type;      ///< -1 to detect
+    int out_fmt;            ///< EVT_OUT_*
+    int probe_frames;
+    const char *out_dir;
+} batch_cfg_t;
+
+typedef struct {
+    const char *path;
+    char *name;             ///< file name without extension
+    int status;             ///< JOB_*
+    int radio_ch_type;
+    int scr;                ///< PHYS_CH_SCR_DETECT when not detected
+    bool has_cell_id;
+    cell_id_t cell_id;
+    uint8_t country_code;
+    uint64_t bits;
+    uint64_t frames;        ///< frames with frame synchronization
+    uint64_t frames_ok;     ///< frames without errors
+    uint64_t tsdus;
+} job_t;
+
+typedef struct {
+    const batch_cfg_t *cfg;
+    job_t *jobs;
+    int njobs;
+    atomic_int next_job;
+    pthread_mutex_t print_lock;
+} batch_t;
+
+/// decoding of single file
+typedef struct {
+    job_t *job;
+    evt_out_t out;
+} decoder_t;
+
+static void sigint_handler(int sig)
+{
+    do_exit = true;
+}
+
+static int log_worker(const char *fmt, va_list ap)
+{
+    if (!worker_log) {
+        return -1;
+    }
+    vfprintf(worker_log, fmt, ap);
+
+    return 0;
+}
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Decode directories of demodulated TETRAPOL channels in parallel.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...] { DIR | FILE | GLOB } ...\n", prg_name);
+    fprintf(stderr, "    DIR                     decode *.bits and *.tprc files in DIR\n");
+    fprintf(stderr, "    -o <DIR>                output directory (default .)\n");
+    fprintf(stderr, "    -j <WORKERS>            number of decoders (default number of CPUs)\n");
+    fprintf(stderr, "    -b { UHF | VHF }        radio band (default is UHF)\n");
+    fprintf(stderr, "    -d { DOWN | UP }        direction, downlink/direct or uplink\n");
+    fprintf(stderr, "    -t { CCH | TCH | AUTO } channel type (default AUTO)\n");
+    fprintf(stderr, "    -p <FRAMES>             frames decoded as CCH before file is decoded\n"
+                    "                            as TCH when no BCH is found (default %d)\n",
+            PROBE_FRAMES_DEFAULT);
+    fprintf(stderr, "    -f { JSON | BIN | NONE }\n"
+                    "                            output format (default JSON)\n");
+    fprintf(stderr, "Band, direction and channel type of recordings are taken from header.\n");
+}
+
+static void evt_callback(const tetrapol_evt_t *evt, void *ptr)
+{
+    decoder_t *dec = ptr;
+    job_t *job = dec->job;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            ++job->frames;
+            if (evt->frame.fr->broken) {
+                return;
+            }
+            ++job->frames_ok;
+            break;
+
+        case TETRAPOL_EVT_SCR:
+            job->scr = evt->scr.scr;
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            ++job->tsdus;
+            if (!evt->tsdu.decoded) {
+                break;
+            }
+            LOGF("\n\tTSAP_ID=%d\tPRIO=%d\n",
+                    evt->tsdu.tsdu->tsap_id, evt->tsdu.tsdu->prio);
+            tsdu_print(evt->tsdu.decoded);
+            if (evt->tsdu.decoded->codop == D_SYSTEM_INFO) {
+                const tsdu_d_system_info_t *tsdu =
+                    (const tsdu_d_system_info_t *)evt->tsdu.decoded;
+                job->has_cell_id = true;
+                job->cell_id = tsdu->cell_id;
+                job->country_code = tsdu->country_code;
+            }
+            break;
+    }
+
+    evt_out_write(&dec->out, evt);
+}
+
+static void job_reset(job_t *job, int radio_ch_type)
+{
+    job->radio_ch_type = radio_ch_type;
+    job->scr = PHYS_CH_SCR_DETECT;
+    job->has_cell_id = false;
+    job->bits = 0;
+    job->frames = 0;
+    job->frames_ok = 0;
+    job->tsdus = 0;
+}
+
+/**
+  Decode in_len bits from fd, when probe is set decoding stops once probe
+  frames were received without D_SYSTEM_INFO.
+  */
+static int decode(decoder_t *dec, const tetrapol_cfg_t *cfg, int fd,
+        uint64_t in_len, int probe)
+{
+    job_reset(dec->job, cfg->radio_ch_type);
+    tetrapol_t *tetrapol = tetrapol_create(cfg);
+    phys_ch_t *phys_ch = tetrapol ? tetrapol_phys_ch_create(tetrapol) : NULL;
+    if (!phys_ch || !tetrapol_subscribe(tetrapol, TETRAPOL_EVT_FRAME |
+                TETRAPOL_EVT_SCR | TETRAPOL_EVT_TSDU_DECODED |
+                TETRAPOL_EVT_PCH | TETRAPOL_EVT_RCH, evt_callback, dec)) {
+        if (phys_ch) {
+            tetrapol_phys_ch_destroy(phys_ch);
+        }
+        tetrapol_destroy(tetrapol);
+        return DECODE_ERR;
+    }
+
+    int ret = DECODE_OK;
+    uint8_t data[4096];
+    while (in_len) {
+        if (do_exit) {
+            ret = DECODE_INTERRUPTED;
+            break;
+        }
+        if (probe && !dec->job->has_cell_id && dec->job->frames >= probe) {
+            ret = DECODE_NOT_CCH;
+            break;
+        }
+
+        const int len = read(fd, data,
+                (in_len < sizeof(data)) ? in_len : sizeof(data));
+        if (len <= 0) {
+            ret = len ? DECODE_ERR : DECODE_OK;
+            break;
+        }
+        in_len -= len;
+        dec->job->bits += len;
+
+        for (int offs = 0; offs < len; ) {
+            offs += tetrapol_phys_ch_recv(phys_ch, data + offs, len - offs);
+            tetrapol_phys_ch_process(phys_ch);
+        }
+        if (dec->out.jw && json_writer_flush(dec->out.jw)) {
+            ret = DECODE_ERR;
+            break;
+        }
+    }
+    if (ret == DECODE_OK && probe && !dec->job->has_cell_id) {
+        ret = DECODE_NOT_CCH;
+    }
+    if (ret == DECODE_OK) {
+        dec->job->scr = tetrapol_phys_ch_get_scr(phys_ch);
+    }
+
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    return ret;
+}
+
+/// @return "dir/name" allocated by malloc() or NULL
+static char *path_join(const char *dir, const char *name)
+{
+    const size_t len = strlen(dir) + strlen(name) + 2;
+    char *path = malloc(len);
+    if (path) {
+        snprintf(path, len, "%s/%s", dir, name);
+    }
+    return path;
+}
+
+static char *out_path(const batch_cfg_t *cfg, const job_t *job,
+        const char *ext)
+{
+    char name[strlen(job->name) + strlen(ext) + 1];
+    snprintf(name, sizeof(name), "%s%s", job->name, ext);
+
+    return path_join(cfg->out_dir, name);
+}
+
+/// write string as JSON string, only quotes, backslash and controls escaped
+static void json_str(json_writer_t *jw, const char *s)
+{
+    json_writer_str(jw, "\"");
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') {
+            json_writer_str(jw, "\\");
+        } else if ((unsigned char)*s < 0x20) {
+            json_writer_str(jw, "?");
+            continue;
+        }
+        json_writer_mem(jw, s, 1);
+    }
+    json_writer_str(jw, "\"");
+}
+
+static void summary_json(json_writer_t *jw, const job_t *job)
+{
+    json_writer_str(jw, "{ \"file\": ");
+    json_str(jw, job->path);
+    if (job->status == JOB_FAILED) {
+        json_writer_str(jw, ", \"error\": true }\n");
+        return;
+    }
+
+    json_writer_str(jw, ", \"radio_ch_type\": ");
+    if (job->radio_ch_type == TETRAPOL_RADIO_CCH) {
+        json_writer_str(jw, "\"CCH\"");
+    } else {
+        json_writer_str(jw, "\"TCH\"");
+    }
+    json_writer_str(jw, ", \"scr\": ");
+    if (job->scr == PHYS_CH_SCR_DETECT) {
+        json_writer_str(jw, "null");
+    } else {
+        json_writer_int(jw, job->scr);
+    }
+    json_writer_str(jw, ", \"cell_id\": ");
+    if (job->has_cell_id) {
+        json_writer_str(jw, "{ \"country_code\": ");
+        json_writer_uint(jw, job->country_code);
+        json_writer_str(jw, ", \"bs_id\": ");
+        json_writer_uint(jw, job->cell_id.bs_id);
+        json_writer_str(jw, ", \"rsw_id\": ");
+        json_writer_uint(jw, job->cell_id.rsw_id);
+        json_writer_str(jw, " }");
+    } else {
+        json_writer_str(jw, "null");
+    }
+    json_writer_str(jw, ", \"bits\": ");
+    json_writer_uint(jw, job->bits);
+    json_writer_str(jw, ", \"frames\": ");
+    json_writer_uint(jw, job->frames);
+    json_writer_str(jw, ", \"frames_ok\": ");
+    json_writer_uint(jw, job->frames_ok);
+    // frames without errors per frame period of input, in per mille
+    const uint64_t nframes = job->bits / FRAME_LEN;
+    json_writer_str(jw, ", \"frame_yield\": ");
+    json_writer_uint(jw, nframes ? 1000 * job->frames_ok / nframes : 0);
+    json_writer_str(jw, ", \"tsdus\": ");
+    json_writer_uint(jw, job->tsdus);
+    json_writer_str(jw, " }\n");
+}
+
+/// write summary of job into output directory, atomically
+static int summary_write(const batch_cfg_t *cfg, const job_t *job)
+{
+    char *path = out_path(cfg, job, ".summary");
+    if (!path) {
+        return -1;
+    }
+    char tmp_path[strlen(path) + sizeof(".tmp")];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    const int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    json_writer_t *jw = (fd != -1) ? json_writer_create(fd) : NULL;
+    if (!jw) {
+        if (fd != -1) {
+            close(fd);
+        }
+        free(path);
+        return -1;
+    }
+    summary_json(jw, job);
+    int ret = json_writer_flush(jw);
+    json_writer_destroy(jw);
+    if (close(fd) || ret || rename(tmp_path, path)) {
+        unlink(tmp_path);
+        ret = -1;
+    }
+    free(path);
+
+    return ret;
+}
+
+/// summary of failed file ends with error flag, see summary_json()
+static bool summary_is_error(const char *path)
+{
+    static const char err_end[] = ", \"error\": true }\n";
+    char buf[sizeof(err_end) - 1];
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return true;
+    }
+    const bool is_err = fseek(f, -(long)sizeof(buf), SEEK_END) ||
+        fread(buf, sizeof(buf), 1, f) != 1 ||
+        !memcmp(buf, err_end, sizeof(buf));
+    fclose(f);
+
+    return is_err;
+}
+
+/**
+  File is done when its summary is newer than the file itself, files which
+  failed in previous run are not done.
+  */
+static bool job_is_done(const batch_cfg_t *cfg, const job_t *job)
+{
+    char *path = out_path(cfg, job, ".summary");
+    struct stat st_in, st_sum;
+    const bool done = path && !stat(job->path, &st_in) &&
+        !stat(path, &st_sum) && st_sum.st_mtime >= st_in.st_mtime &&
+        !summary_is_error(path);
+    free(path);
+
+    return done;
+}
+
+static int job_open_outputs(const batch_cfg_t *cfg, job_t *job,
+        decoder_t *dec, char **paths)
+{
+    memset(dec, 0, sizeof(*dec));
+    dec->job = job;
+    evt_out_init(&dec->out, cfg->out_fmt, NULL, NULL);
+
+    if (!(worker_log = fopen(paths[0], "w"))) {
+        return -1;
+    }
+
+    if (cfg->out_fmt == EVT_OUT_JSON) {
+        const int fd = open(paths[1], O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        dec->out.jw = (fd != -1) ? json_writer_create(fd) : NULL;
+        if (!dec->out.jw) {
+            if (fd != -1) {
+                close(fd);
+            }
+            return -1;
+        }
+    }
+    if (cfg->out_fmt == EVT_OUT_BIN) {
+        dec->out.bin_f = fopen(paths[1], "wb");
+        if (!dec->out.bin_f || evt_bin_write_file_hdr(dec->out.bin_f)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/// truncate outputs to decode file again
+static int job_rewind_outputs(decoder_t *dec)
+{
+    if (fflush(worker_log) || ftruncate(fileno(worker_log), 0) ||
+            fseek(worker_log, 0, SEEK_SET)) {
+        return -1;
+    }
+    if (dec->out.jw && (json_writer_flush(dec->out.jw) ||
+                ftruncate(dec->out.jw->fd, 0) ||
+                lseek(dec->out.jw->fd, 0, SEEK_SET))) {
+        return -1;
+    }
+    if (dec->out.bin_f) {
+        evt_bin_ctx_init(&dec->out.bin_ctx);
+        if (fflush(dec->out.bin_f) || ftruncate(fileno(dec->out.bin_f), 0) ||
+                fseek(dec->out.bin_f, 0, SEEK_SET) ||
+                evt_bin_write_file_hdr(dec->out.bin_f)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int job_close_outputs(decoder_t *dec)
+{
+    int ret = 0;
+    if (dec->out.jw) {
+        const int fd = dec->out.jw->fd;
+        ret |= json_writer_flush(dec->out.jw);
+        json_writer_destroy(dec->out.jw);
+        ret |= close(fd);
+    }
+    if (dec->out.bin_f) {
+        ret |= fclose(dec->out.bin_f);
+    }
+    if (worker_log) {
+        ret |= fclose(worker_log);
+        worker_log = NULL;
+    }
+
+    return ret ? -1 : 0;
+}
+
+static int job_run(const batch_cfg_t *cfg, job_t *job)
+{
+    const int fd = open(job->path, O_RDONLY);
+    if (fd == -1) {
+        return DECODE_ERR;
+    }
+
+    tetrapol_cfg_t tp_cfg = {
+        .band = cfg->band,
+        .dir = cfg->dir,
+        .radio_ch_type = cfg->radio_ch_type,
+    };
+    uint64_t in_len = UINT64_MAX;
+    recording_hdr_t rec_hdr;
+    const int is_recording = recording_read_hdr(fd, &rec_hdr);
+    struct stat st;
+    if (is_recording < 0 || fstat(fd, &st)) {
+        close(fd);
+        return DECODE_ERR;
+    }
+    if (is_recording) {
+        tp_cfg = rec_hdr.cfg;
+        in_len = rec_hdr.nbits;
+    } else {
+        // file is written while received, reception ended at mtime
+        const uint64_t duration = (uint64_t)st.st_size * TETRAPOL_BIT_USEC;
+        const uint64_t mtime = (uint64_t)st.st_mtime * 1000000;
+        tp_cfg.start_time = (mtime > duration) ? mtime - duration : 0;
+    }
+    const off_t in_offs = lseek(fd, 0, SEEK_CUR);
+
+    // outputs: log and events, written as temporary files first, summary
+    // is written by caller once job status is known
+    static const char *exts[] = { ".log", ".json", };
+    char *paths[ARRAY_LEN(exts)];
+    char *tmp_paths[ARRAY_LEN(exts)];
+    for (int i = 0; i < ARRAY_LEN(exts); ++i) {
+        const bool is_bin = (i == 1 && cfg->out_fmt == EVT_OUT_BIN);
+        char ext[16];
+        snprintf(ext, sizeof(ext), "%s", is_bin ? ".bin" : exts[i]);
+        paths[i] = out_path(cfg, job, ext);
+        strncat(ext, ".tmp", sizeof(ext) - strlen(ext) - 1);
+        tmp_paths[i] = out_path(cfg, job, ext);
+    }
+
+    decoder_t dec;
+    int ret = DECODE_ERR;
+    for (int i = 0; i < ARRAY_LEN(exts); ++i) {
+        if (!paths[i] || !tmp_paths[i]) {
+            goto out;
+        }
+    }
+    if (job_open_outputs(cfg, job, &dec, tmp_paths)) {
+        job_close_outputs(&dec);
+        goto out;
+    }
+
+    if (!is_recording && cfg->radio_ch_type < 0) {
+        tp_cfg.radio_ch_type = TETRAPOL_RADIO_CCH;
+        ret = decode(&dec, &tp_cfg, fd, in_len, cfg->probe_frames);
+        if (ret == DECODE_NOT_CCH) {
+            tp_cfg.radio_ch_type = TETRAPOL_RADIO_TCH;
+            ret = (lseek(fd, in_offs, SEEK_SET) < 0 ||
+                    job_rewind_outputs(&dec)) ? DECODE_ERR :
+                decode(&dec, &tp_cfg, fd, in_len, 0);
+        }
+    } else {
+        ret = decode(&dec, &tp_cfg, fd, in_len, 0);
+    }
+
+    if (job_close_outputs(&dec) && ret == DECODE_OK) {
+        ret = DECODE_ERR;
+    }
+    if (ret == DECODE_OK) {
+        if ((cfg->out_fmt != EVT_OUT_NONE &&
+                    rename(tmp_paths[1], paths[1])) ||
+                rename(tmp_paths[0], paths[0])) {
+            ret = DECODE_ERR;
+        }
+    }
+
+out:
+    for (int i = 0; i < ARRAY_LEN(exts); ++i) {
+        if (tmp_paths[i]) {
+            unlink(tmp_paths[i]);
+        }
+        free(paths[i]);
+        free(tmp_paths[i]);
+    }
+    close(fd);
+
+    return ret;
+}
+
+static void job_print(batch_t *batch, const job_t *job)
+{
+    pthread_mutex_lock(&batch->print_lock);
+    if (job->status == JOB_SKIPPED) {
+        printf("%s: done by previous run\n", job->path);
+    } else if (job->status == JOB_FAILED) {
+        printf("%s: failed\n", job->path);
+    } else {
+        const uint64_t nframes = job->bits / FRAME_LEN;
+        printf("%s: %s SCR=", job->path,
+                (job->radio_ch_type == TETRAPOL_RADIO_CCH) ? "CCH" : "TCH");
+        if (job->scr == PHYS_CH_SCR_DETECT) {
+            printf("?");
+        } else {
+            printf("%d", job->scr);
+        }
+        if (job->has_cell_id) {
+            printf(" CELL=%d.%d.%d", job->country_code, job->cell_id.bs_id,
+                    job->cell_id.rsw_id);
+        }
+        printf(" frames=%llu/%llu (%.1f%%)\n",
+                (unsigned long long)job->frames_ok,
+                (unsigned long long)nframes,
+                nframes ? 100.0 * job->frames_ok / nframes : 0.0);
+    }
+    fflush(stdout);
+    pthread_mutex_unlock(&batch->print_lock);
+}
+
+static void *worker(void *ptr)
+{
+    batch_t *batch = ptr;
+
+    int i;
+    while (!do_exit && (i = atomic_fetch_add(&batch->next_job, 1)) <
+            batch->njobs) {
+        job_t *job = &batch->jobs[i];
+        if (job_is_done(batch->cfg, job)) {
+            job->status = JOB_SKIPPED;
+            job_print(batch, job);
+            continue;
+        }
+
+        const int r = job_run(batch->cfg, job);
+        if (r == DECODE_INTERRUPTED) {
+            break;
+        }
+        job->status = (r == DECODE_OK) ? JOB_DONE : JOB_FAILED;
+        if (summary_write(batch->cfg, job) && job->status == JOB_DONE) {
+            job->status = JOB_FAILED;
+            summary_write(batch->cfg, job);
+        }
+        job_print(batch, job);
+    }
+
+    return NULL;
+}
+
+static int job_add(job_t **jobs, int *njobs, const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) || !S_ISREG(st.st_mode)) {
+        return 0;
+    }
+
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    const char *ext = strrchr(base, '.');
+    char *name = strndup(base, ext ? ext - base : strlen(base));
+    if (!name) {
+        return -1;
+    }
+    for (int i = 0; i < *njobs; ++i) {
+        if (!strcmp((*jobs)[i].name, name)) {
+            fprintf(stderr, "Duplicate input name %s (%s, %s)\n", name,
+                    (*jobs)[i].path, path);
+            free(name);
+            return -1;
+        }
+    }
+
+    job_t *p = realloc(*jobs, (*njobs + 1) * sizeof(job_t));
+    if (!p) {
+        free(name);
+        return -1;
+    }
+    *jobs = p;
+    memset(&p[*njobs], 0, sizeof(job_t));
+    p[*njobs].path = strdup(path);
+    p[*njobs].name = name;
+    p[*njobs].status = JOB_PENDING;
+    ++*njobs;
+
+    return p[*njobs - 1].path ? 0 : -1;
+}
+
+/// add files from directory, file or glob pattern
+static int jobs_add(job_t **jobs, int *njobs, const char *arg)
+{
+    glob_t g;
+    struct stat st;
+    int r;
+    if (!stat(arg, &st) && S_ISDIR(st.st_mode)) {
+        char *pattern = path_join(arg, "*.bits");
+        if (!pattern) {
+            return -1;
+        }
+        r = glob(pattern, 0, NULL, &g);
+        free(pattern);
+        if (r && r != GLOB_NOMATCH) {
+            return -1;
+        }
+        if (!(pattern = path_join(arg, "*.tprc"))) {
+            if (!r) {
+                globfree(&g);
+            }
+            return -1;
+        }
+        const int r2 = glob(pattern, r ? 0 : GLOB_APPEND, NULL, &g);
+        free(pattern);
+        // either of patterns might not match
+        r = (r2 == GLOB_NOMATCH && !r) ? 0 : r2;
+    } else {
+        r = glob(arg, 0, NULL, &g);
+    }
+    if (r == GLOB_NOMATCH) {
+        fprintf(stderr, "No input files found in %s\n", arg);
+        return -1;
+    }
+    if (r) {
+        return -1;
+    }
+
+    for (int i = 0; i < g.gl_pathc; ++i) {
+        if (job_add(jobs, njobs, g.gl_pathv[i])) {
+            globfree(&g);
+            return -1;
+        }
+    }
+    globfree(&g);
+
+    return 0;
+}
+
+/// concatenate summaries of all inputs, failed are reported without details
+static int summary_collect(const batch_cfg_t *cfg, const job_t *jobs,
+        int njobs)
+{
+    char *path = path_join(cfg->out_dir, "summary.jsonl");
+    if (!path) {
+        return -1;
+    }
+    char tmp_path[strlen(path) + sizeof(".tmp")];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) {
+        free(path);
+        return -1;
+    }
+    for (int i = 0; i < njobs; ++i) {
+        char *sum_path = out_path(cfg, &jobs[i], ".summary");
+        FILE *sum_f = sum_path ? fopen(sum_path, "r") : NULL;
+        free(sum_path);
+        if (!sum_f) {
+            continue;
+        }
+        char buf[4096];
+        size_t len;
+        while ((len = fread(buf, 1, sizeof(buf), sum_f)) > 0) {
+            fwrite(buf, 1, len, f);
+        }
+        fclose(sum_f);
+    }
+
+    const int ret = (ferror(f) | fclose(f) || rename(tmp_path, path)) ? -1 : 0;
+    if (ret) {
+        unlink(tmp_path);
+    }
+    free(path);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    batch_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = -1,
+        .out_fmt = EVT_OUT_JSON,
+        .probe_frames = PROBE_FRAMES_DEFAULT,
+        .out_dir = ".",
+    };
+    long nworkers = sysconf(_SC_NPROCESSORS_ONLN);
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:d:f:hj:o:p:t:")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'b':
+                if (!strcmp(optarg, "VHF")) {
+                    cfg.band = TETRAPOL_BAND_VHF;
+                } else if (!strcmp(optarg, "UHF")) {
+                    cfg.band = TETRAPOL_BAND_UHF;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'd':
+                if (!strcmp("UP", optarg)) {
+                    cfg.dir = DIR_UPLINK;
+                } else if (!strcmp("DOWN", optarg)) {
+                    cfg.dir = DIR_DOWNLINK;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'f':
+                cfg.out_fmt = evt_out_parse_fmt(optarg);
+                err = (cfg.out_fmt < 0) ? -1 : 0;
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            case 'j':
+                nworkers = atoi(optarg);
+                err = (nworkers <= 0) ? -1 : 0;
+                break;
+
+            case 'o':
+                cfg.out_dir = optarg;
+                break;
+
+            case 'p':
+                cfg.probe_frames = atoi(optarg);
+                err = (cfg.probe_frames <= 0) ? -1 : 0;
+                break;
+
+            case 't':
+                if (!strcmp("CCH", optarg)) {
+                    cfg.radio_ch_type = TETRAPOL_RADIO_CCH;
+                } else if (!strcmp("TCH", optarg)) {
+                    cfg.radio_ch_type = TETRAPOL_RADIO_TCH;
+                } else if (!strcmp("AUTO", optarg)) {
+                    cfg.radio_ch_type = -1;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (optind == argc) {
+        print_help(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    job_t *jobs = NULL;
+    int njobs = 0;
+    for (int i = optind; i < argc; ++i) {
+        if (jobs_add(&jobs, &njobs, argv[i])) {
+            return EXIT_FAILURE;
+        }
+    }
+    if (mkdir(cfg.out_dir, 0777) && errno != EEXIST) {
+        perror("Failed to create output directory");
+        return EXIT_FAILURE;
+    }
+
+    if (nworkers < 1) {
+        nworkers = 1;
+    }
+    if (nworkers > njobs) {
+        nworkers = njobs;
+    }
+    if (nworkers > WORKERS_MAX) {
+        nworkers = WORKERS_MAX;
+    }
+
+    batch_t batch = {
+        .cfg = &cfg,
+        .jobs = jobs,
+        .njobs = njobs,
+    };
+    pthread_mutex_init(&batch.print_lock, NULL);
+    log_set_backend(log_worker);
+    signal(SIGINT, sigint_handler);
+    signal(SIGTERM, sigint_handler);
+
+    pthread_t threads[WORKERS_MAX];
+    int nthreads = 0;
+    for (; nthreads < nworkers; ++nthreads) {
+        if (pthread_create(&threads[nthreads], NULL, worker, &batch)) {
+            break;
+        }
+    }
+    if (!nthreads) {
+        fprintf(stderr, "Failed to start workers.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < nthreads; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    int ndone = 0, nskipped = 0, nfailed = 0;
+    for (int i = 0; i < njobs; ++i) {
+        ndone += jobs[i].status == JOB_DONE;
+        nskipped += jobs[i].status == JOB_SKIPPED;
+        nfailed += jobs[i].status == JOB_FAILED;
+    }
+    int ret = 0;
+    if (summary_collect(&cfg, jobs, njobs)) {
+        fprintf(stderr, "Failed to write summary.\n");
+        ret = -1;
+    }
+    fprintf(stderr, "Files: total=%d decoded=%d skipped=%d failed=%d%s\n",
+            njobs, ndone, nskipped, nfailed,
+            do_exit ? " (interrupted, run again to resume)" : "");
+
+    for (int i = 0; i < njobs; ++i) {
+        free((char *)jobs[i].path);
+        free(jobs[i].name);
+    }
+    free(jobs);
+    pthread_mutex_destroy(&batch.print_lock);
+
+    return (ret || nfailed || do_exit) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+/**
+  Convert binary event stream produced by tetrapol_dump -f BIN into
+  JSON Lines, output is the same as produced by tetrapol_dump -f JSON.
+ */
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_out.h>
+#include <tetrapol/json_writer.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Convert binary TETRAPOL events into JSON Lines.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -i <PATH>               input file, (default stdin)\n");
+    fprintf(stderr, "    -o <PATH>               output file, (default stdout)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char *in = NULL;
+    const char *out = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:o:")) != -1) {
+        switch (opt) {
+            case 'i':
+                in = optarg;
+                break;
+
+            case 'o':
+                out = optarg;
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            default:
+                print_help(argv[0]);
+                exit(EXIT_FAILURE);
+                break;
+        }
+    }
+
+    FILE *fin = stdin;
+    if (in && strcmp(in, "-")) {
+        fin = fopen(in, "rb");
+        if (!fin) {
+            perror("Failed to open input file");
+            return -1;
+        }
+    }
+
+    if (out && strcmp(out, "-")) {
+        if (!freopen(out, "w", stdout)) {
+            perror("Failed to open output file");
+            return -1;
+        }
+    }
+
+    if (evt_bin_read_file_hdr(fin)) {
+        return -1;
+    }
+
+    evt_bin_rec_t *rec = malloc(sizeof(evt_bin_rec_t));
+    if (!rec) {
+        return -1;
+    }
+
+    json_writer_t *jw = json_writer_create(STDOUT_FILENO);
+    if (!jw) {
+        free(rec);
+        return -1;
+    }
+
+    evt_bin_ctx_t ctx;
+    evt_bin_ctx_init(&ctx);
+
+    int ret;
+    while ((ret = evt_bin_read(fin, &ctx, rec)) > 0) {
+        evt_json(jw, &rec->evt);
+    }
+
+    if (json_writer_flush(jw)) {
+        ret = -1;
+    }
+    json_writer_destroy(jw);
+    free(rec);
+    if (fin != stdin) {
+        fclose(fin);
+    }
+
+    return ret;
+}
@@ -1,7 +1,27 @@
 #include <tetrapol/tetrapol.h>
-// TODO: should use only tetrapol.h, but hi-level interface not implemented yet
+// events are received by tetrapol_subscribe(), input is fed by phys_ch.h,
+// capture, recording and checkpoint use their own interfaces
 #include <tetrapol/phys_ch.h>
+#include <tetrapol/capture.h>
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_bus.h>
+#include <tetrapol/evt_delta.h>
+#include <tetrapol/evt_out.h>
+#include <tetrapol/filter.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/log_async.h>
+#include <tetrapol/lsdu_cd.h>
+#include <tetrapol/lsdu_vch.h>
+#include <tetrapol/metrics.h>
+#include <tetrapol/recording.h>
+#include <tetrapol/snapshot.h>
+#include <tetrapol/trace.h>
+#include <tetrapol/tsdu_print.h>
 
+#include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <signal.h>
@@ -9,11 +29,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
-// set on SIGINT
+// set on SIGINT or SIGTERM
 volatile static int do_exit = 0;
 
+enum {
+    METRICS_INTERVAL = 10,  ///< seconds between metrics file updates
+    REPLAY_FLUSH_RECORDS = 64,  ///< replayed records between output flushes
+};
+
+typedef struct {
+    evt_out_t out;
+    evt_delta_t *delta;     ///< NULL when delta output is disabled
+    evt_bus_t *bus;         ///< NULL when publishing is disabled
+    tetrapol_t *tetrapol;
+    recording_writer_t *rw;     ///< NULL when recording is not written
+    const char *metrics_path;   ///< NULL when metrics are not written
+    time_t metrics_time;    ///< last update of metrics file
+    const char *checkpoint_path;  ///< NULL when checkpoint is not written
+    int checkpoint_interval;  ///< seconds between checkpoints, 0 on exit only
+    time_t checkpoint_time;   ///< last checkpoint
+} output_t;
+
 
 static void sigint_handler(int sig)
 {
@@ -38,7 +79,183 @@ static int do_read(int fd, uint8_t *buf, int len)
     return do_exit ? 0 : -1;
 }
 
-static int tetrapol_dump_loop(phys_ch_t *phys_ch, int fd)
+static void lsdu_print(const hdlc_frame_t *hdlc_fr)
+{
+    if (hdlc_fr->command.cmd == COMMAND_UNNUMBERED_UI_VCH) {
+        lsdu_vch_t lsdu;
+        if (!lsdu_vch_parse_hdlc_frame(hdlc_fr, &lsdu)) {
+            lsdu_vch_print(&lsdu);
+        }
+    } else {
+        lsdu_cd_t lsdu;
+        if (!lsdu_cd_parse(hdlc_fr->data, hdlc_fr->nbits / 8, &lsdu)) {
+            lsdu_cd_print(&lsdu);
+        }
+    }
+}
+
+static void output_write(output_t *output, const tetrapol_evt_t *evt)
+{
+    if (output->bus) {
+        evt_bus_publish(output->bus, evt);
+    }
+
+    if (output->out.fmt == EVT_OUT_NONE) {
+        return;
+    }
+
+    tetrapol_evt_t repeat;
+    if (output->delta) {
+        evt = evt_delta_push(output->delta, evt, &repeat);
+    }
+
+    evt_out_write(&output->out, evt);
+}
+
+static void evt_callback(const tetrapol_evt_t *evt, void *ptr)
+{
+    output_t *output = ptr;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            if (evt->frame.fr->broken) {
+                break;
+            }
+            output_write(output, evt);
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            if (evt->tsdu.decoded) {
+                LOG_IF(INFO) {
+                    LOGF("\n\tTSAP_ID=%d\tPRIO=%d\n",
+                            evt->tsdu.tsdu->tsap_id, evt->tsdu.tsdu->prio);
+                    tsdu_print(evt->tsdu.decoded);
+                }
+            }
+            output_write(output, evt);
+            break;
+
+        case TETRAPOL_EVT_LSDU:
+            lsdu_print(evt->lsdu.hdlc_fr);
+            break;
+
+        default:
+            output_write(output, evt);
+    }
+}
+
+static void metrics_update(output_t *output, bool force)
+{
+    if (!output->metrics_path) {
+        return;
+    }
+
+    const time_t now = time(NULL);
+    if (!force && now - output->metrics_time < METRICS_INTERVAL) {
+        return;
+    }
+    output->metrics_time = now;
+
+    tetrapol_metrics_t metrics;
+    tetrapol_get_metrics(output->tetrapol, &metrics);
+    metrics_write_prom(output->metrics_path, &metrics);
+}
+
+/// write checkpoint atomically, replaces the previous one
+static int checkpoint_write(const char *path, phys_ch_t *phys_ch)
+{
+    char tmp_path[strlen(path) + sizeof(".tmp")];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        perror("Failed to write checkpoint");
+        return -1;
+    }
+    if (tetrapol_snapshot_save(phys_ch, f) || fsync(fileno(f))) {
+        fclose(f);
+        unlink(tmp_path);
+        fprintf(stderr, "Failed to write checkpoint.\n");
+        return -1;
+    }
+    if (fclose(f) || rename(tmp_path, path)) {
+        unlink(tmp_path);
+        perror("Failed to write checkpoint");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void checkpoint_update(output_t *output, phys_ch_t *phys_ch, bool force)
+{
+    if (!output->checkpoint_path || (!force && !output->checkpoint_interval)) {
+        return;
+    }
+
+    const time_t now = time(NULL);
+    if (!force && now - output->checkpoint_time < output->checkpoint_interval) {
+        return;
+    }
+    output->checkpoint_time = now;
+
+    checkpoint_write(output->checkpoint_path, phys_ch);
+}
+
+/**
+  Resume from checkpoint when it exists. Seekable input continues at the
+  position where decoding stopped, bits lost on live input while decoder
+  was not running are estimated from current time.
+
+  @return 0 on success, -1 on error
+  */
+static int checkpoint_resume(const char *path, tetrapol_t *tetrapol,
+        phys_ch_t *phys_ch, int fd, const recording_hdr_t *rec_hdr,
+        uint64_t *in_len)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return (errno == ENOENT) ? 0 : -1;
+    }
+    const int r = tetrapol_snapshot_load(phys_ch, f);
+    fclose(f);
+    if (r) {
+        return -1;
+    }
+
+    const uint64_t in_offs = tetrapol_phys_ch_get_in_offs(phys_ch);
+    struct stat st;
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode)) {
+        const uint64_t hdr_len = rec_hdr ? RECORDING_HDR_LEN : 0;
+        if (lseek(fd, hdr_len + in_offs, SEEK_SET) < 0) {
+            return -1;
+        }
+        if (rec_hdr) {
+            *in_len = (rec_hdr->nbits > in_offs) ? rec_hdr->nbits - in_offs : 0;
+        }
+        fprintf(stderr, "Resumed at %llu bits.\n", (unsigned long long)in_offs);
+        return 0;
+    }
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    const uint64_t now = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+    const uint64_t start_time = tetrapol_get_cfg(tetrapol)->start_time;
+    const uint64_t rx_offs = (now > start_time) ?
+        (now - start_time) / TETRAPOL_BIT_USEC : 0;
+    if (rx_offs > in_offs) {
+        tetrapol_phys_ch_rx_gap(phys_ch, rx_offs);
+    }
+    fprintf(stderr, "Resumed at %llu bits, %llu bits lost.\n",
+            (unsigned long long)in_offs,
+            (unsigned long long)((rx_offs > in_offs) ? rx_offs - in_offs : 0));
+
+    return 0;
+}
+
+/// in_len limits number of bits read from fd
+static int tetrapol_dump_loop(phys_ch_t *phys_ch, int fd, uint64_t in_len,
+        output_t *output)
 {
     int ret = 0;
     int data_len = 0;
@@ -49,16 +266,24 @@ static int tetrapol_dump_loop(phys_ch_t *phys_ch, int fd)
     }
 
     signal(SIGINT, sigint_handler);
+    signal(SIGTERM, sigint_handler);
 
     while (ret == 0 && !do_exit) {
         if (sizeof(data) - data_len > 0) {
-            const int rsize = do_read(fd, data + data_len, sizeof(data) - data_len);
+            const int len = (sizeof(data) - data_len > in_len) ?
+                in_len : sizeof(data) - data_len;
+            const int rsize = len ? do_read(fd, data + data_len, len) : 0;
             if (rsize < 0) {
                 return rsize;
             }
             if (!rsize && !data_len) {
                 return 0;
             }
+            if (output->rw &&
+                    recording_writer_write(output->rw, data + data_len, rsize)) {
+                return -1;
+            }
+            in_len -= rsize;
             data_len += rsize;
         }
 
@@ -72,19 +297,200 @@ static int tetrapol_dump_loop(phys_ch_t *phys_ch, int fd)
         }
 
         ret = tetrapol_phys_ch_process(phys_ch);
+        if (output->out.jw && json_writer_flush(output->out.jw)) {
+            return -1;
+        }
+        if (output->bus) {
+            evt_bus_poll(output->bus);
+        }
+        metrics_update(output, false);
+        checkpoint_update(output, phys_ch, false);
     }
 
     return ret;
 }
 
+static int tetrapol_replay_loop(phys_ch_t *phys_ch, capture_reader_t *cr,
+        output_t *output)
+{
+    signal(SIGINT, sigint_handler);
+
+    int r = 0;
+    capture_rec_t rec;
+    for (int i = 1; !do_exit && (r = capture_read(cr, &rec)) > 0; ++i) {
+        capture_replay(phys_ch, &rec);
+        if (i % REPLAY_FLUSH_RECORDS) {
+            continue;
+        }
+
+        if (output->out.jw && json_writer_flush(output->out.jw)) {
+            return -1;
+        }
+        if (output->bus) {
+            evt_bus_poll(output->bus);
+        }
+        metrics_update(output, false);
+    }
+
+    if (output->out.jw && json_writer_flush(output->out.jw)) {
+        return -1;
+    }
+
+    return (r < 0) ? -1 : 0;
+}
+
+/// parse "SECONDS[.FRACTION]" into us, return -1 on error
+static int parse_start_time(const char *s, uint64_t *start_time)
+{
+    char *end;
+    errno = 0;
+    const unsigned long long sec = strtoull(s, &end, 10);
+    if (errno || end == s || *s == '-') {
+        return -1;
+    }
+
+    uint64_t usec = 0;
+    if (*end == '.') {
+        ++end;
+        for (int i = 0; i < 6; ++i) {
+            usec *= 10;
+            if (*end >= '0' && *end <= '9') {
+                usec += *end++ - '0';
+            }
+        }
+        while (*end >= '0' && *end <= '9') {
+            ++end;
+        }
+    }
+    if (*end) {
+        return -1;
+    }
+
+    *start_time = sec * 1000000 + usec;
+
+    return 0;
+}
+
+/// parse frequency in Hz, return -1 on error
+static int parse_freq(const char *s, uint64_t *freq)
+{
+    char *end;
+    errno = 0;
+    const unsigned long long f = strtoull(s, &end, 10);
+    if (errno || end == s || *s == '-' || *end) {
+        return -1;
+    }
+    *freq = f;
+
+    return 0;
+}
+
+/// parse "SECONDS[.FRACTION]" or "FRAMESf" into position in bits
+static int parse_seek(const char *s, uint64_t *rx_offs)
+{
+    const size_t len = strlen(s);
+    if (len && s[len - 1] == 'f') {
+        char *end;
+        errno = 0;
+        const unsigned long long nframes = strtoull(s, &end, 10);
+        if (errno || end == s || *s == '-' || end != s + len - 1) {
+            return -1;
+        }
+        *rx_offs = nframes * FRAME_LEN;
+        return 0;
+    }
+
+    uint64_t usec;
+    if (parse_start_time(s, &usec)) {
+        return -1;
+    }
+    *rx_offs = usec / TETRAPOL_BIT_USEC;
+
+    return 0;
+}
+
+/// prepare decoding of recording from position rx_offs, return -1 on error
+static int recording_seek(int fd, const recording_hdr_t *hdr,
+        uint64_t rx_offs, phys_ch_t *phys_ch, uint64_t *in_len)
+{
+    if (rx_offs >= hdr->nbits) {
+        fprintf(stderr, "Seek position is past the end of recording.\n");
+        return -1;
+    }
+
+    recording_idx_t *idx;
+    const int nidx = recording_read_index(fd, hdr, &idx);
+    if (nidx <= 0) {
+        fprintf(stderr, "Recording has no index.\n");
+        return -1;
+    }
+
+    const recording_idx_t *e = recording_find(idx, nidx, rx_offs);
+    if (!e || e->rx_offs >= hdr->nbits) {
+        free(idx);
+        return e ? -1 : 0;
+    }
+
+    if (lseek(fd, RECORDING_HDR_LEN + e->rx_offs, SEEK_SET) < 0) {
+        free(idx);
+        return -1;
+    }
+    *in_len = hdr->nbits - e->rx_offs;
+    tetrapol_phys_ch_seek(phys_ch, e->rx_offs, e->frame_no, e->scr);
+    if (e->has_cell_id) {
+        fprintf(stderr, "Seek: frame=%llu frame_no=%d scr=%d "
+                "cell_id=%d.%d\n", (unsigned long long)(e->rx_offs / FRAME_LEN),
+                e->frame_no, e->scr, e->cell_id.bs_id, e->cell_id.rsw_id);
+    } else {
+        fprintf(stderr, "Seek: frame=%llu frame_no=%d scr=%d\n",
+                (unsigned long long)(e->rx_offs / FRAME_LEN),
+                e->frame_no, e->scr);
+    }
+    free(idx);
+
+    return 0;
+}
+
 static void print_help(const char *prg_name)
 {
     fprintf(stderr, "Decode data from demodulated TETRAPOL channel.\n");
     fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
-    fprintf(stderr, "    -i <PATH>               input file with demodulated bits\n");
+    fprintf(stderr, "    -i <PATH>               input file with demodulated bits or recording\n");
+    fprintf(stderr, "    -S, --seek <POS>        start decoding of recording at SECONDS[.FRACTION]\n"
+                    "                            or FRAMESf from its start, using index\n");
+    fprintf(stderr, "    -w <PATH>               write recording of input with index for --seek\n");
+    fprintf(stderr, "    -q <HZ>                 carrier frequency stored in recording, requires -w\n");
+    fprintf(stderr, "    -k <PATH>               resume decoder state from checkpoint when it\n"
+                    "                            exists, write it on exit (SIGINT, SIGTERM, EOF)\n");
+    fprintf(stderr, "    -K <SECONDS>            write checkpoint also every SECONDS\n");
+    fprintf(stderr, "    -r <PATH>               replay capture instead of decoding bits, band,\n"
+                    "                            direction and channel type are taken from capture\n");
+    fprintf(stderr, "    -c <PATH>               capture decoded frames for replay by -r\n");
+    fprintf(stderr, "    -C <PATH>               capture HDLC frames for replay by -r, smaller\n"
+                    "                            and faster to replay, frames, PCH and RCH are lost\n");
     fprintf(stderr, "    -b { UHF | VHF }        radio band (default is UHF\n");
     fprintf(stderr, "    -t { CCH | TCH }        select betwen control and traffic channel\n");
     fprintf(stderr, "    -d { DOWN | UP }        direction, downlink/direct or uplink\n");
+    fprintf(stderr, "    -f { JSON | BIN | NONE }\n"
+                    "                            output format, BIN can be converted\n"
+                    "                            by tetrapol_bin2json (default JSON)\n");
+    fprintf(stderr, "    -P <PATH>               publish events for tetrapol_sub on UNIX socket\n");
+    fprintf(stderr, "    -M <PATH>               write metrics in Prometheus text format every %d s\n",
+            METRICS_INTERVAL);
+    fprintf(stderr, "    -T <PATH>               write trace of decoding stages for chrome://tracing\n");
+    fprintf(stderr, "    -D <SECONDS>            write BCH, PCH and RCH only when changed, but\n"
+                    "                            at least once per SECONDS, requires -f BIN,\n"
+                    "                            see tetrapol_expand\n");
+    fprintf(stderr, "    -F <KEY=VAL[,VAL...]>   report only matching events, might be\n"
+                    "                            repeated, can not be combined with -c, -C, -w\n"
+                    "                            log_ch=SDCH,BCH   codop=0x4e\n"
+                    "                            addr=Z.Y.X[-Z.Y.X]   frame=DATA,VOICE\n");
+    fprintf(stderr, "    -a <SECONDS>            drop terminal state after inactivity (default %d)\n",
+            TETRAPOL_TERMINAL_IDLE_TIMEOUT_DEFAULT);
+    fprintf(stderr, "    -m <COUNT>              max. number of tracked terminals (default %d)\n",
+            TETRAPOL_TERMINALS_MAX_DEFAULT);
+    fprintf(stderr, "    -s <SECONDS[.FRACTION]> reception time of input start, seconds since\n"
+                    "                            epoch (default current time)\n");
 }
 
 int main(int argc, char* argv[])
@@ -96,10 +502,40 @@ int main(int argc, char* argv[])
     };
 
     const char *in = NULL;
+    const char *replay_path = NULL;
+    const char *recording_path = NULL;
+    uint64_t freq = 0;
+    bool has_freq = false;
+    bool has_seek = false;
+    uint64_t seek_rx_offs = 0;
+    const char *capture_path = NULL;
+    int capture_level = 0;
+    bool has_start_time = false;
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+    int keyframe_interval = 0;
+    const char *bus_path = NULL;
+    const char *trace_path = NULL;
+    output_t output;
+    memset(&output, 0, sizeof(output));
+    evt_out_init(&output.out, EVT_OUT_JSON, NULL, stdout);
 
+    static const struct option long_opts[] = {
+        { "seek", required_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 },
+    };
     int opt;
-    while ((opt = getopt(argc, argv, "b:hi:t:d:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:b:c:C:d:D:f:F:hi:k:K:m:M:P:q:r:s:S:t:T:w:",
+                    long_opts, NULL)) != -1) {
         switch (opt) {
+            case 'a':
+                if (atoi(optarg) <= 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                cfg.terminal_idle_timeout = atoi(optarg);
+                break;
+
             case 'b':
                 if (!strcmp(optarg, "VHF")) {
                     cfg.band = TETRAPOL_BAND_VHF;
@@ -111,10 +547,64 @@ int main(int argc, char* argv[])
                 }
                 break;
 
+            case 'c':
+                capture_path = optarg;
+                capture_level = CAPTURE_LEVEL_FRAME;
+                break;
+
+            case 'C':
+                capture_path = optarg;
+                capture_level = CAPTURE_LEVEL_HDLC;
+                break;
+
             case 'i':
                 in = optarg;
                 break;
 
+            case 'k':
+                output.checkpoint_path = optarg;
+                break;
+
+            case 'K':
+                output.checkpoint_interval = atoi(optarg);
+                if (output.checkpoint_interval <= 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'q':
+                if (parse_freq(optarg, &freq)) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                has_freq = true;
+                break;
+
+            case 'r':
+                replay_path = optarg;
+                break;
+
+            case 'S':
+                if (parse_seek(optarg, &seek_rx_offs)) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                has_seek = true;
+                break;
+
+            case 'w':
+                recording_path = optarg;
+                break;
+
+            case 's':
+                if (parse_start_time(optarg, &cfg.start_time)) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                has_start_time = true;
+                break;
+
             case 't':
                 if (!strcmp("CCH", optarg)) {
                     cfg.radio_ch_type = TETRAPOL_RADIO_CCH;
@@ -142,6 +632,49 @@ int main(int argc, char* argv[])
                 }
                 break;
 
+            case 'f':
+                output.out.fmt = evt_out_parse_fmt(optarg);
+                if (output.out.fmt < 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'D':
+                keyframe_interval = atoi(optarg);
+                if (keyframe_interval <= 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'F':
+                if (filter_parse(&filter, optarg)) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 'M':
+                output.metrics_path = optarg;
+                break;
+
+            case 'P':
+                bus_path = optarg;
+                break;
+
+            case 'T':
+                trace_path = optarg;
+                break;
+
+            case 'm':
+                if (atoi(optarg) <= 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                cfg.terminals_max = atoi(optarg);
+                break;
+
             default:
                 print_help(argv[0]);
                 exit(EXIT_FAILURE);
@@ -149,13 +682,81 @@ int main(int argc, char* argv[])
         }
     }
 
+    capture_reader_t cr;
+    FILE *replay_f = NULL;
+    if (replay_path) {
+        replay_f = strcmp(replay_path, "-") ? fopen(replay_path, "rb") : stdin;
+        if (!replay_f) {
+            perror("Failed to open capture");
+            return -1;
+        }
+        if (capture_reader_init(&cr, replay_f)) {
+            fprintf(stderr, "Invalid capture.");
+            return -1;
+        }
+        cfg.band = cr.hdr.cfg.band;
+        cfg.dir = cr.hdr.cfg.dir;
+        cfg.radio_ch_type = cr.hdr.cfg.radio_ch_type;
+        if (!has_start_time) {
+            cfg.start_time = cr.hdr.cfg.start_time;
+            has_start_time = true;
+        }
+    }
+
+    if ((replay_f || has_seek) && recording_path) {
+        fprintf(stderr, "Recording can be written only from the start of input.\n");
+        return -1;
+    }
+
+    if (has_freq && !recording_path) {
+        fprintf(stderr, "Frequency (-q) can be stored only with -w.\n");
+        return -1;
+    }
+
+    if (keyframe_interval && output.out.fmt != EVT_OUT_BIN) {
+        fprintf(stderr, "Delta output (-D) can be written only with -f BIN.\n");
+        return -1;
+    }
+
+    if ((replay_f || has_seek || recording_path) && output.checkpoint_path) {
+        fprintf(stderr, "Checkpoint can not be combined with -r, -S or -w.\n");
+        return -1;
+    }
+
     int infd = STDIN_FILENO;
-    if (in && strcmp(in, "-")) {
+    recording_hdr_t rec_hdr;
+    int is_recording = 0;
+    uint64_t in_len = UINT64_MAX;
+    if (!replay_f && in && strcmp(in, "-")) {
         infd = open(in, O_RDONLY);
         if (infd == -1) {
             perror("Failed to open input file");
             return -1;
         }
+        is_recording = recording_read_hdr(infd, &rec_hdr);
+        if (is_recording < 0) {
+            fprintf(stderr, "Invalid recording.\n");
+            return -1;
+        }
+    }
+    if (is_recording) {
+        cfg.band = rec_hdr.cfg.band;
+        cfg.dir = rec_hdr.cfg.dir;
+        cfg.radio_ch_type = rec_hdr.cfg.radio_ch_type;
+        if (!has_start_time) {
+            cfg.start_time = rec_hdr.cfg.start_time;
+            has_start_time = true;
+        }
+        in_len = rec_hdr.nbits;
+    } else if (has_seek) {
+        fprintf(stderr, "Seek is supported only for recordings.\n");
+        return -1;
+    }
+
+    if (!has_start_time) {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        cfg.start_time = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
     }
 
     tetrapol_t *tetrapol = tetrapol_create(&cfg);
@@ -163,18 +764,169 @@ int main(int argc, char* argv[])
         fprintf(stderr, "Failed to initialize TETRAPOL instance.");
         return -1;
     }
+    output.tetrapol = tetrapol;
+    if (!tetrapol_set_filter(tetrapol, &filter)) {
+        fprintf(stderr, "Invalid filter.");
+        return -1;
+    }
+    if ((capture_path || recording_path) && tetrapol_has_filter(tetrapol)) {
+        fprintf(stderr, "Capture and recording can not be combined with -F.\n");
+        return -1;
+    }
+    if (keyframe_interval) {
+        output.delta = evt_delta_create((uint64_t)keyframe_interval * 1000000);
+        if (!output.delta) {
+            fprintf(stderr, "Failed to initialize output.");
+            return -1;
+        }
+    }
+    if (bus_path) {
+        output.bus = evt_bus_create(bus_path, EVT_BUS_QUEUE_SIZE_DEFAULT);
+        if (!output.bus) {
+            fprintf(stderr, "Failed to create event bus.");
+            return -1;
+        }
+    }
+    if (!tetrapol_subscribe(tetrapol, TETRAPOL_EVT_FRAME | TETRAPOL_EVT_SCR |
+                TETRAPOL_EVT_TSDU_DECODED | TETRAPOL_EVT_LSDU |
+                TETRAPOL_EVT_PCH | TETRAPOL_EVT_RCH,
+                evt_callback, &output)) {
+        fprintf(stderr, "Failed to subscribe for events.");
+        return -1;
+    }
+    if (output.out.fmt == EVT_OUT_BIN && evt_bin_write_file_hdr(stdout)) {
+        fprintf(stderr, "Failed to write output.");
+        return -1;
+    }
+    if (output.out.fmt == EVT_OUT_JSON) {
+        output.out.jw = json_writer_create(STDOUT_FILENO);
+        if (!output.out.jw) {
+            fprintf(stderr, "Failed to initialize output.");
+            return -1;
+        }
+    }
     phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
     if (phys_ch == NULL) {
         fprintf(stderr, "Failed to initialize TETRAPOL instance.");
         return -1;
     }
+    if (has_seek &&
+            recording_seek(infd, &rec_hdr, seek_rx_offs, phys_ch, &in_len)) {
+        fprintf(stderr, "Seek failed.\n");
+        return -1;
+    }
+    if (output.checkpoint_path && checkpoint_resume(output.checkpoint_path,
+                tetrapol, phys_ch, infd, is_recording ? &rec_hdr : NULL,
+                &in_len)) {
+        fprintf(stderr, "Failed to resume from checkpoint.\n");
+        return -1;
+    }
+    output.checkpoint_time = time(NULL);
+    FILE *recording_f = NULL;
+    if (recording_path) {
+        recording_f = fopen(recording_path, "wb");
+        output.rw = recording_f ?
+            recording_writer_create(recording_f, freq, tetrapol) : NULL;
+        if (!output.rw) {
+            fprintf(stderr, "Failed to create recording.\n");
+            return -1;
+        }
+    }
+    FILE *capture_f = NULL;
+    capture_writer_t *cw = NULL;
+    if (capture_path) {
+        capture_f = fopen(capture_path, "wb");
+        cw = capture_f ?
+            capture_writer_create(capture_f, capture_level, tetrapol) : NULL;
+        if (!cw) {
+            fprintf(stderr, "Failed to create capture.");
+            return -1;
+        }
+    }
+
+    if (trace_path && trace_start(TRACE_EVENTS_DEFAULT)) {
+        fprintf(stderr, "Failed to start tracing.");
+        return -1;
+    }
+
+    // keep decoding when stderr is slow
+    if (log_async_start()) {
+        fprintf(stderr, "Failed to start logging thread.");
+    }
+    int ret = replay_f ? tetrapol_replay_loop(phys_ch, &cr, &output) :
+        tetrapol_dump_loop(phys_ch, infd, in_len, &output);
+    log_async_stop();
+    if (cw && (capture_writer_destroy(cw) || fclose(capture_f))) {
+        fprintf(stderr, "Failed to write capture.\n");
+        ret = -1;
+    }
+    if (output.rw &&
+            (recording_writer_destroy(output.rw) || fclose(recording_f))) {
+        fprintf(stderr, "Failed to write recording.\n");
+        ret = -1;
+    }
+    metrics_update(&output, true);
+    if (!replay_f) {
+        checkpoint_update(&output, phys_ch, true);
+    }
+
+    tetrapol_stats_t stats;
+    tetrapol_get_stats(tetrapol, &stats);
+    fprintf(stderr, "Terminals: live=%llu created=%llu evicted_idle=%llu "
+            "evicted_lru=%llu\n",
+            (unsigned long long)stats.terminals_live,
+            (unsigned long long)stats.terminals_created,
+            (unsigned long long)stats.terminals_evicted_idle,
+            (unsigned long long)stats.terminals_evicted_lru);
+    fprintf(stderr, "Memory pools: allocs=%llu frees=%llu in_use=%llu "
+            "slabs=%llu bytes=%llu\n",
+            (unsigned long long)stats.pool_allocs,
+            (unsigned long long)stats.pool_frees,
+            (unsigned long long)stats.pool_in_use,
+            (unsigned long long)stats.pool_slabs,
+            (unsigned long long)stats.pool_bytes);
+    fprintf(stderr, "Log: dropped=%llu\n",
+            (unsigned long long)log_async_dropped());
+    fprintf(stderr, "Filtered: log_ch=%llu codop=%llu addr=%llu frame=%llu\n",
+            (unsigned long long)stats.filtered_log_ch,
+            (unsigned long long)stats.filtered_codop,
+            (unsigned long long)stats.filtered_addr,
+            (unsigned long long)stats.filtered_fr_type);
+    if (output.bus) {
+        evt_bus_stats_t bus_stats;
+        evt_bus_get_stats(output.bus, &bus_stats);
+        fprintf(stderr, "Event bus: clients=%llu published=%llu queued=%llu "
+                "dropped=%llu disconnected=%llu\n",
+                (unsigned long long)bus_stats.clients,
+                (unsigned long long)bus_stats.published,
+                (unsigned long long)bus_stats.queued,
+                (unsigned long long)bus_stats.dropped,
+                (unsigned long long)bus_stats.disconnected);
+    }
+    if (trace_path) {
+        trace_latency_t latency;
+        trace_get_latency(&latency);
+        fprintf(stderr, "Trace: tsdus=%llu latency_avg_us=%llu "
+                "latency_max_us=%llu\n",
+                (unsigned long long)latency.count,
+                (unsigned long long)(latency.count ?
+                    latency.sum_ns / latency.count / 1000 : 0),
+                (unsigned long long)(latency.max_ns / 1000));
+        trace_write_chrome(trace_path);
+        trace_stop();
+    }
 
-    const int ret = tetrapol_dump_loop(phys_ch, infd);
     tetrapol_phys_ch_destroy(phys_ch);
     if (infd != STDIN_FILENO) {
         close(infd);
     }
+    if (replay_f && replay_f != stdin) {
+        fclose(replay_f);
+    }
     tetrapol_destroy(tetrapol);
+    json_writer_destroy(output.out.jw);
+    evt_delta_destroy(output.delta);
+    evt_bus_destroy(output.bus);
 
     fprintf(stderr, "Exiting.\n");
 
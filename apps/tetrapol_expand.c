@@ -0,0 +1,102 @@
+/**
+  Expand binary event stream produced by tetrapol_dump -f BIN -D <SECONDS>,
+  repeat records are replaced by full events. Output is binary event stream
+  as produced without -D.
+ */
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_delta.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Expand delta coded binary TETRAPOL events.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -i <PATH>               input file, (default stdin)\n");
+    fprintf(stderr, "    -o <PATH>               output file, (default stdout)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    const char *in = NULL;
+    const char *out = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:o:")) != -1) {
+        switch (opt) {
+            case 'i':
+                in = optarg;
+                break;
+
+            case 'o':
+                out = optarg;
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            default:
+                print_help(argv[0]);
+                exit(EXIT_FAILURE);
+                break;
+        }
+    }
+
+    FILE *fin = stdin;
+    if (in && strcmp(in, "-")) {
+        fin = fopen(in, "rb");
+        if (!fin) {
+            perror("Failed to open input file");
+            return -1;
+        }
+    }
+
+    if (out && strcmp(out, "-")) {
+        if (!freopen(out, "wb", stdout)) {
+            perror("Failed to open output file");
+            return -1;
+        }
+    }
+
+    if (evt_bin_read_file_hdr(fin) || evt_bin_write_file_hdr(stdout)) {
+        return -1;
+    }
+
+    evt_bin_rec_t *rec = malloc(sizeof(evt_bin_rec_t));
+    if (!rec) {
+        return -1;
+    }
+
+    evt_expand_t *expand = evt_expand_create();
+    if (!expand) {
+        free(rec);
+        return -1;
+    }
+
+    evt_bin_ctx_t ctx_in;
+    evt_bin_ctx_t ctx_out;
+    evt_bin_ctx_init(&ctx_in);
+    evt_bin_ctx_init(&ctx_out);
+
+    int ret;
+    while ((ret = evt_bin_read(fin, &ctx_in, rec)) > 0) {
+        const tetrapol_evt_t *evt = evt_expand_push(expand, &rec->evt);
+        if (evt && evt_bin_write(stdout, &ctx_out, evt)) {
+            ret = -1;
+            break;
+        }
+    }
+
+    evt_expand_destroy(expand);
+    free(rec);
+    if (fin != stdin) {
+        fclose(fin);
+    }
+
+    return ret;
+}
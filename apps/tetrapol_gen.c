@@ -0,0 +1,319 @@
+/**
+  Generate synthetic TETRAPOL channel, stream of encoded frames with
+  pseudo-random content and optional impairments. Output has the same format
+  as input of tetrapol_dump, one bit per byte.
+
+  Ground truth is written into sidecar file as JSON events, one per line.
+  Frame events use the same frame description as tetrapol_dump.
+ */
+#include <tetrapol/chan_gen.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/tetrapol.h>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+enum {
+    NFRAMES_DEFAULT = 1000,
+};
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Generate synthetic TETRAPOL channel.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -o <PATH>               output file (default stdout)\n");
+    fprintf(stderr, "    -g <PATH>               write ground truth as JSON events\n");
+    fprintf(stderr, "    -b { UHF | VHF }        radio band (default is UHF)\n");
+    fprintf(stderr, "    -d { DOWN | UP }        direction, downlink/direct or uplink\n");
+    fprintf(stderr, "    -t { DATA | VOICE }     type of frames (default DATA)\n");
+    fprintf(stderr, "    -s <SCR>                scrambling constant (default 0)\n");
+    fprintf(stderr, "    -n <FRAMES>             number of frames (default %d)\n",
+            NFRAMES_DEFAULT);
+    fprintf(stderr, "    -r <SEED>               seed of pseudo-random generator\n");
+    fprintf(stderr, "    -e <BER>                bit error rate\n");
+    fprintf(stderr, "    -B <RATE:LEN>           burst of LEN random bits, RATE per frame\n");
+    fprintf(stderr, "    -l <RATE>               bit slip (deletion or insertion) per frame\n");
+    fprintf(stderr, "    -p <RATE>               polarity flip per frame\n");
+    fprintf(stderr, "    -G <RATE:LEN>           idle gap of LEN noise bits, RATE per frame\n");
+}
+
+static void frame_truth(json_writer_t *jw, const chan_gen_evt_t *evt)
+{
+    const frame_t *fr = evt->frame.fr;
+
+    json_writer_str(jw, "{ \"event\": \"frame\", \"offs\": ");
+    json_writer_uint(jw, evt->offs);
+    json_writer_str(jw, ", \"seq\": ");
+    json_writer_uint(jw, evt->frame.seq);
+    json_writer_str(jw, ", \"bit_errs\": ");
+    json_writer_int(jw, evt->frame.bit_errs);
+    json_writer_str(jw, ", \"frame\": { ");
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        json_writer_str(jw, "\"type\": \"DATA\", \"asb\": [");
+        json_writer_int(jw, fr->data.asb[0]);
+        json_writer_str(jw, ", ");
+        json_writer_int(jw, fr->data.asb[1]);
+        json_writer_str(jw, "], \"fn\": [");
+        json_writer_int(jw, fr->data.data[0]);
+        json_writer_str(jw, ", ");
+        json_writer_int(jw, fr->data.data[1]);
+        json_writer_str(jw, "], ");
+
+        uint8_t data[8];
+        memset(data, 0, sizeof(data));
+        for (int i = 0; i < 8*8; ++i) {
+            data[i / 8] |= fr->data.data[i + 2] << (i % 8);
+        }
+        json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+        json_writer_hex(jw, data, sizeof(data));
+        json_writer_str(jw, "\" } ");
+    } else {
+        json_writer_str(jw, "\"type\": \"VOICE\", \"asb\": [");
+        json_writer_int(jw, fr->voice.asb[0]);
+        json_writer_str(jw, ", ");
+        json_writer_int(jw, fr->voice.asb[1]);
+        json_writer_str(jw, "], ");
+
+        uint8_t voice[120/8];
+        memset(voice, 0, sizeof(voice));
+        for (int i = 0; i < 20; ++i) {
+            voice[i / 8] |= fr->voice.voice1[i] << (i % 8);
+        }
+        for (int i = 20; i < 120; ++i) {
+            voice[i / 8] |= fr->voice.voice2[i - 20] << (i % 8);
+        }
+        json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+        json_writer_hex(jw, voice, sizeof(voice));
+        json_writer_str(jw, "\" } ");
+    }
+    json_writer_str(jw, "} }\n");
+}
+
+static void truth_cb(const chan_gen_evt_t *evt, void *ptr)
+{
+    json_writer_t *jw = ptr;
+
+    switch (evt->type) {
+        case CHAN_GEN_EVT_FRAME:
+            frame_truth(jw, evt);
+            return;
+
+        case CHAN_GEN_EVT_BURST:
+            json_writer_str(jw, "{ \"event\": \"burst\", \"offs\": ");
+            json_writer_uint(jw, evt->offs);
+            json_writer_str(jw, ", \"len\": ");
+            json_writer_int(jw, evt->burst.len);
+            break;
+
+        case CHAN_GEN_EVT_SLIP:
+            json_writer_str(jw, "{ \"event\": \"slip\", \"offs\": ");
+            json_writer_uint(jw, evt->offs);
+            json_writer_str(jw, ", \"bits\": ");
+            json_writer_int(jw, evt->slip.bits);
+            break;
+
+        case CHAN_GEN_EVT_POLARITY:
+            json_writer_str(jw, "{ \"event\": \"polarity\", \"offs\": ");
+            json_writer_uint(jw, evt->offs);
+            break;
+
+        case CHAN_GEN_EVT_GAP:
+            json_writer_str(jw, "{ \"event\": \"gap\", \"offs\": ");
+            json_writer_uint(jw, evt->offs);
+            json_writer_str(jw, ", \"len\": ");
+            json_writer_int(jw, evt->gap.len);
+            break;
+    }
+    json_writer_str(jw, " }\n");
+}
+
+/// parse "RATE:LEN", return -1 on error
+static int parse_rate_len(const char *s, double *rate, int *len)
+{
+    char c;
+    if (sscanf(s, "%lf:%d%c", rate, len, &c) != 2) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int parse_rate(const char *s, double *rate)
+{
+    char c;
+    if (sscanf(s, "%lf%c", rate, &c) != 1) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const char *out = NULL;
+    const char *truth = NULL;
+    long long nframes = NFRAMES_DEFAULT;
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .fr_type = FRAME_TYPE_DATA,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "B:b:d:e:G:g:hl:n:o:p:r:s:t:")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'B':
+                err = parse_rate_len(optarg, &cfg.burst_rate, &cfg.burst_len);
+                break;
+
+            case 'b':
+                if (!strcmp(optarg, "VHF")) {
+                    cfg.band = TETRAPOL_BAND_VHF;
+                } else if (!strcmp(optarg, "UHF")) {
+                    cfg.band = TETRAPOL_BAND_UHF;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'd':
+                if (!strcmp(optarg, "DOWN")) {
+                    cfg.dir = DIR_DOWNLINK;
+                } else if (!strcmp(optarg, "UP")) {
+                    cfg.dir = DIR_UPLINK;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'e':
+                err = parse_rate(optarg, &cfg.ber);
+                break;
+
+            case 'G':
+                err = parse_rate_len(optarg, &cfg.gap_rate, &cfg.gap_len);
+                break;
+
+            case 'g':
+                truth = optarg;
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            case 'l':
+                err = parse_rate(optarg, &cfg.slip_rate);
+                break;
+
+            case 'n':
+                nframes = atoll(optarg);
+                err = (nframes < 0) ? -1 : 0;
+                break;
+
+            case 'o':
+                out = optarg;
+                break;
+
+            case 'p':
+                err = parse_rate(optarg, &cfg.polarity_rate);
+                break;
+
+            case 'r':
+                cfg.seed = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                cfg.scr = atoi(optarg);
+                err = (cfg.scr < 0 || cfg.scr > 127) ? -1 : 0;
+                break;
+
+            case 't':
+                if (!strcmp(optarg, "DATA")) {
+                    cfg.fr_type = FRAME_TYPE_DATA;
+                } else if (!strcmp(optarg, "VOICE")) {
+                    cfg.fr_type = FRAME_TYPE_VOICE;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    chan_gen_t *gen = chan_gen_create(&cfg);
+    if (!gen) {
+        fprintf(stderr, "Invalid configuration\n");
+        print_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (out && strcmp(out, "-")) {
+        if (!freopen(out, "wb", stdout)) {
+            perror("Failed to open output file");
+            chan_gen_destroy(gen);
+            return EXIT_FAILURE;
+        }
+    }
+
+    json_writer_t *jw = NULL;
+    if (truth) {
+        const int fd = open(truth, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror("Failed to open ground truth file");
+            chan_gen_destroy(gen);
+            return EXIT_FAILURE;
+        }
+        jw = json_writer_create(fd);
+        if (!jw) {
+            close(fd);
+            chan_gen_destroy(gen);
+            return EXIT_FAILURE;
+        }
+        chan_gen_set_evt_cb(gen, truth_cb, jw);
+    }
+
+    int ret = 0;
+    uint8_t *bits = malloc(chan_gen_frame_len_max(gen));
+    if (!bits) {
+        ret = -1;
+    }
+    for (long long i = 0; !ret && i < nframes; ++i) {
+        const int n = chan_gen_frame(gen, bits);
+        if (n < 0 || fwrite(bits, 1, n, stdout) != n) {
+            perror("Failed to write output");
+            ret = -1;
+        }
+        if (jw && json_writer_flush(jw)) {
+            perror("Failed to write ground truth");
+            ret = -1;
+        }
+    }
+
+    free(bits);
+    if (jw) {
+        const int fd = jw->fd;
+        json_writer_destroy(jw);
+        close(fd);
+    }
+    chan_gen_destroy(gen);
+    if (fflush(stdout)) {
+        ret = -1;
+    }
+
+    return ret ? EXIT_FAILURE : 0;
+}
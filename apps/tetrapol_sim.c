@@ -0,0 +1,325 @@
+/**
+  Virtual SwMI, generate control channel traffic of cell with many terminals
+  and either decode it in-process or write it into file.
+
+  In-process mode reports decoder cost and memory periodically as JSON
+  lines, time spent in simulator and encoder is not included. Output file
+  has the same format as input of tetrapol_dump, one bit per byte.
+ */
+#define _DEFAULT_SOURCE 1
+
+#include <tetrapol/frame.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/swmi_sim.h>
+#include <tetrapol/tetrapol.h>
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    NFRAMES_DEFAULT = 30 * 200,     ///< 30 superframes, 2 minutes
+    NTERMINALS_DEFAULT = 1000,
+    REPORT_DEFAULT = 1500,          ///< 30 s
+};
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Simulate control channel traffic of TETRAPOL cell.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -o <PATH>               write channel bits instead of decoding\n");
+    fprintf(stderr, "    -b { UHF | VHF }        radio band (default is UHF)\n");
+    fprintf(stderr, "    -s <SCR>                scrambling constant (default 0)\n");
+    fprintf(stderr, "    -n <FRAMES>             number of frames (default %d)\n",
+            NFRAMES_DEFAULT);
+    fprintf(stderr, "    -r <SEED>               seed of pseudo-random generator\n");
+    fprintf(stderr, "    -T <TERMINALS>          number of terminals (default %d)\n",
+            NTERMINALS_DEFAULT);
+    fprintf(stderr, "    -R <RATE>               registrations per second\n");
+    fprintf(stderr, "    -C <RATE>               call setups per second\n");
+    fprintf(stderr, "    -U <RATE>               UI datagrams per second\n");
+    fprintf(stderr, "    -D <RATE>               connection-oriented data per second\n");
+    fprintf(stderr, "    -l <LEN>                length of data messages (bytes)\n");
+    fprintf(stderr, "    -i <FRAMES>             report interval (default %d)\n",
+            REPORT_DEFAULT);
+    fprintf(stderr, "    -v                      do not discard decoder log\n");
+}
+
+static int log_discard(const char *fmt, va_list ap)
+{
+    return 0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int parse_rate(const char *s, double *rate)
+{
+    char c;
+    if (sscanf(s, "%lf%c", rate, &c) != 1 || *rate < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+typedef struct {
+    tetrapol_t *tetrapol;
+    phys_ch_t *phys_ch;
+    json_writer_t *jw;
+    uint64_t *frame_ns;     ///< decoding time of frames in interval
+    int nframe_ns;
+} decoder_t;
+
+static void report(decoder_t *dec, swmi_sim_t *sim)
+{
+    swmi_sim_stats_t sim_stats;
+    tetrapol_stats_t stats;
+    swmi_sim_get_stats(sim, &sim_stats);
+    tetrapol_get_stats(dec->tetrapol, &stats);
+
+    uint64_t sum = 0;
+    for (int i = 0; i < dec->nframe_ns; ++i) {
+        sum += dec->frame_ns[i];
+    }
+    qsort(dec->frame_ns, dec->nframe_ns, sizeof(dec->frame_ns[0]), cmp_u64);
+    const int n = dec->nframe_ns;
+
+    json_writer_t *jw = dec->jw;
+    json_writer_str(jw, "{ \"time\": ");
+    json_writer_uint(jw, sim_stats.frames * FRAME_LEN * TETRAPOL_BIT_USEC /
+            1000000);
+    json_writer_str(jw, ", \"frames\": ");
+    json_writer_uint(jw, sim_stats.frames);
+    json_writer_str(jw, ", \"hdlc_frames\": ");
+    json_writer_uint(jw, sim_stats.hdlc_frames);
+    json_writer_str(jw, ", \"stuffing\": ");
+    json_writer_uint(jw, sim_stats.stuffing);
+    json_writer_str(jw, ", \"dropped\": ");
+    json_writer_uint(jw, sim_stats.dropped);
+    json_writer_str(jw, ", \"queue_len\": ");
+    json_writer_int(jw, sim_stats.queue_len);
+    json_writer_str(jw, ", \"terminals_live\": ");
+    json_writer_uint(jw, stats.terminals_live);
+    json_writer_str(jw, ", \"pool_in_use\": ");
+    json_writer_uint(jw, stats.pool_in_use);
+    json_writer_str(jw, ", \"pool_bytes\": ");
+    json_writer_uint(jw, stats.pool_bytes);
+    json_writer_str(jw, ", \"ns_per_frame\": ");
+    json_writer_uint(jw, n ? sum / n : 0);
+    json_writer_str(jw, ", \"p50_ns\": ");
+    json_writer_uint(jw, n ? dec->frame_ns[n / 2] : 0);
+    json_writer_str(jw, ", \"p99_ns\": ");
+    json_writer_uint(jw, n ? dec->frame_ns[(n * 99) / 100] : 0);
+    json_writer_str(jw, " }\n");
+
+    dec->nframe_ns = 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const char *out = NULL;
+    int band = TETRAPOL_BAND_UHF;
+    int scr = 0;
+    long long nframes = NFRAMES_DEFAULT;
+    int report_interval = REPORT_DEFAULT;
+    bool verbose = false;
+    swmi_sim_cfg_t cfg = {
+        .nterminals = NTERMINALS_DEFAULT,
+        .reg_rate = 1,
+        .call_rate = 0.2,
+        .ui_data_rate = 0.2,
+        .co_data_rate = 0.2,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:C:D:hi:l:n:o:R:r:s:T:U:v")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'b':
+                if (!strcmp(optarg, "VHF")) {
+                    band = TETRAPOL_BAND_VHF;
+                } else if (!strcmp(optarg, "UHF")) {
+                    band = TETRAPOL_BAND_UHF;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'C':
+                err = parse_rate(optarg, &cfg.call_rate);
+                break;
+
+            case 'D':
+                err = parse_rate(optarg, &cfg.co_data_rate);
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            case 'i':
+                report_interval = atoi(optarg);
+                err = (report_interval <= 0) ? -1 : 0;
+                break;
+
+            case 'l':
+                cfg.data_len = atoi(optarg);
+                break;
+
+            case 'n':
+                nframes = atoll(optarg);
+                err = (nframes < 0) ? -1 : 0;
+                break;
+
+            case 'o':
+                out = optarg;
+                break;
+
+            case 'R':
+                err = parse_rate(optarg, &cfg.reg_rate);
+                break;
+
+            case 'r':
+                cfg.seed = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                scr = atoi(optarg);
+                err = (scr < 0 || scr > 127) ? -1 : 0;
+                break;
+
+            case 'T':
+                cfg.nterminals = atoi(optarg);
+                break;
+
+            case 'U':
+                err = parse_rate(optarg, &cfg.ui_data_rate);
+                break;
+
+            case 'v':
+                verbose = true;
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!verbose) {
+        log_set_backend(log_discard);
+    }
+
+    swmi_sim_t *sim = swmi_sim_create(&cfg);
+    if (!sim) {
+        fprintf(stderr, "Invalid configuration\n");
+        print_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    frame_encoder_t *fe = frame_encoder_create(band, scr, DIR_DOWNLINK);
+    if (!fe) {
+        swmi_sim_destroy(sim);
+        return EXIT_FAILURE;
+    }
+
+    decoder_t dec;
+    memset(&dec, 0, sizeof(dec));
+    FILE *f = NULL;
+    int ret = 0;
+    if (out) {
+        f = strcmp(out, "-") ? fopen(out, "wb") : stdout;
+        if (!f) {
+            perror("Failed to open output file");
+            ret = -1;
+        }
+    } else {
+        const tetrapol_cfg_t tp_cfg = {
+            .band = band,
+            .dir = DIR_DOWNLINK,
+            .radio_ch_type = TETRAPOL_RADIO_CCH,
+        };
+        dec.tetrapol = tetrapol_create(&tp_cfg);
+        dec.phys_ch = dec.tetrapol ?
+            tetrapol_phys_ch_create(dec.tetrapol) : NULL;
+        dec.jw = json_writer_create(STDOUT_FILENO);
+        dec.frame_ns = malloc(report_interval * sizeof(dec.frame_ns[0]));
+        if (!dec.phys_ch || !dec.jw || !dec.frame_ns) {
+            fprintf(stderr, "Failed to create decoder\n");
+            ret = -1;
+        } else {
+            tetrapol_phys_ch_set_scr(dec.phys_ch, scr);
+        }
+    }
+
+    for (long long i = 0; !ret && i < nframes; ++i) {
+        uint8_t bits[FRAME_LEN];
+
+        if (swmi_sim_bits(sim, fe, bits)) {
+            fprintf(stderr, "Frame encoding failed\n");
+            ret = -1;
+            break;
+        }
+
+        if (f) {
+            if (fwrite(bits, 1, FRAME_LEN, f) != FRAME_LEN) {
+                perror("Failed to write output");
+                ret = -1;
+            }
+            continue;
+        }
+
+        const uint64_t start = now_ns();
+        tetrapol_phys_ch_recv(dec.phys_ch, bits, FRAME_LEN);
+        tetrapol_phys_ch_process(dec.phys_ch);
+        dec.frame_ns[dec.nframe_ns++] = now_ns() - start;
+
+        if (dec.nframe_ns == report_interval || i == nframes - 1) {
+            report(&dec, sim);
+            if (json_writer_flush(dec.jw)) {
+                perror("Failed to write report");
+                ret = -1;
+            }
+        }
+    }
+
+    if (f && (fflush(f) || (f != stdout && fclose(f)))) {
+        perror("Failed to write output");
+        ret = -1;
+    }
+    free(dec.frame_ns);
+    json_writer_destroy(dec.jw);
+    if (dec.phys_ch) {
+        tetrapol_phys_ch_destroy(dec.phys_ch);
+    }
+    tetrapol_destroy(dec.tetrapol);
+    frame_encoder_destroy(fe);
+    swmi_sim_destroy(sim);
+
+    return ret ? EXIT_FAILURE : 0;
+}
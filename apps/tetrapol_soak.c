@@ -0,0 +1,444 @@
+/**
+  Long-run soak of decoder, simulated days of control channel traffic with
+  growing and churning population of terminals.
+
+  Time of decoder is derived from position in bit stream, so simulation runs
+  as fast as possible. Each sample interval RSS, live heap blocks, live
+  objects of decoder and p50/p99 of per-frame decoding time are reported as
+  JSON line. Growth against baseline sample taken after warm-up is checked
+  against budgets, the first exceeded budget terminates the run with
+  failure. Frame time depends on load of host, its budget is checked only
+  when requested (-P).
+ */
+#define _DEFAULT_SOURCE 1
+
+#include "bench.h"
+
+#include <tetrapol/frame.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/swmi_sim.h>
+#include <tetrapol/tetrapol.h>
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    NFRAMES_PER_SEC = 1000000 / (FRAME_LEN * TETRAPOL_BIT_USEC),
+    SEC_PER_DAY = 24 * 3600,
+    NTERMINALS_DEFAULT = 1000,
+    GROWTH_DEFAULT = 2000,      ///< terminals per day
+    INTERVAL_DEFAULT = 3600,    ///< seconds
+    WARMUP_DEFAULT = 3600,      ///< seconds
+    RSS_BUDGET_DEFAULT = 16384,     ///< kB
+    OBJS_BUDGET_DEFAULT = 20000,
+};
+
+static const double DAYS_DEFAULT = 3;
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Soak decoder with simulated days of control channel traffic.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -b { UHF | VHF }        radio band (default is UHF)\n");
+    fprintf(stderr, "    -s <SCR>                scrambling constant (default 0)\n");
+    fprintf(stderr, "    -d <DAYS>               simulated days (default %g)\n",
+            DAYS_DEFAULT);
+    fprintf(stderr, "    -r <SEED>               seed of pseudo-random generator\n");
+    fprintf(stderr, "    -T <TERMINALS>          initial number of terminals (default %d)\n",
+            NTERMINALS_DEFAULT);
+    fprintf(stderr, "    -g <TERMINALS>          population growth per day (default %d)\n",
+            GROWTH_DEFAULT);
+    fprintf(stderr, "    -c <RATE>               terminals replaced by new ones per second\n");
+    fprintf(stderr, "    -R <RATE>               registrations per second\n");
+    fprintf(stderr, "    -C <RATE>               call setups per second\n");
+    fprintf(stderr, "    -U <RATE>               UI datagrams per second\n");
+    fprintf(stderr, "    -D <RATE>               connection-oriented data per second\n");
+    fprintf(stderr, "    -l <LEN>                length of data messages (bytes)\n");
+    fprintf(stderr, "    -i <SECONDS>            sample interval (default %d)\n",
+            INTERVAL_DEFAULT);
+    fprintf(stderr, "    -w <SECONDS>            warm-up before baseline sample (default %d)\n",
+            WARMUP_DEFAULT);
+    fprintf(stderr, "    -M <KB>                 budget for RSS growth (default %d)\n",
+            RSS_BUDGET_DEFAULT);
+    fprintf(stderr, "    -O <OBJECTS>            budget for growth of live heap blocks and\n");
+    fprintf(stderr, "                            pool objects (default %d)\n",
+            OBJS_BUDGET_DEFAULT);
+    fprintf(stderr, "    -P <RATIO>              budget for p99 of frame time relative\n");
+    fprintf(stderr, "                            to baseline (default not checked)\n");
+    fprintf(stderr, "    -v                      do not discard decoder log\n");
+}
+
+static int log_discard(const char *fmt, va_list ap)
+{
+    return 0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *)a;
+    const uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static int parse_rate(const char *s, double *rate)
+{
+    char c;
+    if (sscanf(s, "%lf%c", rate, &c) != 1 || *rate < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/// resident set size in kB, 0 when not available
+static uint64_t rss_kb(void)
+{
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) {
+        return 0;
+    }
+
+    unsigned long size, resident;
+    const int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    if (n != 2) {
+        return 0;
+    }
+
+    return (uint64_t)resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+typedef struct {
+    uint64_t time;          ///< simulated seconds
+    uint64_t rss_kb;
+    uint64_t heap_blocks;   ///< live heap blocks
+    uint64_t pool_in_use;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+} sample_t;
+
+typedef struct {
+    uint64_t rss_kb;
+    uint64_t objs;
+    double p99;         ///< 0 when not checked
+} budget_t;
+
+static void take_sample(sample_t *s, tetrapol_t *tetrapol, uint64_t frames,
+        uint64_t *frame_ns, int n)
+{
+    tetrapol_stats_t stats;
+    tetrapol_get_stats(tetrapol, &stats);
+
+    qsort(frame_ns, n, sizeof(frame_ns[0]), cmp_u64);
+
+    s->time = frames / NFRAMES_PER_SEC;
+    s->rss_kb = rss_kb();
+    uint64_t nallocs, nfrees;
+    bench_heap_count(&nallocs, &nfrees);
+    s->heap_blocks = nallocs - nfrees;
+    s->pool_in_use = stats.pool_in_use;
+    s->p50_ns = n ? frame_ns[n / 2] : 0;
+    s->p99_ns = n ? frame_ns[(n * 99) / 100] : 0;
+}
+
+static void report(json_writer_t *jw, const sample_t *s, swmi_sim_t *sim,
+        tetrapol_t *tetrapol)
+{
+    swmi_sim_stats_t sim_stats;
+    tetrapol_stats_t stats;
+    swmi_sim_get_stats(sim, &sim_stats);
+    tetrapol_get_stats(tetrapol, &stats);
+
+    json_writer_str(jw, "{ \"time\": ");
+    json_writer_uint(jw, s->time);
+    json_writer_str(jw, ", \"frames\": ");
+    json_writer_uint(jw, sim_stats.frames);
+    json_writer_str(jw, ", \"nterminals\": ");
+    json_writer_int(jw, sim_stats.nterminals);
+    json_writer_str(jw, ", \"churned\": ");
+    json_writer_uint(jw, sim_stats.churned);
+    json_writer_str(jw, ", \"dropped\": ");
+    json_writer_uint(jw, sim_stats.dropped);
+    json_writer_str(jw, ", \"terminals_live\": ");
+    json_writer_uint(jw, stats.terminals_live);
+    json_writer_str(jw, ", \"pool_in_use\": ");
+    json_writer_uint(jw, stats.pool_in_use);
+    json_writer_str(jw, ", \"pool_bytes\": ");
+    json_writer_uint(jw, stats.pool_bytes);
+    json_writer_str(jw, ", \"heap_blocks\": ");
+    json_writer_uint(jw, s->heap_blocks);
+    json_writer_str(jw, ", \"rss_kb\": ");
+    json_writer_uint(jw, s->rss_kb);
+    json_writer_str(jw, ", \"p50_ns\": ");
+    json_writer_uint(jw, s->p50_ns);
+    json_writer_str(jw, ", \"p99_ns\": ");
+    json_writer_uint(jw, s->p99_ns);
+    json_writer_str(jw, " }\n");
+}
+
+/// return -1 and print reason when sample exceeds budget
+static int check_budget(const budget_t *budget, const sample_t *base,
+        const sample_t *s)
+{
+    if (s->rss_kb > base->rss_kb + budget->rss_kb) {
+        fprintf(stderr, "RSS grew by %llu kB since %llu s, budget %llu kB\n",
+                (unsigned long long)(s->rss_kb - base->rss_kb),
+                (unsigned long long)base->time,
+                (unsigned long long)budget->rss_kb);
+        return -1;
+    }
+
+    if (s->heap_blocks > base->heap_blocks + budget->objs) {
+        fprintf(stderr, "live heap blocks grew by %llu since %llu s, "
+                "budget %llu\n",
+                (unsigned long long)(s->heap_blocks - base->heap_blocks),
+                (unsigned long long)base->time,
+                (unsigned long long)budget->objs);
+        return -1;
+    }
+
+    if (s->pool_in_use > base->pool_in_use + budget->objs) {
+        fprintf(stderr, "live pool objects grew by %llu since %llu s, "
+                "budget %llu\n",
+                (unsigned long long)(s->pool_in_use - base->pool_in_use),
+                (unsigned long long)base->time,
+                (unsigned long long)budget->objs);
+        return -1;
+    }
+
+    if (budget->p99 && s->p99_ns > base->p99_ns * budget->p99) {
+        fprintf(stderr, "p99 of frame time %llu ns, baseline %llu ns, "
+                "budget %gx\n", (unsigned long long)s->p99_ns,
+                (unsigned long long)base->p99_ns, budget->p99);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    int band = TETRAPOL_BAND_UHF;
+    int scr = 0;
+    double days = DAYS_DEFAULT;
+    double growth = GROWTH_DEFAULT;
+    int interval = INTERVAL_DEFAULT;
+    int warmup = WARMUP_DEFAULT;
+    bool verbose = false;
+    budget_t budget = {
+        .rss_kb = RSS_BUDGET_DEFAULT,
+        .objs = OBJS_BUDGET_DEFAULT,
+    };
+    swmi_sim_cfg_t cfg = {
+        .nterminals = NTERMINALS_DEFAULT,
+        .reg_rate = 1,
+        .call_rate = 0.2,
+        .ui_data_rate = 0.2,
+        .co_data_rate = 0.2,
+        .churn_rate = 0.05,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:C:c:D:d:g:hi:l:M:O:P:R:r:s:T:U:vw:")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'b':
+                if (!strcmp(optarg, "VHF")) {
+                    band = TETRAPOL_BAND_VHF;
+                } else if (!strcmp(optarg, "UHF")) {
+                    band = TETRAPOL_BAND_UHF;
+                } else {
+                    err = -1;
+                }
+                break;
+
+            case 'C':
+                err = parse_rate(optarg, &cfg.call_rate);
+                break;
+
+            case 'c':
+                err = parse_rate(optarg, &cfg.churn_rate);
+                break;
+
+            case 'D':
+                err = parse_rate(optarg, &cfg.co_data_rate);
+                break;
+
+            case 'd':
+                err = parse_rate(optarg, &days);
+                break;
+
+            case 'g':
+                err = parse_rate(optarg, &growth);
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            case 'i':
+                interval = atoi(optarg);
+                err = (interval <= 0) ? -1 : 0;
+                break;
+
+            case 'l':
+                cfg.data_len = atoi(optarg);
+                break;
+
+            case 'M':
+                budget.rss_kb = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'O':
+                budget.objs = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'P':
+                err = parse_rate(optarg, &budget.p99);
+                break;
+
+            case 'R':
+                err = parse_rate(optarg, &cfg.reg_rate);
+                break;
+
+            case 'r':
+                cfg.seed = strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                scr = atoi(optarg);
+                err = (scr < 0 || scr > 127) ? -1 : 0;
+                break;
+
+            case 'T':
+                cfg.nterminals = atoi(optarg);
+                break;
+
+            case 'U':
+                err = parse_rate(optarg, &cfg.ui_data_rate);
+                break;
+
+            case 'v':
+                verbose = true;
+                break;
+
+            case 'w':
+                warmup = atoi(optarg);
+                err = (warmup < 0) ? -1 : 0;
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (!verbose) {
+        log_set_backend(log_discard);
+    }
+
+    swmi_sim_t *sim = swmi_sim_create(&cfg);
+    if (!sim) {
+        fprintf(stderr, "Invalid configuration\n");
+        print_help(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const tetrapol_cfg_t tp_cfg = {
+        .band = band,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+    };
+    frame_encoder_t *fe = frame_encoder_create(band, scr, DIR_DOWNLINK);
+    tetrapol_t *tetrapol = tetrapol_create(&tp_cfg);
+    phys_ch_t *phys_ch = tetrapol ? tetrapol_phys_ch_create(tetrapol) : NULL;
+    json_writer_t *jw = json_writer_create(STDOUT_FILENO);
+    const int nframe_ns = interval * NFRAMES_PER_SEC;
+    uint64_t *frame_ns = malloc(nframe_ns * sizeof(frame_ns[0]));
+    int ret = 0;
+    if (!fe || !phys_ch || !jw || !frame_ns) {
+        fprintf(stderr, "Failed to create decoder\n");
+        ret = -1;
+    } else {
+        tetrapol_phys_ch_set_scr(phys_ch, scr);
+    }
+
+    const uint64_t nframes = days * SEC_PER_DAY * NFRAMES_PER_SEC;
+    sample_t base;
+    bool have_base = false;
+    int n = 0;
+    for (uint64_t i = 0; !ret && i < nframes; ++i) {
+        uint8_t bits[FRAME_LEN];
+
+        if (i % NFRAMES_PER_SEC == 0) {
+            int nterminals = cfg.nterminals +
+                growth * i / NFRAMES_PER_SEC / SEC_PER_DAY;
+            if (nterminals > SWMI_SIM_TERMINALS_MAX) {
+                nterminals = SWMI_SIM_TERMINALS_MAX;
+            }
+            swmi_sim_set_nterminals(sim, nterminals);
+        }
+
+        if (swmi_sim_bits(sim, fe, bits)) {
+            fprintf(stderr, "Frame encoding failed\n");
+            ret = -1;
+            break;
+        }
+
+        const uint64_t start = now_ns();
+        tetrapol_phys_ch_recv(phys_ch, bits, FRAME_LEN);
+        tetrapol_phys_ch_process(phys_ch);
+        frame_ns[n++] = now_ns() - start;
+
+        if (n < nframe_ns && i != nframes - 1) {
+            continue;
+        }
+
+        sample_t s;
+        take_sample(&s, tetrapol, i + 1, frame_ns, n);
+        n = 0;
+        report(jw, &s, sim, tetrapol);
+        if (json_writer_flush(jw)) {
+            perror("Failed to write report");
+            ret = -1;
+        }
+        if (have_base) {
+            ret = check_budget(&budget, &base, &s);
+        } else if (s.time >= warmup) {
+            memcpy(&base, &s, sizeof(base));
+            have_base = true;
+        }
+    }
+
+    free(frame_ns);
+    json_writer_destroy(jw);
+    if (phys_ch) {
+        tetrapol_phys_ch_destroy(phys_ch);
+    }
+    tetrapol_destroy(tetrapol);
+    frame_encoder_destroy(fe);
+    swmi_sim_destroy(sim);
+
+    return ret ? EXIT_FAILURE : 0;
+}
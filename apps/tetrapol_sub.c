@@ -0,0 +1,142 @@
+/**
+  Subscribe for events published by tetrapol_dump -P <PATH>, received
+  binary event stream is written to output, see tetrapol_bin2json.
+ */
+#include <tetrapol/evt_bus.h>
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Receive binary TETRAPOL events from tetrapol_dump.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...] -S <PATH>\n", prg_name);
+    fprintf(stderr, "    -S <PATH>               socket given to tetrapol_dump -P\n");
+    fprintf(stderr, "    -o <PATH>               output file, (default stdout)\n");
+    fprintf(stderr, "    -e <TYPE[,TYPE...]>     events FRAME,SCR,TSDU,PCH,RCH (default all)\n");
+    fprintf(stderr, "    -F <KEY=VAL[,VAL...]>   receive only matching events, might be repeated,\n"
+                    "                            see tetrapol_dump -F\n");
+    fprintf(stderr, "    -p { drop | disconnect }\n"
+                    "                            when we are too slow drop events or get\n"
+                    "                            disconnected (default drop)\n");
+}
+
+static int req_append(char *req, const char *key, const char *val)
+{
+    const int len = strlen(req);
+    const int n = snprintf(&req[len], EVT_BUS_REQ_MAX - len, "%s%s ",
+            key, val);
+
+    return (n < 0 || n >= EVT_BUS_REQ_MAX - len) ? -1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+    const char *path = NULL;
+    const char *out = NULL;
+    char req[EVT_BUS_REQ_MAX] = "";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:F:ho:p:S:")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'e':
+                err = req_append(req, "events=", optarg);
+                break;
+
+            case 'F':
+                err = req_append(req, "", optarg);
+                break;
+
+            case 'o':
+                out = optarg;
+                break;
+
+            case 'p':
+                err = req_append(req, "policy=", optarg);
+                break;
+
+            case 'S':
+                path = optarg;
+                break;
+
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct sockaddr_un sa;
+    if (!path || strlen(path) >= sizeof(sa.sun_path) ||
+            strlen(req) + 1 >= sizeof(req)) {
+        print_help(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    strcat(req, "\n");
+
+    if (out && strcmp(out, "-")) {
+        if (!freopen(out, "wb", stdout)) {
+            perror("Failed to open output file");
+            return -1;
+        }
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("Failed to create socket");
+        return -1;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+    if (connect(fd, (struct sockaddr *)&sa, sizeof(sa))) {
+        perror("Failed to connect");
+        close(fd);
+        return -1;
+    }
+    if (write(fd, req, strlen(req)) != strlen(req)) {
+        perror("Failed to subscribe");
+        close(fd);
+        return -1;
+    }
+
+    int ret = 0;
+    uint8_t buf[64 * 1024];
+    while (true) {
+        const ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Failed to receive");
+            ret = -1;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (fwrite(buf, n, 1, stdout) != 1 || fflush(stdout)) {
+            ret = -1;
+            break;
+        }
+    }
+
+    close(fd);
+
+    return ret;
+}
@@ -51,9 +51,5 @@ timeout ${TIMEOUT} \
         -o ${OUT_DIR}/channel%%.bits \
         -l "${FREQS}"
 
-for f in `echo "${FREQS}" | tr , ' '`; do
-    ../build/apps/tetrapol_dump -t CCH -i ${OUT_DIR}/channel${f}.bits \
-            >${OUT_DIR}/cch_${f}.json 2>${OUT_DIR}/cch_${f}.log
-    ../build/apps/tetrapol_dump -t TCH -i ${OUT_DIR}/channel${f}.bits \
-            >${OUT_DIR}/tch_${f}.json 2>${OUT_DIR}/tch_${f}.log
-done
+echo "Decoding received channels"
+../build/apps/tetrapol_batch -o ${OUT_DIR} ${OUT_DIR}
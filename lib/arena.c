@@ -0,0 +1,101 @@
+#define LOG_PREFIX "arena"
+#include <tetrapol/log.h>
+#include <tetrapol/arena.h>
+
+#include <stdalign.h>
+#include <stdlib.h>
+#include <string.h>
+
+// each allocation is prefixed by its size, required by arena_realloc
+typedef struct {
+    alignas(max_align_t) size_t size;
+} arena_hdr_t;
+
+#define ARENA_ALIGN(x) \
+    (((x) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1))
+
+void arena_init(arena_t *arena, void *buf, size_t size)
+{
+    arena->buf = buf;
+    arena->size = size;
+    arena_reset(arena);
+}
+
+void arena_reset(arena_t *arena)
+{
+    arena->used = 0;
+    arena->last = SIZE_MAX;
+}
+
+arena_mark_t arena_mark(const arena_t *arena)
+{
+    return arena->used;
+}
+
+void arena_rewind(arena_t *arena, arena_mark_t mark)
+{
+    arena->used = mark;
+    arena->last = SIZE_MAX;
+}
+
+void *arena_alloc(arena_t *arena, size_t size)
+{
+    if (!arena) {
+        return malloc(size);
+    }
+
+    const size_t offs = ARENA_ALIGN(arena->used);
+    // compare without sum of header and size, it might overflow
+    if (offs > arena->size || arena->size - offs < sizeof(arena_hdr_t) ||
+            arena->size - offs - sizeof(arena_hdr_t) < size) {
+        LOG(ERR, "arena exhausted size=%zu used=%zu request=%zu",
+                arena->size, arena->used, size);
+        return NULL;
+    }
+
+    arena_hdr_t *hdr = (arena_hdr_t *)&arena->buf[offs];
+    hdr->size = size;
+    arena->last = offs;
+    arena->used = offs + sizeof(arena_hdr_t) + size;
+
+    return hdr + 1;
+}
+
+void *arena_realloc(arena_t *arena, void *ptr, size_t size)
+{
+    if (!arena) {
+        return realloc(ptr, size);
+    }
+
+    if (!ptr) {
+        return arena_alloc(arena, size);
+    }
+
+    arena_hdr_t *hdr = (arena_hdr_t *)ptr - 1;
+    const size_t offs = (uint8_t *)hdr - arena->buf;
+    if (offs == arena->last) {
+        if (arena->size - offs - sizeof(arena_hdr_t) < size) {
+            LOG(ERR, "arena exhausted size=%zu used=%zu request=%zu",
+                    arena->size, arena->used, size);
+            return NULL;
+        }
+        hdr->size = size;
+        arena->used = offs + sizeof(arena_hdr_t) + size;
+
+        return ptr;
+    }
+
+    void *p = arena_alloc(arena, size);
+    if (p) {
+        memcpy(p, ptr, hdr->size < size ? hdr->size : size);
+    }
+
+    return p;
+}
+
+void arena_free(arena_t *arena, void *ptr)
+{
+    if (!arena) {
+        free(ptr);
+    }
+}
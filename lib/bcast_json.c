@@ -0,0 +1,59 @@
+#include <tetrapol/bcast_json.h>
+
+static void frame_no_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    if (evt->frame_no != FRAME_NO_UNKNOWN) {
+        json_writer_str(jw, "\"frame_no\": ");
+        json_writer_int(jw, evt->frame_no);
+        json_writer_str(jw, ", ");
+    } else {
+        json_writer_str(jw, "\"frame_no\": null, ");
+    }
+}
+
+static void block_json(json_writer_t *jw, const tetrapol_evt_t *evt,
+        const char *name, const uint8_t *data, int len)
+{
+    json_writer_str(jw, "{ \"event\": \"");
+    json_writer_cstr(jw, name);
+    json_writer_str(jw, "\", \"rx_offs\": ");
+    json_writer_uint(jw, evt->rx_offs);
+    json_writer_str(jw, ", \"");
+    json_writer_cstr(jw, name);
+    json_writer_str(jw, "\": { ");
+    frame_no_json(jw, evt);
+    json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+    json_writer_hex(jw, data, len);
+    json_writer_str(jw, "\" } } }\n");
+}
+
+void pch_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    block_json(jw, evt, "pch", evt->pch.data, evt->pch.len);
+}
+
+void rch_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    block_json(jw, evt, "rch", evt->rch.data, evt->rch.len);
+}
+
+void repeat_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    const char *log_ch_str;
+    switch (evt->repeat.log_ch) {
+        case LOG_CH_BCH:    log_ch_str = "BCH";     break;
+        case LOG_CH_PCH:    log_ch_str = "PCH";     break;
+        case LOG_CH_RCH:    log_ch_str = "RCH";     break;
+
+        default:
+            log_ch_str = "FIXME";
+    };
+
+    json_writer_str(jw, "{ \"event\": \"repeat\", \"rx_offs\": ");
+    json_writer_uint(jw, evt->rx_offs);
+    json_writer_str(jw, ", \"repeat\": { ");
+    frame_no_json(jw, evt);
+    json_writer_str(jw, "\"log_ch\": \"");
+    json_writer_cstr(jw, log_ch_str);
+    json_writer_str(jw, "\" } }\n");
+}
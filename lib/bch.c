@@ -5,18 +5,28 @@
 #include <tetrapol/hdlc_frame.h>
 #include <tetrapol/misc.h>
 #include <tetrapol/tpdu.h>
+#include <tetrapol/trace.h>
 #include <tetrapol/system_config.h>
 
+#include <stdalign.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
+enum {
+    BCH_ARENA_SIZE = 4096,
+};
 
 struct bch_priv_t {
     data_frame_t *data_fr;
     tpdu_ui_t *tpdu;
-    tsdu_d_system_info_t *tsdu;
+    tsdu_d_system_info_t *tsdu;     ///< allocated from arena[arena_idx]
     tpol_t *tpol;
+    /// Two arenas are used in turn, the one holding last D_SYSTEM_INFO is kept
+    /// untouched while the next TSDU is decoded into the other.
+    int arena_idx;
+    arena_t arena[2];
+    alignas(max_align_t) uint8_t arena_buf[2][BCH_ARENA_SIZE];
 };
 
 bch_t *bch_create(tpol_t *tpol)
@@ -34,20 +44,23 @@ bch_t *bch_create(tpol_t *tpol)
 
     bch->tpdu = tpdu_ui_create(tpol, FRAME_TYPE_DATA, LOG_CH_BCH);
     if (!bch->tpdu) {
-        free(bch);
         data_frame_destroy(bch->data_fr);
+        free(bch);
         return NULL;
     }
 
     bch->tsdu = NULL;
     bch->tpol = tpol;
+    bch->arena_idx = 0;
+    for (int i = 0; i < ARRAY_LEN(bch->arena); ++i) {
+        arena_init(&bch->arena[i], bch->arena_buf[i], BCH_ARENA_SIZE);
+    }
 
     return bch;
 }
 
 void bch_destroy(bch_t *bch)
 {
-    tsdu_destroy(&bch->tsdu->base);
     data_frame_destroy(bch->data_fr);
     tpdu_ui_destroy(bch->tpdu);
     free(bch);
@@ -55,36 +68,67 @@ void bch_destroy(bch_t *bch)
 
 bool bch_push_frame(bch_t *bch, const frame_t *fr)
 {
-    if (data_frame_push_frame(bch->data_fr, fr) <= 0) {
+    TRACE_BEGIN(TRACE_DATA_FRAME);
+    const int r = data_frame_push_frame(bch->data_fr, fr);
+    TRACE_END(TRACE_DATA_FRAME);
+    if (r < 0) {
+        metric_inc(&bch->tpol->metrics.data_frame_errs);
+    }
+    if (r <= 0) {
         return false;
     }
 
     uint8_t tpdu_data[SYS_PAR_N200_BYTES_MAX];
-    const int nblocks = data_frame_blocks(bch->data_fr);
     const int size = data_frame_get_bytes(bch->data_fr, tpdu_data);
 
     hdlc_frame_t hdlc_fr;
-    if (!hdlc_frame_parse(&hdlc_fr, tpdu_data, size)) {
+    TRACE_BEGIN(TRACE_HDLC_PARSE);
+    const bool fcs_ok = hdlc_frame_parse(&hdlc_fr, tpdu_data, size);
+    TRACE_END(TRACE_HDLC_PARSE);
+    if (!fcs_ok) {
+        metric_inc(&bch->tpol->metrics.hdlc_fcs_errs);
         return false;
     }
 
-    if (hdlc_fr.command.cmd != COMMAND_UNNUMBERED_UI) {
+    return bch_push_hdlc_frame(bch, &hdlc_fr);
+}
+
+bool bch_push_hdlc_frame(bch_t *bch, const hdlc_frame_t *hdlc_fr)
+{
+    tetrapol_evt_hdlc(bch->tpol, LOG_CH_BCH, hdlc_fr);
+
+    // address, command and FCS (5 bytes) are not included in nbits,
+    // frames with more than 2 data blocks have extra parity block
+    int nblocks = (hdlc_fr->nbits + 5 * 8) / 64;
+    if (nblocks > 2) {
+        ++nblocks;
+    }
+
+    if (hdlc_fr->command.cmd != COMMAND_UNNUMBERED_UI) {
         return false;
     }
 
-    if (!addr_is_tti_all_st(&hdlc_fr.addr, true)) {
+    if (!addr_is_tti_all_st(&hdlc_fr->addr, true)) {
         if (bch->tpol->frame_no == FRAME_NO_UNKNOWN) {
             LOG_IF(DBG) {
                 char buf[ADDR_PRINT_BUF_SIZE];
                 LOG(DBG, "invalid address for BCH %s",
-                        addr_print(buf, &hdlc_fr.addr));
+                        addr_print(buf, &hdlc_fr->addr));
             }
         }
         return false;
     }
 
+    // decode into arena not used by current TSDU
+    const int arena_idx = !bch->arena_idx;
+    arena_t *arena = &bch->arena[arena_idx];
+    arena_reset(arena);
+
     tsdu_t *tsdu;
-    if (tpdu_ui_push_hdlc_frame2(bch->tpdu, &hdlc_fr, &tsdu) == -1) {
+    TRACE_BEGIN(TRACE_LINK);
+    const int r2 = tpdu_ui_push_hdlc_frame2(bch->tpdu, hdlc_fr, arena, &tsdu);
+    TRACE_END(TRACE_LINK);
+    if (r2 == -1) {
         return false;
     }
 
@@ -94,12 +138,11 @@ bool bch_push_frame(bch_t *bch, const frame_t *fr)
 
     if (tsdu->codop != D_SYSTEM_INFO) {
         LOG(DBG, "Invalid codop for BCH 0x%02x", tsdu->codop);
-        tsdu_destroy(tsdu);
 
         return false;
     }
 
-    tsdu_destroy(&bch->tsdu->base);
+    bch->arena_idx = arena_idx;
     bch->tsdu = (tsdu_d_system_info_t *)tsdu;
 
     const int bch_frame_no = 100 * bch->tsdu->cell_state.bch + nblocks - 1;
@@ -113,10 +156,19 @@ bool bch_push_frame(bch_t *bch, const frame_t *fr)
     return true;
 }
 
-tsdu_d_system_info_t *bch_get_tsdu(bch_t *bch)
+const tsdu_d_system_info_t *bch_get_tsdu(bch_t *bch)
 {
-    tsdu_d_system_info_t *tsdu = bch->tsdu;
-    bch->tsdu = NULL;
+    return bch->tsdu;
+}
 
-    return tsdu;
+void bch_save(const bch_t *bch, snapshot_t *snap)
+{
+    data_frame_save(bch->data_fr, snap);
+    tpdu_ui_save(bch->tpdu, snap);
+}
+
+bool bch_load(bch_t *bch, snapshot_t *snap)
+{
+    return data_frame_load(bch->data_fr, snap) &&
+        tpdu_ui_load(bch->tpdu, snap);
 }
@@ -0,0 +1,211 @@
+#define _DEFAULT_SOURCE 1
+
+#include "bench.h"
+#include <tetrapol/log.h>
+
+#include <getopt.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+volatile uint64_t bench_sink;
+
+static uint64_t allocs;     ///< heap allocations done by process
+static uint64_t frees;      ///< heap blocks released by process
+
+#ifdef __GLIBC__
+// Count heap allocations including those done by shared libraries (GLib),
+// allocator itself is provided by glibc.
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size)
+{
+    ++allocs;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    ++allocs;
+    return __libc_calloc(nmemb, size);
+}
+
+// new block replaces the old one
+void *realloc(void *ptr, size_t size)
+{
+    if (ptr) {
+        ++frees;
+    }
+    if (size || !ptr) {
+        ++allocs;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    if (ptr) {
+        ++frees;
+    }
+    __libc_free(ptr);
+}
+#define HAVE_ALLOC_COUNT 1
+#else
+#define HAVE_ALLOC_COUNT 0
+#endif
+
+bool bench_heap_count(uint64_t *nallocs, uint64_t *nfrees)
+{
+    *nallocs = allocs;
+    *nfrees = frees;
+
+    return HAVE_ALLOC_COUNT;
+}
+
+static struct {
+    const char *filter;
+    int samples;
+    uint64_t sample_ns;
+} bench = {
+    .samples = BENCH_SAMPLES_DEFAULT,
+    .sample_ns = BENCH_SAMPLE_MS_DEFAULT * 1000000ULL,
+};
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -f <SUBSTR>             run only benchmarks matching name/param\n");
+    fprintf(stderr, "    -n <SAMPLES>            number of samples (default %d)\n",
+            BENCH_SAMPLES_DEFAULT);
+    fprintf(stderr, "    -t <MS>                 min. duration of sample (default %d)\n",
+            BENCH_SAMPLE_MS_DEFAULT);
+}
+
+/// logging is not part of measurement
+static int log_discard(const char *fmt, va_list ap)
+{
+    return 0;
+}
+
+void bench_init(int argc, char *argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "f:hn:t:")) != -1) {
+        switch (opt) {
+            case 'f':
+                bench.filter = optarg;
+                break;
+
+            case 'n':
+                bench.samples = atoi(optarg);
+                if (bench.samples <= 0 || bench.samples > BENCH_SAMPLES_MAX) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                break;
+
+            case 't':
+                if (atoi(optarg) <= 0) {
+                    print_help(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+                bench.sample_ns = atoi(optarg) * 1000000ULL;
+                break;
+
+            default:
+                print_help(argv[0]);
+                exit(EXIT_FAILURE);
+                break;
+        }
+    }
+
+    log_set_backend(log_discard);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t run_sample(bench_func_t func, void *arg, int n)
+{
+    const uint64_t start = now_ns();
+    func(arg, n);
+    const uint64_t t = now_ns() - start;
+
+    return t ? t : 1;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, int n)
+{
+    qsort(v, n, sizeof(double), cmp_double);
+
+    return (n % 2) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+void bench_run(const char *name, const char *param, const char *unit,
+        bench_func_t func, void *arg)
+{
+    char id[128];
+    snprintf(id, sizeof(id), "%s/%s", name, param);
+    if (bench.filter && !strstr(id, bench.filter)) {
+        return;
+    }
+
+    // calibrate number of operations, serves as warm up as well
+    int n = 1;
+    uint64_t t = run_sample(func, arg, n);
+    while (t < bench.sample_ns / 4 && n <= INT_MAX / 2) {
+        n *= 2;
+        t = run_sample(func, arg, n);
+    }
+    const double n_ = (double)n * bench.sample_ns / t;
+    n = (n_ < 1) ? 1 : (n_ > INT_MAX) ? INT_MAX : n_;
+
+    double ns[BENCH_SAMPLES_MAX];
+    const uint64_t allocs_start = allocs;
+    for (int i = 0; i < bench.samples; ++i) {
+        ns[i] = (double)run_sample(func, arg, n) / n;
+    }
+
+    const double allocs_per_op =
+        (double)(allocs - allocs_start) / bench.samples / n;
+
+    const double med = median(ns, bench.samples);
+    const double min = ns[0];
+    const double max = ns[bench.samples - 1];
+    // median absolute deviation
+    for (int i = 0; i < bench.samples; ++i) {
+        ns[i] = (ns[i] > med) ? ns[i] - med : med - ns[i];
+    }
+    const double mad = median(ns, bench.samples);
+
+    printf("{\"bench\":\"%s\",\"param\":\"%s\",\"unit\":\"%s\","
+            "\"ns_per_op\":%.1f,\"ops_per_s\":%.0f,"
+            "\"min_ns\":%.1f,\"max_ns\":%.1f,\"mad_ns\":%.1f,"
+            "\"samples\":%d,\"ops_per_sample\":%d,",
+            name, param, unit, med, 1e9 / med, min, max, mad,
+            bench.samples, n);
+    if (HAVE_ALLOC_COUNT) {
+        printf("\"allocs_per_op\":%.3f}\n", allocs_per_op);
+    } else {
+        printf("\"allocs_per_op\":null}\n");
+    }
+    fflush(stdout);
+}
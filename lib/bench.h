@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+  Minimal benchmark harness shared by bench_* programs.
+
+  Benchmark is a function which performs given number of operations (decodes
+  n frames, parses n HDLC frames, ...). Harness calibrates number of
+  operations so single sample takes at least sample time, repeats the sample
+  and reports median time per operation together with number of heap
+  allocations per operation (counted with glibc only, null otherwise). One
+  JSON object per benchmark is written to stdout, so results of two runs can
+  be compared line by line.
+
+  Options accepted by bench_init():
+    -f <SUBSTR>     run only benchmarks with SUBSTR in "name/param"
+    -n <SAMPLES>    number of samples (default BENCH_SAMPLES_DEFAULT)
+    -t <MS>         min. duration of single sample (default BENCH_SAMPLE_MS_DEFAULT)
+  */
+
+enum {
+    BENCH_SAMPLES_DEFAULT = 11,
+    BENCH_SAMPLES_MAX = 101,
+    BENCH_SAMPLE_MS_DEFAULT = 20,
+};
+
+/// perform n operations, arg is passed from bench_run()
+typedef void (*bench_func_t)(void *arg, int n);
+
+/// Results should be written here to prevent removal of benchmarked code.
+extern volatile uint64_t bench_sink;
+
+/**
+  Get number of heap allocations and released heap blocks of process,
+  including shared libraries (GLib). realloc() counts as both, so difference
+  is number of live heap blocks. Also used by tetrapol_soak.
+
+  @return false when heap is not counted (glibc only), counters are 0
+  */
+bool bench_heap_count(uint64_t *nallocs, uint64_t *nfrees);
+
+/// Parse command line options (exits on error) and discard log messages.
+void bench_init(int argc, char *argv[]);
+
+/**
+  Run benchmark and report its results.
+
+  @param name Benchmarked function.
+  @param param Variant of benchmark, e.g. band and frame type.
+  @param unit Name of single operation, e.g. "frame".
+  */
+void bench_run(const char *name, const char *param, const char *unit,
+        bench_func_t func, void *arg);
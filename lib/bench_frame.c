@@ -0,0 +1,340 @@
+#include "bench.h"
+
+// include, we are benchmarking static methods
+#include "frame.c"
+
+#include <tetrapol/data_frame.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/system_config.h>
+
+#include <stdio.h>
+
+enum {
+    NFRAMES = 64,   ///< distinct input frames for each benchmark
+    SCR = 23,
+};
+
+static uint32_t seed = 0x7e7a9011;
+
+/// fill frame with pseudo-random payload
+static void mk_frame(frame_t *fr, int fr_type)
+{
+    memset(fr, 0, sizeof(*fr));
+    fr->fr_type = fr_type;
+    if (fr_type == FRAME_TYPE_DATA) {
+        for (int i = 0; i < ARRAY_LEN(fr->data.data); ++i) {
+            fr->data.data[i] = rand_next(&seed) & 1;
+        }
+        // FN 00, single block data frame
+        fr->data.data[0] = fr->data.data[1] = 0;
+    } else {
+        for (int i = 0; i < ARRAY_LEN(fr->voice.voice1); ++i) {
+            fr->voice.voice1[i] = rand_next(&seed) & 1;
+        }
+        for (int i = 0; i < ARRAY_LEN(fr->voice.voice2); ++i) {
+            fr->voice.voice2[i] = rand_next(&seed) & 1;
+        }
+    }
+}
+
+/**
+  Encode frame and convert it into form passed to frame_decoder_decode(),
+  the same way as tetrapol_build output is processed by phys_ch.
+  */
+static void encode(frame_encoder_t *fe, uint8_t *fr_data, frame_t *fr)
+{
+    uint8_t frame[FRAME_LEN / 8];
+    if (frame_encoder_encode(fe, frame, fr)) {
+        fprintf(stderr, "Frame encoding failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint8_t last_bit = 0;
+    for (int i = FRAME_HDR_LEN; i < FRAME_LEN; ++i) {
+        const uint8_t bit = (frame[i / 8] >> (i % 8)) & 1;
+        last_bit = fr_data[i - FRAME_HDR_LEN] = bit ^ last_bit;
+    }
+}
+
+typedef struct {
+    frame_decoder_t *fd;
+    int band;
+    int fr_type;
+    uint8_t fr_data[NFRAMES][FRAME_DATA_LEN];
+} decode_ctx_t;
+
+static void bench_decode(void *arg, int n)
+{
+    decode_ctx_t *ctx = arg;
+    frame_t fr;
+    uint64_t broken = 0;
+
+    for (int i = 0; i < n; ++i) {
+        frame_decoder_reset(ctx->fd, ctx->band, SCR, ctx->fr_type);
+        frame_decoder_decode(ctx->fd, &fr, ctx->fr_data[i % NFRAMES]);
+        broken += fr.broken;
+    }
+    bench_sink += broken;
+}
+
+/**
+  Prepare input frames for decoder.
+
+  @param nerrs Number of bit errors injected into each frame.
+  */
+static void decode_ctx_init(decode_ctx_t *ctx, int band, int fr_type,
+        int enc_type, int nerrs)
+{
+    ctx->fd = frame_decoder_create(band, SCR, fr_type);
+    ctx->band = band;
+    ctx->fr_type = fr_type;
+    frame_encoder_t *fe = frame_encoder_create(band, SCR, DIR_DOWNLINK);
+    if (!ctx->fd || !fe) {
+        fprintf(stderr, "Failed to create frame encoder/decoder\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < NFRAMES; ++i) {
+        frame_t fr;
+        mk_frame(&fr, enc_type);
+        encode(fe, ctx->fr_data[i], &fr);
+        for (int j = 0; j < nerrs; ++j) {
+            ctx->fr_data[i][rand_next(&seed) % FRAME_DATA_LEN] ^= 1;
+        }
+
+        // make sure we are measuring decoding of valid frames
+        frame_t fr_dec;
+        frame_decoder_decode(ctx->fd, &fr_dec, ctx->fr_data[i]);
+        if (!nerrs && (fr_dec.broken ||
+                    memcmp(fr_dec.blob_, fr.blob_, sizeof(fr.data)))) {
+            fprintf(stderr, "Frame %d is not decoded correctly\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    frame_encoder_destroy(fe);
+}
+
+static void run_decode(void)
+{
+    static const struct {
+        const char *param;
+        int band;
+        int fr_type;    ///< decoder setting
+        int enc_type;   ///< type of encoded frame
+        int nerrs;
+    } variants[] = {
+        { "UHF/DATA", TETRAPOL_BAND_UHF, FRAME_TYPE_DATA, FRAME_TYPE_DATA, 0, },
+        { "VHF/DATA", TETRAPOL_BAND_VHF, FRAME_TYPE_DATA, FRAME_TYPE_DATA, 0, },
+        { "UHF/VOICE", TETRAPOL_BAND_UHF, FRAME_TYPE_VOICE, FRAME_TYPE_VOICE, 0, },
+        { "VHF/VOICE", TETRAPOL_BAND_VHF, FRAME_TYPE_VOICE, FRAME_TYPE_VOICE, 0, },
+        { "UHF/AUTO", TETRAPOL_BAND_UHF, FRAME_TYPE_AUTO, FRAME_TYPE_DATA, 0, },
+        { "UHF/DATA/1ERR", TETRAPOL_BAND_UHF, FRAME_TYPE_DATA, FRAME_TYPE_DATA, 1, },
+        { "UHF/DATA/4ERR", TETRAPOL_BAND_UHF, FRAME_TYPE_DATA, FRAME_TYPE_DATA, 4, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        decode_ctx_t ctx;
+        decode_ctx_init(&ctx, variants[i].band, variants[i].fr_type,
+                variants[i].enc_type, variants[i].nerrs);
+        bench_run("frame_decoder_decode", variants[i].param, "frame",
+                bench_decode, &ctx);
+        frame_decoder_destroy(ctx.fd);
+    }
+}
+
+typedef struct {
+    uint8_t sol[NFRAMES][26];
+    uint8_t errs[NFRAMES][26];
+} fix_errs_ctx_t;
+
+static void bench_fix_errs(void *arg, int n)
+{
+    fix_errs_ctx_t *ctx = arg;
+    int bits_fixed = 0;
+
+    for (int i = 0; i < n; ++i) {
+        // frame_fix_errs works in place, copy is included in measurement
+        uint8_t sol[26];
+        uint8_t errs[26];
+        memcpy(sol, ctx->sol[i % NFRAMES], sizeof(sol));
+        memcpy(errs, ctx->errs[i % NFRAMES], sizeof(errs));
+        frame_fix_errs(sol, errs, 26, &bits_fixed);
+    }
+    bench_sink += bits_fixed;
+}
+
+/// error syndromes of protected part of frames with single bit error
+static void run_fix_errs(void)
+{
+    decode_ctx_t dec_ctx;
+    decode_ctx_init(&dec_ctx, TETRAPOL_BAND_UHF, FRAME_TYPE_DATA,
+            FRAME_TYPE_DATA, 1);
+
+    fix_errs_ctx_t ctx;
+    for (int i = 0; i < NFRAMES; ++i) {
+        uint8_t fr_data_tmp[FRAME_DATA_LEN];
+        uint8_t fr_data_deint[FRAME_DATA_LEN];
+        uint8_t fr_errs[FRAME_DATA_LEN];
+        frame_t fr;
+
+        frame_descramble(fr_data_tmp, dec_ctx.fr_data[i], SCR);
+        frame_diff_dec(fr_data_tmp);
+        frame_deinterleave1(fr_data_deint, fr_data_tmp, TETRAPOL_BAND_UHF);
+        frame_decode1(fr.blob_, fr_errs, fr_data_deint, FRAME_TYPE_DATA);
+        memcpy(ctx.sol[i], fr.blob_, 26);
+        memcpy(ctx.errs[i], fr_errs, 26);
+    }
+    frame_decoder_destroy(dec_ctx.fd);
+
+    bench_run("frame_fix_errs", "UHF/DATA/1ERR", "frame", bench_fix_errs, &ctx);
+}
+
+typedef struct {
+    int nbits;
+    uint8_t data[NFRAMES][SYS_PAR_N200_BYTES_MAX];
+} fcs_ctx_t;
+
+static void bench_check_fcs(void *arg, int n)
+{
+    fcs_ctx_t *ctx = arg;
+    uint64_t ok = 0;
+
+    for (int i = 0; i < n; ++i) {
+        ok += check_fcs(ctx->data[i % NFRAMES], ctx->nbits);
+    }
+    bench_sink += ok;
+}
+
+static void run_check_fcs(void)
+{
+    static fcs_ctx_t ctx;
+    for (int i = 0; i < NFRAMES; ++i) {
+        for (int j = 0; j < SYS_PAR_N200_BYTES_MAX; ++j) {
+            ctx.data[i][j] = rand_next(&seed);
+        }
+    }
+
+    ctx.nbits = 64;
+    bench_run("check_fcs", "64b", "block", bench_check_fcs, &ctx);
+    ctx.nbits = 8 * SYS_PAR_N200_BYTES_MAX;
+    bench_run("check_fcs", "N200", "block", bench_check_fcs, &ctx);
+}
+
+typedef struct {
+    data_frame_t *data_fr;
+    int nframes;
+    frame_t frames[NFRAMES];
+} data_frame_ctx_t;
+
+/// push frame, get data when data frame is complete, as logical channels do
+static int push_frame(data_frame_t *data_fr, const frame_t *fr)
+{
+    uint8_t data[SYS_PAR_N200_BYTES_MAX];
+
+    if (data_frame_push_frame(data_fr, fr) <= 0) {
+        return 0;
+    }
+    data_frame_get_bytes(data_fr, data);
+
+    return 1;
+}
+
+static void bench_data_frame(void *arg, int n)
+{
+    data_frame_ctx_t *ctx = arg;
+    uint64_t decoded = 0;
+
+    for (int i = 0; i < n; ++i) {
+        decoded += push_frame(ctx->data_fr, &ctx->frames[i % ctx->nframes]);
+    }
+    bench_sink += decoded;
+}
+
+/**
+  Prepare sequence of data frames composed from blocks.
+
+  @param blocks Number of blocks per data frame, including parity block.
+  */
+static void data_frame_ctx_init(data_frame_ctx_t *ctx, int blocks)
+{
+    ctx->data_fr = data_frame_create();
+    if (!ctx->data_fr) {
+        fprintf(stderr, "Failed to create data_frame\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ctx->nframes = NFRAMES - NFRAMES % blocks;
+    for (int i = 0; i < ctx->nframes; i += blocks) {
+        frame_t *frames = &ctx->frames[i];
+        for (int j = 0; j < blocks; ++j) {
+            mk_frame(&frames[j], FRAME_TYPE_DATA);
+        }
+
+        if (blocks == 2) {
+            // FN 01, FN 11
+            frames[0].data.data[0] = 1;
+            frames[1].data.data[0] = frames[1].data.data[1] = 1;
+            continue;
+        }
+        if (blocks > 3) {
+            // FN 01, FN 10, FN 11 ..., FN 10, FN 01 with parity
+            frames[0].data.data[0] = 1;
+            frames[1].data.data[1] = 1;
+            for (int j = 2; j < blocks - 2; ++j) {
+                frames[j].data.data[0] = frames[j].data.data[1] = 1;
+            }
+            frames[blocks - 2].data.data[1] = 1;
+            frames[blocks - 1].data.data[0] = 1;
+            for (int k = 3; k < 3 + 64; ++k) {
+                uint8_t parity = 0;
+                for (int j = 0; j < blocks - 1; ++j) {
+                    parity ^= frames[j].data.data[k];
+                }
+                frames[blocks - 1].data.data[k] = parity;
+            }
+        }
+    }
+
+    // make sure each data frame is decoded
+    int decoded = 0;
+    for (int i = 0; i < ctx->nframes; ++i) {
+        decoded += push_frame(ctx->data_fr, &ctx->frames[i]);
+    }
+    if (decoded != ctx->nframes / blocks) {
+        fprintf(stderr, "Data frames with %d blocks are not decoded\n", blocks);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void run_data_frame(void)
+{
+    static const struct {
+        const char *param;
+        int blocks;
+    } variants[] = {
+        { "single", 1, },
+        { "dual", 2, },
+        { "multi8", SYS_PAR_DATA_FRAME_BLOCKS_MAX, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        static data_frame_ctx_t ctx;
+        data_frame_ctx_init(&ctx, variants[i].blocks);
+        bench_run("data_frame_push_frame", variants[i].param, "frame",
+                bench_data_frame, &ctx);
+        data_frame_destroy(ctx.data_fr);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bench_init(argc, argv);
+
+    run_decode();
+    run_fix_errs();
+    run_check_fcs();
+    run_data_frame();
+
+    return 0;
+}
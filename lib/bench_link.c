@@ -0,0 +1,494 @@
+#include "bench.h"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/link.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/system_config.h>
+#include <tetrapol/terminal.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+#include <tetrapol/tpdu.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    NFRAMES = 64,   ///< distinct input frames, multiple of 8 (N(S) modulo)
+    TSDU_LEN = 24,  ///< length of TSDU carried by single HDLC frame
+    SEG_LEN = 24,   ///< payload of single UI DU segment
+    TPDU_CODE_FCR = 0x10,
+    TPDU_CODE_DT = 0x1b,
+    TSAP_REF = 3,   ///< connection used for TPDU benchmarks
+};
+
+static uint32_t seed = 0x11dc0de5;
+
+/// compose HDLC frame with valid FCS, returns its length in bits
+static int mk_hdlc(uint8_t *buf, const addr_t *addr, uint8_t cmd,
+        const uint8_t *payload, int len)
+{
+    buf[0] = (addr->z << 7) | (addr->y << 4) | (addr->x >> 8);
+    buf[1] = addr->x;
+    buf[2] = cmd;
+    memcpy(&buf[3], payload, len);
+    const int nbits = (3 + len + 2) * 8;
+    set_fcs(buf, nbits);
+    if (!check_fcs(buf, nbits)) {
+        fprintf(stderr, "Failed to compute FCS\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return nbits;
+}
+
+static uint8_t cmd_information(int n_s)
+{
+    return (n_s & 7) << 1;
+}
+
+static void parse_hdlc(hdlc_frame_t *hdlc_fr, const uint8_t *buf, int nbits)
+{
+    if (!hdlc_frame_parse(hdlc_fr, buf, nbits)) {
+        fprintf(stderr, "Invalid HDLC frame\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/// TPDU header (PAS 0001-3-3 9.4) followed by data
+static int mk_tpdu(uint8_t *buf, bool seg, bool d, int code,
+        const uint8_t *data, int len)
+{
+    buf[0] = (seg << 6) | (d << 5) | code;
+    buf[1] = (TSAP_REF << 4) | TSAP_REF;
+    int n = 2;
+    if (!seg && d) {
+        buf[n++] = len;
+    }
+    memcpy(&buf[n], data, len);
+
+    return n + len;
+}
+
+static void mk_tsdu(uint8_t *tsdu, int len)
+{
+    tsdu[0] = D_EXPLICIT_SHORT_DATA;
+    for (int i = 1; i < len; ++i) {
+        tsdu[i] = rand_next(&seed);
+    }
+}
+
+static const addr_t addr_rt = { .z = 0, .y = 1, .x = 0x123, };
+
+typedef struct {
+    tetrapol_t *tetrapol;
+    tpol_t *tpol;
+    uint64_t ntsdus;    ///< TSDUs reported to subscriber
+} link_ctx_t;
+
+static void on_tsdu(const tetrapol_evt_t *evt, void *ptr)
+{
+    link_ctx_t *ctx = ptr;
+    ctx->ntsdus += (evt->tsdu.decoded != NULL);
+}
+
+static void link_ctx_init(link_ctx_t *ctx, uint32_t terminals_max)
+{
+    tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+        .terminals_max = terminals_max,
+    };
+    ctx->tetrapol = tetrapol_create(&cfg);
+    if (!ctx->tetrapol) {
+        fprintf(stderr, "Failed to create TETRAPOL instance\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->tpol = tetrapol_get_tpol(ctx->tetrapol);
+    ctx->ntsdus = 0;
+    // TSDUs are decoded as for any application which asks for them
+    if (!tetrapol_subscribe(ctx->tetrapol, TETRAPOL_EVT_TSDU_DECODED,
+                on_tsdu, ctx)) {
+        fprintf(stderr, "Failed to subscribe for TSDUs\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void link_ctx_check(link_ctx_t *ctx, const char *name)
+{
+    if (!ctx->ntsdus) {
+        fprintf(stderr, "No TSDU decoded by %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void link_ctx_deinit(link_ctx_t *ctx)
+{
+    tetrapol_destroy(ctx->tetrapol);
+}
+
+typedef struct {
+    uint8_t data[NFRAMES][SYS_PAR_N200_BYTES_MAX];
+    int nbits;
+} parse_ctx_t;
+
+static void bench_hdlc_frame_parse(void *arg, int n)
+{
+    parse_ctx_t *ctx = arg;
+    hdlc_frame_t hdlc_fr;
+    uint64_t ok = 0;
+
+    for (int i = 0; i < n; ++i) {
+        ok += hdlc_frame_parse(&hdlc_fr, ctx->data[i % NFRAMES], ctx->nbits);
+    }
+    bench_sink += ok + hdlc_fr.nbits;
+}
+
+static void run_hdlc_frame_parse(void)
+{
+    static const struct {
+        const char *param;
+        int len;    ///< payload length in bytes
+    } variants[] = {
+        // single block data frame has 64 bits
+        { "64b", 8 - 3 - 2, },
+        { "N200", SYS_PAR_N200_BYTES_MAX - 3 - 2, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        static parse_ctx_t ctx;
+        for (int fr_no = 0; fr_no < NFRAMES; ++fr_no) {
+            uint8_t payload[SYS_PAR_N200_BYTES_MAX];
+            for (int j = 0; j < variants[i].len; ++j) {
+                payload[j] = rand_next(&seed);
+            }
+            ctx.nbits = mk_hdlc(ctx.data[fr_no], &addr_rt,
+                    cmd_information(fr_no), payload, variants[i].len);
+        }
+
+        bench_run("hdlc_frame_parse", variants[i].param, "frame",
+                bench_hdlc_frame_parse, &ctx);
+    }
+}
+
+typedef struct {
+    link_ctx_t lctx;
+    link_t *link;
+    tpdu_t *tpdu;
+    tpdu_ui_t *tpdu_ui;
+    hdlc_frame_t frames[NFRAMES];
+    int nframes;
+    uint64_t pos;       ///< number of frames pushed so far
+} push_ctx_t;
+
+/// I frames carrying DT TPDU with single TSDU, N(S) goes from 0 to 7
+static void mk_dt_frames(push_ctx_t *ctx)
+{
+    for (int fr_no = 0; fr_no < NFRAMES; ++fr_no) {
+        uint8_t tsdu[TSDU_LEN];
+        uint8_t tpdu[SYS_PAR_N200_BYTES_MAX];
+        uint8_t buf[SYS_PAR_N200_BYTES_MAX];
+        mk_tsdu(tsdu, sizeof(tsdu));
+        const int len = mk_tpdu(tpdu, false, true, TPDU_CODE_DT, tsdu,
+                sizeof(tsdu));
+        const int nbits = mk_hdlc(buf, &addr_rt, cmd_information(fr_no),
+                tpdu, len);
+        parse_hdlc(&ctx->frames[fr_no], buf, nbits);
+    }
+    ctx->nframes = NFRAMES;
+}
+
+/// I frames carrying segmented DT TPDU, each 4 frames compose single TSDU
+static void mk_dt_seg_frames(push_ctx_t *ctx)
+{
+    for (int fr_no = 0; fr_no < NFRAMES; ++fr_no) {
+        const bool last = (fr_no % 4) == 3;
+        uint8_t tsdu[TSDU_LEN];
+        uint8_t tpdu[SYS_PAR_N200_BYTES_MAX];
+        uint8_t buf[SYS_PAR_N200_BYTES_MAX];
+        mk_tsdu(tsdu, sizeof(tsdu));
+        if (fr_no % 4) {
+            tsdu[0] = rand_next(&seed);
+        }
+        const int len = mk_tpdu(tpdu, !last, true, TPDU_CODE_DT, tsdu,
+                sizeof(tsdu));
+        const int nbits = mk_hdlc(buf, &addr_rt, cmd_information(fr_no),
+                tpdu, len);
+        parse_hdlc(&ctx->frames[fr_no], buf, nbits);
+    }
+    ctx->nframes = NFRAMES;
+}
+
+static void push_fcr(push_ctx_t *ctx, bool link)
+{
+    uint8_t tpdu[2];
+    uint8_t buf[SYS_PAR_N200_BYTES_MAX];
+    hdlc_frame_t hdlc_fr;
+    mk_tpdu(tpdu, false, false, TPDU_CODE_FCR, NULL, 0);
+    // N(S) of the last benchmark frame, so the first one is in sequence
+    parse_hdlc(&hdlc_fr, buf, mk_hdlc(buf, &addr_rt, cmd_information(7),
+                tpdu, sizeof(tpdu)));
+    if (link) {
+        link_push_hdlc_frame(ctx->link, &hdlc_fr);
+    } else {
+        tpdu_push_hdlc_frame(ctx->tpdu, &hdlc_fr);
+    }
+}
+
+static void bench_link_push_hdlc_frame(void *arg, int n)
+{
+    push_ctx_t *ctx = arg;
+    uint64_t errs = 0;
+
+    for (int i = 0; i < n; ++i, ++ctx->pos) {
+        errs += link_push_hdlc_frame(ctx->link,
+                &ctx->frames[ctx->pos % ctx->nframes]) != 0;
+    }
+    bench_sink += errs;
+}
+
+static void bench_tpdu_push_hdlc_frame(void *arg, int n)
+{
+    push_ctx_t *ctx = arg;
+    uint64_t errs = 0;
+
+    for (int i = 0; i < n; ++i, ++ctx->pos) {
+        errs += tpdu_push_hdlc_frame(ctx->tpdu,
+                &ctx->frames[ctx->pos % ctx->nframes]) != 0;
+    }
+    bench_sink += errs;
+}
+
+static void run_link_tpdu(void)
+{
+    static const struct {
+        const char *param;
+        void (*mk_frames)(push_ctx_t *ctx);
+    } variants[] = {
+        { "I/DT", mk_dt_frames, },
+        { "I/DT/SEG4", mk_dt_seg_frames, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        static push_ctx_t ctx;
+        link_ctx_init(&ctx.lctx, 0);
+        ctx.link = link_create(ctx.lctx.tpol, LOG_CH_SDCH);
+        ctx.tpdu = tpdu_create(ctx.lctx.tpol, LOG_CH_SDCH);
+        if (!ctx.link || !ctx.tpdu) {
+            fprintf(stderr, "Failed to create link\n");
+            exit(EXIT_FAILURE);
+        }
+        variants[i].mk_frames(&ctx);
+
+        push_fcr(&ctx, true);
+        ctx.pos = 0;
+        bench_run("link_push_hdlc_frame", variants[i].param, "frame",
+                bench_link_push_hdlc_frame, &ctx);
+        link_ctx_check(&ctx.lctx, "link_push_hdlc_frame");
+
+        ctx.lctx.ntsdus = 0;
+        push_fcr(&ctx, false);
+        ctx.pos = 0;
+        bench_run("tpdu_push_hdlc_frame", variants[i].param, "frame",
+                bench_tpdu_push_hdlc_frame, &ctx);
+        link_ctx_check(&ctx.lctx, "tpdu_push_hdlc_frame");
+
+        tpdu_destroy(ctx.tpdu);
+        link_destroy(ctx.link);
+        link_ctx_deinit(&ctx.lctx);
+    }
+}
+
+/// UI DU segment (PAS 0001-3-3 9.5.1.3), the last one carries length
+static void mk_ui_segment(hdlc_frame_t *hdlc_fr, int seg_ref, int packet_num,
+        bool last)
+{
+    uint8_t du[SYS_PAR_N200_BYTES_MAX];
+    uint8_t buf[SYS_PAR_N200_BYTES_MAX];
+    du[0] = 0x80 | (last ? 0 : 0x40) | 0x01;
+    du[1] = 0x80 | seg_ref;
+    du[2] = packet_num;
+    int n = 3;
+    if (last) {
+        du[n++] = SEG_LEN;
+    }
+    for (int i = 0; i < SEG_LEN; ++i) {
+        du[n + i] = rand_next(&seed);
+    }
+    if (!packet_num) {
+        du[n] = D_DATAGRAM;
+    }
+    const int nbits = mk_hdlc(buf, &addr_rt, COMMAND_UNNUMBERED_UI, du,
+            n + SEG_LEN);
+    parse_hdlc(hdlc_fr, buf, nbits);
+}
+
+/// UI DU without segmentation, TSDU length is stated explicitly
+static void mk_ui_du(hdlc_frame_t *hdlc_fr)
+{
+    uint8_t du[2 + TSDU_LEN];
+    uint8_t buf[SYS_PAR_N200_BYTES_MAX];
+    du[0] = 0x01;
+    du[1] = TSDU_LEN;
+    mk_tsdu(&du[2], TSDU_LEN);
+    parse_hdlc(hdlc_fr, buf, mk_hdlc(buf, &addr_rt, COMMAND_UNNUMBERED_UI, du,
+                sizeof(du)));
+}
+
+static void bench_tpdu_ui_push_hdlc_frame(void *arg, int n)
+{
+    push_ctx_t *ctx = arg;
+    uint64_t errs = 0;
+
+    for (int i = 0; i < n; ++i, ++ctx->pos) {
+        errs += tpdu_ui_push_hdlc_frame(ctx->tpdu_ui,
+                &ctx->frames[ctx->pos % ctx->nframes], NULL) != 0;
+    }
+    bench_sink += errs;
+}
+
+static void run_tpdu_ui(void)
+{
+    static push_ctx_t ctx;
+    link_ctx_init(&ctx.lctx, 0);
+    ctx.tpdu_ui = tpdu_ui_create(ctx.lctx.tpol, FRAME_TYPE_DATA, LOG_CH_SDCH);
+    if (!ctx.tpdu_ui) {
+        fprintf(stderr, "Failed to create TPDU UI\n");
+        exit(EXIT_FAILURE);
+    }
+
+    mk_ui_du(&ctx.frames[0]);
+    ctx.nframes = 1;
+    ctx.pos = 0;
+    bench_run("tpdu_ui_push_hdlc_frame", "UNSEGMENTED", "frame",
+            bench_tpdu_ui_push_hdlc_frame, &ctx);
+    link_ctx_check(&ctx.lctx, "tpdu_ui_push_hdlc_frame");
+
+    // segments of the whole DU are pushed in reverse order, the last one
+    // (first received) determines number of segments
+    for (int i = 0; i < SYS_PAR_N452; ++i) {
+        const int packet_num = SYS_PAR_N452 - 1 - i;
+        mk_ui_segment(&ctx.frames[i], 5, packet_num,
+                packet_num == SYS_PAR_N452 - 1);
+    }
+    ctx.nframes = SYS_PAR_N452;
+    ctx.pos = 0;
+    ctx.lctx.ntsdus = 0;
+    bench_run("tpdu_ui_push_hdlc_frame", "SEG64", "segment",
+            bench_tpdu_ui_push_hdlc_frame, &ctx);
+    link_ctx_check(&ctx.lctx, "tpdu_ui_push_hdlc_frame");
+
+    tpdu_ui_destroy(ctx.tpdu_ui);
+    link_ctx_deinit(&ctx.lctx);
+}
+
+typedef struct {
+    link_ctx_t lctx;
+    terminal_list_t *tlist;
+    hdlc_frame_t hdlc_fr;   ///< template, address and N(S) are replaced
+    addr_t *addrs;          ///< terminals in order of frame reception
+    uint8_t *n_s;           ///< N(S) of next frame for each terminal
+    int nterminals;
+    uint64_t pos;
+} tlist_ctx_t;
+
+static void tlist_push(tlist_ctx_t *ctx)
+{
+    const int idx = ctx->pos % ctx->nterminals;
+    ctx->hdlc_fr.addr = ctx->addrs[idx];
+    ctx->hdlc_fr.command.information.n_s = ctx->n_s[idx];
+    ctx->n_s[idx] = (ctx->n_s[idx] + 1) % 8;
+    ++ctx->pos;
+    terminal_list_push_hdlc_frame(ctx->tlist, &ctx->hdlc_fr);
+}
+
+static void bench_terminal_list_push_hdlc_frame(void *arg, int n)
+{
+    tlist_ctx_t *ctx = arg;
+
+    for (int i = 0; i < n; ++i) {
+        tlist_push(ctx);
+    }
+}
+
+static void run_terminal_list(void)
+{
+    // address has 16 bits, larger table is not possible
+    static const int nterminals[] = { 10, 100, 1000, 10000, 65536, };
+
+    // random permutation of all addresses
+    static uint16_t all_addrs[65536];
+    for (int i = 0; i < ARRAY_LEN(all_addrs); ++i) {
+        all_addrs[i] = i;
+    }
+    for (int i = ARRAY_LEN(all_addrs) - 1; i > 0; --i) {
+        const int j = rand_next(&seed) % (i + 1);
+        const uint16_t t = all_addrs[i];
+        all_addrs[i] = all_addrs[j];
+        all_addrs[j] = t;
+    }
+
+    for (int i = 0; i < ARRAY_LEN(nterminals); ++i) {
+        static tlist_ctx_t ctx;
+        const int n = nterminals[i];
+        link_ctx_init(&ctx.lctx, n);
+        ctx.tlist = terminal_list_create(ctx.lctx.tpol, LOG_CH_SDCH);
+        ctx.addrs = malloc(n * sizeof(addr_t));
+        ctx.n_s = calloc(n, sizeof(uint8_t));
+        if (!ctx.tlist || !ctx.addrs || !ctx.n_s) {
+            fprintf(stderr, "Failed to create terminal list\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int j = 0; j < n; ++j) {
+            ctx.addrs[j].z = all_addrs[j] >> 15;
+            ctx.addrs[j].y = (all_addrs[j] >> 12) & 7;
+            ctx.addrs[j].x = all_addrs[j] & 0xfff;
+        }
+        ctx.nterminals = n;
+        ctx.pos = 0;
+
+        static push_ctx_t frames;
+        mk_dt_frames(&frames);
+        ctx.hdlc_fr = frames.frames[0];
+
+        // create all terminals, the first DT repairs connection
+        for (int j = 0; j < n; ++j) {
+            tlist_push(&ctx);
+        }
+        ctx.lctx.ntsdus = 0;
+
+        char param[16];
+        snprintf(param, sizeof(param), "%d", n);
+        bench_run("terminal_list_push_hdlc_frame", param, "frame",
+                bench_terminal_list_push_hdlc_frame, &ctx);
+        link_ctx_check(&ctx.lctx, "terminal_list_push_hdlc_frame");
+
+        tetrapol_stats_t stats;
+        tetrapol_get_stats(ctx.lctx.tetrapol, &stats);
+        if (stats.terminals_live != n) {
+            fprintf(stderr, "Terminals lost: %llu of %d\n",
+                    (unsigned long long)stats.terminals_live, n);
+            exit(EXIT_FAILURE);
+        }
+
+        free(ctx.n_s);
+        free(ctx.addrs);
+        terminal_list_destroy(ctx.tlist);
+        link_ctx_deinit(&ctx.lctx);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bench_init(argc, argv);
+
+    run_hdlc_frame_parse();
+    run_link_tpdu();
+    run_tpdu_ui();
+    run_terminal_list();
+
+    return 0;
+}
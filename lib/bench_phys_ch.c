@@ -0,0 +1,249 @@
+#include "bench.h"
+
+// include, we are benchmarking static methods
+#include "phys_ch.c"
+
+#include <tetrapol/chan_gen.h>
+
+#include <stdio.h>
+
+enum {
+    STREAM_FRAMES = 200,    ///< one CCH superframe
+    RECV_CHUNK = 4 * FRAME_LEN,
+    SCR = 23,
+};
+
+/// encode stream of frames as bits, one bit per byte, as tetrapol_build does
+static int mk_stream(uint8_t *bits, int nframes, chan_gen_cfg_t *cfg)
+{
+    chan_gen_t *gen = chan_gen_create(cfg);
+    if (!gen) {
+        fprintf(stderr, "Failed to create channel generator\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int len = 0;
+    for (int fr_no = 0; fr_no < nframes; ++fr_no) {
+        const int n = chan_gen_frame(gen, &bits[len]);
+        if (n < 0) {
+            fprintf(stderr, "Frame encoding failed\n");
+            exit(EXIT_FAILURE);
+        }
+        len += n;
+    }
+
+    chan_gen_destroy(gen);
+
+    return len;
+}
+
+typedef struct {
+    tetrapol_t *tetrapol;
+    phys_ch_t *phys_ch;
+    uint8_t fr_data[FRAME_DATA_LEN];
+    uint8_t bits[STREAM_FRAMES * (FRAME_LEN + 1)];
+    int len;    ///< used part of bits
+    int pos;    ///< position in bits for end-to-end benchmark
+} phys_ch_ctx_t;
+
+/// impairments might be NULL for clean stream
+static void phys_ch_ctx_init(phys_ch_ctx_t *ctx, int band, int radio_ch_type,
+        const chan_gen_cfg_t *impairments)
+{
+    tetrapol_cfg_t cfg = {
+        .band = band,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = radio_ch_type,
+    };
+    ctx->tetrapol = tetrapol_create(&cfg);
+    if (!ctx->tetrapol) {
+        fprintf(stderr, "Failed to create TETRAPOL instance\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->phys_ch = tetrapol_phys_ch_create(ctx->tetrapol);
+    if (!ctx->phys_ch) {
+        fprintf(stderr, "Failed to create physical channel\n");
+        exit(EXIT_FAILURE);
+    }
+    ctx->pos = 0;
+
+    chan_gen_cfg_t gen_cfg;
+    if (impairments) {
+        memcpy(&gen_cfg, impairments, sizeof(gen_cfg));
+    } else {
+        memset(&gen_cfg, 0, sizeof(gen_cfg));
+    }
+    gen_cfg.band = band;
+    gen_cfg.dir = DIR_DOWNLINK;
+    gen_cfg.scr = SCR;
+    gen_cfg.fr_type = (radio_ch_type == TETRAPOL_RADIO_CCH) ?
+        FRAME_TYPE_DATA : FRAME_TYPE_VOICE;
+    gen_cfg.seed = 0x5eed0fca;
+    ctx->len = mk_stream(ctx->bits, STREAM_FRAMES, &gen_cfg);
+}
+
+static void phys_ch_ctx_deinit(phys_ch_ctx_t *ctx)
+{
+    tetrapol_phys_ch_destroy(ctx->phys_ch);
+    tetrapol_destroy(ctx->tetrapol);
+}
+
+static void bench_cmp_frame_sync(void *arg, int n)
+{
+    phys_ch_ctx_t *ctx = arg;
+    uint64_t errs = 0;
+
+    for (int i = 0; i < n; ++i) {
+        errs += cmp_frame_sync(&ctx->bits[i % (ctx->len - 8)]);
+    }
+    bench_sink += errs;
+}
+
+/// search for frame synchronization in data without any, 160 positions per op
+static void bench_find_frame_sync(void *arg, int n)
+{
+    phys_ch_ctx_t *ctx = arg;
+    phys_ch_t *phys_ch = ctx->phys_ch;
+    uint64_t found = 0;
+
+    for (int i = 0; i < n; ++i) {
+        phys_ch->data_begin = phys_ch->data + DATA_OFFS;
+        phys_ch->data_end = phys_ch->data_begin + 2 * FRAME_LEN +
+            FRAME_HDR_LEN - 1;
+        found += find_frame_sync(phys_ch);
+    }
+    bench_sink += found;
+}
+
+static void run_sync(void)
+{
+    static phys_ch_ctx_t ctx;
+    phys_ch_ctx_init(&ctx, TETRAPOL_BAND_UHF, TETRAPOL_RADIO_CCH, NULL);
+
+    bench_run("cmp_frame_sync", "UHF", "call", bench_cmp_frame_sync, &ctx);
+
+    // constant signal never matches synchronization sequence
+    memset(ctx.phys_ch->data, 0, sizeof(ctx.phys_ch->data));
+    bench_run("find_frame_sync", "no_sync", "frame", bench_find_frame_sync,
+            &ctx);
+
+    phys_ch_ctx_deinit(&ctx);
+}
+
+static void bench_detect_scr(void *arg, int n)
+{
+    phys_ch_ctx_t *ctx = arg;
+    phys_ch_t *phys_ch = ctx->phys_ch;
+
+    for (int i = 0; i < n; ++i) {
+        // keep detection running, do not let it succeed
+        memset(phys_ch->scr_stat, 0, sizeof(phys_ch->scr_stat));
+        detect_scr(phys_ch, ctx->fr_data);
+    }
+    bench_sink += phys_ch->scr_guess;
+}
+
+static void run_detect_scr(void)
+{
+    static const struct {
+        const char *param;
+        int band;
+    } variants[] = {
+        { "UHF", TETRAPOL_BAND_UHF, },
+        { "VHF", TETRAPOL_BAND_VHF, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        static phys_ch_ctx_t ctx;
+        phys_ch_ctx_init(&ctx, variants[i].band, TETRAPOL_RADIO_CCH, NULL);
+        memcpy(ctx.fr_data, &ctx.bits[FRAME_HDR_LEN], FRAME_DATA_LEN);
+        differential_dec(ctx.fr_data, FRAME_DATA_LEN, 0);
+        tetrapol_phys_ch_set_scr(ctx.phys_ch, PHYS_CH_SCR_DETECT);
+
+        bench_run("detect_scr", variants[i].param, "frame", bench_detect_scr,
+                &ctx);
+        phys_ch_ctx_deinit(&ctx);
+    }
+}
+
+/// feed stream in chunks into phys_ch, 1 op = 1 frame
+static void bench_recv_process(void *arg, int n)
+{
+    phys_ch_ctx_t *ctx = arg;
+    int nbits = n * FRAME_LEN;
+
+    while (nbits) {
+        int len = ctx->len - ctx->pos;
+        len = (len > RECV_CHUNK) ? RECV_CHUNK : len;
+        len = (len > nbits) ? nbits : len;
+        len = tetrapol_phys_ch_recv(ctx->phys_ch, &ctx->bits[ctx->pos], len);
+        tetrapol_phys_ch_process(ctx->phys_ch);
+        ctx->pos = (ctx->pos + len) % ctx->len;
+        nbits -= len;
+    }
+}
+
+static void run_recv_process(void)
+{
+    // bit errors, bursts and slips forcing resynchronization in get_frame()
+    static const chan_gen_cfg_t impaired = {
+        .ber = 0.005,
+        .burst_rate = 0.02,
+        .burst_len = 24,
+        .slip_rate = 0.01,
+    };
+    static const struct {
+        const char *param;
+        int band;
+        int radio_ch_type;
+        int scr;
+        const chan_gen_cfg_t *impairments;
+    } variants[] = {
+        { "UHF/CCH", TETRAPOL_BAND_UHF, TETRAPOL_RADIO_CCH, SCR, NULL, },
+        { "VHF/CCH", TETRAPOL_BAND_VHF, TETRAPOL_RADIO_CCH, SCR, NULL, },
+        { "UHF/TCH", TETRAPOL_BAND_UHF, TETRAPOL_RADIO_TCH, SCR, NULL, },
+        { "UHF/CCH/SCR_DETECT", TETRAPOL_BAND_UHF, TETRAPOL_RADIO_CCH,
+            PHYS_CH_SCR_DETECT, NULL, },
+        { "UHF/CCH/IMPAIRED", TETRAPOL_BAND_UHF, TETRAPOL_RADIO_CCH, SCR,
+            &impaired, },
+    };
+
+    for (int i = 0; i < ARRAY_LEN(variants); ++i) {
+        static phys_ch_ctx_t ctx;
+        phys_ch_ctx_init(&ctx, variants[i].band, variants[i].radio_ch_type,
+                variants[i].impairments);
+        tetrapol_phys_ch_set_scr(ctx.phys_ch, variants[i].scr);
+        if (variants[i].scr == PHYS_CH_SCR_DETECT) {
+            // never finish detection
+            tetrapol_phys_ch_set_scr_confidence(ctx.phys_ch, INT_MAX);
+        }
+
+        bench_run("tetrapol_phys_ch_recv+process", variants[i].param, "frame",
+                bench_recv_process, &ctx);
+
+        tetrapol_metrics_t metrics;
+        tetrapol_get_metrics(ctx.tetrapol, &metrics);
+        const int fr_type = (variants[i].radio_ch_type == TETRAPOL_RADIO_CCH) ?
+            FRAME_TYPE_DATA : FRAME_TYPE_VOICE;
+        if (variants[i].scr != PHYS_CH_SCR_DETECT && !variants[i].impairments &&
+                metrics.frames_broken[fr_type] * 100 > metrics.frames[fr_type]) {
+            fprintf(stderr, "Too many broken frames in %s: %llu of %llu\n",
+                    variants[i].param,
+                    (unsigned long long)metrics.frames_broken[fr_type],
+                    (unsigned long long)metrics.frames[fr_type]);
+            exit(EXIT_FAILURE);
+        }
+        phys_ch_ctx_deinit(&ctx);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    bench_init(argc, argv);
+
+    run_sync();
+    run_detect_scr();
+    run_recv_process();
+
+    return 0;
+}
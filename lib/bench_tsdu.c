@@ -0,0 +1,234 @@
+#include "bench.h"
+
+#include <tetrapol/arena.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/msg_coding.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    TSDU_LEN_MAX = 2000,    ///< max. TSDU composed by TPDU layer
+    MIXED_LEN = 64,         ///< payload length of TSDUs for mixed benchmark
+};
+
+static uint32_t seed = 0x75d0c0de;
+
+typedef struct {
+    const char *name;
+    int len;
+    uint8_t data[TSDU_LEN_MAX];
+} tsdu_msg_t;
+
+static void fill_rand(uint8_t *data, int len)
+{
+    for (int i = 0; i < len; ++i) {
+        data[i] = rand_next(&seed);
+    }
+}
+
+static void mk_system_info(tsdu_msg_t *msg)
+{
+    msg->name = "D_SYSTEM_INFO";
+    msg->len = 17;
+    fill_rand(msg->data, msg->len);
+    msg->data[0] = D_SYSTEM_INFO;
+    msg->data[1] = CELL_STATE_MODE_NORMAL;
+}
+
+/// group list with maximal number of entries of each type
+static void mk_group_list(tsdu_msg_t *msg)
+{
+    static const struct {
+        int type;
+        int size;       ///< size of single entry
+    } lists[] = {
+        { TYPE_NB_TYPE_EMERGENCY, 2, },
+        { TYPE_NB_TYPE_OPEN, 5, },
+        { TYPE_NB_TYPE_TALK_GROUP, 4, },
+        { TYPE_NB_TYPE_OPEN, 5, },
+        { TYPE_NB_TYPE_TALK_GROUP, 4, },
+    };
+
+    msg->name = "D_GROUP_LIST";
+    msg->data[0] = D_GROUP_LIST;
+    msg->data[1] = 1 << 5;  // revision 1
+    msg->data[2] = 0;       // index_list
+    int len = 3;
+    for (int i = 0; i < ARRAY_LEN(lists); ++i) {
+        const type_nb_t type_nb = {
+            .type = lists[i].type,
+            .number = 63,
+        };
+        msg->data[len++] = type_nb._data;
+        for (int j = 0; j < type_nb.number; ++j) {
+            memset(&msg->data[len], 0, lists[i].size);
+            msg->data[len] = rand_next(&seed);
+            len += lists[i].size;
+        }
+    }
+    msg->data[len++] = TYPE_NB_TYPE_END;
+    msg->len = len;
+}
+
+/// neighbouring cell with all adjacent cells and long IEI lists
+static void mk_neighbouring_cell(tsdu_msg_t *msg)
+{
+    msg->name = "D_NEIGHBOURING_CELL";
+    msg->data[0] = D_NEIGHBOURING_CELL;
+    msg->data[1] = 15;      // ccr_config.number
+    msg->data[2] = 0;       // ccr_param
+    int len = 3;
+    for (int i = 0; i < 15; ++i) {
+        fill_rand(&msg->data[len], 2);
+        msg->data[len + 2] = 0;
+        len += 3;
+    }
+    // IEIs are repeated, lists are extended by each occurrence
+    for (int i = 0; i < 4; ++i) {
+        msg->data[len++] = IEI_CELL_ID_LIST;
+        msg->data[len++] = 64;
+        fill_rand(&msg->data[len], 64);
+        len += 64;
+        msg->data[len++] = IEI_ADJACENT_BN_LIST;
+        msg->data[len++] = 48;
+        fill_rand(&msg->data[len], 48);
+        len += 48;
+    }
+    msg->len = len;
+}
+
+static void mk_group_composition(tsdu_msg_t *msg)
+{
+    msg->name = "D_GROUP_COMPOSITION";
+    msg->len = 3 + (12 * 15 + 7) / 8;
+    fill_rand(msg->data, msg->len);
+    msg->data[0] = D_GROUP_COMPOSITION;
+    msg->data[2] |= 0x0f;   // og_nb
+}
+
+static void mk_datagram(tsdu_msg_t *msg)
+{
+    msg->name = "D_DATAGRAM";
+    msg->len = 5 + 256;
+    fill_rand(msg->data, msg->len);
+    msg->data[0] = D_DATAGRAM;
+}
+
+static void mk_explicit_short_data(tsdu_msg_t *msg)
+{
+    msg->name = "D_EXPLICIT_SHORT_DATA";
+    msg->len = 1 + 32;
+    fill_rand(msg->data, msg->len);
+    msg->data[0] = D_EXPLICIT_SHORT_DATA;
+}
+
+typedef struct {
+    const tsdu_msg_t *msgs;
+    int nmsgs;
+    arena_t *arena;
+    uint64_t pos;       ///< number of decoded TSDUs
+} tsdu_ctx_t;
+
+static void bench_tsdu_decode(void *arg, int n)
+{
+    tsdu_ctx_t *ctx = arg;
+    uint64_t ok = 0;
+
+    for (int i = 0; i < n; ++i, ++ctx->pos) {
+        const tsdu_msg_t *msg = &ctx->msgs[ctx->pos % ctx->nmsgs];
+        tsdu_t *tsdu;
+        ok += !tsdu_decode(msg->data, msg->len, &tsdu);
+        tsdu_destroy(tsdu);
+    }
+    bench_sink += ok;
+}
+
+static void bench_tsdu_decode_arena(void *arg, int n)
+{
+    tsdu_ctx_t *ctx = arg;
+    uint64_t ok = 0;
+
+    for (int i = 0; i < n; ++i, ++ctx->pos) {
+        const tsdu_msg_t *msg = &ctx->msgs[ctx->pos % ctx->nmsgs];
+        tsdu_t *tsdu;
+        ok += !tsdu_decode_arena(ctx->arena, msg->data, msg->len, &tsdu);
+        arena_reset(ctx->arena);
+    }
+    bench_sink += ok;
+}
+
+/// make sure message is decoded, otherwise error path is benchmarked
+static void check_msg(const tsdu_msg_t *msg)
+{
+    tsdu_t *tsdu;
+    if (tsdu_decode(msg->data, msg->len, &tsdu) || !tsdu) {
+        fprintf(stderr, "Failed to decode %s\n", msg->name);
+        exit(EXIT_FAILURE);
+    }
+    tsdu_destroy(tsdu);
+}
+
+static void run_codops(arena_t *arena)
+{
+    static void (*const mk_msg[])(tsdu_msg_t *msg) = {
+        mk_system_info,
+        mk_group_list,
+        mk_neighbouring_cell,
+        mk_group_composition,
+        mk_datagram,
+        mk_explicit_short_data,
+    };
+
+    for (int i = 0; i < ARRAY_LEN(mk_msg); ++i) {
+        static tsdu_msg_t msg;
+        mk_msg[i](&msg);
+        check_msg(&msg);
+
+        tsdu_ctx_t ctx = {
+            .msgs = &msg,
+            .nmsgs = 1,
+            .arena = arena,
+        };
+        bench_run("tsdu_decode", msg.name, "tsdu", bench_tsdu_decode, &ctx);
+        bench_run("tsdu_decode_arena", msg.name, "tsdu",
+                bench_tsdu_decode_arena, &ctx);
+    }
+}
+
+/// all codops with pseudo-random payload, dispatch and error paths included
+static void run_mixed(arena_t *arena)
+{
+    static tsdu_msg_t msgs[256];
+    for (int codop = 0; codop < ARRAY_LEN(msgs); ++codop) {
+        msgs[codop].name = "MIXED";
+        msgs[codop].len = MIXED_LEN;
+        fill_rand(msgs[codop].data, MIXED_LEN);
+        msgs[codop].data[0] = codop;
+    }
+
+    tsdu_ctx_t ctx = {
+        .msgs = msgs,
+        .nmsgs = ARRAY_LEN(msgs),
+        .arena = arena,
+    };
+    bench_run("tsdu_decode", "MIXED", "tsdu", bench_tsdu_decode, &ctx);
+    bench_run("tsdu_decode_arena", "MIXED", "tsdu", bench_tsdu_decode_arena,
+            &ctx);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_init(argc, argv);
+
+    static uint8_t arena_buf[64 * 1024];
+    arena_t arena;
+    arena_init(&arena, arena_buf, sizeof(arena_buf));
+
+    run_codops(&arena);
+    run_mixed(&arena);
+
+    return 0;
+}
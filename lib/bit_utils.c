@@ -36,6 +36,32 @@ bool check_fcs(const uint8_t *data, int nbits)
     return !(crc ^ 0xffff);
 }
 
+void set_fcs(uint8_t *data, int nbits)
+{
+    uint8_t *fcs = data + nbits / 8 - 2;
+    fcs[0] = fcs[1] = 0;
+
+    // FCS bits are shifted into CRC register as the last ones and never
+    // reach its top, so their value can be derived from CRC of data
+    // followed by zeroes
+    uint32_t crc = 0;
+    for (int i = 0; i < nbits; ++i) {
+        crc = (crc << 1) | ((data[i / 8] >> (i % 8)) & 1);
+        if (i == 15) {
+            crc ^= 0xffff;
+        }
+        if (crc & 0x10000) {
+            crc ^= 0x11021;
+        }
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        if (!((crc >> (15 - i)) & 1)) {
+            fcs[i / 8] |= 1 << (i % 8);
+        }
+    }
+}
+
 void pack_bits(uint8_t *bytes, const uint8_t *bits, int offs, int nbits)
 {
     bytes += offs / 8;
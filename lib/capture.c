@@ -0,0 +1,493 @@
+#define LOG_PREFIX "capture"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/capture.h>
+#include <tetrapol/log.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char CAPTURE_MAGIC[4] = { 'T', 'P', 'C', 'P', };
+
+enum {
+    FRAME_DATA_BITS = 69,                   ///< crc_data of data frame
+    FRAME_VOICE_BITS = 23 + 100,            ///< crc_data and voice2
+    /// header, base and the longest payload (HDLC frame)
+    REC_MAX = 2 * CAPTURE_REC_HDR_LEN + 8 + 10 + SYS_PAR_N200_BYTES_MAX,
+};
+
+struct capture_writer_priv_t {
+    FILE *f;
+    tetrapol_t *tetrapol;
+    uint64_t rx_offs;   ///< rx_offs of last record
+    int scr;            ///< SCR reported by last SCR event
+    bool err;
+};
+
+static uint8_t *put_bits(uint8_t *p, const uint8_t *bits, int nbits)
+{
+    memset(p, 0, (nbits + 7) / 8);
+    for (int i = 0; i < nbits; ++i) {
+        p[i / 8] |= (bits[i] & 1) << (i % 8);
+    }
+    return p + (nbits + 7) / 8;
+}
+
+static void get_bits_(uint8_t *bits, const uint8_t *p, int nbits)
+{
+    for (int i = 0; i < nbits; ++i) {
+        bits[i] = (p[i / 8] >> (i % 8)) & 1;
+    }
+}
+
+static uint8_t *put_rec_hdr(uint8_t *p, int type, int frame_no,
+        uint32_t rx_offs)
+{
+    // length is filled when record is complete
+    p = put_u16(p, 0);
+    p = put_u8(p, type);
+    p = put_u8(p, (frame_no == FRAME_NO_UNKNOWN) ?
+            CAPTURE_FRAME_NO_UNKNOWN : frame_no);
+
+    return put_u32(p, rx_offs);
+}
+
+/// write base record when rx_offs difference does not fit into record header
+static uint8_t *put_base(capture_writer_t *cw, uint8_t *p,
+        const tetrapol_evt_t *evt)
+{
+    if (evt->rx_offs >= cw->rx_offs &&
+            evt->rx_offs - cw->rx_offs <= UINT32_MAX) {
+        return p;
+    }
+
+    uint8_t *rec = p;
+    p = put_rec_hdr(rec, CAPTURE_REC_BASE, evt->frame_no, 0);
+    p = put_u64(p, evt->rx_offs);
+    put_u16(rec, p - rec);
+    cw->rx_offs = evt->rx_offs;
+
+    return p;
+}
+
+static uint8_t *frame_encode(uint8_t *p, const frame_t *fr, int scr)
+{
+    p = put_u8(p, scr);
+    p = put_u8(p, fr->fr_type);
+    p = put_u8(p, fr->broken > INT8_MAX ? INT8_MAX : fr->broken);
+    p = put_u8(p, fr->syndromes > UINT8_MAX ? UINT8_MAX : fr->syndromes);
+    p = put_u8(p, fr->bits_fixed > UINT8_MAX ? UINT8_MAX : fr->bits_fixed);
+
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        return put_bits(p, fr->data.crc_data, FRAME_DATA_BITS);
+    }
+
+    if (fr->fr_type == FRAME_TYPE_VOICE) {
+        uint8_t bits[FRAME_VOICE_BITS];
+        memcpy(bits, fr->voice.crc_data, sizeof(fr->voice.crc_data));
+        memcpy(bits + sizeof(fr->voice.crc_data), fr->voice.voice2,
+                sizeof(fr->voice.voice2));
+        return put_bits(p, bits, FRAME_VOICE_BITS);
+    }
+
+    return p;
+}
+
+static int frame_decode(frame_t *fr, int *scr, const uint8_t *p, int len)
+{
+    if (len < 5) {
+        return -1;
+    }
+
+    memset(fr, 0, sizeof(*fr));
+    *scr = p[0];
+    fr->fr_type = (int8_t)p[1];
+    fr->broken = (int8_t)p[2];
+    fr->syndromes = p[3];
+    fr->bits_fixed = p[4];
+    p += 5;
+    len -= 5;
+
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        if (len < (FRAME_DATA_BITS + 7) / 8) {
+            return -1;
+        }
+        get_bits_(fr->data.crc_data, p, FRAME_DATA_BITS);
+    } else if (fr->fr_type == FRAME_TYPE_VOICE) {
+        if (len < (FRAME_VOICE_BITS + 7) / 8) {
+            return -1;
+        }
+        uint8_t bits[FRAME_VOICE_BITS];
+        get_bits_(bits, p, FRAME_VOICE_BITS);
+        memcpy(fr->voice.crc_data, bits, sizeof(fr->voice.crc_data));
+        memcpy(fr->voice.voice2, bits + sizeof(fr->voice.crc_data),
+                sizeof(fr->voice.voice2));
+    }
+
+    return 0;
+}
+
+static uint8_t *command_encode(uint8_t *p, const command_t *cmd)
+{
+    uint8_t v[3] = { 0, 0, 0, };
+
+    switch (cmd->cmd) {
+        case COMMAND_INFORMATION:
+            v[0] = cmd->information.n_r;
+            v[1] = cmd->information.n_s;
+            v[2] = cmd->information.p_e;
+            break;
+
+        case COMMAND_SUPERVISION_RR:
+        case COMMAND_SUPERVISION_RNR:
+        case COMMAND_SUPERVISION_REJ:
+            v[0] = cmd->supervision.n_r;
+            v[1] = cmd->supervision.p_e;
+            break;
+
+        case COMMAND_DACH:
+            v[0] = cmd->dach_access.seq_no;
+            v[1] = cmd->dach_access.retry;
+            break;
+
+        case COMMAND_UNNUMBERED_U_RR:
+            v[1] = cmd->unnumbered.response_format;
+            // no break
+        case COMMAND_UNNUMBERED_UI:
+        case COMMAND_UNNUMBERED_DISC:
+        case COMMAND_UNNUMBERED_UA:
+        case COMMAND_UNNUMBERED_SNRM:
+        case COMMAND_UNNUMBERED_UI_P0:
+        case COMMAND_UNNUMBERED_FRMR:
+        case COMMAND_UNNUMBERED_DM:
+            v[0] = cmd->unnumbered.p_e;
+            break;
+    }
+
+    p = put_u8(p, cmd->cmd);
+    memcpy(p, v, sizeof(v));
+
+    return p + sizeof(v);
+}
+
+static void command_decode(command_t *cmd, const uint8_t *p)
+{
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->cmd = p[0];
+
+    switch (cmd->cmd) {
+        case COMMAND_INFORMATION:
+            cmd->information.n_r = p[1];
+            cmd->information.n_s = p[2];
+            cmd->information.p_e = p[3];
+            break;
+
+        case COMMAND_SUPERVISION_RR:
+        case COMMAND_SUPERVISION_RNR:
+        case COMMAND_SUPERVISION_REJ:
+            cmd->supervision.n_r = p[1];
+            cmd->supervision.p_e = p[2];
+            break;
+
+        case COMMAND_DACH:
+            cmd->dach_access.seq_no = p[1];
+            cmd->dach_access.retry = p[2];
+            break;
+
+        default:
+            cmd->unnumbered.p_e = p[1];
+            cmd->unnumbered.response_format = p[2];
+            break;
+    }
+}
+
+static uint8_t *hdlc_encode(uint8_t *p, int log_ch,
+        const hdlc_frame_t *hdlc_fr)
+{
+    const int len = (hdlc_fr->nbits + 16 + 7) / 8;
+
+    p = put_u8(p, log_ch);
+    p = put_u16(p, addr_pack(&hdlc_fr->addr));
+    p = command_encode(p, &hdlc_fr->command);
+    p = put_u16(p, hdlc_fr->nbits);
+    memcpy(p, hdlc_fr->data, len);
+
+    return p + len;
+}
+
+static int hdlc_decode(hdlc_frame_t *hdlc_fr, int *log_ch,
+        const uint8_t *p, int len)
+{
+    if (len < 9) {
+        return -1;
+    }
+
+    *log_ch = p[0];
+    const uint16_t addr = get_u16(&p[1]);
+    hdlc_fr->addr.z = addr >> 15;
+    hdlc_fr->addr.y = (addr >> 12) & 0x7;
+    hdlc_fr->addr.x = addr & 0xfff;
+    command_decode(&hdlc_fr->command, &p[3]);
+    hdlc_fr->nbits = get_u16(&p[7]);
+
+    const int data_len = (hdlc_fr->nbits + 16 + 7) / 8;
+    if (data_len > sizeof(hdlc_fr->data) || data_len > len - 9) {
+        return -1;
+    }
+    memcpy(hdlc_fr->data, &p[9], data_len);
+
+    return 0;
+}
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    capture_writer_t *cw = ptr;
+
+    if (evt->type == TETRAPOL_EVT_SCR) {
+        cw->scr = evt->scr.scr;
+        return;
+    }
+
+    int type;
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            type = CAPTURE_REC_FRAME;
+            break;
+
+        case TETRAPOL_EVT_HDLC:
+            if (evt->hdlc.hdlc_fr->nbits < 0) {
+                return;
+            }
+            type = CAPTURE_REC_HDLC;
+            break;
+
+        case TETRAPOL_EVT_SYNC:
+            type = CAPTURE_REC_SYNC;
+            break;
+
+        default:
+            return;
+    }
+
+    uint8_t buf[REC_MAX];
+    uint8_t *rec = put_base(cw, buf, evt);
+    uint8_t *p = put_rec_hdr(rec, type, evt->frame_no,
+            evt->rx_offs - cw->rx_offs);
+    cw->rx_offs = evt->rx_offs;
+
+    switch (type) {
+        case CAPTURE_REC_FRAME:
+            p = frame_encode(p, evt->frame.fr, cw->scr);
+            break;
+
+        case CAPTURE_REC_HDLC:
+            p = hdlc_encode(p, evt->hdlc.log_ch, evt->hdlc.hdlc_fr);
+            break;
+
+        case CAPTURE_REC_SYNC:
+            p = put_u8(p, evt->sync.has_sync);
+            break;
+    }
+    put_u16(rec, p - rec);
+
+    if (!cw->err && fwrite(buf, p - buf, 1, cw->f) != 1) {
+        LOG(ERR, "write failed");
+        cw->err = true;
+    }
+}
+
+capture_writer_t *capture_writer_create(FILE *f, int level,
+        tetrapol_t *tetrapol)
+{
+    int mask;
+    switch (level) {
+        case CAPTURE_LEVEL_FRAME:
+            mask = TETRAPOL_EVT_FRAME | TETRAPOL_EVT_SCR | TETRAPOL_EVT_SYNC;
+            break;
+
+        case CAPTURE_LEVEL_HDLC:
+            mask = TETRAPOL_EVT_HDLC | TETRAPOL_EVT_SYNC;
+            break;
+
+        default:
+            LOG(ERR, "invalid capture level %d", level);
+            return NULL;
+    }
+    if (tetrapol_has_filter(tetrapol)) {
+        LOG(ERR, "capture of filtered events is not supported");
+        return NULL;
+    }
+
+    capture_writer_t *cw = calloc(1, sizeof(capture_writer_t));
+    if (!cw) {
+        return NULL;
+    }
+    cw->f = f;
+    cw->tetrapol = tetrapol;
+    cw->scr = PHYS_CH_SCR_DETECT;
+
+    const tetrapol_cfg_t *cfg = tetrapol_get_cfg(tetrapol);
+    uint8_t hdr[CAPTURE_FILE_HDR_LEN];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    hdr[4] = CAPTURE_VERSION;
+    hdr[5] = level;
+    hdr[6] = cfg->band;
+    hdr[7] = cfg->dir;
+    hdr[8] = cfg->radio_ch_type;
+    put_u64(&hdr[16], cfg->start_time);
+
+    if (fwrite(hdr, sizeof(hdr), 1, f) != 1) {
+        LOG(ERR, "failed to write file header");
+        free(cw);
+        return NULL;
+    }
+
+    if (!tetrapol_subscribe(tetrapol, mask, evt_cb, cw)) {
+        free(cw);
+        return NULL;
+    }
+
+    return cw;
+}
+
+int capture_writer_destroy(capture_writer_t *cw)
+{
+    if (!cw) {
+        return 0;
+    }
+
+    tetrapol_unsubscribe(cw->tetrapol, evt_cb, cw);
+    const int ret = (cw->err || fflush(cw->f)) ? -1 : 0;
+    free(cw);
+
+    return ret;
+}
+
+int capture_reader_init(capture_reader_t *cr, FILE *f)
+{
+    uint8_t hdr[CAPTURE_FILE_HDR_LEN];
+    if (fread(hdr, sizeof(hdr), 1, f) != 1) {
+        LOG(ERR, "failed to read file header");
+        return -1;
+    }
+
+    if (memcmp(hdr, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) ||
+            hdr[4] != CAPTURE_VERSION ||
+            (hdr[5] != CAPTURE_LEVEL_FRAME && hdr[5] != CAPTURE_LEVEL_HDLC)) {
+        LOG(ERR, "invalid file header");
+        return -1;
+    }
+
+    memset(cr, 0, sizeof(*cr));
+    cr->f = f;
+    cr->hdr.level = hdr[5];
+    cr->hdr.cfg.band = hdr[6];
+    cr->hdr.cfg.dir = hdr[7];
+    cr->hdr.cfg.radio_ch_type = hdr[8];
+    cr->hdr.cfg.start_time = get_u64(&hdr[16]);
+
+    return 0;
+}
+
+int capture_read(capture_reader_t *cr, capture_rec_t *rec)
+{
+    uint8_t hdr[CAPTURE_REC_HDR_LEN];
+    uint8_t data[REC_MAX];
+
+    while (true) {
+        if (fread(hdr, 2, 1, cr->f) != 1) {
+            return feof(cr->f) ? 0 : -1;
+        }
+
+        const int len = get_u16(hdr);
+        if (len < CAPTURE_REC_HDR_LEN ||
+                len - CAPTURE_REC_HDR_LEN > sizeof(data)) {
+            LOG(ERR, "invalid record length %d", len);
+            return -1;
+        }
+        if (fread(&hdr[2], CAPTURE_REC_HDR_LEN - 2, 1, cr->f) != 1) {
+            LOG(ERR, "truncated record");
+            return -1;
+        }
+        const int payload_len = len - CAPTURE_REC_HDR_LEN;
+        if (payload_len && fread(data, payload_len, 1, cr->f) != 1) {
+            LOG(ERR, "truncated record");
+            return -1;
+        }
+
+        rec->type = hdr[2];
+        rec->frame_no = (hdr[3] == CAPTURE_FRAME_NO_UNKNOWN) ?
+            FRAME_NO_UNKNOWN : hdr[3];
+        const uint32_t rx_offs_diff = get_u32(&hdr[4]);
+        if (cr->rx_offs + rx_offs_diff < cr->rx_offs) {
+            LOG(ERR, "rx_offs overflow");
+            return -1;
+        }
+        cr->rx_offs += rx_offs_diff;
+        rec->rx_offs = cr->rx_offs;
+
+        switch (rec->type) {
+            case CAPTURE_REC_BASE:
+                if (payload_len < 8) {
+                    LOG(ERR, "invalid base record");
+                    return -1;
+                }
+                // replay expects time to advance only
+                if (get_u64(data) < cr->rx_offs) {
+                    LOG(ERR, "base record moves rx_offs backward");
+                    return -1;
+                }
+                cr->rx_offs = get_u64(data);
+                break;
+
+            case CAPTURE_REC_FRAME:
+                if (frame_decode(&rec->fr, &rec->scr, data, payload_len)) {
+                    LOG(ERR, "invalid frame record");
+                    return -1;
+                }
+                return 1;
+
+            case CAPTURE_REC_HDLC:
+                if (hdlc_decode(&rec->hdlc_fr, &rec->log_ch, data,
+                            payload_len)) {
+                    LOG(ERR, "invalid HDLC record");
+                    return -1;
+                }
+                return 1;
+
+            case CAPTURE_REC_SYNC:
+                if (payload_len < 1) {
+                    LOG(ERR, "invalid sync record");
+                    return -1;
+                }
+                rec->has_sync = data[0];
+                return 1;
+
+            default:
+                LOG(DBG, "skipping unknown record type %d", rec->type);
+                break;
+        }
+    }
+}
+
+void capture_replay(phys_ch_t *phys_ch, const capture_rec_t *rec)
+{
+    switch (rec->type) {
+        case CAPTURE_REC_FRAME:
+            tetrapol_phys_ch_replay_frame(phys_ch, &rec->fr, rec->scr,
+                    rec->rx_offs, rec->frame_no);
+            break;
+
+        case CAPTURE_REC_HDLC:
+            tetrapol_phys_ch_replay_hdlc(phys_ch, rec->log_ch, &rec->hdlc_fr,
+                    rec->rx_offs, rec->frame_no);
+            break;
+
+        case CAPTURE_REC_SYNC:
+            tetrapol_phys_ch_replay_sync(phys_ch, rec->has_sync,
+                    rec->rx_offs);
+            break;
+    }
+}
@@ -42,6 +42,7 @@ cch_t *cch_create(tpol_t *tpol)
         goto err_sdch;
     }
 
+    cch->cch_mux_type = CELL_CONFIG_MUX_TYPE_DEFAULT;
     cch->tpol = tpol;
 
     return cch;
@@ -72,23 +73,30 @@ void cch_destroy(cch_t *cch)
     free(cch);
 }
 
+static int update_mux_type(cch_t *cch)
+{
+    const tsdu_d_system_info_t *tsdu = bch_get_tsdu(cch->bch);
+    if (!tsdu) {
+        return 0;
+    }
+
+    cch->cch_mux_type = tsdu->cell_config.mux_type;
+    if (cch->cch_mux_type != CELL_CONFIG_MUX_TYPE_DEFAULT &&
+            cch->cch_mux_type != CELL_CONFIG_MUX_TYPE_TYPE_2) {
+        LOG(ERR, "Unknown channel multiplexing type");
+        return -1;
+    }
+
+    return 0;
+}
+
 int cch_push_frame(cch_t *cch, const frame_t *fr)
 {
     // For BCH decoding are used all frames, not only frames 0-3, 100-103.
     // Firs of all for BCH detection (frame 0/100 in superblock).
     // The second reason is just to check frame synchronization.
     if (bch_push_frame(cch->bch, fr)) {
-        tsdu_d_system_info_t *tsdu = bch_get_tsdu(cch->bch);
-        if (tsdu) {
-            cch->cch_mux_type = tsdu->cell_config.mux_type;
-            if (cch->cch_mux_type != CELL_CONFIG_MUX_TYPE_DEFAULT &&
-                    cch->cch_mux_type != CELL_CONFIG_MUX_TYPE_TYPE_2) {
-                LOG(ERR, "Unknown channel multiplexing type");
-                return -1;
-            }
-            tsdu_destroy(&tsdu->base);
-            return 0;
-        }
+        return update_mux_type(cch);
     }
 
     if (cch->tpol->frame_no == FRAME_NO_UNKNOWN) {
@@ -139,11 +147,48 @@ int cch_push_frame(cch_t *cch, const frame_t *fr)
     return -1;
 }
 
+int cch_push_hdlc_frame(cch_t *cch, int log_ch, const hdlc_frame_t *hdlc_fr)
+{
+    switch (log_ch) {
+        case LOG_CH_BCH:
+            if (bch_push_hdlc_frame(cch->bch, hdlc_fr)) {
+                return update_mux_type(cch);
+            }
+            return 0;
+
+        case LOG_CH_SDCH:
+            return sdch_push_hdlc_frame(cch->sdch, hdlc_fr) ? 0 : -1;
+
+        default:
+            LOG(ERR, "HDLC frame on unsupported logical channel %d", log_ch);
+            return -1;
+    }
+}
+
 void cch_fr_error(cch_t *cch)
 {
     pch_reset(cch->pch);
 }
 
-void cch_tick(time_evt_t *te, void *cch)
+void cch_rx_glitch(cch_t *cch)
 {
+    pch_reset(cch->pch);
+    sdch_rx_glitch(cch->sdch);
+}
+
+void cch_save(const cch_t *cch, snapshot_t *snap)
+{
+    snapshot_put_u8(snap, cch->cch_mux_type);
+    bch_save(cch->bch, snap);
+    pch_save(cch->pch, snap);
+    rch_save(cch->rch, snap);
+    sdch_save(cch->sdch, snap);
+}
+
+bool cch_load(cch_t *cch, snapshot_t *snap)
+{
+    cch->cch_mux_type = snapshot_get_u8(snap);
+
+    return bch_load(cch->bch, snap) && pch_load(cch->pch, snap) &&
+        rch_load(cch->rch, snap) && sdch_load(cch->sdch, snap);
 }
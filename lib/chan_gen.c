@@ -0,0 +1,217 @@
+#define LOG_PREFIX "chan_gen"
+#include <tetrapol/log.h>
+#include <tetrapol/chan_gen.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/tetrapol.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    GAP_LEN_MAX = 1024 * FRAME_LEN,
+};
+
+struct chan_gen_priv_t {
+    chan_gen_cfg_t cfg;
+    frame_encoder_t *fe;
+    chan_gen_evt_cb_t evt_cb;
+    void *evt_cb_ptr;
+    uint32_t data_rand;     ///< state of generator for frame content
+    uint32_t chan_rand;     ///< state of generator for impairments
+    uint64_t offs;          ///< bits generated so far
+    uint64_t seq;           ///< frames generated so far
+    bool inverted;          ///< signal polarity is inverted
+};
+
+/// event with probability p, generator is not used for p == 0
+static bool rand_event(uint32_t *state, double p)
+{
+    return p > 0 && rand_unit(state) < p;
+}
+
+chan_gen_t *chan_gen_create(const chan_gen_cfg_t *cfg)
+{
+    if (cfg->fr_type != FRAME_TYPE_DATA && cfg->fr_type != FRAME_TYPE_VOICE) {
+        LOG(ERR, "unsupported frame type %d", cfg->fr_type);
+        return NULL;
+    }
+    if (!rate_is_valid(cfg->ber, 1) || !rate_is_valid(cfg->burst_rate, 1) ||
+            !rate_is_valid(cfg->slip_rate, 1) ||
+            !rate_is_valid(cfg->polarity_rate, 1) ||
+            !rate_is_valid(cfg->gap_rate, 1)) {
+        LOG(ERR, "invalid impairment rate");
+        return NULL;
+    }
+    if (cfg->burst_len < 0 || cfg->burst_len > FRAME_LEN ||
+            cfg->gap_len < 0 || cfg->gap_len > GAP_LEN_MAX) {
+        LOG(ERR, "invalid burst or gap length");
+        return NULL;
+    }
+
+    chan_gen_t *gen = calloc(1, sizeof(chan_gen_t));
+    if (!gen) {
+        return NULL;
+    }
+
+    gen->fe = frame_encoder_create(cfg->band, cfg->scr, cfg->dir);
+    if (!gen->fe) {
+        free(gen);
+        return NULL;
+    }
+    memcpy(&gen->cfg, cfg, sizeof(gen->cfg));
+    gen->data_rand = cfg->seed ? cfg->seed : SEED_DEFAULT;
+    // impairments must not share sequence with data
+    gen->chan_rand = ~gen->data_rand ? ~gen->data_rand : SEED_DEFAULT;
+
+    return gen;
+}
+
+void chan_gen_destroy(chan_gen_t *gen)
+{
+    if (!gen) {
+        return;
+    }
+
+    frame_encoder_destroy(gen->fe);
+    free(gen);
+}
+
+void chan_gen_set_evt_cb(chan_gen_t *gen, chan_gen_evt_cb_t cb, void *ptr)
+{
+    gen->evt_cb = cb;
+    gen->evt_cb_ptr = ptr;
+}
+
+int chan_gen_frame_len_max(const chan_gen_t *gen)
+{
+    return gen->cfg.gap_len + FRAME_LEN + 1;
+}
+
+static void mk_frame(chan_gen_t *gen, frame_t *fr)
+{
+    memset(fr, 0, sizeof(*fr));
+    fr->fr_type = gen->cfg.fr_type;
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        // FN 00, single block frame
+        for (int i = 2; i < ARRAY_LEN(fr->data.data); ++i) {
+            fr->data.data[i] = rand_next(&gen->data_rand) & 1;
+        }
+    } else {
+        for (int i = 0; i < ARRAY_LEN(fr->voice.voice1); ++i) {
+            fr->voice.voice1[i] = rand_next(&gen->data_rand) & 1;
+        }
+        for (int i = 0; i < ARRAY_LEN(fr->voice.voice2); ++i) {
+            fr->voice.voice2[i] = rand_next(&gen->data_rand) & 1;
+        }
+    }
+}
+
+static void report(chan_gen_t *gen, chan_gen_evt_t *evt)
+{
+    if (gen->evt_cb) {
+        gen->evt_cb(evt, gen->evt_cb_ptr);
+    }
+}
+
+int chan_gen_frame(chan_gen_t *gen, uint8_t *bits)
+{
+    const chan_gen_cfg_t *cfg = &gen->cfg;
+    uint32_t *chan_rand = &gen->chan_rand;
+    chan_gen_evt_t evt;
+    int n = 0;
+
+    if (rand_event(chan_rand, cfg->gap_rate) && cfg->gap_len) {
+        evt.type = CHAN_GEN_EVT_GAP;
+        evt.offs = gen->offs;
+        evt.gap.len = cfg->gap_len;
+        report(gen, &evt);
+        for ( ; n < cfg->gap_len; ++n) {
+            bits[n] = rand_next(chan_rand) & 1;
+        }
+    }
+
+    if (rand_event(chan_rand, cfg->polarity_rate)) {
+        gen->inverted = !gen->inverted;
+        evt.type = CHAN_GEN_EVT_POLARITY;
+        evt.offs = gen->offs + n;
+        report(gen, &evt);
+    }
+
+    frame_t fr;
+    uint8_t frame[FRAME_LEN / 8];
+    mk_frame(gen, &fr);
+    if (frame_encoder_encode(gen->fe, frame, &fr)) {
+        LOG(ERR, "frame encoding failed");
+        return -1;
+    }
+
+    // uplink is received inverted, see tetrapol_phys_ch_recv()
+    const uint8_t inv = gen->inverted ^ (cfg->dir == DIR_UPLINK);
+    uint8_t fr_bits[FRAME_LEN];
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        fr_bits[i] = ((frame[i / 8] >> (i % 8)) & 1) ^ inv;
+    }
+    uint8_t clean_bits[FRAME_LEN];
+    memcpy(clean_bits, fr_bits, FRAME_LEN);
+
+    for (int i = 0; cfg->ber > 0 && i < FRAME_LEN; ++i) {
+        if (rand_event(chan_rand, cfg->ber)) {
+            fr_bits[i] ^= 1;
+        }
+    }
+
+    int burst_pos = -1;
+    if (rand_event(chan_rand, cfg->burst_rate) && cfg->burst_len) {
+        burst_pos = rand_next(chan_rand) % (FRAME_LEN - cfg->burst_len + 1);
+        for (int i = burst_pos; i < burst_pos + cfg->burst_len; ++i) {
+            fr_bits[i] = rand_next(chan_rand) & 1;
+        }
+    }
+
+    int bit_errs = 0;
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        bit_errs += fr_bits[i] ^ clean_bits[i];
+    }
+
+    evt.type = CHAN_GEN_EVT_FRAME;
+    evt.offs = gen->offs + n;
+    evt.frame.fr = &fr;
+    evt.frame.seq = gen->seq;
+    evt.frame.bit_errs = bit_errs;
+    report(gen, &evt);
+
+    if (burst_pos >= 0) {
+        evt.type = CHAN_GEN_EVT_BURST;
+        evt.offs = gen->offs + n + burst_pos;
+        evt.burst.len = cfg->burst_len;
+        report(gen, &evt);
+    }
+
+    if (!rand_event(chan_rand, cfg->slip_rate)) {
+        memcpy(&bits[n], fr_bits, FRAME_LEN);
+        n += FRAME_LEN;
+    } else {
+        const int pos = rand_next(chan_rand) % FRAME_LEN;
+        evt.type = CHAN_GEN_EVT_SLIP;
+        evt.offs = gen->offs + n + pos;
+        evt.slip.bits = (rand_next(chan_rand) & 1) ? -1 : 1;
+        report(gen, &evt);
+
+        memcpy(&bits[n], fr_bits, pos);
+        n += pos;
+        if (evt.slip.bits < 0) {
+            memcpy(&bits[n], &fr_bits[pos + 1], FRAME_LEN - pos - 1);
+            n += FRAME_LEN - pos - 1;
+        } else {
+            bits[n++] = rand_next(chan_rand) & 1;
+            memcpy(&bits[n], &fr_bits[pos], FRAME_LEN - pos);
+            n += FRAME_LEN - pos;
+        }
+    }
+
+    gen->offs += n;
+    ++gen->seq;
+
+    return n;
+}
@@ -254,3 +254,45 @@ int data_frame_get_bytes(data_frame_t *data_fr, uint8_t *data)
 
     return nframes * 64;
 }
+
+void data_frame_save(const data_frame_t *data_fr, snapshot_t *snap)
+{
+    snapshot_put_u8(snap, data_fr->nframes);
+    snapshot_put_u8(snap, data_fr->nerrs);
+    for (int i = 0; i < data_fr->nframes; ++i) {
+        const frame_t *fr = &data_fr->frames[i];
+        snapshot_put_u8(snap, data_fr->fn[i]);
+        snapshot_put_u8(snap, fr->fr_type);
+        snapshot_put_u32(snap, fr->broken);
+        snapshot_put_u32(snap, fr->syndromes);
+        snapshot_put_u32(snap, fr->bits_fixed);
+        snapshot_put_bits(snap, fr->data.crc_data,
+                SIZEOF(frame_data_t, crc_data));
+    }
+}
+
+bool data_frame_load(data_frame_t *data_fr, snapshot_t *snap)
+{
+    data_frame_reset(data_fr);
+    const int nframes = snapshot_get_u8(snap);
+    data_fr->nerrs = snapshot_get_u8(snap);
+    if (nframes > ARRAY_LEN(data_fr->frames)) {
+        snapshot_invalid(snap, "data frame");
+        return false;
+    }
+
+    for (int i = 0; i < nframes; ++i) {
+        frame_t *fr = &data_fr->frames[i];
+        memset(fr, 0, sizeof(*fr));
+        data_fr->fn[i] = (int8_t)snapshot_get_u8(snap);
+        fr->fr_type = (int8_t)snapshot_get_u8(snap);
+        fr->broken = (int32_t)snapshot_get_u32(snap);
+        fr->syndromes = snapshot_get_u32(snap);
+        fr->bits_fixed = snapshot_get_u32(snap);
+        snapshot_get_bits(snap, fr->data.crc_data,
+                SIZEOF(frame_data_t, crc_data));
+    }
+    data_fr->nframes = nframes;
+
+    return !snap->err;
+}
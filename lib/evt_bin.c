@@ -0,0 +1,427 @@
+#define LOG_PREFIX "evt_bin"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/log.h>
+
+#include <string.h>
+
+static const char EVT_BIN_MAGIC[4] = { 'T', 'P', 'E', 'V', };
+
+static uint8_t *frame_encode(uint8_t *p, const frame_t *fr)
+{
+    p = put_u8(p, fr->fr_type);
+    p = put_u8(p, fr->broken);
+    p = put_u8(p, fr->syndromes > UINT8_MAX ? UINT8_MAX : fr->syndromes);
+    p = put_u8(p, fr->bits_fixed > UINT8_MAX ? UINT8_MAX : fr->bits_fixed);
+
+    if (fr->broken) {
+        return put_u8(p, 0);
+    }
+
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        p = put_u8(p, fr->data.asb[0] | (fr->data.asb[1] << 1) |
+                (fr->data.data[0] << 2) | (fr->data.data[1] << 3));
+        memset(p, 0, 8);
+        for (int i = 0; i < 8*8; ++i) {
+            p[i / 8] |= fr->data.data[i + 2] << (i % 8);
+        }
+        return p + 8;
+    }
+
+    if (fr->fr_type == FRAME_TYPE_VOICE) {
+        p = put_u8(p, fr->voice.asb[0] | (fr->voice.asb[1] << 1));
+        memset(p, 0, 120/8);
+        for (int i = 0; i < 20; ++i) {
+            p[i / 8] |= fr->voice.voice1[i] << (i % 8);
+        }
+        for (int i = 20; i < 120; ++i) {
+            p[i / 8] |= fr->voice.voice2[i - 20] << (i % 8);
+        }
+        return p + 120/8;
+    }
+
+    return put_u8(p, 0);
+}
+
+static int frame_decode(frame_t *fr, const uint8_t *p, int len)
+{
+    if (len < 5) {
+        return -1;
+    }
+
+    memset(fr, 0, sizeof(*fr));
+    fr->fr_type = (int8_t)p[0];
+    fr->broken = (int8_t)p[1];
+    fr->syndromes = p[2];
+    fr->bits_fixed = p[3];
+    const uint8_t bits = p[4];
+    p += 5;
+    len -= 5;
+
+    if (fr->broken) {
+        return 0;
+    }
+
+    if (fr->fr_type == FRAME_TYPE_DATA) {
+        if (len < 8) {
+            return -1;
+        }
+        fr->data.asb[0] = bits & 1;
+        fr->data.asb[1] = (bits >> 1) & 1;
+        fr->data.data[0] = (bits >> 2) & 1;
+        fr->data.data[1] = (bits >> 3) & 1;
+        for (int i = 0; i < 8*8; ++i) {
+            fr->data.data[i + 2] = (p[i / 8] >> (i % 8)) & 1;
+        }
+    } else if (fr->fr_type == FRAME_TYPE_VOICE) {
+        if (len < 120/8) {
+            return -1;
+        }
+        fr->voice.asb[0] = bits & 1;
+        fr->voice.asb[1] = (bits >> 1) & 1;
+        for (int i = 0; i < 20; ++i) {
+            fr->voice.voice1[i] = (p[i / 8] >> (i % 8)) & 1;
+        }
+        for (int i = 20; i < 120; ++i) {
+            fr->voice.voice2[i - 20] = (p[i / 8] >> (i % 8)) & 1;
+        }
+    }
+
+    return 0;
+}
+
+/// encode fixed part of TSDU, data are appended by caller
+static uint8_t *tsdu_encode(uint8_t *p, const tpol_tsdu_t *tsdu, int data_len)
+{
+    p = put_u8(p, tsdu->log_ch);
+    p = put_u8(p, tsdu->tpdu_type);
+    p = put_u8(p, tsdu->prio);
+    p = put_u8(p, tsdu->tsap_id);
+    p = put_u16(p, tsdu->tsap_ref_swmi);
+    p = put_u16(p, tsdu->tsap_ref_rt);
+    p = put_u8(p, tsdu->addr.z);
+    p = put_u8(p, tsdu->addr.y);
+    p = put_u16(p, tsdu->addr.x);
+
+    return put_u16(p, data_len);
+}
+
+static int tsdu_decode_(tpol_tsdu_t *tsdu, uint8_t *data,
+        const uint8_t *p, int len)
+{
+    if (len < 14) {
+        return -1;
+    }
+
+    tsdu->log_ch = p[0];
+    tsdu->tpdu_type = p[1];
+    tsdu->prio = (int8_t)p[2];
+    tsdu->tsap_id = (int8_t)p[3];
+    tsdu->tsap_ref_swmi = (int16_t)get_u16(&p[4]);
+    tsdu->tsap_ref_rt = (int16_t)get_u16(&p[6]);
+    tsdu->addr.z = p[8];
+    tsdu->addr.y = p[9];
+    tsdu->addr.x = get_u16(&p[10]);
+    tsdu->data_len = get_u16(&p[12]);
+    if (tsdu->data_len > len - 14) {
+        return -1;
+    }
+    memmove(data, &p[14], tsdu->data_len);
+    tsdu->data = data;
+
+    return 0;
+}
+
+void evt_bin_ctx_init(evt_bin_ctx_t *ctx)
+{
+    ctx->has_base = false;
+    ctx->rx_offs = 0;
+    ctx->rx_time = 0;
+}
+
+void evt_bin_encode_file_hdr(uint8_t *buf)
+{
+    memset(buf, 0, EVT_BIN_FILE_HDR_LEN);
+    memcpy(buf, EVT_BIN_MAGIC, sizeof(EVT_BIN_MAGIC));
+    buf[4] = EVT_BIN_VERSION;
+}
+
+int evt_bin_write_file_hdr(FILE *f)
+{
+    uint8_t hdr[EVT_BIN_FILE_HDR_LEN];
+    evt_bin_encode_file_hdr(hdr);
+
+    return fwrite(hdr, sizeof(hdr), 1, f) == 1 ? 0 : -1;
+}
+
+static uint8_t *put_rec_hdr(uint8_t *p, int type, int frame_no,
+        uint32_t rx_offs, uint32_t rx_time)
+{
+    // length is filled when record is complete
+    p = put_u16(p, 0);
+    p = put_u8(p, type);
+    p = put_u8(p, (frame_no == FRAME_NO_UNKNOWN) ?
+            EVT_BIN_FRAME_NO_UNKNOWN : frame_no);
+    p = put_u32(p, rx_offs);
+
+    return put_u32(p, rx_time);
+}
+
+static uint8_t *put_base(uint8_t *p, evt_bin_ctx_t *ctx,
+        const tetrapol_evt_t *evt)
+{
+    uint8_t *rec = p;
+    p = put_rec_hdr(rec, EVT_BIN_REC_BASE, evt->frame_no, 0, 0);
+    p = put_u64(p, evt->rx_offs);
+    p = put_u64(p, evt->rx_time);
+    put_u16(rec, p - rec);
+
+    ctx->has_base = true;
+    ctx->rx_offs = evt->rx_offs;
+    ctx->rx_time = evt->rx_time;
+
+    return p;
+}
+
+/**
+  Encode record without its variable length data, those are stored into
+  data and data_len and must follow encoded part in stream.
+
+  @return length of data in buf, 0 for unsupported event, -1 when buf is too
+    small
+  */
+static int encode_fixed(uint8_t *buf, int size, evt_bin_ctx_t *ctx,
+        const tetrapol_evt_t *evt, const uint8_t **data, int *data_len_)
+{
+    int rec_type = evt->type;
+    const uint8_t *data_ = NULL;
+    int data_len = 0;
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+        case TETRAPOL_EVT_SCR:
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            data_ = evt->tsdu.tsdu->data;
+            data_len = evt->tsdu.tsdu->data_len;
+            if (data_len > EVT_BIN_REC_MAX - EVT_BIN_REC_HDR_LEN - 14) {
+                LOG(ERR, "TSDU too long %d", data_len);
+                data_len = EVT_BIN_REC_MAX - EVT_BIN_REC_HDR_LEN - 14;
+            }
+            break;
+
+        case TETRAPOL_EVT_PCH:
+            rec_type = EVT_BIN_REC_PCH;
+            data_ = evt->pch.data;
+            data_len = evt->pch.len;
+            break;
+
+        case TETRAPOL_EVT_RCH:
+            rec_type = EVT_BIN_REC_RCH;
+            data_ = evt->rch.data;
+            data_len = evt->rch.len;
+            break;
+
+        case TETRAPOL_EVT_REPEAT:
+            rec_type = EVT_BIN_REC_REPEAT;
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (size < EVT_BIN_ENCODE_FIXED_MAX) {
+        return -1;
+    }
+
+    uint8_t *p = buf;
+    evt_bin_ctx_t ctx_ = *ctx;
+    if (!ctx_.has_base || evt->rx_offs < ctx_.rx_offs ||
+            evt->rx_time < ctx_.rx_time ||
+            evt->rx_offs - ctx_.rx_offs > UINT32_MAX ||
+            evt->rx_time - ctx_.rx_time > UINT32_MAX) {
+        p = put_base(p, &ctx_, evt);
+    }
+
+    uint8_t *rec = p;
+    p = put_rec_hdr(rec, rec_type, evt->frame_no,
+            evt->rx_offs - ctx_.rx_offs, evt->rx_time - ctx_.rx_time);
+    ctx->has_base = true;
+    ctx->rx_offs = evt->rx_offs;
+    ctx->rx_time = evt->rx_time;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            p = frame_encode(p, evt->frame.fr);
+            break;
+
+        case TETRAPOL_EVT_SCR:
+            p = put_u8(p, evt->scr.scr);
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            p = tsdu_encode(p, evt->tsdu.tsdu, data_len);
+            break;
+
+        case TETRAPOL_EVT_REPEAT:
+            p = put_u8(p, evt->repeat.log_ch);
+            break;
+    }
+    put_u16(rec, p - rec + data_len);
+    *data = data_;
+    *data_len_ = data_len;
+
+    return p - buf;
+}
+
+int evt_bin_encode(uint8_t *buf, int size, evt_bin_ctx_t *ctx,
+        const tetrapol_evt_t *evt)
+{
+    const uint8_t *data;
+    int data_len;
+    evt_bin_ctx_t ctx_ = *ctx;
+    const int len = encode_fixed(buf, size, &ctx_, evt, &data, &data_len);
+    if (len <= 0) {
+        return len;
+    }
+    if (size - len < data_len) {
+        return -1;
+    }
+    *ctx = ctx_;
+    memcpy(&buf[len], data, data_len);
+
+    return len + data_len;
+}
+
+int evt_bin_write(FILE *f, evt_bin_ctx_t *ctx, const tetrapol_evt_t *evt)
+{
+    // data are written directly from event, no need to copy them
+    uint8_t buf[EVT_BIN_ENCODE_FIXED_MAX];
+    const uint8_t *data;
+    int data_len;
+    const int len = encode_fixed(buf, sizeof(buf), ctx, evt, &data, &data_len);
+    if (len <= 0) {
+        return len;
+    }
+    if (fwrite(buf, len, 1, f) != 1) {
+        return -1;
+    }
+
+    return (!data_len || fwrite(data, data_len, 1, f) == 1) ? 0 : -1;
+}
+
+int evt_bin_read_file_hdr(FILE *f)
+{
+    uint8_t hdr[EVT_BIN_FILE_HDR_LEN];
+    if (fread(hdr, sizeof(hdr), 1, f) != 1) {
+        LOG(ERR, "failed to read file header");
+        return -1;
+    }
+
+    if (memcmp(hdr, EVT_BIN_MAGIC, sizeof(EVT_BIN_MAGIC)) ||
+            hdr[4] != EVT_BIN_VERSION) {
+        LOG(ERR, "invalid file header");
+        return -1;
+    }
+
+    return 0;
+}
+
+int evt_bin_read(FILE *f, evt_bin_ctx_t *ctx, evt_bin_rec_t *rec)
+{
+    uint8_t hdr[EVT_BIN_REC_HDR_LEN];
+
+    while (true) {
+        if (fread(hdr, 2, 1, f) != 1) {
+            return feof(f) ? 0 : -1;
+        }
+
+        const int len = get_u16(hdr);
+        if (len < EVT_BIN_REC_HDR_LEN) {
+            LOG(ERR, "invalid record length %d", len);
+            return -1;
+        }
+        if (fread(&hdr[2], EVT_BIN_REC_HDR_LEN - 2, 1, f) != 1) {
+            LOG(ERR, "truncated record");
+            return -1;
+        }
+        const int payload_len = len - EVT_BIN_REC_HDR_LEN;
+        if (payload_len && fread(rec->data, payload_len, 1, f) != 1) {
+            LOG(ERR, "truncated record");
+            return -1;
+        }
+
+        tetrapol_evt_t *evt = &rec->evt;
+        evt->type = hdr[2];
+        evt->frame_no = (hdr[3] == EVT_BIN_FRAME_NO_UNKNOWN) ?
+            FRAME_NO_UNKNOWN : hdr[3];
+        ctx->rx_offs += get_u32(&hdr[4]);
+        ctx->rx_time += get_u32(&hdr[8]);
+        evt->rx_offs = ctx->rx_offs;
+        evt->rx_time = ctx->rx_time;
+
+        switch (evt->type) {
+            case EVT_BIN_REC_BASE:
+                if (payload_len < 16) {
+                    LOG(ERR, "invalid base record");
+                    return -1;
+                }
+                ctx->has_base = true;
+                ctx->rx_offs = get_u64(&rec->data[0]);
+                ctx->rx_time = get_u64(&rec->data[8]);
+                break;
+
+            case TETRAPOL_EVT_FRAME:
+                if (frame_decode(&rec->fr, rec->data, payload_len)) {
+                    LOG(ERR, "invalid frame record");
+                    return -1;
+                }
+                evt->frame.fr = &rec->fr;
+                return 1;
+
+            case TETRAPOL_EVT_SCR:
+                if (payload_len < 1) {
+                    LOG(ERR, "invalid SCR record");
+                    return -1;
+                }
+                evt->scr.scr = rec->data[0];
+                return 1;
+
+            case TETRAPOL_EVT_TSDU:
+                // payload is moved to the start of data buffer
+                if (tsdu_decode_(&rec->tsdu, rec->data, rec->data,
+                            payload_len)) {
+                    LOG(ERR, "invalid TSDU record");
+                    return -1;
+                }
+                evt->tsdu.tsdu = &rec->tsdu;
+                evt->tsdu.decoded = NULL;
+                return 1;
+
+            case EVT_BIN_REC_PCH:
+                evt->type = TETRAPOL_EVT_PCH;
+                evt->pch.data = rec->data;
+                evt->pch.len = payload_len;
+                return 1;
+
+            case EVT_BIN_REC_RCH:
+                evt->type = TETRAPOL_EVT_RCH;
+                evt->rch.data = rec->data;
+                evt->rch.len = payload_len;
+                return 1;
+
+            case EVT_BIN_REC_REPEAT:
+                if (payload_len < 1) {
+                    LOG(ERR, "invalid repeat record");
+                    return -1;
+                }
+                evt->type = TETRAPOL_EVT_REPEAT;
+                evt->repeat.log_ch = rec->data[0];
+                return 1;
+
+            default:
+                LOG(DBG, "skipping record type %d", evt->type);
+        }
+    }
+}
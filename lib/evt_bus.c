@@ -0,0 +1,383 @@
+#define LOG_PREFIX "evt_bus"
+#define _DEFAULT_SOURCE 1
+
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_bus.h>
+#include <tetrapol/filter.h>
+#include <tetrapol/log.h>
+#include <tetrapol/misc.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+enum {
+    POLICY_DROP,
+    POLICY_DISCONNECT,
+};
+
+typedef struct {
+    int fd;
+    bool subscribed;        ///< subscription received, records are queued
+    int req_len;
+    char req[EVT_BUS_REQ_MAX];
+    int evt_mask;
+    int policy;
+    tetrapol_filter_t filter;
+    evt_bin_ctx_t ctx;
+    uint8_t *queue;
+    int queue_begin;        ///< first unsent byte
+    int queue_end;
+    uint64_t queued;
+    uint64_t dropped;
+} client_t;
+
+struct evt_bus_priv_t {
+    int fd;
+    char *path;
+    int queue_size;
+    client_t *clients[EVT_BUS_CLIENTS_MAX];
+    evt_bus_stats_t stats;
+};
+
+static const struct {
+    const char *name;
+    int type;
+} evt_names[] = {
+    { "FRAME",  TETRAPOL_EVT_FRAME },
+    { "SCR",    TETRAPOL_EVT_SCR },
+    { "TSDU",   TETRAPOL_EVT_TSDU },
+    { "PCH",    TETRAPOL_EVT_PCH },
+    { "RCH",    TETRAPOL_EVT_RCH },
+};
+
+static const int EVT_MASK_ALL = TETRAPOL_EVT_FRAME | TETRAPOL_EVT_SCR |
+    TETRAPOL_EVT_TSDU | TETRAPOL_EVT_PCH | TETRAPOL_EVT_RCH;
+
+static int set_nonblock(int fd)
+{
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags == -1) {
+        return -1;
+    }
+
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+evt_bus_t *evt_bus_create(const char *path, int queue_size)
+{
+    struct sockaddr_un sa;
+    if (strlen(path) >= sizeof(sa.sun_path) ||
+            queue_size < EVT_BIN_ENCODE_MAX) {
+        LOG(ERR, "Invalid socket path or queue size");
+        return NULL;
+    }
+
+    evt_bus_t *bus = calloc(1, sizeof(evt_bus_t));
+    if (!bus) {
+        return NULL;
+    }
+    bus->queue_size = queue_size;
+
+    bus->path = strdup(path);
+    if (!bus->path) {
+        goto err_path;
+    }
+
+    bus->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (bus->fd == -1) {
+        LOG(ERR, "socket() failed, errno=%d", errno);
+        goto err_socket;
+    }
+
+    // replace socket left by previous instance, but nothing else
+    struct stat st;
+    if (!lstat(path, &st) && S_ISSOCK(st.st_mode)) {
+        unlink(path);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, path);
+    if (bind(bus->fd, (struct sockaddr *)&sa, sizeof(sa)) ||
+            listen(bus->fd, EVT_BUS_CLIENTS_MAX) || set_nonblock(bus->fd)) {
+        LOG(ERR, "Failed to listen on '%s', errno=%d", path, errno);
+        goto err_listen;
+    }
+
+    return bus;
+
+err_listen:
+    close(bus->fd);
+err_socket:
+    free(bus->path);
+err_path:
+    free(bus);
+
+    return NULL;
+}
+
+static void client_close(evt_bus_t *bus, int idx)
+{
+    client_t *client = bus->clients[idx];
+    LOG(INFO, "Subscriber %d closed, queued=%llu dropped=%llu", idx,
+            (unsigned long long)client->queued,
+            (unsigned long long)client->dropped);
+
+    close(client->fd);
+    free(client->queue);
+    free(client);
+    bus->clients[idx] = NULL;
+}
+
+void evt_bus_destroy(evt_bus_t *bus)
+{
+    if (!bus) {
+        return;
+    }
+
+    for (int i = 0; i < EVT_BUS_CLIENTS_MAX; ++i) {
+        if (bus->clients[i]) {
+            client_close(bus, i);
+        }
+    }
+    close(bus->fd);
+    unlink(bus->path);
+    free(bus->path);
+    free(bus);
+}
+
+static void accept_clients(evt_bus_t *bus)
+{
+    while (true) {
+        const int fd = accept(bus->fd, NULL, NULL);
+        if (fd == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG(ERR, "accept() failed, errno=%d", errno);
+            }
+            return;
+        }
+
+        int idx = 0;
+        while (idx < EVT_BUS_CLIENTS_MAX && bus->clients[idx]) {
+            ++idx;
+        }
+        client_t *client = NULL;
+        if (idx < EVT_BUS_CLIENTS_MAX && !set_nonblock(fd)) {
+            client = calloc(1, sizeof(client_t));
+        }
+        if (!client) {
+            LOG(ERR, "Subscriber rejected");
+            close(fd);
+            continue;
+        }
+
+        client->fd = fd;
+        client->evt_mask = EVT_MASK_ALL;
+        client->policy = POLICY_DROP;
+        filter_init(&client->filter);
+        evt_bin_ctx_init(&client->ctx);
+        bus->clients[idx] = client;
+        ++bus->stats.clients;
+    }
+}
+
+static int parse_events(client_t *client, const char *s)
+{
+    client->evt_mask = 0;
+    while (true) {
+        const char *end = strchr(s, ',');
+        if (!end) {
+            end = s + strlen(s);
+        }
+        int i = 0;
+        while (i < ARRAY_LEN(evt_names) &&
+                (strlen(evt_names[i].name) != end - s ||
+                 strncmp(evt_names[i].name, s, end - s))) {
+            ++i;
+        }
+        if (i == ARRAY_LEN(evt_names)) {
+            return -1;
+        }
+        client->evt_mask |= evt_names[i].type;
+        if (!*end) {
+            return 0;
+        }
+        s = end + 1;
+    }
+}
+
+/// parse subscription line, req is modified
+static int parse_req(client_t *client, char *req)
+{
+    char *saveptr;
+    for (char *expr = strtok_r(req, " \t\r", &saveptr); expr;
+            expr = strtok_r(NULL, " \t\r", &saveptr)) {
+        if (!strncmp(expr, "events=", 7)) {
+            if (parse_events(client, expr + 7)) {
+                return -1;
+            }
+        } else if (!strcmp(expr, "policy=drop")) {
+            client->policy = POLICY_DROP;
+        } else if (!strcmp(expr, "policy=disconnect")) {
+            client->policy = POLICY_DISCONNECT;
+        } else if (filter_parse(&client->filter, expr)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/// read subscription, return -1 when connection should be closed
+static int read_req(evt_bus_t *bus, client_t *client)
+{
+    const ssize_t n = read(client->fd, &client->req[client->req_len],
+            sizeof(client->req) - client->req_len);
+    if (n < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ?
+            0 : -1;
+    }
+    if (n == 0) {
+        return -1;
+    }
+    client->req_len += n;
+
+    char *eol = memchr(client->req, '\n', client->req_len);
+    if (!eol) {
+        if (client->req_len == sizeof(client->req)) {
+            LOG(ERR, "Subscription too long");
+            return -1;
+        }
+        return 0;
+    }
+    *eol = 0;
+
+    if (parse_req(client, client->req)) {
+        LOG(ERR, "Invalid subscription");
+        return -1;
+    }
+
+    client->queue = malloc(bus->queue_size);
+    if (!client->queue) {
+        return -1;
+    }
+    evt_bin_encode_file_hdr(client->queue);
+    client->queue_end = EVT_BIN_FILE_HDR_LEN;
+    client->subscribed = true;
+
+    return 0;
+}
+
+/// send queued data, return -1 when connection should be closed
+static int client_flush(client_t *client)
+{
+    while (client->queue_begin < client->queue_end) {
+        const ssize_t n = send(client->fd,
+                &client->queue[client->queue_begin],
+                client->queue_end - client->queue_begin, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        client->queue_begin += n;
+    }
+
+    if (client->queue_begin == client->queue_end) {
+        client->queue_begin = client->queue_end = 0;
+    }
+
+    return 0;
+}
+
+void evt_bus_poll(evt_bus_t *bus)
+{
+    accept_clients(bus);
+
+    for (int i = 0; i < EVT_BUS_CLIENTS_MAX; ++i) {
+        client_t *client = bus->clients[i];
+        if (!client) {
+            continue;
+        }
+        const int ret = client->subscribed ?
+            client_flush(client) : read_req(bus, client);
+        if (ret) {
+            client_close(bus, i);
+        }
+    }
+}
+
+/// queue event, return -1 when connection should be closed
+static int client_publish(evt_bus_t *bus, client_t *client,
+        const tetrapol_evt_t *evt)
+{
+    int free_size = bus->queue_size - client->queue_end;
+    if (free_size < EVT_BIN_ENCODE_MAX) {
+        if (client_flush(client)) {
+            return -1;
+        }
+        if (client->queue_begin) {
+            memmove(client->queue, &client->queue[client->queue_begin],
+                    client->queue_end - client->queue_begin);
+            client->queue_end -= client->queue_begin;
+            client->queue_begin = 0;
+        }
+        free_size = bus->queue_size - client->queue_end;
+    }
+
+    const int len = evt_bin_encode(&client->queue[client->queue_end],
+            free_size, &client->ctx, evt);
+    if (len > 0) {
+        client->queue_end += len;
+        ++client->queued;
+        ++bus->stats.queued;
+        return 0;
+    }
+    if (len == 0) {
+        return 0;
+    }
+
+    ++client->dropped;
+    ++bus->stats.dropped;
+    if (client->policy == POLICY_DISCONNECT) {
+        ++bus->stats.disconnected;
+        return -1;
+    }
+
+    return 0;
+}
+
+void evt_bus_publish(evt_bus_t *bus, const tetrapol_evt_t *evt)
+{
+    ++bus->stats.published;
+
+    for (int i = 0; i < EVT_BUS_CLIENTS_MAX; ++i) {
+        client_t *client = bus->clients[i];
+        if (!client || !client->subscribed ||
+                !(client->evt_mask & evt->type) ||
+                !filter_match(&client->filter, evt)) {
+            continue;
+        }
+        if (client_publish(bus, client, evt)) {
+            client_close(bus, i);
+        }
+    }
+}
+
+void evt_bus_get_stats(evt_bus_t *bus, evt_bus_stats_t *stats)
+{
+    memcpy(stats, &bus->stats, sizeof(evt_bus_stats_t));
+}
@@ -0,0 +1,237 @@
+#define LOG_PREFIX "evt_delta"
+
+#include <tetrapol/evt_delta.h>
+#include <tetrapol/log.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+  Copy of broadcast event including all data it points to.
+  */
+typedef struct {
+    bool valid;
+    tetrapol_evt_t evt;
+    tpol_tsdu_t tsdu;
+    int data_len;
+    uint8_t *data;
+} bcast_state_t;
+
+enum {
+    BCAST_BCH,
+    BCAST_PCH,
+    BCAST_RCH,
+    BCAST_NUM,
+};
+
+struct evt_delta_priv_t {
+    uint64_t keyframe_interval;
+    uint64_t keyframe_rx_time[BCAST_NUM];
+    bcast_state_t state[BCAST_NUM];
+};
+
+struct evt_expand_priv_t {
+    tetrapol_evt_t evt;     ///< last returned repeated event
+    bcast_state_t state[BCAST_NUM];
+};
+
+/// return BCAST_* for broadcast event, -1 for other events
+static int bcast_idx(const tetrapol_evt_t *evt)
+{
+    switch (evt->type) {
+        case TETRAPOL_EVT_TSDU:
+            return (evt->tsdu.tsdu->log_ch == LOG_CH_BCH) ? BCAST_BCH : -1;
+
+        case TETRAPOL_EVT_PCH:
+            return BCAST_PCH;
+
+        case TETRAPOL_EVT_RCH:
+            return BCAST_RCH;
+
+        case TETRAPOL_EVT_REPEAT:
+            switch (evt->repeat.log_ch) {
+                case LOG_CH_BCH:    return BCAST_BCH;
+                case LOG_CH_PCH:    return BCAST_PCH;
+                case LOG_CH_RCH:    return BCAST_RCH;
+            }
+    }
+
+    return -1;
+}
+
+static const int bcast_log_ch[BCAST_NUM] = {
+    [BCAST_BCH] = LOG_CH_BCH,
+    [BCAST_PCH] = LOG_CH_PCH,
+    [BCAST_RCH] = LOG_CH_RCH,
+};
+
+/// get data of broadcast event
+static const uint8_t *bcast_data(const tetrapol_evt_t *evt, int *len)
+{
+    switch (evt->type) {
+        case TETRAPOL_EVT_TSDU:
+            *len = evt->tsdu.tsdu->data_len;
+            return evt->tsdu.tsdu->data;
+
+        case TETRAPOL_EVT_PCH:
+            *len = evt->pch.len;
+            return evt->pch.data;
+
+        default:
+            *len = evt->rch.len;
+            return evt->rch.data;
+    }
+}
+
+static bool bcast_state_eq(const bcast_state_t *state,
+        const tetrapol_evt_t *evt)
+{
+    if (!state->valid) {
+        return false;
+    }
+
+    int len;
+    const uint8_t *data = bcast_data(evt, &len);
+    if (len != state->data_len || memcmp(data, state->data, len)) {
+        return false;
+    }
+
+    if (evt->type == TETRAPOL_EVT_TSDU) {
+        const tpol_tsdu_t *tsdu = evt->tsdu.tsdu;
+        return tsdu->tpdu_type == state->tsdu.tpdu_type &&
+            tsdu->prio == state->tsdu.prio &&
+            tsdu->tsap_id == state->tsdu.tsap_id &&
+            tsdu->tsap_ref_swmi == state->tsdu.tsap_ref_swmi &&
+            tsdu->tsap_ref_rt == state->tsdu.tsap_ref_rt &&
+            !memcmp(&tsdu->addr, &state->tsdu.addr, sizeof(addr_t));
+    }
+
+    return true;
+}
+
+static bool bcast_state_set(bcast_state_t *state, const tetrapol_evt_t *evt)
+{
+    int len;
+    const uint8_t *data = bcast_data(evt, &len);
+    if (len > state->data_len || !state->data) {
+        uint8_t *p = realloc(state->data, len ? len : 1);
+        if (!p) {
+            LOG(ERR, "ERR OOM");
+            state->valid = false;
+            return false;
+        }
+        state->data = p;
+    }
+    memcpy(state->data, data, len);
+    state->data_len = len;
+
+    memcpy(&state->evt, evt, sizeof(tetrapol_evt_t));
+    switch (evt->type) {
+        case TETRAPOL_EVT_TSDU:
+            memcpy(&state->tsdu, evt->tsdu.tsdu, sizeof(tpol_tsdu_t));
+            state->tsdu.data = state->data;
+            state->evt.tsdu.tsdu = &state->tsdu;
+            state->evt.tsdu.decoded = NULL;
+            break;
+
+        case TETRAPOL_EVT_PCH:
+            state->evt.pch.data = state->data;
+            break;
+
+        case TETRAPOL_EVT_RCH:
+            state->evt.rch.data = state->data;
+            break;
+    }
+    state->valid = true;
+
+    return true;
+}
+
+evt_delta_t *evt_delta_create(uint64_t keyframe_interval)
+{
+    evt_delta_t *delta = calloc(1, sizeof(evt_delta_t));
+    if (!delta) {
+        return NULL;
+    }
+
+    delta->keyframe_interval = keyframe_interval;
+
+    return delta;
+}
+
+void evt_delta_destroy(evt_delta_t *delta)
+{
+    if (delta) {
+        for (int i = 0; i < BCAST_NUM; ++i) {
+            free(delta->state[i].data);
+        }
+    }
+    free(delta);
+}
+
+const tetrapol_evt_t *evt_delta_push(evt_delta_t *delta,
+        const tetrapol_evt_t *evt, tetrapol_evt_t *repeat)
+{
+    const int idx = bcast_idx(evt);
+    if (idx < 0 || evt->type == TETRAPOL_EVT_REPEAT) {
+        return evt;
+    }
+
+    bcast_state_t *state = &delta->state[idx];
+    if (bcast_state_eq(state, evt) && evt->rx_time >= delta->keyframe_rx_time[idx] &&
+            evt->rx_time - delta->keyframe_rx_time[idx] < delta->keyframe_interval) {
+        repeat->type = TETRAPOL_EVT_REPEAT;
+        repeat->rx_offs = evt->rx_offs;
+        repeat->rx_time = evt->rx_time;
+        repeat->frame_no = evt->frame_no;
+        repeat->repeat.log_ch = bcast_log_ch[idx];
+        return repeat;
+    }
+
+    bcast_state_set(state, evt);
+    delta->keyframe_rx_time[idx] = evt->rx_time;
+
+    return evt;
+}
+
+evt_expand_t *evt_expand_create(void)
+{
+    return calloc(1, sizeof(evt_expand_t));
+}
+
+void evt_expand_destroy(evt_expand_t *expand)
+{
+    if (expand) {
+        for (int i = 0; i < BCAST_NUM; ++i) {
+            free(expand->state[i].data);
+        }
+    }
+    free(expand);
+}
+
+const tetrapol_evt_t *evt_expand_push(evt_expand_t *expand,
+        const tetrapol_evt_t *evt)
+{
+    const int idx = bcast_idx(evt);
+    if (idx < 0) {
+        return evt;
+    }
+
+    bcast_state_t *state = &expand->state[idx];
+    if (evt->type != TETRAPOL_EVT_REPEAT) {
+        bcast_state_set(state, evt);
+        return evt;
+    }
+
+    if (!state->valid) {
+        LOG(DBG, "repeat without full event, log_ch=%d", evt->repeat.log_ch);
+        return NULL;
+    }
+
+    memcpy(&expand->evt, &state->evt, sizeof(tetrapol_evt_t));
+    expand->evt.rx_offs = evt->rx_offs;
+    expand->evt.rx_time = evt->rx_time;
+    expand->evt.frame_no = evt->frame_no;
+
+    return &expand->evt;
+}
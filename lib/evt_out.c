@@ -0,0 +1,72 @@
+#include <tetrapol/bcast_json.h>
+#include <tetrapol/evt_out.h>
+#include <tetrapol/frame_json.h>
+#include <tetrapol/tsdu_json.h>
+
+#include <string.h>
+
+void evt_out_init(evt_out_t *out, int fmt, json_writer_t *jw, FILE *bin_f)
+{
+    out->fmt = fmt;
+    out->jw = jw;
+    out->bin_f = bin_f;
+    evt_bin_ctx_init(&out->bin_ctx);
+}
+
+int evt_out_parse_fmt(const char *name)
+{
+    if (!strcmp(name, "JSON")) {
+        return EVT_OUT_JSON;
+    }
+    if (!strcmp(name, "BIN")) {
+        return EVT_OUT_BIN;
+    }
+    if (!strcmp(name, "NONE")) {
+        return EVT_OUT_NONE;
+    }
+
+    return -1;
+}
+
+int evt_out_write(evt_out_t *out, const tetrapol_evt_t *evt)
+{
+    switch (out->fmt) {
+        case EVT_OUT_JSON:
+            evt_json(out->jw, evt);
+            return 0;
+
+        case EVT_OUT_BIN:
+            return evt_bin_write(out->bin_f, &out->bin_ctx, evt);
+    }
+
+    return 0;
+}
+
+void evt_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            frame_json(jw, evt);
+            break;
+
+        case TETRAPOL_EVT_SCR:
+            scr_json(jw, evt);
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            tsdu_json(jw, evt);
+            break;
+
+        case TETRAPOL_EVT_PCH:
+            pch_json(jw, evt);
+            break;
+
+        case TETRAPOL_EVT_RCH:
+            rch_json(jw, evt);
+            break;
+
+        case TETRAPOL_EVT_REPEAT:
+            repeat_json(jw, evt);
+            break;
+    }
+}
@@ -0,0 +1,258 @@
+#define LOG_PREFIX "filter"
+
+#include <tetrapol/filter.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/log.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    int val;
+} name_val_t;
+
+static const name_val_t log_ch_names[] = {
+    { "BCH",    LOG_CH_BCH },
+    { "DACH",   LOG_CH_DACH },
+    { "DCH",    LOG_CH_DCH },
+    { "PCH",    LOG_CH_PCH },
+    { "RACH",   LOG_CH_RACH },
+    { "RCH",    LOG_CH_RCH },
+    { "SCH",    LOG_CH_SCH },
+    { "SDCH",   LOG_CH_SDCH },
+    { "VCH",    LOG_CH_VCH },
+};
+
+static const name_val_t fr_type_names[] = {
+    { "VOICE",          FRAME_TYPE_VOICE },
+    { "DATA",           FRAME_TYPE_DATA },
+    { "HR_DATA",        FRAME_TYPE_HR_DATA },
+    { "RANDOM_ACCESS",  FRAME_TYPE_RANDOM_ACCESS },
+    { "TRAINING",       FRAME_TYPE_TRAINING },
+    { "DM_EMERGENCY",   FRAME_TYPE_DM_EMERGENCY },
+    { "SCH_TI",         FRAME_TYPE_SCH_TI },
+};
+
+void filter_init(tetrapol_filter_t *filter)
+{
+    memset(filter, 0, sizeof(tetrapol_filter_t));
+}
+
+static int find_name(const name_val_t *names, int n, const char *name, int len)
+{
+    for (int i = 0; i < n; ++i) {
+        if (strlen(names[i].name) == len && !strncmp(names[i].name, name, len)) {
+            return names[i].val;
+        }
+    }
+
+    return -1;
+}
+
+/// parse number from s, number must end at end
+static int parse_num(const char *s, const char *end, long max, long *val)
+{
+    char *e;
+    if (s == end) {
+        return -1;
+    }
+    *val = strtol(s, &e, 0);
+    if (e != end || *val < 0 || *val > max) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/// parse Z.Y.X address
+static int parse_addr(const char *s, const char *end, uint16_t *addr)
+{
+    const char *dot1 = memchr(s, '.', end - s);
+    const char *dot2 = dot1 ? memchr(dot1 + 1, '.', end - dot1 - 1) : NULL;
+    if (!dot2) {
+        return -1;
+    }
+
+    long z, y, x;
+    if (parse_num(s, dot1, 1, &z) || parse_num(dot1 + 1, dot2, 7, &y) ||
+            parse_num(dot2 + 1, end, 0xfff, &x)) {
+        return -1;
+    }
+    *addr = TETRAPOL_ADDR(z, y, x);
+
+    return 0;
+}
+
+static int parse_value(tetrapol_filter_t *filter, const char *key, int key_len,
+        const char *s, const char *end)
+{
+    char buf[32];
+    // strtol requires null terminated string
+    if (end - s >= sizeof(buf)) {
+        return -1;
+    }
+    memcpy(buf, s, end - s);
+    buf[end - s] = 0;
+    end = buf + (end - s);
+    s = buf;
+
+    if (key_len == 6 && !strncmp(key, "log_ch", key_len)) {
+        const int log_ch = find_name(log_ch_names, ARRAY_LEN(log_ch_names),
+                s, end - s);
+        if (log_ch < 0) {
+            return -1;
+        }
+        filter->log_ch_mask |= 1u << log_ch;
+
+    } else if (key_len == 5 && !strncmp(key, "frame", key_len)) {
+        const int fr_type = find_name(fr_type_names, ARRAY_LEN(fr_type_names),
+                s, end - s);
+        if (fr_type < 0) {
+            return -1;
+        }
+        filter->fr_type_mask |= 1u << fr_type;
+
+    } else if (key_len == 5 && !strncmp(key, "codop", key_len)) {
+        long codop;
+        if (parse_num(s, end, 0xff, &codop) ||
+                filter->ncodops >= TETRAPOL_FILTER_CODOPS_MAX) {
+            return -1;
+        }
+        filter->codops[filter->ncodops++] = codop;
+
+    } else if (key_len == 4 && !strncmp(key, "addr", key_len)) {
+        tetrapol_addr_range_t range;
+        const char *dash = memchr(s, '-', end - s);
+        if (dash) {
+            if (parse_addr(s, dash, &range.first) ||
+                    parse_addr(dash + 1, end, &range.last)) {
+                return -1;
+            }
+        } else {
+            if (parse_addr(s, end, &range.first)) {
+                return -1;
+            }
+            range.last = range.first;
+        }
+        if (range.first > range.last ||
+                filter->naddr_ranges >= TETRAPOL_FILTER_ADDR_RANGES_MAX) {
+            return -1;
+        }
+        filter->addr_ranges[filter->naddr_ranges++] = range;
+
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+int filter_parse(tetrapol_filter_t *filter, const char *expr)
+{
+    const char *eq = strchr(expr, '=');
+    if (!eq) {
+        LOG(ERR, "Invalid filter '%s'", expr);
+        return -1;
+    }
+
+    const char *s = eq + 1;
+    while (true) {
+        const char *end = strchr(s, ',');
+        if (!end) {
+            end = s + strlen(s);
+        }
+        if (parse_value(filter, expr, eq - expr, s, end)) {
+            LOG(ERR, "Invalid filter '%s'", expr);
+            return -1;
+        }
+        if (!*end) {
+            break;
+        }
+        s = end + 1;
+    }
+
+    return 0;
+}
+
+bool filter_log_ch_match(const tetrapol_filter_t *filter, int log_ch)
+{
+    return !filter->log_ch_mask || (filter->log_ch_mask & (1u << log_ch));
+}
+
+bool filter_addr_match(const tetrapol_filter_t *filter, const addr_t *addr)
+{
+    if (!filter->naddr_ranges) {
+        return true;
+    }
+
+    const uint16_t a = addr_pack(addr);
+    for (int i = 0; i < filter->naddr_ranges; ++i) {
+        if (a >= filter->addr_ranges[i].first &&
+                a <= filter->addr_ranges[i].last) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool filter_codop_match(const tetrapol_filter_t *filter, const uint8_t *data,
+        int len)
+{
+    if (!filter->ncodops) {
+        return true;
+    }
+
+    if (len <= 0) {
+        return false;
+    }
+    for (int i = 0; i < filter->ncodops; ++i) {
+        if (data[0] == filter->codops[i]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool filter_fr_type_match(const tetrapol_filter_t *filter, int fr_type)
+{
+    return !filter->fr_type_mask ||
+        (fr_type >= 0 && (filter->fr_type_mask & (1u << fr_type)));
+}
+
+bool filter_match(const tetrapol_filter_t *filter, const tetrapol_evt_t *evt)
+{
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            return filter_fr_type_match(filter, evt->frame.fr->fr_type);
+
+        case TETRAPOL_EVT_HDLC:
+            return filter_log_ch_match(filter, evt->hdlc.log_ch) &&
+                filter_addr_match(filter, &evt->hdlc.hdlc_fr->addr);
+
+        case TETRAPOL_EVT_LSDU:
+            return filter_log_ch_match(filter, evt->lsdu.log_ch) &&
+                filter_addr_match(filter, &evt->lsdu.hdlc_fr->addr);
+
+        case TETRAPOL_EVT_PCH:
+            return filter_log_ch_match(filter, LOG_CH_PCH);
+
+        case TETRAPOL_EVT_RCH:
+            return filter_log_ch_match(filter, LOG_CH_RCH);
+
+        case TETRAPOL_EVT_TSDU:
+            {
+                const tpol_tsdu_t *tsdu = evt->tsdu.tsdu;
+                return filter_log_ch_match(filter, tsdu->log_ch) &&
+                    filter_codop_match(filter, tsdu->data, tsdu->data_len) &&
+                    filter_addr_match(filter, &tsdu->addr);
+            }
+    }
+
+    return true;
+}
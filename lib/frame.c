@@ -620,7 +620,9 @@ static void frame_encode1(uint8_t *out_bytes, const uint8_t *in_bits)
     // drop one bit copy from data_1
     data_1 &= 0x5555555555555555LL;
 
-    *(uint64_t *)out_bytes = htole64(data ^ data_1 ^ data_2);
+    // shifted data overflow 2*26 bits, do not spill into the second part
+    *(uint64_t *)out_bytes = htole64((data ^ data_1 ^ data_2) &
+            ((1LL << (2*26)) - 1));
 }
 
 /**
@@ -1,98 +1,109 @@
 #include <tetrapol/frame_json.h>
-#include <tetrapol/misc.h>
 
-#include <inttypes.h>
-#include <stdio.h>
 #include <string.h>
-#include <sys/time.h>
-#include <time.h>
 
-void frame_json(tpol_t *tpol, const frame_t *fr)
+void frame_json(json_writer_t *jw, const tetrapol_evt_t *evt)
 {
-    printf("{ \"event\": \"frame\", ");
-    printf("\"rx_offs\": %" PRIu64 ", ", tpol->rx_offs);
+    const frame_t *fr = evt->frame.fr;
 
-    struct timeval tv;
-    struct tm gmt;
-    gettimeofday(&tv, NULL);
-    gmtime_r(&tv.tv_sec, &gmt);
+    json_writer_str(jw, "{ \"event\": \"frame\", \"rx_offs\": ");
+    json_writer_uint(jw, evt->rx_offs);
+    json_writer_str(jw, ", \"rx_time\": \"");
+    json_writer_time(jw, evt->rx_time);
+    json_writer_str(jw, "\", ");
 
-    printf("\"rx_time\": \"%4d-%02d-%02dT%02d-%02d-%02d.%06ld\", ",
-            gmt.tm_year + 1900, gmt.tm_mon + 1, gmt.tm_mday,
-            gmt.tm_hour, gmt.tm_min, gmt.tm_sec, tv.tv_usec);
-
-
-    printf("\"frame\": { ");
+    json_writer_str(jw, "\"frame\": { ");
     {
-        if (tpol->frame_no != FRAME_NO_UNKNOWN) {
-            printf("\"frame_no\": %d, ", tpol->frame_no);
+        if (evt->frame_no != FRAME_NO_UNKNOWN) {
+            json_writer_str(jw, "\"frame_no\": ");
+            json_writer_int(jw, evt->frame_no);
+            json_writer_str(jw, ", ");
         } else {
-            printf("\"frame_no\": null, ");
+            json_writer_str(jw, "\"frame_no\": null, ");
         }
 
         if (!fr->broken) {
-            printf("\"state\": \"ok\", ");
-            printf("\"syndromes\": %d, ", fr->syndromes);
-            printf("\"bits_fixed\": %d, ", fr->bits_fixed);
+            json_writer_str(jw, "\"state\": \"ok\", \"syndromes\": ");
+            json_writer_int(jw, fr->syndromes);
+            json_writer_str(jw, ", \"bits_fixed\": ");
+            json_writer_int(jw, fr->bits_fixed);
+            json_writer_str(jw, ", ");
 
-            const char *fr_type;
             switch (fr->fr_type) {
                 case FRAME_TYPE_VOICE:
-                    fr_type = "VOICE";
+                    json_writer_str(jw, "\"type\": \"VOICE\", ");
                     break;
 
                 case FRAME_TYPE_DATA:
-                    fr_type = "DATA";
+                    json_writer_str(jw, "\"type\": \"DATA\", ");
                     break;
 
                 default:
-                    fr_type = "FIXME";
+                    json_writer_str(jw, "\"type\": \"FIXME\", ");
             }
-            printf("\"type\": \"%s\", ", fr_type);
 
             if (fr->fr_type == FRAME_TYPE_DATA) {
-                printf("\"asb\": [%d, %d], ", fr->data.asb[0], fr->data.asb[1]);
-                printf("\"fn\": [%d, %d], ", fr->data.data[0], fr->data.data[1]);
+                json_writer_str(jw, "\"asb\": [");
+                json_writer_int(jw, fr->data.asb[0]);
+                json_writer_str(jw, ", ");
+                json_writer_int(jw, fr->data.asb[1]);
+                json_writer_str(jw, "], \"fn\": [");
+                json_writer_int(jw, fr->data.data[0]);
+                json_writer_str(jw, ", ");
+                json_writer_int(jw, fr->data.data[1]);
+                json_writer_str(jw, "], ");
 
                 uint8_t data[8];
                 memset(data, 0, sizeof(data));
                 for (int i = 0; i < 8*8; ++i) {
                     data[i / 8] |= fr->data.data[i + 2] << (i % 8);
                 }
-                char buf[3*sizeof(data)];
-                printf("\"data\": { \"encoding\": \"hex\", \"value\": \"%s\" } ",
-                        sprint_hex2(buf, data, sizeof(data)));
+                json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+                json_writer_hex(jw, data, sizeof(data));
+                json_writer_str(jw, "\" } ");
 
             } else if (fr->fr_type == FRAME_TYPE_VOICE) {
-                printf("\"asb\": [%d, %d], ", fr->voice.asb[0], fr->voice.asb[1]);
+                json_writer_str(jw, "\"asb\": [");
+                json_writer_int(jw, fr->voice.asb[0]);
+                json_writer_str(jw, ", ");
+                json_writer_int(jw, fr->voice.asb[1]);
+                json_writer_str(jw, "], ");
+
                 uint8_t voice[120/8];
                 memset(voice, 0, sizeof(voice));
-
                 for (int i = 0; i < 20; ++i) {
                     voice[i / 8] |= fr->voice.voice1[i] << (i % 8);
                 }
                 for (int i = 20; i < 120; ++i) {
                     voice[i / 8] |= fr->voice.voice2[i - 20] << (i % 8);
                 }
-
-                char buf[120/8*3];
-                printf("\"data\": { \"encoding\": \"hex\", \"value\": \"%s\" } ",
-                        sprint_hex2(buf, voice, 120/8));
+                json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+                json_writer_hex(jw, voice, sizeof(voice));
+                json_writer_str(jw, "\" } ");
 
             } else {
-                printf("\"FIXME\": \"FIXME\" ");
+                json_writer_str(jw, "\"FIXME\": \"FIXME\" ");
             }
         } else if (fr->broken == -1) {
-            printf("\"state\": \"bad_CRC\", ");
-            printf("\"syndromes\": %d, ", fr->syndromes);
-            printf("\"bits_fixed\": %d ", fr->bits_fixed);
+            json_writer_str(jw, "\"state\": \"bad_CRC\", \"syndromes\": ");
+            json_writer_int(jw, fr->syndromes);
+            json_writer_str(jw, ", \"bits_fixed\": ");
+            json_writer_int(jw, fr->bits_fixed);
+            json_writer_str(jw, " ");
         } else if (fr->broken > 0) {
-            printf("\"state\": %d, ", fr->broken);
+            json_writer_str(jw, "\"state\": ");
+            json_writer_int(jw, fr->broken);
+            json_writer_str(jw, ", ");
         } else {
-            printf("\"state\": \"FIXME\", ");
+            json_writer_str(jw, "\"state\": \"FIXME\", ");
         }
     }
-    printf("}");
+    json_writer_str(jw, "}}\n");
+}
 
-    printf("}\n");
+void scr_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    json_writer_str(jw, "{ \"event\": \"scr\", \"scr\": ");
+    json_writer_int(jw, evt->scr.scr);
+    json_writer_str(jw, " }\n");
 }
@@ -0,0 +1,204 @@
+#define LOG_PREFIX "json_writer"
+
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/misc.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+json_writer_t *json_writer_create(int fd)
+{
+    json_writer_t *jw = malloc(sizeof(json_writer_t));
+    if (!jw) {
+        return NULL;
+    }
+
+    jw->fd = fd;
+    jw->err = false;
+    jw->len = 0;
+    jw->time_sec = -1;
+    jw->time_prefix_len = 0;
+
+    return jw;
+}
+
+void json_writer_destroy(json_writer_t *jw)
+{
+    if (jw) {
+        json_writer_flush(jw);
+    }
+    free(jw);
+}
+
+int json_writer_flush(json_writer_t *jw)
+{
+    int offs = 0;
+    while (!jw->err && offs < jw->len) {
+        const ssize_t n = write(jw->fd, &jw->buf[offs], jw->len - offs);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG(ERR, "write failed, errno=%d", errno);
+            jw->err = true;
+            break;
+        }
+        offs += n;
+    }
+    jw->len = 0;
+
+    return jw->err ? -1 : 0;
+}
+
+/// Make space for n bytes in buffer, n must be <= JSON_WRITER_BUF_SIZE.
+static inline char *reserve(json_writer_t *jw, int n)
+{
+    if (jw->len + n > JSON_WRITER_BUF_SIZE) {
+        json_writer_flush(jw);
+    }
+
+    return &jw->buf[jw->len];
+}
+
+void json_writer_mem(json_writer_t *jw, const char *s, int n)
+{
+    while (n > 0) {
+        const int l = (n > JSON_WRITER_BUF_SIZE) ? JSON_WRITER_BUF_SIZE : n;
+        memcpy(reserve(jw, l), s, l);
+        jw->len += l;
+        s += l;
+        n -= l;
+    }
+}
+
+void json_writer_hex(json_writer_t *jw, const uint8_t *data, int n)
+{
+    while (n > 0) {
+        const int l = (2*n > JSON_WRITER_BUF_SIZE) ?
+            JSON_WRITER_BUF_SIZE / 2 : n;
+        hex_encode(reserve(jw, 2*l), data, l);
+        jw->len += 2*l;
+        data += l;
+        n -= l;
+    }
+}
+
+// "00" "01" ... "99"
+static const char DEC_DIGITS[200] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+/// format val into end of buffer, return pointer to the first digit
+static char *fmt_uint(char *end, uint64_t val)
+{
+    char *p = end;
+    while (val >= 100) {
+        const int i = 2 * (val % 100);
+        val /= 100;
+        *--p = DEC_DIGITS[i + 1];
+        *--p = DEC_DIGITS[i];
+    }
+    if (val >= 10) {
+        *--p = DEC_DIGITS[2 * val + 1];
+        *--p = DEC_DIGITS[2 * val];
+    } else {
+        *--p = '0' + val;
+    }
+
+    return p;
+}
+
+void json_writer_uint(json_writer_t *jw, uint64_t val)
+{
+    char buf[20];
+    char *end = buf + sizeof(buf);
+    const char *p = fmt_uint(end, val);
+    json_writer_mem(jw, p, end - p);
+}
+
+void json_writer_int(json_writer_t *jw, int64_t val)
+{
+    char buf[21];
+    char *end = buf + sizeof(buf);
+    char *p;
+    if (val < 0) {
+        p = fmt_uint(end, -(uint64_t)val);
+        *--p = '-';
+    } else {
+        p = fmt_uint(end, val);
+    }
+    json_writer_mem(jw, p, end - p);
+}
+
+/// format val as n digits with leading zeros
+static char *fmt_uint_pad(char *p, unsigned val, int n)
+{
+    for (int i = n - 1; i >= 0; --i) {
+        p[i] = '0' + val % 10;
+        val /= 10;
+    }
+
+    return p + n;
+}
+
+static void update_time_prefix(json_writer_t *jw, time_t sec)
+{
+    struct tm gmt;
+    gmtime_r(&sec, &gmt);
+
+    char *p = jw->time_prefix;
+    const int year = gmt.tm_year + 1900;
+    if (year >= 0 && year <= 9999) {
+        // %4d pads by spaces
+        char digits[4];
+        char *end = digits + sizeof(digits);
+        const char *d = fmt_uint(end, year);
+        for (int i = end - d; i < 4; ++i) {
+            *p++ = ' ';
+        }
+        memcpy(p, d, end - d);
+        p += end - d;
+    } else {
+        char digits[21];
+        char *end = digits + sizeof(digits);
+        char *d;
+        if (year < 0) {
+            d = fmt_uint(end, -(int64_t)year);
+            *--d = '-';
+        } else {
+            d = fmt_uint(end, year);
+        }
+        memcpy(p, d, end - d);
+        p += end - d;
+    }
+    *p++ = '-';
+    p = fmt_uint_pad(p, gmt.tm_mon + 1, 2);
+    *p++ = '-';
+    p = fmt_uint_pad(p, gmt.tm_mday, 2);
+    *p++ = 'T';
+    p = fmt_uint_pad(p, gmt.tm_hour, 2);
+    *p++ = '-';
+    p = fmt_uint_pad(p, gmt.tm_min, 2);
+    *p++ = '-';
+    p = fmt_uint_pad(p, gmt.tm_sec, 2);
+    *p++ = '.';
+
+    jw->time_sec = sec;
+    jw->time_prefix_len = p - jw->time_prefix;
+}
+
+void json_writer_time(json_writer_t *jw, uint64_t t)
+{
+    const time_t sec = t / 1000000;
+    if (sec != jw->time_sec) {
+        update_time_prefix(jw, sec);
+    }
+
+    char *p = reserve(jw, jw->time_prefix_len + 6);
+    memcpy(p, jw->time_prefix, jw->time_prefix_len);
+    fmt_uint_pad(p + jw->time_prefix_len, t % 1000000, 6);
+    jw->len += jw->time_prefix_len + 6;
+}
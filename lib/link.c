@@ -2,10 +2,9 @@
 
 #include <tetrapol/link.h>
 #include <tetrapol/log.h>
-#include <tetrapol/lsdu_cd.h>
 #include <tetrapol/misc.h>
+#include <tetrapol/pool.h>
 #include <tetrapol/tpdu.h>
-#include <tetrapol/lsdu_vch.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -13,30 +12,47 @@
 struct link_priv_t {
     tpdu_t *tpdu;
     tpdu_ui_t *tpdu_ui;
+    tpol_t *tpol;
+    int log_ch;
     uint8_t v_r;    ///< v(r) PAS 0001-3-3 7.5.4.2.2
     uint8_t v_s;    ///< v(s) PAS 0001-3-3 7.5.4.2.2
     bool rx_glitch;
 };
 
+bool link_pools_create(tpol_t *tpol)
+{
+    tpol->link_pool = pool_create("link", sizeof(link_t));
+
+    return tpol->link_pool != NULL;
+}
+
+void link_pools_destroy(tpol_t *tpol)
+{
+    pool_destroy(tpol->link_pool);
+    tpol->link_pool = NULL;
+}
+
 link_t *link_create(tpol_t *tpol, int log_ch)
 {
-    link_t *link = malloc(sizeof(link_t));
+    link_t *link = pool_alloc(tpol->link_pool);
     if (!link) {
         return NULL;
     }
 
     link->tpdu_ui = tpdu_ui_create(tpol, FRAME_TYPE_DATA, log_ch);
     if (!link->tpdu_ui) {
-        free(link);
+        pool_free(tpol->link_pool, link);
         return NULL;
     }
 
     link->tpdu = tpdu_create(tpol, LOG_CH_SDCH);
     if (!link->tpdu) {
         tpdu_ui_destroy(link->tpdu_ui);
-        free(link);
+        pool_free(tpol->link_pool, link);
         return NULL;
     }
+    link->tpol = tpol;
+    link->log_ch = log_ch;
 
     link->v_r = 0;
     link->v_s = 0;
@@ -53,7 +69,7 @@ void link_destroy(link_t *link)
 
     tpdu_ui_destroy(link->tpdu_ui);
     tpdu_destroy(link->tpdu);
-    free(link);
+    pool_free(link->tpol->link_pool, link);
 }
 
 int link_push_hdlc_frame(link_t *link, const hdlc_frame_t *hdlc_fr)
@@ -183,12 +199,7 @@ int link_push_hdlc_frame(link_t *link, const hdlc_frame_t *hdlc_fr)
                     sprint_hex(buf, hdlc_fr->data, hdlc_fr->nbits / 8));
         }
 
-        lsdu_vch_t *lsdu;
-        if (!lsdu_vch_decode_hdlc_frame(hdlc_fr, &lsdu)) {
-            // LSDU should be send upwards like TSDU
-            lsdu_vch_print(lsdu);
-            lsdu_vch_destroy(lsdu);
-        }
+        tetrapol_evt_lsdu(link->tpol, link->log_ch, hdlc_fr);
 
         return 0;
     }
@@ -202,12 +213,8 @@ int link_push_hdlc_frame(link_t *link, const hdlc_frame_t *hdlc_fr)
                     sprint_hex(buf, hdlc_fr->data, hdlc_fr->nbits / 8));
         }
 
-        lsdu_cd_t *lsdu;
-        if (!lsdu_cd_decode(hdlc_fr->data, hdlc_fr->nbits / 8, &lsdu)) {
-            // LSDU should be send upwards like TSDU
-            lsdu_cd_print(lsdu);
-            lsdu_cd_destroy(lsdu);
-        }
+        tetrapol_evt_lsdu(link->tpol, link->log_ch, hdlc_fr);
+
         return 0;
     }
 
@@ -221,8 +228,20 @@ void link_rx_glitch(link_t *link)
     link->rx_glitch = true;
 }
 
-void link_tick(time_evt_t* te, link_t *link)
+void link_save(const link_t *link, snapshot_t *snap)
 {
-    link->rx_glitch |= te->rx_glitch;
-    tpdu_du_tick(te, link->tpdu_ui);
+    snapshot_put_u8(snap, link->v_r);
+    snapshot_put_u8(snap, link->v_s);
+    snapshot_put_u8(snap, link->rx_glitch);
+    tpdu_save(link->tpdu, snap);
+    tpdu_ui_save(link->tpdu_ui, snap);
+}
+
+bool link_load(link_t *link, snapshot_t *snap)
+{
+    link->v_r = snapshot_get_u8(snap) % 8;
+    link->v_s = snapshot_get_u8(snap) % 8;
+    link->rx_glitch = snapshot_get_u8(snap);
+
+    return tpdu_load(link->tpdu, snap) && tpdu_ui_load(link->tpdu_ui, snap);
 }
@@ -1,3 +1,28 @@
 #include <tetrapol/log.h>
 
 int log_global_lvl = INFO;
+
+static log_backend_t log_backend = NULL;
+
+void log_set_backend(log_backend_t backend)
+{
+    log_backend = backend;
+}
+
+void log_printf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    if (log_backend) {
+        va_list ap2;
+        va_copy(ap2, ap);
+        const int ret = log_backend(fmt, ap2);
+        va_end(ap2);
+        if (!ret) {
+            va_end(ap);
+            return;
+        }
+    }
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+}
@@ -0,0 +1,578 @@
+#define _DEFAULT_SOURCE 1
+#define LOG_PREFIX "log_async"
+
+#include <tetrapol/log.h>
+#include <tetrapol/log_async.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    LMOD_NONE,
+    LMOD_HH,
+    LMOD_H,
+    LMOD_L,
+    LMOD_LL,
+    LMOD_J,
+    LMOD_Z,
+    LMOD_T,
+    LMOD_LD,    ///< long double
+};
+
+enum {
+    OUT_BUF_SIZE = 64 * 1024,
+    IDLE_SLEEP_NS = 1000 * 1000,
+};
+
+/// conversion specification, part of format starting by '%'
+typedef struct {
+    int len;            ///< length of specification including '%'
+    char conv;
+    int lmod;
+    int nstars;         ///< width and precision given as arguments
+    int prec;           ///< -1 when not given, -2 when given as argument
+} spec_t;
+
+typedef struct {
+    const char *fmt;
+    int len;            ///< used part of data
+    uint8_t data[LOG_ASYNC_REC_SIZE];
+} rec_t;
+
+/// single producer (owning thread), single consumer (background thread)
+typedef struct {
+    atomic_uint head;
+    atomic_uint tail;
+    rec_t recs[LOG_ASYNC_RING_LEN];
+} ring_t;
+
+static _Atomic(ring_t *) rings[LOG_ASYNC_THREADS_MAX];
+static atomic_int nrings;
+/// incremented by log_async_stop() to invalidate thread_ring of all threads
+static atomic_uint generation;
+static _Thread_local ring_t *thread_ring;
+static _Thread_local unsigned thread_generation;
+static _Thread_local bool thread_sync;   ///< no ring for this thread
+
+static atomic_bool running;
+static atomic_uint_fast64_t dropped;
+static pthread_t thread;
+
+/**
+  Parse conversion specification.
+
+  @param p Points to '%'.
+
+  @return 0 on success, -1 for unsupported conversion
+  */
+static int parse_spec(const char *p, spec_t *spec)
+{
+    const char *s = p + 1;
+    spec->nstars = 0;
+    spec->prec = -1;
+    spec->lmod = LMOD_NONE;
+
+    while (*s && strchr("-+ #0'", *s)) {
+        ++s;
+    }
+    if (*s == '*') {
+        ++spec->nstars;
+        ++s;
+    }
+    while (*s >= '0' && *s <= '9') {
+        ++s;
+    }
+    if (*s == '.') {
+        ++s;
+        if (*s == '*') {
+            ++spec->nstars;
+            spec->prec = -2;
+            ++s;
+        } else {
+            spec->prec = 0;
+            while (*s >= '0' && *s <= '9') {
+                spec->prec = 10 * spec->prec + *s++ - '0';
+            }
+        }
+    }
+
+    switch (*s) {
+        case 'h':
+            spec->lmod = (s[1] == 'h') ? LMOD_HH : LMOD_H;
+            s += (s[1] == 'h') ? 2 : 1;
+            break;
+
+        case 'l':
+            spec->lmod = (s[1] == 'l') ? LMOD_LL : LMOD_L;
+            s += (s[1] == 'l') ? 2 : 1;
+            break;
+
+        case 'j':
+            spec->lmod = LMOD_J;
+            ++s;
+            break;
+
+        case 'z':
+            spec->lmod = LMOD_Z;
+            ++s;
+            break;
+
+        case 't':
+            spec->lmod = LMOD_T;
+            ++s;
+            break;
+
+        case 'L':
+            spec->lmod = LMOD_LD;
+            ++s;
+            break;
+    }
+
+    if (!*s || !strchr("diouxXceEfFgGaAsp%", *s) ||
+            ((*s == 'c' || *s == 's') && spec->lmod != LMOD_NONE)) {
+        return -1;
+    }
+    spec->conv = *s;
+    spec->len = s + 1 - p;
+
+    return 0;
+}
+
+static bool put(rec_t *rec, const void *val, int len)
+{
+    if (rec->len + len > LOG_ASYNC_REC_SIZE) {
+        return false;
+    }
+    memcpy(&rec->data[rec->len], val, len);
+    rec->len += len;
+
+    return true;
+}
+
+static int get(const rec_t *rec, int *offs, void *val, int len)
+{
+    if (*offs + len > rec->len) {
+        return -1;
+    }
+    memcpy(val, &rec->data[*offs], len);
+    *offs += len;
+
+    return 0;
+}
+
+/// Copy arguments into record, return -1 for unsupported format.
+static int rec_encode(rec_t *rec, const char *fmt, va_list ap)
+{
+    rec->fmt = fmt;
+    rec->len = 0;
+
+    // when record is full the rest of arguments is lost, but all arguments
+    // must be consumed to avoid undefined behaviour
+    bool ok = true;
+    for (const char *p = strchr(fmt, '%'); p; p = strchr(p, '%')) {
+        spec_t spec;
+        if (parse_spec(p, &spec)) {
+            return -1;
+        }
+        p += spec.len;
+        int prec = spec.prec;
+        for (int i = 0; i < spec.nstars; ++i) {
+            const int v = va_arg(ap, int);
+            ok = ok && put(rec, &v, sizeof(v));
+            // the last star is precision when precision is given by argument
+            if (i == spec.nstars - 1 && spec.prec == -2) {
+                prec = v;
+            }
+        }
+
+        switch (spec.conv) {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+                {
+                    uint64_t v;
+                    switch (spec.lmod) {
+                        case LMOD_L:
+                            v = va_arg(ap, unsigned long);
+                            break;
+                        case LMOD_LL:
+                            v = va_arg(ap, unsigned long long);
+                            break;
+                        case LMOD_J:
+                            v = va_arg(ap, uintmax_t);
+                            break;
+                        case LMOD_Z:
+                            v = va_arg(ap, size_t);
+                            break;
+                        case LMOD_T:
+                            v = va_arg(ap, ptrdiff_t);
+                            break;
+                        default:
+                            v = va_arg(ap, unsigned);
+                    }
+                    ok = ok && put(rec, &v, sizeof(v));
+                }
+                break;
+
+            case 'p':
+                {
+                    void *v = va_arg(ap, void *);
+                    ok = ok && put(rec, &v, sizeof(v));
+                }
+                break;
+
+            case 's':
+                {
+                    const char *s = va_arg(ap, const char *);
+                    if (!s) {
+                        s = "(null)";
+                    }
+                    // string might not be terminated when precision is given
+                    const int max = LOG_ASYNC_REC_SIZE - rec->len - 1;
+                    const int l = strnlen(s,
+                            (prec >= 0 && prec < max) ? prec : (max > 0 ? max : 0));
+                    const char nul = 0;
+                    ok = ok && put(rec, s, l) && put(rec, &nul, 1);
+                }
+                break;
+
+            case '%':
+                break;
+
+            default:
+                if (spec.lmod == LMOD_LD) {
+                    long double v = va_arg(ap, long double);
+                    ok = ok && put(rec, &v, sizeof(v));
+                } else {
+                    double v = va_arg(ap, double);
+                    ok = ok && put(rec, &v, sizeof(v));
+                }
+        }
+    }
+
+    return 0;
+}
+
+typedef struct {
+    int len;
+    char buf[OUT_BUF_SIZE];
+} out_t;
+
+static void out_flush(out_t *out)
+{
+    int offs = 0;
+    while (offs < out->len) {
+        const ssize_t n = write(STDERR_FILENO, &out->buf[offs],
+                out->len - offs);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offs += n;
+    }
+    out->len = 0;
+}
+
+static void out_mem(out_t *out, const char *s, int len)
+{
+    while (len > 0) {
+        if (out->len == OUT_BUF_SIZE) {
+            out_flush(out);
+        }
+        const int l = (len < OUT_BUF_SIZE - out->len) ?
+            len : OUT_BUF_SIZE - out->len;
+        memcpy(&out->buf[out->len], s, l);
+        out->len += l;
+        s += l;
+        len -= l;
+    }
+}
+
+/// format single conversion, fmt is specification without stars
+static void out_conv(out_t *out, const char *fmt, const spec_t *spec,
+        const rec_t *rec, int *offs)
+{
+    char buf[512];
+    int n = -1;
+    switch (spec->conv) {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'c':
+            {
+                uint64_t v;
+                if (get(rec, offs, &v, sizeof(v))) {
+                    return;
+                }
+                const bool is_signed = spec->conv == 'd' || spec->conv == 'i';
+                switch (spec->lmod) {
+                    case LMOD_L:
+                        n = is_signed ? snprintf(buf, sizeof(buf), fmt, (long)v) :
+                            snprintf(buf, sizeof(buf), fmt, (unsigned long)v);
+                        break;
+                    case LMOD_LL:
+                        n = is_signed ? snprintf(buf, sizeof(buf), fmt, (long long)v) :
+                            snprintf(buf, sizeof(buf), fmt, (unsigned long long)v);
+                        break;
+                    case LMOD_J:
+                        n = is_signed ? snprintf(buf, sizeof(buf), fmt, (intmax_t)v) :
+                            snprintf(buf, sizeof(buf), fmt, (uintmax_t)v);
+                        break;
+                    case LMOD_Z:
+                        n = snprintf(buf, sizeof(buf), fmt, (size_t)v);
+                        break;
+                    case LMOD_T:
+                        n = snprintf(buf, sizeof(buf), fmt, (ptrdiff_t)v);
+                        break;
+                    default:
+                        n = is_signed ? snprintf(buf, sizeof(buf), fmt, (int)v) :
+                            snprintf(buf, sizeof(buf), fmt, (unsigned)v);
+                }
+            }
+            break;
+
+        case 'p':
+            {
+                void *v;
+                if (get(rec, offs, &v, sizeof(v))) {
+                    return;
+                }
+                n = snprintf(buf, sizeof(buf), fmt, v);
+            }
+            break;
+
+        case 's':
+            {
+                const char *s = (const char *)&rec->data[*offs];
+                const int l = strnlen(s, rec->len - *offs);
+                if (l == rec->len - *offs) {
+                    *offs = rec->len;
+                    return;
+                }
+                *offs += l + 1;
+                n = snprintf(buf, sizeof(buf), fmt, s);
+            }
+            break;
+
+        default:
+            if (spec->lmod == LMOD_LD) {
+                long double v;
+                if (get(rec, offs, &v, sizeof(v))) {
+                    return;
+                }
+                n = snprintf(buf, sizeof(buf), fmt, v);
+            } else {
+                double v;
+                if (get(rec, offs, &v, sizeof(v))) {
+                    return;
+                }
+                n = snprintf(buf, sizeof(buf), fmt, v);
+            }
+    }
+
+    if (n > 0) {
+        out_mem(out, buf, (n < sizeof(buf)) ? n : sizeof(buf) - 1);
+    }
+}
+
+static void out_rec(out_t *out, const rec_t *rec)
+{
+    int offs = 0;
+    const char *fmt = rec->fmt;
+    const char *p;
+    while ((p = strchr(fmt, '%'))) {
+        out_mem(out, fmt, p - fmt);
+        spec_t spec;
+        parse_spec(p, &spec);
+        fmt = p + spec.len;
+        if (spec.conv == '%') {
+            out_mem(out, "%", 1);
+            continue;
+        }
+
+        // replace stars by values of arguments
+        char spec_fmt[64];
+        int len = 0;
+        for (int i = 0; i < spec.len && len < sizeof(spec_fmt) - 12; ++i) {
+            if (p[i] != '*') {
+                spec_fmt[len++] = p[i];
+                continue;
+            }
+            int v = 0;
+            get(rec, &offs, &v, sizeof(v));
+            len += snprintf(&spec_fmt[len], sizeof(spec_fmt) - len, "%d", v);
+        }
+        spec_fmt[len] = 0;
+        out_conv(out, spec_fmt, &spec, rec, &offs);
+    }
+    out_mem(out, fmt, strlen(fmt));
+}
+
+/// Write pending records of all threads, return number of records.
+static int drain(out_t *out)
+{
+    static uint64_t dropped_reported = 0;
+
+    int n = 0;
+    const int nrings_ = atomic_load(&nrings);
+    for (int i = 0; i < nrings_ && i < LOG_ASYNC_THREADS_MAX; ++i) {
+        ring_t *ring = atomic_load(&rings[i]);
+        if (!ring) {
+            continue;
+        }
+        const unsigned head = atomic_load_explicit(&ring->head,
+                memory_order_acquire);
+        unsigned tail = atomic_load_explicit(&ring->tail,
+                memory_order_relaxed);
+        for (; tail != head; ++tail, ++n) {
+            out_rec(out, &ring->recs[tail % LOG_ASYNC_RING_LEN]);
+            atomic_store_explicit(&ring->tail, tail + 1,
+                    memory_order_release);
+        }
+    }
+
+    const uint64_t dropped_ = atomic_load_explicit(&dropped,
+            memory_order_relaxed);
+    if (dropped_ != dropped_reported) {
+        char buf[80];
+        const int l = snprintf(buf, sizeof(buf),
+                LOG_PREFIX ": %llu messages dropped\n",
+                (unsigned long long)(dropped_ - dropped_reported));
+        out_mem(out, buf, l);
+        dropped_reported = dropped_;
+    }
+    out_flush(out);
+
+    return n;
+}
+
+static void *log_thread(void *arg)
+{
+    out_t *out = arg;
+    while (atomic_load(&running)) {
+        if (!drain(out)) {
+            const struct timespec ts = { 0, IDLE_SLEEP_NS, };
+            nanosleep(&ts, NULL);
+        }
+    }
+    drain(out);
+
+    return NULL;
+}
+
+static ring_t *get_ring(void)
+{
+    const unsigned gen = atomic_load_explicit(&generation,
+            memory_order_relaxed);
+    if (thread_generation != gen) {
+        thread_generation = gen;
+        thread_ring = NULL;
+        thread_sync = false;
+    }
+    if (thread_ring || thread_sync) {
+        return thread_ring;
+    }
+
+    const int idx = atomic_fetch_add(&nrings, 1);
+    if (idx < LOG_ASYNC_THREADS_MAX) {
+        thread_ring = calloc(1, sizeof(ring_t));
+    }
+    if (!thread_ring) {
+        thread_sync = true;
+        return NULL;
+    }
+    atomic_store(&rings[idx], thread_ring);
+
+    return thread_ring;
+}
+
+static int log_async_write(const char *fmt, va_list ap)
+{
+    ring_t *ring = get_ring();
+    if (!ring) {
+        return -1;
+    }
+
+    const unsigned head = atomic_load_explicit(&ring->head,
+            memory_order_relaxed);
+    const unsigned tail = atomic_load_explicit(&ring->tail,
+            memory_order_acquire);
+    if (head - tail >= LOG_ASYNC_RING_LEN) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    if (rec_encode(&ring->recs[head % LOG_ASYNC_RING_LEN], fmt, ap)) {
+        return -1;
+    }
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return 0;
+}
+
+static out_t *out_buf = NULL;
+
+int log_async_start(void)
+{
+    if (atomic_load(&running)) {
+        return 0;
+    }
+
+    out_buf = malloc(sizeof(out_t));
+    if (!out_buf) {
+        return -1;
+    }
+    out_buf->len = 0;
+
+    atomic_store(&running, true);
+    if (pthread_create(&thread, NULL, log_thread, out_buf)) {
+        atomic_store(&running, false);
+        free(out_buf);
+        out_buf = NULL;
+        return -1;
+    }
+    log_set_backend(log_async_write);
+
+    return 0;
+}
+
+void log_async_stop(void)
+{
+    if (!atomic_load(&running)) {
+        return;
+    }
+
+    log_set_backend(NULL);
+    atomic_store(&running, false);
+    pthread_join(thread, NULL);
+    free(out_buf);
+    out_buf = NULL;
+
+    const int nrings_ = atomic_load(&nrings);
+    for (int i = 0; i < nrings_ && i < LOG_ASYNC_THREADS_MAX; ++i) {
+        free(atomic_exchange(&rings[i], NULL));
+    }
+    atomic_store(&nrings, 0);
+    atomic_fetch_add(&generation, 1);
+}
+
+uint64_t log_async_dropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
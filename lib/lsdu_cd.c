@@ -72,35 +72,49 @@ static int tp_address_decode(const uint8_t *data, int len, lsdu_cd_tp_address_t
     return 0;
 }
 
-int lsdu_cd_decode(const uint8_t *data, int len, lsdu_cd_t **lsdu)
+int lsdu_cd_parse(const uint8_t *data, int len, lsdu_cd_t *lsdu)
 {
-    if (!lsdu) {
-        LOG(ERR, "lsdu == NULL");
-        return -1;
-    }
-
-    *lsdu = malloc(sizeof(lsdu_cd_t));
-    if (!*lsdu) {
+    if (len < 1) {
+        LOG(WTF, "LSDU too short");
         return -1;
     }
 
-    (*lsdu)->unknown.codop = data[0];
+    lsdu->unknown.codop = data[0];
 
-    switch ((*lsdu)->unknown.codop) {
+    switch (lsdu->unknown.codop) {
         case TP_ADDRESS:
-            return tp_address_decode(data, len, (lsdu_cd_tp_address_t *)*lsdu);
+            return tp_address_decode(data, len, &lsdu->tp_address);
 
         default:
-            LOG(INFO, "TODO LSDU_CD 0x%02x", (*lsdu)->unknown.codop);
+            LOG(INFO, "TODO LSDU_CD 0x%02x", lsdu->unknown.codop);
             break;
     }
 
-    memcpy(*lsdu, data, len);
-    (*lsdu)->unknown.len = len;
+    if (len > (int)SIZEOF(lsdu_cd_unknown_t, data) + 1) {
+        LOG(WTF, "LSDU too long %d", len);
+        len = (int)SIZEOF(lsdu_cd_unknown_t, data) + 1;
+    }
+    memcpy(lsdu, data, len);
+    lsdu->unknown.len = len;
 
     return 0;
 }
 
+int lsdu_cd_decode(const uint8_t *data, int len, lsdu_cd_t **lsdu)
+{
+    if (!lsdu) {
+        LOG(ERR, "lsdu == NULL");
+        return -1;
+    }
+
+    *lsdu = malloc(sizeof(lsdu_cd_t));
+    if (!*lsdu) {
+        return -1;
+    }
+
+    return lsdu_cd_parse(data, len, *lsdu);
+}
+
 static void tp_address_print(const lsdu_cd_tp_address_t *lsdu)
 {
     LOGF("\tMODIFIER_NUMBER=%d\n", lsdu->modifier_number);
@@ -68,7 +68,12 @@ int lsdu_vch_decode_hdlc_frame(const hdlc_frame_t *hdlc_fr, lsdu_vch_t **lsdu)
         return -1;
     }
 
-    memcpy(*lsdu, hdlc_fr->data, 3);
+    return lsdu_vch_parse_hdlc_frame(hdlc_fr, *lsdu);
+}
+
+int lsdu_vch_parse_hdlc_frame(const hdlc_frame_t *hdlc_fr, lsdu_vch_t *lsdu)
+{
+    memcpy(lsdu, hdlc_fr->data, 3);
 
     return 0;
 }
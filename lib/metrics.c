@@ -0,0 +1,121 @@
+#define LOG_PREFIX "metrics"
+
+#include <tetrapol/log.h>
+#include <tetrapol/metrics.h>
+#include <tetrapol/misc.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// indexed by FRAME_TYPE_*
+static const char *fr_type_names[TETRAPOL_FR_TYPES] = {
+    "voice",
+    "data",
+    "hr_data",
+    "random_access",
+    "training",
+    "dm_emergency",
+    "sch_ti",
+};
+
+static void write_counter(FILE *f, const char *name, const char *help,
+        uint64_t val)
+{
+    fprintf(f, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+            name, help, name, name, (unsigned long long)val);
+}
+
+static void write_hist(FILE *f, const char *name, const char *help,
+        const tetrapol_hist_t *hist)
+{
+    fprintf(f, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    uint64_t cnt = 0;
+    for (int i = 0; i < TETRAPOL_HIST_BUCKETS - 1; ++i) {
+        cnt += hist->buckets[i];
+        fprintf(f, "%s_bucket{le=\"%llu\"} %llu\n", name,
+                1ull << i, (unsigned long long)cnt);
+    }
+    cnt += hist->buckets[TETRAPOL_HIST_BUCKETS - 1];
+    fprintf(f, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cnt);
+    fprintf(f, "%s_sum %llu\n%s_count %llu\n",
+            name, (unsigned long long)hist->sum,
+            name, (unsigned long long)hist->count);
+}
+
+int metrics_write_prom(const char *path, const tetrapol_metrics_t *metrics)
+{
+    char tmp_path[4096];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >=
+            sizeof(tmp_path)) {
+        return -1;
+    }
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f) {
+        LOG(ERR, "Failed to open '%s', errno=%d", tmp_path, errno);
+        return -1;
+    }
+
+    write_counter(f, "tetrapol_bits_total", "Bits passed to decoder.",
+            metrics->bits);
+    write_counter(f, "tetrapol_sync_gained_total",
+            "Frame synchronization acquisitions.", metrics->sync_gained);
+    write_counter(f, "tetrapol_sync_lost_total",
+            "Frame synchronization losses.", metrics->sync_lost);
+
+    fprintf(f, "# HELP tetrapol_frames_total Decoded frames.\n"
+            "# TYPE tetrapol_frames_total counter\n");
+    for (int i = 0; i < TETRAPOL_FR_TYPES; ++i) {
+        fprintf(f, "tetrapol_frames_total{type=\"%s\",state=\"ok\"} %llu\n",
+                fr_type_names[i], (unsigned long long)metrics->frames[i]);
+        fprintf(f, "tetrapol_frames_total{type=\"%s\",state=\"broken\"} %llu\n",
+                fr_type_names[i],
+                (unsigned long long)metrics->frames_broken[i]);
+    }
+
+    write_counter(f, "tetrapol_frame_syndromes_total",
+            "Error syndromes in received frames.", metrics->syndromes);
+    write_counter(f, "tetrapol_frame_bits_fixed_total",
+            "Bits fixed by frame decoder.", metrics->bits_fixed);
+    write_hist(f, "tetrapol_scr_detect_frames",
+            "Frames required to detect SCR.", &metrics->scr_detect);
+    write_counter(f, "tetrapol_data_frame_errors_total",
+            "Multiblock data frames lost by errors.",
+            metrics->data_frame_errs);
+    write_counter(f, "tetrapol_hdlc_fcs_errors_total",
+            "HDLC frames with invalid FCS.", metrics->hdlc_fcs_errs);
+    write_counter(f, "tetrapol_hdlc_stuffing_frames_total",
+            "HDLC stuffing frames.", metrics->hdlc_stuffing);
+    write_counter(f, "tetrapol_tpdu_timeouts_total",
+            "Segmented TPDUs lost by reassembly timeout.",
+            metrics->tpdu_timeouts);
+
+    fprintf(f, "# HELP tetrapol_tsdus_total Received TSDUs by codop.\n"
+            "# TYPE tetrapol_tsdus_total counter\n");
+    for (int i = 0; i < ARRAY_LEN(metrics->tsdus); ++i) {
+        if (metrics->tsdus[i]) {
+            fprintf(f, "tetrapol_tsdus_total{codop=\"0x%02x\"} %llu\n", i,
+                    (unsigned long long)metrics->tsdus[i]);
+        }
+    }
+
+    fprintf(f, "# HELP tetrapol_terminals_live Currently tracked terminals.\n"
+            "# TYPE tetrapol_terminals_live gauge\n"
+            "tetrapol_terminals_live %llu\n",
+            (unsigned long long)metrics->terminals_live);
+
+    if (ferror(f) | fclose(f)) {
+        LOG(ERR, "Failed to write '%s'", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path)) {
+        LOG(ERR, "Failed to rename '%s', errno=%d", tmp_path, errno);
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
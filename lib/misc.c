@@ -1,16 +1,22 @@
 #include <tetrapol/log.h>
 #include <tetrapol/misc.h>
-#include <stdio.h>
+
+static const char HEX_DIGITS[16] = "0123456789abcdef";
+
+void hex_encode(char *str, const uint8_t *bytes, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        str[2*i] = HEX_DIGITS[bytes[i] >> 4];
+        str[2*i + 1] = HEX_DIGITS[bytes[i] & 0xf];
+    }
+}
 
 char *sprint_hex(char *str, const uint8_t *bytes, int n)
 {
-    for(int i = 0; i < n; ) {
-        // TODO: replace sprintf with straight conversion
-        sprintf(&str[3*i], "%02x ", bytes[i]);
-        ++i;
-        if (i == n) {
-            break;
-        }
+    for (int i = 0; i < n; ++i) {
+        str[3*i] = HEX_DIGITS[bytes[i] >> 4];
+        str[3*i + 1] = HEX_DIGITS[bytes[i] & 0xf];
+        str[3*i + 2] = ' ';
     }
     if (n == 0) {
         str[0] = 0;
@@ -23,16 +29,8 @@ char *sprint_hex(char *str, const uint8_t *bytes, int n)
 
 char *sprint_hex2(char *str, const uint8_t *bytes, int n)
 {
-    for(int i = 0; i < n; ) {
-        // TODO: replace sprintf with straight conversion
-        sprintf(&str[2*i], "%02x", bytes[i]);
-        ++i;
-        if (i == n) {
-            break;
-        }
-    }
+    hex_encode(str, bytes, n);
     str[2*n] = 0;
 
     return str;
 }
-
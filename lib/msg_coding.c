@@ -91,21 +91,30 @@ void address_print(const address_t *address)
     }
 }
 
-int address_list_decode(address_list_t **ptr_addrs, const uint8_t *data)
+int address_list_decode(arena_t *arena, address_list_t **ptr_addrs,
+        const uint8_t *data)
 {
     // TODO: check len
     address_list_t *addrs = *ptr_addrs;
+    bool next;
     do {
         const int n = addrs ? (addrs->nadrs + 1) : 1;
         const int l = sizeof(address_list_t) + n * sizeof(address_t);
-        address_list_t *p = realloc(addrs, l);
+        address_list_t *p = arena_realloc(arena, addrs, l);
         if (!p) {
             *ptr_addrs = addrs;
             return -1;
         }
         addrs = p;
         addrs->nadrs = n;
-    } while (address_decode(&addrs->called_adr[addrs->nadrs-1], &data));
+
+        const uint8_t *addr_data = data;
+        next = address_decode(&addrs->called_adr[addrs->nadrs-1], &data);
+        // length of unsupported address is unknown, stop parsing here
+        if (data == addr_data) {
+            break;
+        }
+    } while (next);
 
     *ptr_addrs = addrs;
 
@@ -4,6 +4,7 @@
 #include <tetrapol/addr.h>
 #include <tetrapol/misc.h>
 #include <tetrapol/data_frame.h>
+#include <tetrapol/trace.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -53,7 +54,13 @@ void pch_reset(pch_t *pch)
 
 bool pch_push_frame(pch_t *pch, const frame_t *fr)
 {
-    if (data_frame_push_frame(pch->data_fr, fr) <= 0) {
+    TRACE_BEGIN(TRACE_DATA_FRAME);
+    const int r = data_frame_push_frame(pch->data_fr, fr);
+    TRACE_END(TRACE_DATA_FRAME);
+    if (r < 0) {
+        metric_inc(&pch->tpol->metrics.data_frame_errs);
+    }
+    if (r <= 0) {
         if (pch->tpol->frame_no % 2) {
             LOG(DBG, "PCH frame broken");
             // TODO: PCH block lost
@@ -85,6 +92,8 @@ bool pch_push_frame(pch_t *pch, const frame_t *fr)
         }
     }
 
+    tetrapol_evt_pch(pch->tpol, data, size / 8);
+
     return true;
 }
 
@@ -103,3 +112,13 @@ void pch_print(pch_t *pch)
 // list of pch_data.naddrs link is lost on downlink and all existing
 // connections should be closed.
 
+
+void pch_save(const pch_t *pch, snapshot_t *snap)
+{
+    data_frame_save(pch->data_fr, snap);
+}
+
+bool pch_load(pch_t *pch, snapshot_t *snap)
+{
+    return data_frame_load(pch->data_fr, snap);
+}
@@ -2,15 +2,17 @@
 
 #include <tetrapol/tetrapol_int.h>
 #include <tetrapol/log.h>
-#include <tetrapol/frame_json.h>
 #include <tetrapol/system_config.h>
 #include <tetrapol/tsdu.h>
 #include <tetrapol/misc.h>
 #include <tetrapol/phys_ch.h>
+#include <tetrapol/snapshot.h>
+#include <tetrapol/snapshot_int.h>
 #include <tetrapol/tp_timer.h>
 #include <tetrapol/frame.h>
 #include <tetrapol/cch.h>
 #include <tetrapol/tch.h>
+#include <tetrapol/trace.h>
 
 #include <limits.h>
 #include <stdlib.h>
@@ -34,18 +36,20 @@ struct phys_ch_priv_t {
     int scr_guess;      ///< SCR with best score when guessing SCR
     int scr_confidence; ///< required confidence for SCR detection
     int scr_stat[128];  ///< statistics for SCR detection
+    int scr_detect_frames;  ///< frames used for SCR detection so far
     uint8_t *data_begin;    ///< start of unprocessed part of data
     uint8_t *data_end;      ///< end of unprocessed part of data
     uint8_t data[10*FRAME_LEN];
+    uint64_t timer_offs;    ///< rx_offs skipped by seek, not seen by timer
     frame_decoder_t *fd;
     // CCH specific data, will be union with traffich CH specicic data
-    tp_timer_t *tp_timer;
     cch_t *cch;
     tch_t *tch;
     tpol_t *tpol;
 };
 
 static int process_frame(phys_ch_t *phys_ch, const uint8_t *fr_data);
+static int push_frame(phys_ch_t *phys_ch, const frame_t *fr, int scr);
 
 phys_ch_t *tetrapol_phys_ch_create(tetrapol_t *tetrapol)
 {
@@ -66,11 +70,9 @@ phys_ch_t *tetrapol_phys_ch_create(tetrapol_t *tetrapol)
     phys_ch->scr = PHYS_CH_SCR_DETECT;
     phys_ch->scr_last = PHYS_CH_SCR_DETECT;
     phys_ch->scr_confidence = 50;
-    phys_ch->tp_timer = tp_timer_create();
 
     phys_ch->fd = frame_decoder_create(cfg->band, 0, FRAME_TYPE_AUTO);
     if (!phys_ch->fd) {
-        tp_timer_destroy(phys_ch->tp_timer);
         free(phys_ch);
         return NULL;
     }
@@ -78,7 +80,6 @@ phys_ch_t *tetrapol_phys_ch_create(tetrapol_t *tetrapol)
     if (cfg->radio_ch_type == TETRAPOL_RADIO_CCH) {
         phys_ch->cch = cch_create(phys_ch->tpol);
         if (phys_ch->cch) {
-            tp_timer_register(phys_ch->tp_timer, cch_tick, phys_ch->cch);
             return phys_ch;
         }
     }
@@ -86,13 +87,11 @@ phys_ch_t *tetrapol_phys_ch_create(tetrapol_t *tetrapol)
     if (cfg->radio_ch_type == TETRAPOL_RADIO_TCH) {
         phys_ch->tch = tch_create(phys_ch->tpol);
         if (phys_ch->tch) {
-            tp_timer_register(phys_ch->tp_timer, tch_tick, phys_ch->tch);
             return phys_ch;
         }
     }
 
     frame_decoder_destroy(phys_ch->fd);
-    tp_timer_destroy(phys_ch->tp_timer);
     free(phys_ch);
 
     return NULL;
@@ -107,7 +106,6 @@ void tetrapol_phys_ch_destroy(phys_ch_t *phys_ch)
         tch_destroy(phys_ch->tch);
     }
     frame_decoder_destroy(phys_ch->fd);
-    tp_timer_destroy(phys_ch->tp_timer);
     free(phys_ch);
 }
 
@@ -120,6 +118,7 @@ void tetrapol_phys_ch_set_scr(phys_ch_t *phys_ch, int scr)
 {
     phys_ch->scr = scr;
     memset(&phys_ch->scr_stat, 0, sizeof(phys_ch->scr_stat));
+    phys_ch->scr_detect_frames = 0;
 }
 
 int tetrapol_phys_ch_get_scr_confidence(phys_ch_t *phys_ch)
@@ -155,6 +154,8 @@ int tetrapol_phys_ch_recv(phys_ch_t *phys_ch, uint8_t *buf, int len)
 
     memcpy(phys_ch->data_end, buf, len);
     phys_ch->data_end += len;
+    metric_add(&phys_ch->tpol->metrics.bits, len);
+    trace_rx(phys_ch->tpol->rx_offs + (phys_ch->data_end - phys_ch->data_begin));
 
     if (phys_ch->dir == DIR_UPLINK) {
         for (uint8_t *b = phys_ch->data_end - len; b < phys_ch->data_end; ++b) {
@@ -303,18 +304,45 @@ static int get_frame(phys_ch_t *phys_ch, uint8_t *fr_data)
     return 1;
 }
 
+/// advance timer to the position in input stream
+static void timer_tick(phys_ch_t *phys_ch, bool rx_glitch)
+{
+    tp_timer_t *timer = phys_ch->tpol->tp_timer;
+    // time never goes backward, difference would wrap into endless ticking
+    if (phys_ch->tpol->rx_offs < phys_ch->timer_offs) {
+        return;
+    }
+    const uint64_t now =
+        (phys_ch->tpol->rx_offs - phys_ch->timer_offs) * TETRAPOL_BIT_USEC;
+    if (now < tp_timer_now(timer)) {
+        return;
+    }
+
+    // long gap in input (rx_gap) does not fit into single tick
+    uint64_t usec = now - tp_timer_now(timer);
+    do {
+        const int tick = (usec > INT_MAX) ? INT_MAX : usec;
+        tp_timer_tick(timer, rx_glitch, tick);
+        usec -= tick;
+    } while (usec);
+}
+
 int tetrapol_phys_ch_process(phys_ch_t *phys_ch)
 {
     if (!phys_ch->has_frame_sync) {
-        int n = phys_ch->data_end - phys_ch->data_begin;
+        TRACE_BEGIN(TRACE_SYNC);
         phys_ch->has_frame_sync = find_frame_sync(phys_ch);
-        n -= phys_ch->data_end - phys_ch->data_begin;
+        TRACE_END(TRACE_SYNC);
         if (!phys_ch->has_frame_sync) {
-            tp_timer_tick(phys_ch->tp_timer, true, n * 20000 / 160);
+            if (phys_ch->tch) {
+                tch_rx_glitch(phys_ch->tch);
+            }
+            timer_tick(phys_ch, true);
             return 0;
         }
         LOG(INFO, "Frame sync found");
         phys_ch->tpol->frame_no = FRAME_NO_UNKNOWN;
+        tetrapol_evt_sync(phys_ch->tpol, true);
         if (phys_ch->cch) {
             cch_fr_error(phys_ch->cch);
         }
@@ -324,7 +352,7 @@ int tetrapol_phys_ch_process(phys_ch_t *phys_ch)
     uint8_t fr_data[FRAME_DATA_LEN];
     while ((r = get_frame(phys_ch, fr_data)) > 0) {
         process_frame(phys_ch, fr_data);
-        tp_timer_tick(phys_ch->tp_timer, false, 20000);
+        timer_tick(phys_ch, false);
         if (phys_ch->tpol->frame_no != FRAME_NO_UNKNOWN) {
             phys_ch->tpol->frame_no = (phys_ch->tpol->frame_no + 1) % 200;
         }
@@ -336,6 +364,7 @@ int tetrapol_phys_ch_process(phys_ch_t *phys_ch)
 
     LOG(INFO, "Frame sync lost");
     phys_ch->has_frame_sync = false;
+    tetrapol_evt_sync(phys_ch->tpol, false);
 
     return 0;
 }
@@ -347,6 +376,8 @@ int tetrapol_phys_ch_process(phys_ch_t *phys_ch)
   */
 static void detect_scr(phys_ch_t *phys_ch, const uint8_t *fr_data)
 {
+    ++phys_ch->scr_detect_frames;
+
     // compute SCR statistics
     for(int scr = 0; scr < ARRAY_LEN(phys_ch->scr_stat); ++scr) {
         frame_t fr;
@@ -377,6 +408,8 @@ static void detect_scr(phys_ch_t *phys_ch, const uint8_t *fr_data)
         }
     }
     if (phys_ch->scr_stat[scr_max] - phys_ch->scr_confidence > phys_ch->scr_stat[scr_max2]) {
+        metric_hist_add(&phys_ch->tpol->metrics.scr_detect,
+                phys_ch->scr_detect_frames);
         tetrapol_phys_ch_set_scr(phys_ch, scr_max);
         LOG(INFO, "SCR detected %d", scr_max);
     }
@@ -387,34 +420,42 @@ static void detect_scr(phys_ch_t *phys_ch, const uint8_t *fr_data)
 static int process_frame(phys_ch_t *phys_ch, const uint8_t *fr_data)
 {
     if (phys_ch->scr == PHYS_CH_SCR_DETECT) {
+        TRACE_BEGIN(TRACE_DETECT_SCR);
         detect_scr(phys_ch, fr_data);
+        TRACE_END(TRACE_DETECT_SCR);
     }
 
     const int scr = (phys_ch->scr == PHYS_CH_SCR_DETECT) ?
         phys_ch->scr_guess : phys_ch->scr;
 
-    if (phys_ch->scr_last != scr) {
-        printf("{ \"event\": \"scr\", \"scr\": %d }\n", scr);
-        phys_ch-> scr_last = scr;
-    }
-
     const int fr_type = (phys_ch->radio_ch_type == TETRAPOL_RADIO_CCH) ?
         FRAME_TYPE_DATA : FRAME_TYPE_AUTO;
 
     frame_t fr;
     frame_decoder_reset(phys_ch->fd, phys_ch->band, scr, fr_type);
+    TRACE_BEGIN(TRACE_FRAME_DECODE);
     frame_decoder_decode(phys_ch->fd, &fr, fr_data);
+    TRACE_END(TRACE_FRAME_DECODE);
 
-    if (!fr.broken) {
-        frame_json(phys_ch->tpol, &fr);
+    return push_frame(phys_ch, &fr, scr);
+}
+
+/// pass decoded frame to logical channels, scr is SCR used for decoding
+static int push_frame(phys_ch_t *phys_ch, const frame_t *fr, int scr)
+{
+    if (phys_ch->scr_last != scr) {
+        tetrapol_evt_scr(phys_ch->tpol, scr);
+        phys_ch->scr_last = scr;
     }
 
+    tetrapol_evt_frame(phys_ch->tpol, fr);
+
     if (phys_ch->radio_ch_type == TETRAPOL_RADIO_CCH) {
         // TODO: report when frame_no is detected
-        return cch_push_frame(phys_ch->cch, &fr);
+        return cch_push_frame(phys_ch->cch, fr);
     }
 
-    if (!tch_push_frame(phys_ch->tch, &fr)) {
+    if (!tch_push_frame(phys_ch->tch, fr)) {
         return 0;
     }
 
@@ -426,3 +467,227 @@ static int process_frame(phys_ch_t *phys_ch, const uint8_t *fr_data)
 
     return 0;
 }
+
+void tetrapol_phys_ch_seek(phys_ch_t *phys_ch, uint64_t rx_offs,
+        int frame_no, int scr)
+{
+    phys_ch->data_begin = phys_ch->data_end = phys_ch->data + DATA_OFFS;
+    phys_ch->timer_offs += rx_offs - phys_ch->tpol->rx_offs;
+    phys_ch->tpol->rx_offs = rx_offs;
+    phys_ch->tpol->frame_no = frame_no;
+    if (scr != PHYS_CH_SCR_DETECT) {
+        tetrapol_phys_ch_set_scr(phys_ch, scr);
+    }
+    phys_ch->has_frame_sync = true;
+    phys_ch->sync_errs = 0;
+
+    LOG(INFO, "Frame sync restored");
+    tetrapol_evt_sync(phys_ch->tpol, true);
+    if (phys_ch->cch) {
+        cch_fr_error(phys_ch->cch);
+    }
+    if (phys_ch->tch) {
+        tch_rx_glitch(phys_ch->tch);
+    }
+}
+
+/**
+  Move replay position to rx_offs. Timer is advanced up to the end of
+  previous frame first, so timeouts expire before the frame is processed
+  as they would do when frames are received one by one.
+  */
+static void replay_seek(phys_ch_t *phys_ch, uint64_t rx_offs, int frame_no)
+{
+    if (rx_offs >= phys_ch->tpol->rx_offs + FRAME_LEN) {
+        phys_ch->tpol->rx_offs = rx_offs - FRAME_LEN;
+        timer_tick(phys_ch, false);
+    }
+    phys_ch->tpol->rx_offs = rx_offs;
+    phys_ch->tpol->frame_no = frame_no;
+}
+
+void tetrapol_phys_ch_replay_frame(phys_ch_t *phys_ch, const frame_t *fr,
+        int scr, uint64_t rx_offs, int frame_no)
+{
+    replay_seek(phys_ch, rx_offs, frame_no);
+    push_frame(phys_ch, fr, scr);
+    timer_tick(phys_ch, false);
+}
+
+int tetrapol_phys_ch_replay_hdlc(phys_ch_t *phys_ch, int log_ch,
+        const hdlc_frame_t *hdlc_fr, uint64_t rx_offs, int frame_no)
+{
+    replay_seek(phys_ch, rx_offs, frame_no);
+    const int r = phys_ch->cch ?
+        cch_push_hdlc_frame(phys_ch->cch, log_ch, hdlc_fr) :
+        tch_push_hdlc_frame(phys_ch->tch, hdlc_fr);
+    timer_tick(phys_ch, false);
+
+    return r;
+}
+
+void tetrapol_phys_ch_replay_sync(phys_ch_t *phys_ch, bool has_sync,
+        uint64_t rx_offs)
+{
+    phys_ch->tpol->rx_offs = rx_offs;
+    phys_ch->has_frame_sync = has_sync;
+    if (has_sync) {
+        phys_ch->tpol->frame_no = FRAME_NO_UNKNOWN;
+        tetrapol_evt_sync(phys_ch->tpol, true);
+        if (phys_ch->cch) {
+            cch_fr_error(phys_ch->cch);
+        }
+        return;
+    }
+
+    tetrapol_evt_sync(phys_ch->tpol, false);
+    if (phys_ch->tch) {
+        tch_rx_glitch(phys_ch->tch);
+    }
+    timer_tick(phys_ch, true);
+}
+
+uint64_t tetrapol_phys_ch_get_in_offs(phys_ch_t *phys_ch)
+{
+    return phys_ch->tpol->rx_offs +
+        (phys_ch->data_end - phys_ch->data_begin);
+}
+
+void tetrapol_phys_ch_rx_gap(phys_ch_t *phys_ch, uint64_t rx_offs)
+{
+    phys_ch->data_begin = phys_ch->data_end = phys_ch->data + DATA_OFFS;
+    if (rx_offs > phys_ch->tpol->rx_offs) {
+        phys_ch->tpol->rx_offs = rx_offs;
+    }
+    if (phys_ch->has_frame_sync) {
+        LOG(INFO, "Frame sync lost");
+        phys_ch->has_frame_sync = false;
+        tetrapol_evt_sync(phys_ch->tpol, false);
+    }
+    if (phys_ch->cch) {
+        cch_rx_glitch(phys_ch->cch);
+    }
+    if (phys_ch->tch) {
+        tch_rx_glitch(phys_ch->tch);
+    }
+    timer_tick(phys_ch, true);
+}
+
+static void phys_ch_save(phys_ch_t *phys_ch, snapshot_t *snap)
+{
+    snapshot_put_u8(snap, phys_ch->band);
+    snapshot_put_u8(snap, phys_ch->dir);
+    snapshot_put_u8(snap, phys_ch->radio_ch_type);
+    tp_timer_save(phys_ch->tpol->tp_timer, snap);
+
+    snapshot_put_u8(snap, phys_ch->has_frame_sync);
+    snapshot_put_u32(snap, phys_ch->sync_errs);
+    snapshot_put_u8(snap, phys_ch->scr);
+    snapshot_put_u8(snap, phys_ch->scr_last);
+    snapshot_put_u8(snap, phys_ch->scr_guess);
+    for (int i = 0; i < ARRAY_LEN(phys_ch->scr_stat); ++i) {
+        snapshot_put_u32(snap, phys_ch->scr_stat[i]);
+    }
+    snapshot_put_u32(snap, phys_ch->scr_detect_frames);
+    snapshot_put_u64(snap, phys_ch->timer_offs);
+
+    // unprocessed data and history used to recover frame synchronization
+    const int hist = (phys_ch->data_begin - phys_ch->data > DATA_OFFS) ?
+        DATA_OFFS : phys_ch->data_begin - phys_ch->data;
+    const int len = phys_ch->data_end - phys_ch->data_begin;
+    snapshot_put_u16(snap, hist);
+    snapshot_put_u16(snap, len);
+    snapshot_put_bytes(snap, phys_ch->data_begin - hist, hist + len);
+
+    if (phys_ch->cch) {
+        cch_save(phys_ch->cch, snap);
+    } else {
+        tch_save(phys_ch->tch, snap);
+    }
+
+    tetrapol_state_save(phys_ch->tpol, snap);
+}
+
+static bool phys_ch_load(phys_ch_t *phys_ch, snapshot_t *snap)
+{
+    const int band = snapshot_get_u8(snap);
+    const int dir = snapshot_get_u8(snap);
+    const int radio_ch_type = snapshot_get_u8(snap);
+    if (snap->err) {
+        return false;
+    }
+    if (band != phys_ch->band || dir != phys_ch->dir ||
+            radio_ch_type != phys_ch->radio_ch_type) {
+        LOG(ERR, "snapshot of different channel band=%d dir=%d type=%d",
+                band, dir, radio_ch_type);
+        snap->err = true;
+        return false;
+    }
+    if (!tp_timer_load(phys_ch->tpol->tp_timer, snap)) {
+        return false;
+    }
+
+    phys_ch->has_frame_sync = snapshot_get_u8(snap);
+    phys_ch->sync_errs = snapshot_get_u32(snap);
+    phys_ch->scr = (int8_t)snapshot_get_u8(snap);
+    phys_ch->scr_last = (int8_t)snapshot_get_u8(snap);
+    phys_ch->scr_guess = snapshot_get_u8(snap);
+    if (phys_ch->scr < PHYS_CH_SCR_DETECT ||
+            phys_ch->scr_last < PHYS_CH_SCR_DETECT ||
+            phys_ch->scr_guess >= ARRAY_LEN(phys_ch->scr_stat)) {
+        snapshot_invalid(snap, "SCR");
+        return false;
+    }
+    for (int i = 0; i < ARRAY_LEN(phys_ch->scr_stat); ++i) {
+        phys_ch->scr_stat[i] = snapshot_get_u32(snap);
+    }
+    phys_ch->scr_detect_frames = snapshot_get_u32(snap);
+    phys_ch->timer_offs = snapshot_get_u64(snap);
+
+    const int hist = snapshot_get_u16(snap);
+    const int len = snapshot_get_u16(snap);
+    if (hist > DATA_OFFS || len > sizeof(phys_ch->data) - DATA_OFFS) {
+        snapshot_invalid(snap, "buffered data");
+        return false;
+    }
+    phys_ch->data_begin = phys_ch->data + DATA_OFFS;
+    phys_ch->data_end = phys_ch->data_begin + len;
+    snapshot_get_bytes(snap, phys_ch->data_begin - hist, hist + len);
+
+    const bool ok = phys_ch->cch ?
+        cch_load(phys_ch->cch, snap) : tch_load(phys_ch->tch, snap);
+    if (!ok) {
+        return false;
+    }
+
+    return tetrapol_state_load(phys_ch->tpol, snap);
+}
+
+int tetrapol_snapshot_save(phys_ch_t *phys_ch, FILE *f)
+{
+    snapshot_t snap;
+    memset(&snap, 0, sizeof(snap));
+    phys_ch_save(phys_ch, &snap);
+    const int ret = snapshot_write(&snap, f);
+    free(snap.buf);
+
+    return ret;
+}
+
+int tetrapol_snapshot_load(phys_ch_t *phys_ch, FILE *f)
+{
+    snapshot_t snap;
+    if (snapshot_read(&snap, f)) {
+        return -1;
+    }
+
+    const bool ok = phys_ch_load(phys_ch, &snap) && !snap.err &&
+        snap.pos == snap.len;
+    free(snap.buf);
+    if (!ok) {
+        LOG(ERR, "failed to load snapshot");
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+#define LOG_PREFIX "pool"
+#include <tetrapol/log.h>
+#include <tetrapol/pool.h>
+
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    SLAB_SIZE = 16 * 1024,
+    SLAB_OBJS_MIN = 4,
+};
+
+typedef struct free_obj_t {
+    struct free_obj_t *next;
+} free_obj_t;
+
+typedef struct slab_t {
+    struct slab_t *next;
+    alignas(max_align_t) uint8_t objs[];
+} slab_t;
+
+struct pool_priv_t {
+    size_t obj_size;
+    int slab_objs;      ///< number of objects in single slab
+    free_obj_t *free;
+    slab_t *slabs;
+    pool_stats_t stats;
+};
+
+pool_t *pool_create(const char *name, size_t obj_size)
+{
+    pool_t *pool = malloc(sizeof(pool_t));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (obj_size < sizeof(free_obj_t)) {
+        obj_size = sizeof(free_obj_t);
+    }
+    // keep all objects aligned
+    obj_size = (obj_size + alignof(max_align_t) - 1) &
+        ~(alignof(max_align_t) - 1);
+
+    pool->obj_size = obj_size;
+    pool->slab_objs = SLAB_SIZE / obj_size;
+    if (pool->slab_objs < SLAB_OBJS_MIN) {
+        pool->slab_objs = SLAB_OBJS_MIN;
+    }
+    pool->free = NULL;
+    pool->slabs = NULL;
+    memset(&pool->stats, 0, sizeof(pool->stats));
+    pool->stats.name = name;
+    pool->stats.obj_size = obj_size;
+
+    return pool;
+}
+
+void pool_destroy(pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+
+    if (pool->stats.in_use) {
+        LOG(WTF, "destroying pool '%s' with %llu objects in use",
+                pool->stats.name, (unsigned long long)pool->stats.in_use);
+    }
+
+    while (pool->slabs) {
+        slab_t *slab = pool->slabs;
+        pool->slabs = slab->next;
+        free(slab);
+    }
+    free(pool);
+}
+
+static bool pool_grow(pool_t *pool)
+{
+    const size_t size = sizeof(slab_t) + pool->obj_size * pool->slab_objs;
+    slab_t *slab = malloc(size);
+    if (!slab) {
+        LOG(ERR, "ERR OOM");
+        return false;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    ++pool->stats.nslabs;
+    pool->stats.bytes += size;
+
+    // keep objects on free list in address order
+    for (int i = pool->slab_objs - 1; i >= 0; --i) {
+        free_obj_t *obj = (free_obj_t *)&slab->objs[i * pool->obj_size];
+        obj->next = pool->free;
+        pool->free = obj;
+    }
+
+    return true;
+}
+
+void *pool_alloc(pool_t *pool)
+{
+    if (!pool->free && !pool_grow(pool)) {
+        return NULL;
+    }
+
+    free_obj_t *obj = pool->free;
+    pool->free = obj->next;
+
+    ++pool->stats.nallocs;
+    ++pool->stats.in_use;
+    if (pool->stats.in_use > pool->stats.peak) {
+        pool->stats.peak = pool->stats.in_use;
+    }
+
+    return obj;
+}
+
+void pool_free(pool_t *pool, void *obj)
+{
+    if (!obj) {
+        return;
+    }
+
+    free_obj_t *free_obj = obj;
+    free_obj->next = pool->free;
+    pool->free = free_obj;
+
+    ++pool->stats.nfrees;
+    --pool->stats.in_use;
+}
+
+void pool_get_stats(const pool_t *pool, pool_stats_t *stats)
+{
+    memcpy(stats, &pool->stats, sizeof(pool_stats_t));
+}
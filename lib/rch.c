@@ -6,6 +6,7 @@
 #include <tetrapol/data_frame.h>
 #include <tetrapol/misc.h>
 #include <tetrapol/system_config.h>
+#include <tetrapol/trace.h>
 
 #include <stdlib.h>
 
@@ -17,6 +18,7 @@ typedef struct {
 struct rch_priv_t {
     data_frame_t *data_fr;
     rch_data_t rch_data;
+    tpol_t *tpol;
 };
 
 rch_t *rch_create(tpol_t *tpol)
@@ -32,6 +34,8 @@ rch_t *rch_create(tpol_t *tpol)
         return NULL;
     }
 
+    rch->tpol = tpol;
+
     return rch;
 }
 
@@ -45,7 +49,13 @@ void rch_destroy(rch_t *rch)
 
 bool rch_push_frame(rch_t *rch, const frame_t *fr)
 {
-    if (data_frame_push_frame(rch->data_fr, fr) <= 0) {
+    TRACE_BEGIN(TRACE_DATA_FRAME);
+    const int r = data_frame_push_frame(rch->data_fr, fr);
+    TRACE_END(TRACE_DATA_FRAME);
+    if (r < 0) {
+        metric_inc(&rch->tpol->metrics.data_frame_errs);
+    }
+    if (r <= 0) {
         LOG(DBG, "RCH: block fail");
         return false;
     }
@@ -63,6 +73,7 @@ bool rch_push_frame(rch_t *rch, const frame_t *fr)
     }
 
     if (!check_fcs(data, size)) {
+        metric_inc(&rch->tpol->metrics.hdlc_fcs_errs);
         LOG(DBG, "invalid FCS");
         return false;
     }
@@ -75,6 +86,8 @@ bool rch_push_frame(rch_t *rch, const frame_t *fr)
         }
     }
 
+    tetrapol_evt_rch(rch->tpol, data, size / 8);
+
     return true;
 }
 
@@ -98,3 +111,13 @@ void rch_print(const rch_t *rch)
         }
     }
 }
+
+void rch_save(const rch_t *rch, snapshot_t *snap)
+{
+    data_frame_save(rch->data_fr, snap);
+}
+
+bool rch_load(rch_t *rch, snapshot_t *snap)
+{
+    return data_frame_load(rch->data_fr, snap);
+}
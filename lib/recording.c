@@ -0,0 +1,307 @@
+#define _DEFAULT_SOURCE 1
+#define LOG_PREFIX "recording"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/log.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/recording.h>
+#include <tetrapol/tetrapol_int.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char RECORDING_MAGIC[4] = { 'T', 'P', 'R', 'C', };
+
+struct recording_writer_priv_t {
+    FILE *f;
+    tetrapol_t *tetrapol;
+    recording_hdr_t hdr;
+    int scr;            ///< SCR reported by last SCR event
+    bool has_cell_id;
+    cell_id_t cell_id;
+    bool add_next;      ///< add entry for next frame
+    int nframes;        ///< frames since last entry
+    uint64_t last_rx_offs;  ///< position of last entry
+    uint8_t *idx;       ///< encoded entries
+    int nidx;
+    int idx_size;       ///< allocated entries
+    bool err;
+};
+
+static void hdr_encode(uint8_t *buf, const recording_hdr_t *hdr)
+{
+    memset(buf, 0, RECORDING_HDR_LEN);
+    memcpy(buf, RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+    buf[4] = RECORDING_VERSION;
+    buf[5] = hdr->sample_fmt;
+    buf[6] = hdr->cfg.band;
+    buf[7] = hdr->cfg.dir;
+    buf[8] = hdr->cfg.radio_ch_type;
+    put_u64(&buf[16], hdr->freq);
+    put_u64(&buf[24], hdr->cfg.start_time);
+    put_u64(&buf[32], hdr->nbits);
+    put_u64(&buf[40], hdr->index_offs);
+    put_u32(&buf[48], hdr->nindex);
+}
+
+static void idx_add(recording_writer_t *rw, const tetrapol_evt_t *evt)
+{
+    if (rw->nidx == rw->idx_size) {
+        const int size = rw->idx_size ? 2 * rw->idx_size : 1024;
+        uint8_t *idx = realloc(rw->idx, size * RECORDING_IDX_LEN);
+        if (!idx) {
+            LOG(ERR, "failed to allocate index");
+            rw->err = true;
+            return;
+        }
+        rw->idx = idx;
+        rw->idx_size = size;
+    }
+
+    // event is reported after the whole frame is received
+    const uint64_t rx_offs = evt->rx_offs - FRAME_LEN;
+    uint8_t *p = &rw->idx[rw->nidx * RECORDING_IDX_LEN];
+    memset(p, 0, RECORDING_IDX_LEN);
+    put_u64(p, rx_offs);
+    p[8] = (evt->frame_no == FRAME_NO_UNKNOWN) ?
+        RECORDING_FRAME_NO_UNKNOWN : evt->frame_no;
+    p[9] = (rw->scr < 0) ? RECORDING_SCR_UNKNOWN : rw->scr;
+    if (rw->has_cell_id) {
+        p[10] = RECORDING_IDX_CELL_ID;
+        p[11] = rw->cell_id.bs_id;
+        p[12] = rw->cell_id.rsw_id;
+    }
+    ++rw->nidx;
+
+    rw->last_rx_offs = rx_offs;
+    rw->nframes = 0;
+    rw->add_next = false;
+}
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    recording_writer_t *rw = ptr;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            ++rw->nframes;
+            if (evt->rx_offs < FRAME_LEN ||
+                    (rw->nidx && evt->rx_offs - FRAME_LEN <= rw->last_rx_offs)) {
+                break;
+            }
+            if (rw->add_next ||
+                    (evt->frame_no != FRAME_NO_UNKNOWN &&
+                     evt->frame_no % 100 == 0) ||
+                    (evt->frame_no == FRAME_NO_UNKNOWN &&
+                     rw->nframes >= RECORDING_IDX_INTERVAL)) {
+                idx_add(rw, evt);
+            }
+            break;
+
+        case TETRAPOL_EVT_SCR:
+            rw->scr = evt->scr.scr;
+            rw->add_next = true;
+            break;
+
+        case TETRAPOL_EVT_SYNC:
+            rw->add_next = evt->sync.has_sync;
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            if (evt->tsdu.decoded && evt->tsdu.decoded->codop == D_SYSTEM_INFO) {
+                const tsdu_d_system_info_t *tsdu =
+                    (const tsdu_d_system_info_t *)evt->tsdu.decoded;
+                rw->has_cell_id = true;
+                rw->cell_id = tsdu->cell_id;
+            }
+            break;
+    }
+}
+
+recording_writer_t *recording_writer_create(FILE *f, uint64_t freq,
+        tetrapol_t *tetrapol)
+{
+    if (tetrapol_has_filter(tetrapol)) {
+        LOG(ERR, "index can not be built from filtered events");
+        return NULL;
+    }
+
+    recording_writer_t *rw = calloc(1, sizeof(recording_writer_t));
+    if (!rw) {
+        return NULL;
+    }
+    rw->f = f;
+    rw->tetrapol = tetrapol;
+    rw->scr = PHYS_CH_SCR_DETECT;
+    rw->hdr.sample_fmt = RECORDING_FMT_BITS;
+    rw->hdr.cfg = *tetrapol_get_cfg(tetrapol);
+    rw->hdr.freq = freq;
+
+    uint8_t hdr[RECORDING_HDR_LEN];
+    hdr_encode(hdr, &rw->hdr);
+    if (fwrite(hdr, sizeof(hdr), 1, f) != 1) {
+        LOG(ERR, "failed to write file header");
+        free(rw);
+        return NULL;
+    }
+
+    if (!tetrapol_subscribe(tetrapol, TETRAPOL_EVT_FRAME | TETRAPOL_EVT_SCR |
+                TETRAPOL_EVT_SYNC | TETRAPOL_EVT_TSDU_DECODED, evt_cb, rw)) {
+        free(rw);
+        return NULL;
+    }
+
+    return rw;
+}
+
+int recording_writer_write(recording_writer_t *rw, const uint8_t *bits,
+        int len)
+{
+    if (len && fwrite(bits, len, 1, rw->f) != 1) {
+        rw->err = true;
+        return -1;
+    }
+    rw->hdr.nbits += len;
+
+    return 0;
+}
+
+int recording_writer_destroy(recording_writer_t *rw)
+{
+    if (!rw) {
+        return 0;
+    }
+
+    tetrapol_unsubscribe(rw->tetrapol, evt_cb, rw);
+
+    rw->hdr.index_offs = RECORDING_HDR_LEN + rw->hdr.nbits;
+    rw->hdr.nindex = rw->nidx;
+    uint8_t hdr[RECORDING_HDR_LEN];
+    hdr_encode(hdr, &rw->hdr);
+
+    int ret = rw->err ? -1 : 0;
+    if ((rw->nidx && fwrite(rw->idx, rw->nidx * RECORDING_IDX_LEN, 1,
+                    rw->f) != 1) ||
+            fseek(rw->f, 0, SEEK_SET) ||
+            fwrite(hdr, sizeof(hdr), 1, rw->f) != 1 ||
+            fflush(rw->f)) {
+        LOG(ERR, "failed to write index");
+        ret = -1;
+    }
+
+    free(rw->idx);
+    free(rw);
+
+    return ret;
+}
+
+int recording_read_hdr(int fd, recording_hdr_t *hdr)
+{
+    struct stat st;
+    if (fstat(fd, &st)) {
+        return -1;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        // pipe, FIFO, ..., data cannot be put back after probing
+        return 0;
+    }
+
+    uint8_t buf[RECORDING_HDR_LEN];
+    const ssize_t len = read(fd, buf, sizeof(buf));
+    if (len < 0) {
+        return -1;
+    }
+
+    if (len < sizeof(RECORDING_MAGIC) ||
+            memcmp(buf, RECORDING_MAGIC, sizeof(RECORDING_MAGIC))) {
+        return lseek(fd, 0, SEEK_SET) ? -1 : 0;
+    }
+
+    if (len != sizeof(buf) || buf[4] != RECORDING_VERSION ||
+            buf[5] != RECORDING_FMT_BITS) {
+        LOG(ERR, "invalid file header");
+        return -1;
+    }
+
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->sample_fmt = buf[5];
+    hdr->cfg.band = buf[6];
+    hdr->cfg.dir = buf[7];
+    hdr->cfg.radio_ch_type = buf[8];
+    hdr->freq = get_u64(&buf[16]);
+    hdr->cfg.start_time = get_u64(&buf[24]);
+    hdr->nbits = get_u64(&buf[32]);
+    hdr->index_offs = get_u64(&buf[40]);
+    hdr->nindex = get_u32(&buf[48]);
+
+    if (!hdr->index_offs) {
+        // writing was interrupted, no index
+        hdr->nbits = st.st_size - RECORDING_HDR_LEN;
+        hdr->nindex = 0;
+    }
+
+    return 1;
+}
+
+int recording_read_index(int fd, const recording_hdr_t *hdr,
+        recording_idx_t **idx)
+{
+    *idx = NULL;
+    if (!hdr->nindex) {
+        return 0;
+    }
+
+    const size_t size = (size_t)hdr->nindex * RECORDING_IDX_LEN;
+    uint8_t *buf = malloc(size);
+    *idx = malloc(hdr->nindex * sizeof(recording_idx_t));
+    if (!buf || !*idx) {
+        free(buf);
+        free(*idx);
+        *idx = NULL;
+        return -1;
+    }
+
+    if (pread(fd, buf, size, hdr->index_offs) != size) {
+        LOG(ERR, "failed to read index");
+        free(buf);
+        free(*idx);
+        *idx = NULL;
+        return -1;
+    }
+
+    for (int i = 0; i < hdr->nindex; ++i) {
+        const uint8_t *p = &buf[i * RECORDING_IDX_LEN];
+        recording_idx_t *e = &(*idx)[i];
+        e->rx_offs = get_u64(p);
+        e->frame_no = (p[8] == RECORDING_FRAME_NO_UNKNOWN) ?
+            FRAME_NO_UNKNOWN : p[8];
+        e->scr = (p[9] == RECORDING_SCR_UNKNOWN) ? PHYS_CH_SCR_DETECT : p[9];
+        e->has_cell_id = p[10] & RECORDING_IDX_CELL_ID;
+        e->cell_id.bs_id = p[11];
+        e->cell_id.rsw_id = p[12];
+    }
+    free(buf);
+
+    return hdr->nindex;
+}
+
+const recording_idx_t *recording_find(const recording_idx_t *idx, int nidx,
+        uint64_t rx_offs)
+{
+    int lo = 0;
+    int hi = nidx;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (idx[mid].rx_offs <= rx_offs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo ? &idx[lo - 1] : NULL;
+}
@@ -5,6 +5,7 @@
 #include <tetrapol/hdlc_frame.h>
 #include <tetrapol/misc.h>
 #include <tetrapol/terminal.h>
+#include <tetrapol/trace.h>
 #include <tetrapol/system_config.h>
 
 #include <stdlib.h>
@@ -13,10 +14,7 @@
 struct sdch_priv_t {
     data_frame_t *data_fr;
     terminal_list_t *tlist;
-    bool rx_glitch;
-    // This is used for re-sending tick event with changed state
-    // do not allocate or release.
-    time_evt_t *te;
+    tpol_t *tpol;
 };
 
 sdch_t *sdch_create(tpol_t *tpol)
@@ -26,8 +24,6 @@ sdch_t *sdch_create(tpol_t *tpol)
         return NULL;
     }
 
-    sdch->te = NULL;
-
     sdch->data_fr = data_frame_create();
     if (!sdch->data_fr) {
         goto err_data_fr;
@@ -37,8 +33,7 @@ sdch_t *sdch_create(tpol_t *tpol)
     if (!sdch->tlist) {
         goto err_tlist;
     }
-
-    sdch->rx_glitch = false;
+    sdch->tpol = tpol;
 
     return sdch;
 
@@ -62,10 +57,13 @@ void sdch_destroy(sdch_t *sdch)
 
 bool sdch_dl_push_data_frame(sdch_t *sdch, const frame_t *fr)
 {
+    TRACE_BEGIN(TRACE_DATA_FRAME);
     int res = data_frame_push_frame(sdch->data_fr, fr);
+    TRACE_END(TRACE_DATA_FRAME);
 
     if (res < 0) {
-        sdch->rx_glitch = true;
+        metric_inc(&sdch->tpol->metrics.data_frame_errs);
+        sdch_rx_glitch(sdch);
     }
 
     if (res <= 0) {
@@ -73,7 +71,7 @@ bool sdch_dl_push_data_frame(sdch_t *sdch, const frame_t *fr)
     }
 
     if (res == 2) {
-        terminal_list_rx_glitch(sdch->tlist);
+        sdch_rx_glitch(sdch);
     }
 
     uint8_t data[SYS_PAR_N200_BYTES_MAX];
@@ -81,26 +79,50 @@ bool sdch_dl_push_data_frame(sdch_t *sdch, const frame_t *fr)
 
     hdlc_frame_t hdlc_fr;
 
-    if (!hdlc_frame_parse(&hdlc_fr, data, size)) {
+    TRACE_BEGIN(TRACE_HDLC_PARSE);
+    const bool fcs_ok = hdlc_frame_parse(&hdlc_fr, data, size);
+    TRACE_END(TRACE_HDLC_PARSE);
+    if (!fcs_ok) {
         // PAS 0001-3-3 7.4.1.9 stuffing frames are dropped, FCS does not match
         int idx = hdlc_frame_stuffing_idx(&hdlc_fr);
         if (idx == -1) {
-            sdch->rx_glitch = true;
+            metric_inc(&sdch->tpol->metrics.hdlc_fcs_errs);
+            sdch_rx_glitch(sdch);
             LOG(INFO, "HDLC: broken frame");
         } else {
+            metric_inc(&sdch->tpol->metrics.hdlc_stuffing);
             LOG(INFO, "HDLC: stuffing idx=%d", idx);
         }
         return false;
     }
 
-    return terminal_list_push_hdlc_frame(sdch->tlist, &hdlc_fr) != -1;
+    return sdch_push_hdlc_frame(sdch, &hdlc_fr);
+}
+
+bool sdch_push_hdlc_frame(sdch_t *sdch, const hdlc_frame_t *hdlc_fr)
+{
+    tetrapol_evt_hdlc(sdch->tpol, LOG_CH_SDCH, hdlc_fr);
+
+    TRACE_BEGIN(TRACE_LINK);
+    const int ret = terminal_list_push_hdlc_frame(sdch->tlist, hdlc_fr);
+    TRACE_END(TRACE_LINK);
+
+    return ret != -1;
+}
+
+void sdch_rx_glitch(sdch_t *sdch)
+{
+    terminal_list_rx_glitch(sdch->tlist);
+}
+
+void sdch_save(const sdch_t *sdch, snapshot_t *snap)
+{
+    data_frame_save(sdch->data_fr, snap);
+    terminal_list_save(sdch->tlist, snap);
 }
 
-void sdch_tick(time_evt_t *te, void *sdch)
+bool sdch_load(sdch_t *sdch, snapshot_t *snap)
 {
-    sdch_t *sdch_ = sdch;
-    sdch_->te = te;
-    te->rx_glitch |= sdch_->rx_glitch;
-    sdch_->rx_glitch = false;
-    terminal_list_tick(sdch_->tlist, te);
+    return data_frame_load(sdch->data_fr, snap) &&
+        terminal_list_load(sdch->tlist, snap);
 }
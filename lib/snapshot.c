@@ -0,0 +1,208 @@
+#define LOG_PREFIX "snapshot"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/log.h>
+#include <tetrapol/snapshot.h>
+#include <tetrapol/snapshot_int.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char SNAPSHOT_MAGIC[4] = { 'T', 'P', 'S', 'N', };
+
+static void reserve(snapshot_t *snap, size_t len)
+{
+    if (snap->err || snap->len + len <= snap->size) {
+        return;
+    }
+
+    size_t size = snap->size ? snap->size : 4096;
+    while (size < snap->len + len) {
+        size *= 2;
+    }
+    uint8_t *buf = realloc(snap->buf, size);
+    if (!buf) {
+        LOG(ERR, "failed to allocate buffer");
+        snap->err = true;
+        return;
+    }
+    snap->buf = buf;
+    snap->size = size;
+}
+
+void snapshot_put_bytes(snapshot_t *snap, const void *data, size_t len)
+{
+    reserve(snap, len);
+    if (snap->err) {
+        return;
+    }
+    memcpy(&snap->buf[snap->len], data, len);
+    snap->len += len;
+}
+
+void snapshot_put_u8(snapshot_t *snap, uint8_t v)
+{
+    snapshot_put_bytes(snap, &v, 1);
+}
+
+void snapshot_put_u16(snapshot_t *snap, uint16_t v)
+{
+    uint8_t buf[2];
+    put_u16(buf, v);
+    snapshot_put_bytes(snap, buf, sizeof(buf));
+}
+
+void snapshot_put_u32(snapshot_t *snap, uint32_t v)
+{
+    uint8_t buf[4];
+    put_u32(buf, v);
+    snapshot_put_bytes(snap, buf, sizeof(buf));
+}
+
+void snapshot_put_u64(snapshot_t *snap, uint64_t v)
+{
+    uint8_t buf[8];
+    put_u64(buf, v);
+    snapshot_put_bytes(snap, buf, sizeof(buf));
+}
+
+void snapshot_put_bits(snapshot_t *snap, const uint8_t *bits, int nbits)
+{
+    uint8_t buf[(nbits + 7) / 8];
+    memset(buf, 0, sizeof(buf));
+    for (int i = 0; i < nbits; ++i) {
+        buf[i / 8] |= (bits[i] & 1) << (i % 8);
+    }
+    snapshot_put_bytes(snap, buf, sizeof(buf));
+}
+
+void snapshot_get_bytes(snapshot_t *snap, void *data, size_t len)
+{
+    if (snap->err || snap->len - snap->pos < len) {
+        snap->err = true;
+        memset(data, 0, len);
+        return;
+    }
+    memcpy(data, &snap->buf[snap->pos], len);
+    snap->pos += len;
+}
+
+uint8_t snapshot_get_u8(snapshot_t *snap)
+{
+    uint8_t v;
+    snapshot_get_bytes(snap, &v, 1);
+
+    return v;
+}
+
+uint16_t snapshot_get_u16(snapshot_t *snap)
+{
+    uint8_t buf[2];
+    snapshot_get_bytes(snap, buf, sizeof(buf));
+
+    return get_u16(buf);
+}
+
+uint32_t snapshot_get_u32(snapshot_t *snap)
+{
+    uint8_t buf[4];
+    snapshot_get_bytes(snap, buf, sizeof(buf));
+
+    return get_u32(buf);
+}
+
+uint64_t snapshot_get_u64(snapshot_t *snap)
+{
+    uint8_t buf[8];
+    snapshot_get_bytes(snap, buf, sizeof(buf));
+
+    return get_u64(buf);
+}
+
+void snapshot_get_bits(snapshot_t *snap, uint8_t *bits, int nbits)
+{
+    uint8_t buf[(nbits + 7) / 8];
+    snapshot_get_bytes(snap, buf, sizeof(buf));
+    for (int i = 0; i < nbits; ++i) {
+        bits[i] = (buf[i / 8] >> (i % 8)) & 1;
+    }
+}
+
+void snapshot_invalid(snapshot_t *snap, const char *what)
+{
+    if (!snap->err) {
+        LOG(ERR, "invalid %s", what);
+    }
+    snap->err = true;
+}
+
+static uint32_t checksum(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ data[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+int snapshot_write(const snapshot_t *snap, FILE *f)
+{
+    if (snap->err || snap->len > UINT32_MAX) {
+        return -1;
+    }
+
+    uint8_t hdr[SNAPSHOT_HDR_LEN];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    hdr[4] = SNAPSHOT_VERSION;
+    const uint32_t sum = checksum(snap->buf, snap->len);
+    for (int i = 0; i < 4; ++i) {
+        hdr[8 + i] = snap->len >> (8 * i);
+        hdr[12 + i] = sum >> (8 * i);
+    }
+
+    if (fwrite(hdr, sizeof(hdr), 1, f) != 1 ||
+            (snap->len && fwrite(snap->buf, snap->len, 1, f) != 1) ||
+            fflush(f)) {
+        LOG(ERR, "failed to write snapshot");
+        return -1;
+    }
+
+    return 0;
+}
+
+int snapshot_read(snapshot_t *snap, FILE *f)
+{
+    memset(snap, 0, sizeof(*snap));
+
+    uint8_t hdr[SNAPSHOT_HDR_LEN];
+    if (fread(hdr, sizeof(hdr), 1, f) != 1 ||
+            memcmp(hdr, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))) {
+        LOG(ERR, "not a snapshot");
+        return -1;
+    }
+    if (hdr[4] != SNAPSHOT_VERSION) {
+        LOG(ERR, "unsupported version %d", hdr[4]);
+        return -1;
+    }
+
+    uint32_t sum = 0;
+    for (int i = 3; i >= 0; --i) {
+        snap->len = (snap->len << 8) | hdr[8 + i];
+        sum = (sum << 8) | hdr[12 + i];
+    }
+    snap->size = snap->len;
+    snap->buf = malloc(snap->len ? snap->len : 1);
+    if (!snap->buf) {
+        return -1;
+    }
+    if ((snap->len && fread(snap->buf, snap->len, 1, f) != 1) ||
+            checksum(snap->buf, snap->len) != sum) {
+        LOG(ERR, "truncated or corrupted snapshot");
+        free(snap->buf);
+        snap->buf = NULL;
+        return -1;
+    }
+
+    return 0;
+}
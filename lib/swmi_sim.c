@@ -0,0 +1,679 @@
+#define LOG_PREFIX "swmi_sim"
+#include <tetrapol/log.h>
+#include <tetrapol/addr.h>
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/msg_coding.h>
+#include <tetrapol/swmi_sim.h>
+#include <tetrapol/system_config.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    RATE_MAX = 1000,    ///< events per second
+    DATA_LEN_DEFAULT = 200,
+    DATA_LEN_MIN = 5,
+    DATA_LEN_MAX = 1024,
+    NTERMINALS_MAX = SWMI_SIM_TERMINALS_MAX,
+    QUEUE_LEN = 1024,   ///< HDLC frames waiting for SDCH
+    ADDR_QUEUE_LEN = 64,    ///< addresses waiting for PCH or RCH
+    HDLC_BYTES_MAX = 8 * SYS_PAR_DATA_FRAME_BLOCKS_MAX,
+    /// TPDU payload of segmented DT filling the largest HDLC frame
+    DT_SEG_LEN = HDLC_BYTES_MAX - 3 - 2 - 2,
+    /// UI DU payload of non-last segment filling the largest HDLC frame
+    UI_SEG_LEN = HDLC_BYTES_MAX - 3 - 2 - 3,
+    CODOP_NONE = -1,
+    ID_TSAP = 1,
+    TSAP_REF_REG = 1,   ///< TSAP reference used for registrations
+    TSAP_REF_CALL = 2,  ///< TSAP reference used for call setups
+    TSAP_REF_DATA = 3,  ///< TSAP reference used for CO data
+    TPDU_CODE_FCR = 0x10,
+    TPDU_CODE_DR = 0x18,
+    TPDU_CODE_DT = 0x1b,
+    HDLC_CMD_UI = 0x03,
+    NFRAMES_PER_SEC = 1000000 / (FRAME_LEN * TETRAPOL_BIT_USEC),
+};
+
+typedef struct {
+    uint8_t nblocks;
+    int16_t codop;      ///< TSDU completed by this HDLC frame or CODOP_NONE
+    uint8_t data[HDLC_BYTES_MAX];
+} hdlc_buf_t;
+
+typedef struct {
+    addr_t addrs[ADDR_QUEUE_LEN];
+    int head;
+    int len;
+} addr_queue_t;
+
+typedef struct {
+    uint8_t data[SYS_PAR_DATA_FRAME_BLOCKS_MAX * 8];
+    int nblocks;
+    int nframes;    ///< data blocks + parity block for multiblock frame
+    int fr_no;      ///< next frame to send
+    int16_t codop;
+} tx_frame_t;
+
+struct swmi_sim_priv_t {
+    swmi_sim_cfg_t cfg;
+    uint32_t rand;
+    /// terminals in cell are first .. first + nterminals - 1 modulo
+    /// NTERMINALS_MAX, churn moves the window to new addresses
+    int first;
+    int nterminals;
+    uint8_t *v_s;           ///< N(S) of next I frame, for each address
+    hdlc_buf_t *queue;
+    int queue_head;
+    addr_queue_t pages;
+    addr_queue_t acks;
+    tx_frame_t bch;
+    tx_frame_t sdch;
+    uint8_t seg_ref;
+    uint16_t msg_ref;
+    uint16_t superframe_cpt;
+    swmi_sim_stats_t stats;
+};
+
+/// number of arrivals in single frame for mean rate per second
+static int rand_arrivals(uint32_t *state, double rate)
+{
+    const double n = rate / NFRAMES_PER_SEC;
+    int r = n;
+    if (rand_unit(state) < n - r) {
+        ++r;
+    }
+
+    return r;
+}
+
+swmi_sim_t *swmi_sim_create(const swmi_sim_cfg_t *cfg)
+{
+    if (cfg->nterminals < 1 || cfg->nterminals > NTERMINALS_MAX) {
+        LOG(ERR, "invalid number of terminals %d", cfg->nterminals);
+        return NULL;
+    }
+    if (!rate_is_valid(cfg->reg_rate, RATE_MAX) || !rate_is_valid(cfg->call_rate, RATE_MAX) ||
+            !rate_is_valid(cfg->ui_data_rate, RATE_MAX) ||
+            !rate_is_valid(cfg->co_data_rate, RATE_MAX) ||
+            !rate_is_valid(cfg->churn_rate, RATE_MAX)) {
+        LOG(ERR, "invalid message rate");
+        return NULL;
+    }
+    if (cfg->data_len && (cfg->data_len < DATA_LEN_MIN ||
+                cfg->data_len > DATA_LEN_MAX)) {
+        LOG(ERR, "invalid data length %d", cfg->data_len);
+        return NULL;
+    }
+
+    swmi_sim_t *sim = calloc(1, sizeof(swmi_sim_t));
+    if (!sim) {
+        return NULL;
+    }
+
+    sim->v_s = calloc(NTERMINALS_MAX, sizeof(sim->v_s[0]));
+    sim->queue = malloc(QUEUE_LEN * sizeof(hdlc_buf_t));
+    if (!sim->v_s || !sim->queue) {
+        free(sim->v_s);
+        free(sim->queue);
+        free(sim);
+        return NULL;
+    }
+
+    memcpy(&sim->cfg, cfg, sizeof(sim->cfg));
+    if (!sim->cfg.data_len) {
+        sim->cfg.data_len = DATA_LEN_DEFAULT;
+    }
+    sim->rand = cfg->seed ? cfg->seed : SEED_DEFAULT;
+    sim->nterminals = cfg->nterminals;
+    sim->stats.nterminals = cfg->nterminals;
+
+    return sim;
+}
+
+void swmi_sim_destroy(swmi_sim_t *sim)
+{
+    if (!sim) {
+        return;
+    }
+
+    free(sim->v_s);
+    free(sim->queue);
+    free(sim);
+}
+
+int swmi_sim_set_nterminals(swmi_sim_t *sim, int nterminals)
+{
+    if (nterminals < 1 || nterminals > NTERMINALS_MAX) {
+        LOG(ERR, "invalid number of terminals %d", nterminals);
+        return -1;
+    }
+
+    // joining terminals start with fresh link state
+    for (int i = sim->nterminals; i < nterminals; ++i) {
+        sim->v_s[(sim->first + i) % NTERMINALS_MAX] = 0;
+    }
+    sim->nterminals = nterminals;
+    sim->stats.nterminals = nterminals;
+
+    return 0;
+}
+
+void swmi_sim_get_stats(const swmi_sim_t *sim, swmi_sim_stats_t *stats)
+{
+    memcpy(stats, &sim->stats, sizeof(*stats));
+}
+
+/// random terminal from those currently in cell
+static int terminal_pick(swmi_sim_t *sim)
+{
+    return (sim->first + rand_next(&sim->rand) % sim->nterminals) %
+        NTERMINALS_MAX;
+}
+
+static void terminal_addr(addr_t *addr, int idx)
+{
+    addr->z = 0;
+    addr->y = 1 + idx / 0xfff;
+    addr->x = 1 + idx % 0xfff;
+}
+
+static void addr_write(uint8_t *buf, const addr_t *addr)
+{
+    buf[0] = (addr->z << 7) | (addr->y << 4) | (addr->x >> 8);
+    buf[1] = addr->x;
+}
+
+static const addr_t addr_tti_no_st = { .z = 0, .y = 7, .x = 0, };
+static const addr_t addr_tti_all_st = { .z = 0, .y = 7, .x = 0xfff, };
+
+/// RFSI address (PAS 0001-3-2 6.2.5) of terminal, 5 bytes
+static void rfsi_write(uint8_t *buf, int idx)
+{
+    addr_t addr;
+    terminal_addr(&addr, idx);
+    const uint8_t nibbles[9] = {
+        1, 2, 3,    // R
+        0,          // F
+        0, addr.y,  // S
+        (addr.x >> 8) & 0xf, (addr.x >> 4) & 0xf, addr.x & 0xf,    // I
+    };
+
+    buf[0] = (ADDRESS_CNA_RFSI << 4) | nibbles[0];
+    for (int i = 1; i < ARRAY_LEN(nibbles); i += 2) {
+        buf[(i + 1) / 2] = (nibbles[i] << 4) | nibbles[i + 1];
+    }
+}
+
+static void addr_queue_push(addr_queue_t *q, const addr_t *addr)
+{
+    // SwMI would retry later, the address is just not sent
+    if (q->len == ADDR_QUEUE_LEN) {
+        return;
+    }
+    memcpy(&q->addrs[(q->head + q->len) % ADDR_QUEUE_LEN], addr,
+            sizeof(*addr));
+    ++q->len;
+}
+
+static bool addr_queue_pop(addr_queue_t *q, addr_t *addr)
+{
+    if (!q->len) {
+        return false;
+    }
+    memcpy(addr, &q->addrs[q->head], sizeof(*addr));
+    q->head = (q->head + 1) % ADDR_QUEUE_LEN;
+    --q->len;
+
+    return true;
+}
+
+/// compose HDLC frame aligned to data blocks, payload must fit into frame
+static int mk_hdlc(uint8_t *buf, const addr_t *addr, uint8_t cmd,
+        const uint8_t *payload, int len)
+{
+    const int nblocks = (3 + len + 2 + 7) / 8;
+
+    memset(buf, 0, nblocks * 8);
+    addr_write(buf, addr);
+    buf[2] = cmd;
+    memcpy(&buf[3], payload, len);
+    set_fcs(buf, nblocks * 8 * 8);
+
+    return nblocks;
+}
+
+static int queue_free(const swmi_sim_t *sim)
+{
+    return QUEUE_LEN - sim->stats.queue_len;
+}
+
+static void enqueue(swmi_sim_t *sim, const addr_t *addr, uint8_t cmd,
+        const uint8_t *payload, int len, int codop)
+{
+    const int idx = (sim->queue_head + sim->stats.queue_len) % QUEUE_LEN;
+    hdlc_buf_t *buf = &sim->queue[idx];
+
+    buf->nblocks = mk_hdlc(buf->data, addr, cmd, payload, len);
+    buf->codop = codop;
+    ++sim->stats.queue_len;
+}
+
+/// enqueue I frame carrying TPDU (PAS 0001-3-3 9.4), TSDU might be NULL
+static void enqueue_tpdu(swmi_sim_t *sim, int term, bool seg, bool d,
+        int code, int ref, const uint8_t *tsdu, int len, int codop)
+{
+    uint8_t tpdu[HDLC_BYTES_MAX];
+    tpdu[0] = (seg << 6) | (d << 5) | code;
+    tpdu[1] = (ref << 4) | ref;
+    int n = 2;
+    if (!seg && d) {
+        tpdu[n++] = len;
+    }
+    if (len) {
+        memcpy(&tpdu[n], tsdu, len);
+    }
+
+    addr_t addr;
+    terminal_addr(&addr, term);
+    // N(R) is not checked by decoder, uplink is not simulated
+    const uint8_t cmd = (sim->v_s[term] & 7) << 1;
+    sim->v_s[term] = (sim->v_s[term] + 1) % 8;
+    enqueue(sim, &addr, cmd, tpdu, n + len, codop);
+}
+
+static void fill_random(swmi_sim_t *sim, uint8_t *data, int len)
+{
+    for (int i = 0; i < len; ++i) {
+        data[i] = rand_next(&sim->rand);
+    }
+}
+
+static bool transaction_begin(swmi_sim_t *sim, int nframes)
+{
+    if (queue_free(sim) < nframes) {
+        ++sim->stats.dropped;
+        return false;
+    }
+
+    return true;
+}
+
+static void mk_registration(swmi_sim_t *sim, int term)
+{
+    if (!transaction_begin(sim, 2)) {
+        return;
+    }
+
+    addr_t addr;
+    terminal_addr(&addr, term);
+    addr_queue_push(&sim->acks, &addr);
+
+    uint8_t tsdu[14];
+    memset(tsdu, 0, sizeof(tsdu));
+    tsdu[0] = D_REGISTRATION_ACK;
+    tsdu[1] = 1;    // complete_reg
+    rfsi_write(&tsdu[4], term);
+    enqueue_tpdu(sim, term, false, true, TPDU_CODE_FCR, TSAP_REF_REG,
+            tsdu, sizeof(tsdu), D_REGISTRATION_ACK);
+    enqueue_tpdu(sim, term, false, false, TPDU_CODE_DR, TSAP_REF_REG,
+            NULL, 0, CODOP_NONE);
+}
+
+static void mk_call(swmi_sim_t *sim, int term)
+{
+    if (!transaction_begin(sim, 3)) {
+        return;
+    }
+
+    addr_t addr;
+    terminal_addr(&addr, term);
+    addr_queue_push(&sim->pages, &addr);
+
+    // calling party is another terminal in cell
+    uint8_t tsdu[6];
+    tsdu[0] = D_CALL_SETUP;
+    rfsi_write(&tsdu[1], terminal_pick(sim));
+    enqueue_tpdu(sim, term, false, true, TPDU_CODE_FCR, TSAP_REF_CALL,
+            tsdu, sizeof(tsdu), D_CALL_SETUP);
+
+    const int channel_id = rand_next(&sim->rand) & 0xfff;
+    tsdu[0] = D_CONNECT_DCH;
+    tsdu[1] = 0;    // dch_low_layer
+    tsdu[2] = channel_id >> 8;
+    tsdu[3] = channel_id;
+    tsdu[4] = rand_next(&sim->rand) & 0x7f;
+    tsdu[5] = rand_next(&sim->rand) & 0x7f;
+    enqueue_tpdu(sim, term, false, true, TPDU_CODE_DT, TSAP_REF_CALL,
+            tsdu, sizeof(tsdu), D_CONNECT_DCH);
+    enqueue_tpdu(sim, term, false, false, TPDU_CODE_DR, TSAP_REF_CALL,
+            NULL, 0, CODOP_NONE);
+}
+
+/// D_DATAGRAM as segmented UI DU (PAS 0001-3-3 9.5.1.3)
+static void mk_ui_data(swmi_sim_t *sim, int term)
+{
+    const int len = sim->cfg.data_len;
+    // the last segment carries length, so it has one byte less
+    const int nsegs = len / UI_SEG_LEN + 1;
+    if (!transaction_begin(sim, nsegs)) {
+        return;
+    }
+
+    uint8_t tsdu[DATA_LEN_MAX];
+    tsdu[0] = D_DATAGRAM;
+    tsdu[1] = 0;    // prio
+    tsdu[2] = sim->msg_ref;
+    tsdu[3] = sim->msg_ref >> 8;
+    tsdu[4] = 0;    // key_reference
+    fill_random(sim, &tsdu[5], len - 5);
+    ++sim->msg_ref;
+
+    addr_t addr;
+    terminal_addr(&addr, term);
+    const uint8_t seg_ref = sim->seg_ref;
+    sim->seg_ref = (sim->seg_ref + 1) % 128;
+
+    for (int i = 0; i < nsegs; ++i) {
+        const bool last = (i == nsegs - 1);
+        const int seg_len = last ? (len - i * UI_SEG_LEN) : UI_SEG_LEN;
+        uint8_t du[HDLC_BYTES_MAX];
+        int n = 0;
+        du[n++] = 0x80 | (last ? 0 : 0x40) | ID_TSAP;
+        du[n++] = 0x80 | seg_ref;
+        du[n++] = i;    // packet_num
+        if (last) {
+            du[n++] = seg_len;
+        }
+        memcpy(&du[n], &tsdu[i * UI_SEG_LEN], seg_len);
+        enqueue(sim, &addr, HDLC_CMD_UI, du, n + seg_len,
+                last ? D_DATAGRAM : CODOP_NONE);
+    }
+}
+
+/// D_DATA_MSG_DOWN sent over fast connection as segmented DT TPDUs
+static void mk_co_data(swmi_sim_t *sim, int term)
+{
+    const int len = sim->cfg.data_len;
+    // the last DT is not segmented, it carries length and the rest of data
+    const int nsegs = len / DT_SEG_LEN;
+    if (!transaction_begin(sim, nsegs + 3)) {
+        return;
+    }
+
+    uint8_t tsdu[DATA_LEN_MAX];
+    tsdu[0] = D_DATA_MSG_DOWN;
+    fill_random(sim, &tsdu[1], len - 1);
+
+    enqueue_tpdu(sim, term, false, false, TPDU_CODE_FCR, TSAP_REF_DATA,
+            NULL, 0, CODOP_NONE);
+    for (int i = 0; i < nsegs; ++i) {
+        enqueue_tpdu(sim, term, true, true, TPDU_CODE_DT, TSAP_REF_DATA,
+                &tsdu[i * DT_SEG_LEN], DT_SEG_LEN, CODOP_NONE);
+    }
+    enqueue_tpdu(sim, term, false, true, TPDU_CODE_DT, TSAP_REF_DATA,
+            &tsdu[nsegs * DT_SEG_LEN], len - nsegs * DT_SEG_LEN,
+            D_DATA_MSG_DOWN);
+    enqueue_tpdu(sim, term, false, false, TPDU_CODE_DR, TSAP_REF_DATA,
+            NULL, 0, CODOP_NONE);
+}
+
+/// the oldest terminal leaves cell and new one joins
+static void mk_churn(swmi_sim_t *sim)
+{
+    sim->v_s[(sim->first + sim->nterminals) % NTERMINALS_MAX] = 0;
+    sim->first = (sim->first + 1) % NTERMINALS_MAX;
+    ++sim->stats.churned;
+}
+
+static void mk_transactions(swmi_sim_t *sim)
+{
+    const swmi_sim_cfg_t *cfg = &sim->cfg;
+    uint32_t *r = &sim->rand;
+
+    for (int n = rand_arrivals(r, cfg->reg_rate); n; --n) {
+        mk_registration(sim, terminal_pick(sim));
+    }
+    for (int n = rand_arrivals(r, cfg->call_rate); n; --n) {
+        mk_call(sim, terminal_pick(sim));
+    }
+    for (int n = rand_arrivals(r, cfg->ui_data_rate); n; --n) {
+        mk_ui_data(sim, terminal_pick(sim));
+    }
+    for (int n = rand_arrivals(r, cfg->co_data_rate); n; --n) {
+        mk_co_data(sim, terminal_pick(sim));
+    }
+    if (cfg->churn_rate) {
+        for (int n = rand_arrivals(r, cfg->churn_rate); n; --n) {
+            mk_churn(sim);
+        }
+    }
+}
+
+static void tx_frame_init(tx_frame_t *tx, const uint8_t *data, int nblocks,
+        int codop)
+{
+    memcpy(tx->data, data, nblocks * 8);
+    tx->nblocks = nblocks;
+    tx->nframes = (nblocks > 2) ? nblocks + 1 : nblocks;
+    tx->fr_no = 0;
+    tx->codop = codop;
+}
+
+/// FN of frame in data frame sequence, see data_frame_push_frame()
+static int tx_frame_fn(const tx_frame_t *tx)
+{
+    enum {
+        FN_00 = 0,
+        FN_01 = 1,
+        FN_10 = 2,
+        FN_11 = 3,
+    };
+
+    if (tx->nframes == 1) {
+        return FN_00;
+    }
+    if (tx->nframes == 2) {
+        return tx->fr_no ? FN_11 : FN_01;
+    }
+    if (tx->fr_no == 0 || tx->fr_no == tx->nframes - 1) {
+        return FN_01;
+    }
+    if (tx->fr_no == 1 || tx->fr_no == tx->nframes - 2) {
+        return FN_10;
+    }
+
+    return FN_11;
+}
+
+/// emit next frame of data frame sequence, return true for the last one
+static bool tx_frame_next(tx_frame_t *tx, frame_t *fr)
+{
+    memset(fr, 0, sizeof(*fr));
+    fr->fr_type = FRAME_TYPE_DATA;
+
+    const int fn = tx_frame_fn(tx);
+    fr->data.data[0] = fn & 1;
+    fr->data.data[1] = fn >> 1;
+
+    if (tx->fr_no < tx->nblocks) {
+        const uint8_t *block = &tx->data[8 * tx->fr_no];
+        for (int i = 0; i < 64; ++i) {
+            fr->data.data[2 + i] = (block[i / 8] >> (i % 8)) & 1;
+        }
+    } else {
+        // parity block, XOR of all data blocks
+        for (int i = 0; i < 64; ++i) {
+            uint8_t p = 0;
+            for (int j = 0; j < tx->nblocks; ++j) {
+                p ^= tx->data[8 * j + i / 8] >> (i % 8);
+            }
+            fr->data.data[2 + i] = p & 1;
+        }
+    }
+
+    return ++tx->fr_no == tx->nframes;
+}
+
+/// D_SYSTEM_INFO (PAS 0001-3-2 5.3.47) in UI DU, cell in normal mode
+static void mk_bch(swmi_sim_t *sim, bool second_half)
+{
+    uint8_t du[2 + 17];
+    uint8_t *tsdu = &du[2];
+    memset(du, 0, sizeof(du));
+    du[0] = ID_TSAP;
+    du[1] = 17;
+
+    tsdu[0] = D_SYSTEM_INFO;
+    tsdu[1] = second_half << 4; // cell_state: bch, mode normal
+    tsdu[2] = 0;                // cell_config: default CCH mux
+    tsdu[3] = 0x21;             // country_code
+    tsdu[4] = 0x12;             // system_id
+    tsdu[5] = 0x34;             // loc_area_id
+    tsdu[6] = 0x01;             // bn_id
+    tsdu[7] = 0x05;             // cell_id, format 0
+    tsdu[8] = 0x30;
+    tsdu[9] = 0x42;
+    tsdu[10] = 0x11;            // u_ch_scrambling
+    tsdu[15] = (sim->superframe_cpt >> 8) & 0xf;
+    tsdu[16] = sim->superframe_cpt;
+
+    uint8_t buf[HDLC_BYTES_MAX];
+    const int nblocks = mk_hdlc(buf, &addr_tti_all_st, HDLC_CMD_UI,
+            du, sizeof(du));
+    tx_frame_init(&sim->bch, buf, nblocks, D_SYSTEM_INFO);
+}
+
+static void mk_pch(swmi_sim_t *sim)
+{
+    uint8_t buf[2 * 8];
+    memset(buf, 0, 8);  // activation bitmap
+
+    int naddrs = 0;
+    for (int i = 0; i < 4; ++i) {
+        addr_t addr;
+        if (addr_queue_pop(&sim->pages, &addr)) {
+            ++naddrs;
+        } else {
+            memcpy(&addr, &addr_tti_no_st, sizeof(addr));
+        }
+        addr_write(&buf[8 + 2 * i], &addr);
+    }
+    ++sim->stats.pch_blocks;
+    sim->stats.pages += naddrs;
+
+    tx_frame_init(&sim->sdch, buf, 2, CODOP_NONE);
+}
+
+static void mk_rch(swmi_sim_t *sim)
+{
+    uint8_t buf[8];
+
+    int naddrs = 0;
+    for (int i = 0; i < 3; ++i) {
+        addr_t addr;
+        if (addr_queue_pop(&sim->acks, &addr)) {
+            ++naddrs;
+        } else {
+            memcpy(&addr, &addr_tti_no_st, sizeof(addr));
+        }
+        addr_write(&buf[2 * i], &addr);
+    }
+    ++sim->stats.rch_blocks;
+    sim->stats.acks += naddrs;
+    set_fcs(buf, 8 * 8);
+
+    tx_frame_init(&sim->sdch, buf, 1, CODOP_NONE);
+}
+
+/// stuffing frame (PAS 0001-3-3 7.4.1.9), FCS is replaced by pattern
+static void mk_stuffing(swmi_sim_t *sim)
+{
+    static const uint8_t stuffing[8] = {
+        0x70, 0x00, HDLC_CMD_UI, 0x48, 0x57, 0x63, 0xe6, 0x90,
+    };
+
+    tx_frame_init(&sim->sdch, stuffing, 1, CODOP_NONE);
+    ++sim->stats.stuffing;
+}
+
+static bool fn_is_sdch(int fn_mod)
+{
+    return fn_mod > 3 && fn_mod < 98 && (fn_mod % 25) != 14;
+}
+
+static void sdch_next_hdlc(swmi_sim_t *sim, int fn_mod)
+{
+    // multiblock frame must not be interrupted by other logical channel
+    int nslots = 0;
+    while (fn_is_sdch(fn_mod + nslots)) {
+        ++nslots;
+    }
+
+    if (!sim->stats.queue_len) {
+        mk_stuffing(sim);
+        return;
+    }
+
+    const hdlc_buf_t *buf = &sim->queue[sim->queue_head];
+    const int nframes = (buf->nblocks > 2) ? buf->nblocks + 1 : buf->nblocks;
+    if (nframes > nslots) {
+        mk_stuffing(sim);
+        return;
+    }
+
+    tx_frame_init(&sim->sdch, buf->data, buf->nblocks, buf->codop);
+    sim->queue_head = (sim->queue_head + 1) % QUEUE_LEN;
+    --sim->stats.queue_len;
+    ++sim->stats.hdlc_frames;
+}
+
+void swmi_sim_frame(swmi_sim_t *sim, frame_t *fr)
+{
+    const int frame_no = sim->stats.frames % 200;
+    const int fn_mod = frame_no % 100;
+
+    mk_transactions(sim);
+
+    tx_frame_t *tx = &sim->sdch;
+    if (fn_mod <= 3) {
+        if (fn_mod == 0) {
+            if (!frame_no) {
+                sim->superframe_cpt = (sim->superframe_cpt + 1) & 0xfff;
+            }
+            mk_bch(sim, frame_no == 100);
+        }
+        tx = &sim->bch;
+    } else if (fn_mod == 98) {
+        mk_pch(sim);
+    } else if (fn_mod % 25 == 14) {
+        mk_rch(sim);
+    } else if (fn_is_sdch(fn_mod) && sim->sdch.fr_no == sim->sdch.nframes) {
+        sdch_next_hdlc(sim, fn_mod);
+    }
+
+    if (tx_frame_next(tx, fr) && tx->codop != CODOP_NONE) {
+        ++sim->stats.tsdus[tx->codop];
+    }
+    ++sim->stats.frames;
+}
+
+int swmi_sim_bits(swmi_sim_t *sim, frame_encoder_t *fe, uint8_t *bits)
+{
+    frame_t fr;
+    uint8_t fr_data[FRAME_LEN / 8];
+
+    swmi_sim_frame(sim, &fr);
+    if (frame_encoder_encode(fe, fr_data, &fr)) {
+        LOG(ERR, "frame encoding failed");
+        return -1;
+    }
+    for (int i = 0; i < FRAME_LEN; ++i) {
+        bits[i] = (fr_data[i / 8] >> (i % 8)) & 1;
+    }
+
+    return 0;
+}
@@ -7,7 +7,6 @@
 struct tch_priv_t {
     sdch_t *sch;
     sdch_t *vch;
-    bool rx_glitch;
     tpol_t *tpol;
     // sch_ti;
 };
@@ -19,8 +18,6 @@ tch_t *tch_create(tpol_t *tpol)
         return NULL;
     }
 
-    tch->rx_glitch = false;
-
     tch->sch = sdch_create(tpol);
     if (!tch->sch) {
         free(tch);
@@ -52,7 +49,7 @@ int tch_push_frame(tch_t *tch, const frame_t *fr)
 {
     if (fr->broken) {
         LOG(INFO, "Broken frame");
-        tch->rx_glitch = true;
+        tch_rx_glitch(tch);
         return -1;
     }
 
@@ -63,7 +60,7 @@ int tch_push_frame(tch_t *tch, const frame_t *fr)
 
     if (fr->fr_type != FRAME_TYPE_DATA) {
         LOG(WTF, "not a data frame");
-        tch->rx_glitch = true;
+        tch_rx_glitch(tch);
         return -1;
     }
 
@@ -76,7 +73,7 @@ int tch_push_frame(tch_t *tch, const frame_t *fr)
 
     if (fr->fr_type != FRAME_TYPE_DATA) {
         LOG(WTF, "data block expected");
-        tch->rx_glitch = true;
+        tch_rx_glitch(tch);
         return -1;
     }
 
@@ -85,10 +82,23 @@ int tch_push_frame(tch_t *tch, const frame_t *fr)
     return 0;
 }
 
-void tch_tick(time_evt_t *te, void *tch_)
+int tch_push_hdlc_frame(tch_t *tch, const hdlc_frame_t *hdlc_fr)
+{
+    return sdch_push_hdlc_frame(tch->sch, hdlc_fr) ? 0 : -1;
+}
+
+void tch_rx_glitch(tch_t *tch)
+{
+    sdch_rx_glitch(tch->sch);
+}
+
+void tch_save(const tch_t *tch, snapshot_t *snap)
+{
+    sdch_save(tch->sch, snap);
+    sdch_save(tch->vch, snap);
+}
+
+bool tch_load(tch_t *tch, snapshot_t *snap)
 {
-    tch_t *tch = tch_;
-    te->rx_glitch |= tch->rx_glitch;
-    tch->rx_glitch = false;
-    sdch_tick(te, tch->sch);
+    return sdch_load(tch->sch, snap) && sdch_load(tch->vch, snap);
 }
@@ -3,33 +3,63 @@
 #include <tetrapol/log.h>
 #include <tetrapol/terminal.h>
 #include <tetrapol/link.h>
+#include <tetrapol/pool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
 
 struct terminal_priv_t {
+    addr_t addr;            ///< key in terminal_list_t.tree
     link_t *link;
+    tpol_t *tpol;
+    unsigned rx_glitch;     ///< last seen value of terminal_list_t.rx_glitch
+    uint64_t last_rx;       ///< time of last received HDLC frame (us)
+    // LRU list, most recently used terminal is the first one
+    terminal_t *lru_prev;
+    terminal_t *lru_next;
 };
 
 struct terminal_list_priv_t {
     GTree *tree;
     tpol_t *tpol;
     int log_ch;
+    unsigned rx_glitch;     ///< incremented for each RX glitch
+    unsigned nterminals;
+    terminal_t *lru_first;
+    terminal_t *lru_last;
+    tp_timer_entry_t idle_timer;    ///< armed for idle timeout of lru_last
 };
 
-static terminal_t* terminal_create(tpol_t *tpol, int log_ch)
+bool terminal_pools_create(tpol_t *tpol)
+{
+    tpol->terminal_pool = pool_create("terminal", sizeof(terminal_t));
+
+    return tpol->terminal_pool != NULL;
+}
+
+void terminal_pools_destroy(tpol_t *tpol)
 {
-    terminal_t *term = malloc(sizeof(terminal_t));
+    pool_destroy(tpol->terminal_pool);
+    tpol->terminal_pool = NULL;
+}
+
+static terminal_t* terminal_create(tpol_t *tpol, int log_ch, unsigned rx_glitch)
+{
+    terminal_t *term = pool_alloc(tpol->terminal_pool);
     if (!term) {
         return NULL;
     }
 
     term->link = link_create(tpol, log_ch);
     if (!term->link) {
-        free(term);
+        pool_free(tpol->terminal_pool, term);
         return NULL;
     }
+    term->tpol = tpol;
+    term->rx_glitch = rx_glitch;
+    term->lru_prev = NULL;
+    term->lru_next = NULL;
 
     return term;
 }
@@ -41,7 +71,7 @@ static void terminal_destroy(terminal_t *term)
     }
 
     link_destroy(term->link);
-    free(term);
+    pool_free(term->tpol->terminal_pool, term);
 }
 
 static inline void terminal_destroy_(gpointer term)
@@ -54,11 +84,6 @@ int terminal_push_hdlc_frame(terminal_t* term, const hdlc_frame_t *hdlc_fr)
     return link_push_hdlc_frame(term->link, hdlc_fr);
 }
 
-static inline void addr_free(gpointer data)
-{
-    free(data);
-}
-
 static gint addr_cmp(gconstpointer _a1, gconstpointer _a2, gpointer user_data)
 {
     const addr_t *a1 = _a1;
@@ -73,6 +98,80 @@ static gint addr_cmp(gconstpointer _a1, gconstpointer _a2, gpointer user_data)
     return a2->x - a1->x;
 }
 
+static void lru_unlink(terminal_list_t *tlist, terminal_t *term)
+{
+    if (term->lru_prev) {
+        term->lru_prev->lru_next = term->lru_next;
+    } else {
+        tlist->lru_first = term->lru_next;
+    }
+    if (term->lru_next) {
+        term->lru_next->lru_prev = term->lru_prev;
+    } else {
+        tlist->lru_last = term->lru_prev;
+    }
+    term->lru_prev = NULL;
+    term->lru_next = NULL;
+}
+
+static void lru_push_front(terminal_list_t *tlist, terminal_t *term)
+{
+    term->lru_prev = NULL;
+    term->lru_next = tlist->lru_first;
+    if (tlist->lru_first) {
+        tlist->lru_first->lru_prev = term;
+    } else {
+        tlist->lru_last = term;
+    }
+    tlist->lru_first = term;
+}
+
+static void terminal_list_remove(terminal_list_t *tlist, terminal_t *term)
+{
+    lru_unlink(tlist, term);
+    --tlist->nterminals;
+    --tlist->tpol->stats.terminals_live;
+    metric_sub(&tlist->tpol->metrics.terminals_live, 1);
+    // destroys terminal
+    g_tree_remove(tlist->tree, &term->addr);
+}
+
+static void terminal_list_arm_idle_timer(terminal_list_t *tlist)
+{
+    if (!tlist->lru_last) {
+        tp_timer_disarm(&tlist->idle_timer);
+        return;
+    }
+
+    const uint64_t timeout =
+        (uint64_t)tlist->tpol->cfg.terminal_idle_timeout * 1000000;
+    const uint64_t now = tp_timer_now(tlist->tpol->tp_timer);
+    const uint64_t expires = tlist->lru_last->last_rx + timeout;
+    tp_timer_arm(tlist->tpol->tp_timer, &tlist->idle_timer,
+            expires > now ? expires - now : 0);
+}
+
+static void terminal_list_idle_expired(time_evt_t *te, void *ptr)
+{
+    terminal_list_t *tlist = ptr;
+
+    const uint64_t timeout =
+        (uint64_t)tlist->tpol->cfg.terminal_idle_timeout * 1000000;
+    const uint64_t now = tp_timer_now(tlist->tpol->tp_timer);
+
+    while (tlist->lru_last && tlist->lru_last->last_rx + timeout <= now) {
+        LOG_IF(DBG) {
+            char buf[ADDR_PRINT_BUF_SIZE];
+            LOG(DBG, "idle terminal dropped %s",
+                    addr_print(buf, &tlist->lru_last->addr));
+        }
+        ++tlist->tpol->stats.terminals_evicted_idle;
+        terminal_list_remove(tlist, tlist->lru_last);
+    }
+
+    terminal_list_arm_idle_timer(tlist);
+}
+
 terminal_list_t *terminal_list_create(tpol_t * tpol, int log_ch)
 {
     terminal_list_t *tlist = malloc(sizeof(terminal_list_t));
@@ -80,7 +179,8 @@ terminal_list_t *terminal_list_create(tpol_t * tpol, int log_ch)
         return NULL;
     }
 
-    tlist->tree = g_tree_new_full(addr_cmp, NULL, addr_free, terminal_destroy_);
+    // key is part of value, destroyed with terminal
+    tlist->tree = g_tree_new_full(addr_cmp, NULL, NULL, terminal_destroy_);
     if (!tlist->tree) {
         free(tlist);
         return NULL;
@@ -88,12 +188,24 @@ terminal_list_t *terminal_list_create(tpol_t * tpol, int log_ch)
 
     tlist->tpol = tpol;
     tlist->log_ch = log_ch;
+    tlist->rx_glitch = 0;
+    tlist->nterminals = 0;
+    tlist->lru_first = NULL;
+    tlist->lru_last = NULL;
+    tp_timer_entry_init(&tlist->idle_timer, terminal_list_idle_expired, tlist);
 
     return tlist;
 }
 
 void terminal_list_destroy(terminal_list_t *tlist)
 {
+    if (!tlist) {
+        return;
+    }
+
+    tp_timer_disarm(&tlist->idle_timer);
+    tlist->tpol->stats.terminals_live -= tlist->nterminals;
+    metric_sub(&tlist->tpol->metrics.terminals_live, tlist->nterminals);
     g_tree_destroy(tlist->tree);
     free(tlist);
 }
@@ -105,26 +217,49 @@ terminal_t* terminal_list_lookup(const terminal_list_t* tlist, const addr_t *add
 
 terminal_t* terminal_list_insert(terminal_list_t* tlist, const addr_t *addr)
 {
-    terminal_t *term = terminal_create(tlist->tpol, tlist->log_ch);
-    if (!term) {
-        return NULL;
+    terminal_t *term = terminal_list_lookup(tlist, addr);
+    if (term) {
+        return term;
+    }
+
+    if (tlist->nterminals >= tlist->tpol->cfg.terminals_max &&
+            tlist->lru_last) {
+        LOG_IF(DBG) {
+            char buf[ADDR_PRINT_BUF_SIZE];
+            LOG(DBG, "too many terminals, dropping %s",
+                    addr_print(buf, &tlist->lru_last->addr));
+        }
+        ++tlist->tpol->stats.terminals_evicted_lru;
+        terminal_list_remove(tlist, tlist->lru_last);
     }
 
-    addr_t *addr_new = malloc(sizeof(addr_t));
-    if (!addr_new) {
-        terminal_destroy(term);
+    term = terminal_create(tlist->tpol, tlist->log_ch, tlist->rx_glitch);
+    if (!term) {
         return NULL;
     }
-    memcpy(addr_new, addr, sizeof(addr_t));
 
-    g_tree_insert(tlist->tree, addr_new, term);
+    memcpy(&term->addr, addr, sizeof(addr_t));
+    term->last_rx = tp_timer_now(tlist->tpol->tp_timer);
+    g_tree_insert(tlist->tree, &term->addr, term);
+    lru_push_front(tlist, term);
+    ++tlist->nterminals;
+    ++tlist->tpol->stats.terminals_live;
+    metric_inc(&tlist->tpol->metrics.terminals_live);
+    ++tlist->tpol->stats.terminals_created;
+
+    if (!tp_timer_is_armed(&tlist->idle_timer)) {
+        terminal_list_arm_idle_timer(tlist);
+    }
 
     return term;
 }
 
 void terminal_list_erase(terminal_list_t* tlist, const addr_t *addr)
 {
-    g_tree_remove(tlist->tree, addr);
+    terminal_t *term = terminal_list_lookup(tlist, addr);
+    if (term) {
+        terminal_list_remove(tlist, term);
+    }
 }
 
 int terminal_list_push_hdlc_frame(terminal_list_t* tlist,
@@ -139,37 +274,62 @@ int terminal_list_push_hdlc_frame(terminal_list_t* tlist,
         }
     }
 
-    return terminal_push_hdlc_frame(term, hdlc_fr);
-}
-
-static gboolean terminal_rx_glitch(gpointer key, gpointer value,
-        gpointer data)
-{
-    terminal_t *term = value;
+    // idle timer is re-armed lazily when it expires
+    term->last_rx = tp_timer_now(tlist->tpol->tp_timer);
+    if (tlist->lru_first != term) {
+        lru_unlink(tlist, term);
+        lru_push_front(tlist, term);
+    }
 
-    link_rx_glitch(term->link);
+    if (term->rx_glitch != tlist->rx_glitch) {
+        term->rx_glitch = tlist->rx_glitch;
+        link_rx_glitch(term->link);
+    }
 
-    return false;
+    return terminal_push_hdlc_frame(term, hdlc_fr);
 }
 
 void terminal_list_rx_glitch(terminal_list_t* tlist)
 {
-    g_tree_foreach(tlist->tree, terminal_rx_glitch, NULL);
+    ++tlist->rx_glitch;
 }
 
-static gboolean terminal_tick(gpointer key, gpointer value,
-        gpointer data)
+void terminal_list_save(const terminal_list_t *tlist, snapshot_t *snap)
 {
-    terminal_t *term = value;
-    time_evt_t *te = data;
-
-    link_tick(te, term->link);
-
-    return false;
+    snapshot_put_u32(snap, tlist->rx_glitch);
+    snapshot_put_u32(snap, tlist->nterminals);
+    // the least recently used first, load pushes them to the front of LRU
+    for (const terminal_t *term = tlist->lru_last; term;
+            term = term->lru_prev) {
+        snapshot_put_u16(snap, addr_pack(&term->addr));
+        snapshot_put_u32(snap, term->rx_glitch);
+        snapshot_put_u64(snap, term->last_rx);
+        link_save(term->link, snap);
+    }
 }
 
-void terminal_list_tick(terminal_list_t* tlist, time_evt_t *te)
+bool terminal_list_load(terminal_list_t *tlist, snapshot_t *snap)
 {
-    g_tree_foreach(tlist->tree, terminal_tick, te);
-}
+    tlist->rx_glitch = snapshot_get_u32(snap);
+    const uint32_t nterminals = snapshot_get_u32(snap);
+    for (uint32_t i = 0; i < nterminals && !snap->err; ++i) {
+        const uint16_t a = snapshot_get_u16(snap);
+        const addr_t addr = {
+            .z = a >> 15,
+            .y = (a >> 12) & 0x7,
+            .x = a & 0xfff,
+        };
+        terminal_t *term = terminal_list_insert(tlist, &addr);
+        if (!term) {
+            return false;
+        }
+        term->rx_glitch = snapshot_get_u32(snap);
+        term->last_rx = snapshot_get_u64(snap);
+        if (!link_load(term->link, snap)) {
+            return false;
+        }
+    }
+    terminal_list_arm_idle_timer(tlist);
 
+    return !snap->err;
+}
@@ -0,0 +1,242 @@
+#include <tetrapol/arena.h>
+#include <tetrapol/msg_coding.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    BUF_SIZE = 1024,
+};
+
+static alignas(max_align_t) uint8_t buf[BUF_SIZE];
+
+static bool in_buf(const void *p)
+{
+    return (const uint8_t *)p >= buf && (const uint8_t *)p < buf + BUF_SIZE;
+}
+
+static void test_alloc(void **state)
+{
+    (void) state;   // unused
+
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+
+    uint8_t *p1 = arena_alloc(&arena, 1);
+    uint8_t *p2 = arena_alloc(&arena, 3);
+    uint8_t *p3 = arena_alloc(&arena, 0);
+    assert_non_null(p1);
+    assert_non_null(p2);
+    assert_non_null(p3);
+    assert_true(in_buf(p1) && in_buf(p2) && in_buf(p3));
+    assert_true(p1 + 1 <= p2 && p2 + 3 <= p3);
+    assert_int_equal(0, (uintptr_t)p1 % alignof(max_align_t));
+    assert_int_equal(0, (uintptr_t)p2 % alignof(max_align_t));
+    assert_int_equal(0, (uintptr_t)p3 % alignof(max_align_t));
+
+    // arena_free does nothing, memory is released by reset
+    *p1 = 0x11;
+    memset(p2, 0x22, 3);
+    arena_free(&arena, p1);
+    assert_int_equal(0x11, *p1);
+    arena_reset(&arena);
+    assert_int_equal(0, arena.used);
+    assert_true(p1 == arena_alloc(&arena, 1));
+}
+
+static void test_realloc(void **state)
+{
+    (void) state;   // unused
+
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+
+    // last allocation is resized in place
+    uint8_t *p1 = arena_realloc(&arena, NULL, 4);
+    assert_non_null(p1);
+    memcpy(p1, "abcd", 4);
+    assert_true(p1 == arena_realloc(&arena, p1, 100));
+    assert_true(p1 == arena_realloc(&arena, p1, 8));
+    memcpy(p1 + 4, "efgh", 4);
+
+    // other allocations are copied
+    uint8_t *p2 = arena_alloc(&arena, 16);
+    assert_non_null(p2);
+    memcpy(p2, "ABCDEFGH", 8);
+    uint8_t *p3 = arena_realloc(&arena, p1, 32);
+    assert_non_null(p3);
+    assert_true(p3 > p2);
+    assert_memory_equal("abcdefgh", p3, 8);
+
+    // shrinking copy preserves prefix only
+    uint8_t *p4 = arena_realloc(&arena, p2, 4);
+    assert_non_null(p4);
+    assert_true(p4 > p3);
+    assert_memory_equal("ABCD", p4, 4);
+}
+
+static void test_rewind(void **state)
+{
+    (void) state;   // unused
+
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+
+    uint8_t *p1 = arena_alloc(&arena, 10);
+    assert_non_null(p1);
+    const arena_mark_t mark = arena_mark(&arena);
+    uint8_t *p2 = arena_alloc(&arena, 10);
+    assert_non_null(arena_alloc(&arena, 10));
+
+    arena_rewind(&arena, mark);
+    assert_int_equal(mark, arena.used);
+    assert_true(p2 == arena_alloc(&arena, 20));
+
+    // allocation before mark is not the last one anymore, it is copied
+    uint8_t *p3 = arena_realloc(&arena, p1, 11);
+    assert_non_null(p3);
+    assert_true(p3 != p1);
+}
+
+static void test_overflow(void **state)
+{
+    (void) state;   // unused
+
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+
+    assert_null(arena_alloc(&arena, BUF_SIZE));
+    assert_int_equal(0, arena.used);
+    assert_null(arena_alloc(&arena, SIZE_MAX - 8));
+    assert_int_equal(0, arena.used);
+
+    // exhaust arena by small allocations
+    int n = 0;
+    while (arena_alloc(&arena, 8)) {
+        ++n;
+    }
+    assert_true(n > 0);
+    assert_true(arena.used <= arena.size);
+    const size_t used = arena.used;
+    assert_null(arena_alloc(&arena, 0));
+    assert_int_equal(used, arena.used);
+
+    // growing of last allocation fails, allocation is kept
+    arena_reset(&arena);
+    uint8_t *p = arena_alloc(&arena, 16);
+    assert_non_null(p);
+    memset(p, 0x5a, 16);
+    assert_null(arena_realloc(&arena, p, BUF_SIZE));
+    for (int i = 0; i < 16; ++i) {
+        assert_int_equal(0x5a, p[i]);
+    }
+    assert_true(p == arena_realloc(&arena, p, 32));
+}
+
+/// D_GROUP_LIST with 2 emergency cells and 3 talk groups
+static int mk_group_list(uint8_t *data)
+{
+    int len = 0;
+    data[len++] = D_GROUP_LIST;
+    data[len++] = 1 << 5;   // revision 1
+    data[len++] = 0;        // index_list
+
+    type_nb_t type_nb = {
+        .type = TYPE_NB_TYPE_EMERGENCY,
+        .number = 2,
+    };
+    data[len++] = type_nb._data;
+    for (int i = 0; i < type_nb.number; ++i) {
+        data[len++] = 0x40 | (i + 1);   // format 1 cell ID
+        data[len++] = 0x20;
+    }
+    type_nb.type = TYPE_NB_TYPE_TALK_GROUP;
+    type_nb.number = 3;
+    data[len++] = type_nb._data;
+    for (int i = 0; i < type_nb.number; ++i) {
+        data[len++] = 10 + i;   // coverage_id
+        data[len++] = 0;
+        data[len++] = 0x01;     // neighbouring cell 0x100 + i
+        data[len++] = i;
+    }
+    data[len++] = TYPE_NB_TYPE_END;
+
+    return len;
+}
+
+static void test_tsdu_decode(void **state)
+{
+    (void) state;   // unused
+
+    uint8_t data[64];
+    const int len = mk_group_list(data);
+
+    tsdu_t *tsdu_heap;
+    assert_int_equal(0, tsdu_decode(data, len, &tsdu_heap));
+    assert_non_null(tsdu_heap);
+    assert_false(tsdu_heap->in_arena);
+
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+    tsdu_t *tsdu;
+    assert_int_equal(0, tsdu_decode_arena(&arena, data, len, &tsdu));
+    assert_non_null(tsdu);
+    assert_true(tsdu->in_arena);
+    assert_int_equal(D_GROUP_LIST, tsdu->codop);
+
+    const tsdu_d_group_list_t *gl = (const tsdu_d_group_list_t *)tsdu;
+    const tsdu_d_group_list_t *gl_heap =
+        (const tsdu_d_group_list_t *)tsdu_heap;
+    assert_true(in_buf(gl) && in_buf(gl->emergency) && in_buf(gl->group));
+    assert_int_equal(2, gl->nemergency);
+    assert_int_equal(3, gl->ngroup);
+    assert_int_equal(0, gl->nopen);
+    assert_int_equal(gl_heap->nemergency, gl->nemergency);
+    assert_int_equal(gl_heap->ngroup, gl->ngroup);
+    for (int i = 0; i < gl->nemergency; ++i) {
+        assert_int_equal(gl_heap->emergency[i].cell_id.bs_id,
+                gl->emergency[i].cell_id.bs_id);
+        assert_int_equal(gl_heap->emergency[i].cell_id.rsw_id,
+                gl->emergency[i].cell_id.rsw_id);
+    }
+    for (int i = 0; i < gl->ngroup; ++i) {
+        assert_int_equal(10 + i, gl->group[i].coverage_id);
+        assert_int_equal(0x100 + i, gl->group[i].neighbouring_cell);
+    }
+
+    // destroy does nothing for TSDU in arena, rewind releases it
+    const size_t used = arena.used;
+    tsdu_destroy(tsdu);
+    assert_int_equal(used, arena.used);
+    arena_rewind(&arena, 0);
+    tsdu_t *tsdu2;
+    assert_int_equal(0, tsdu_decode_arena(&arena, data, len, &tsdu2));
+    assert_true(tsdu == tsdu2);
+    assert_int_equal(used, arena.used);
+
+    // arena too small for lists, TSDU is not decoded
+    arena_init(&arena, buf, used - 1);
+    assert_int_equal(0, tsdu_decode_arena(&arena, data, len, &tsdu));
+    assert_null(tsdu);
+
+    tsdu_destroy(tsdu_heap);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_alloc),
+        unit_test(test_realloc),
+        unit_test(test_rewind),
+        unit_test(test_overflow),
+        unit_test(test_tsdu_decode),
+    };
+
+    return run_tests(tests);
+}
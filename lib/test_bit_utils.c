@@ -1,6 +1,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
+#include <string.h>
 #include <cmocka.h>
 
 // include, we are testing static methods
@@ -43,10 +44,35 @@ static void test_check_fcs(void **state)
     }
 }
 
+/// FCS computed by set_fcs() must match the known good ones
+static void test_set_fcs(void **state)
+{
+    (void) state;   // unused
+
+    const uint8_t exp[] = {
+        0x7f, 0xff, 0x03, 0x00, 0x11, 0x90, 0x03, 0x60,
+        0x02, 0x16, 0x00, 0x0a, 0x00, 0x01, 0x01, 0x47,
+        0x00, 0x83, 0xf5, 0x00, 0x04, 0xdf, 0xa8, 0x26,
+    };
+    uint8_t in[sizeof(exp)];
+    memcpy(in, exp, sizeof(in));
+    in[sizeof(in) - 2] = in[sizeof(in) - 1] = 0x55;
+
+    set_fcs(in, sizeof(in) * 8);
+    assert_memory_equal(exp, in, sizeof(in));
+
+    for (int i = 0; i < 64; ++i) {
+        in[i % 8] ^= 1 << (i % 7);
+        set_fcs(in, 8 * 8);
+        assert_true(check_fcs(in, 8 * 8));
+    }
+}
+
 int main(void)
 {
     const UnitTest tests[] = {
         unit_test(test_check_fcs),
+        unit_test(test_set_fcs),
     };
 
     return run_tests(tests);
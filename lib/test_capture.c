@@ -0,0 +1,233 @@
+#include "test_sim.h"
+
+#include <tetrapol/capture.h>
+#include <tetrapol/filter.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+#include <tetrapol/tp_timer.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    NFRAMES = 3 * 200,
+};
+
+/// decode simulated traffic, capture is written into f
+static void decode(FILE *f, int level, test_sim_cnt_t *cnt,
+        tetrapol_metrics_t *metrics)
+{
+    uint8_t *bits = test_sim_gen_bits(NFRAMES);
+    tetrapol_t *tetrapol = test_sim_create(&test_sim_cfg, cnt);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    capture_writer_t *cw = capture_writer_create(f, level, tetrapol);
+    assert_non_null(cw);
+
+    for (int i = 0; i < NFRAMES; ++i) {
+        assert_int_equal(FRAME_LEN, tetrapol_phys_ch_recv(phys_ch,
+                    &bits[i * FRAME_LEN], FRAME_LEN));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+
+    assert_int_equal(0, capture_writer_destroy(cw));
+    tetrapol_get_metrics(tetrapol, metrics);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+    free(bits);
+}
+
+static void replay(FILE *f, int level, test_sim_cnt_t *cnt,
+        tetrapol_metrics_t *metrics)
+{
+    rewind(f);
+    capture_reader_t cr;
+    assert_int_equal(0, capture_reader_init(&cr, f));
+    assert_int_equal(level, cr.hdr.level);
+    assert_int_equal(TETRAPOL_BAND_UHF, cr.hdr.cfg.band);
+    assert_int_equal(DIR_DOWNLINK, cr.hdr.cfg.dir);
+    assert_int_equal(TETRAPOL_RADIO_CCH, cr.hdr.cfg.radio_ch_type);
+    assert_true(cr.hdr.cfg.start_time == test_sim_cfg.start_time);
+
+    tetrapol_t *tetrapol = test_sim_create(&cr.hdr.cfg, cnt);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+
+    capture_rec_t rec;
+    int r;
+    while ((r = capture_read(&cr, &rec)) > 0) {
+        capture_replay(phys_ch, &rec);
+    }
+    assert_int_equal(0, r);
+
+    tetrapol_get_metrics(tetrapol, metrics);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+}
+
+static void test_frame_level(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+
+    test_sim_cnt_t cnt, cnt_replay;
+    tetrapol_metrics_t metrics, metrics_replay;
+    decode(f, CAPTURE_LEVEL_FRAME, &cnt, &metrics);
+    replay(f, CAPTURE_LEVEL_FRAME, &cnt_replay, &metrics_replay);
+
+    assert_true(cnt.ntsdus > 0);
+    assert_true(cnt.npch > 0);
+    assert_int_equal(NFRAMES, cnt.nframes);
+    assert_int_equal(cnt.nframes, cnt_replay.nframes);
+    assert_int_equal(cnt.npch, cnt_replay.npch);
+    assert_int_equal(cnt.nsync, cnt_replay.nsync);
+    assert_int_equal(cnt.ntsdus, cnt_replay.ntsdus);
+    assert_true(cnt.hash == cnt_replay.hash);
+    assert_int_equal(metrics.hdlc_stuffing, metrics_replay.hdlc_stuffing);
+    for (int i = 0; i < 256; ++i) {
+        assert_int_equal(metrics.tsdus[i], metrics_replay.tsdus[i]);
+    }
+
+    fclose(f);
+}
+
+static void test_hdlc_level(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+
+    test_sim_cnt_t cnt, cnt_replay;
+    tetrapol_metrics_t metrics, metrics_replay;
+    decode(f, CAPTURE_LEVEL_HDLC, &cnt, &metrics);
+    replay(f, CAPTURE_LEVEL_HDLC, &cnt_replay, &metrics_replay);
+
+    // frames, PCH and RCH are not part of HDLC capture
+    assert_int_equal(0, cnt_replay.nframes);
+    assert_int_equal(cnt.nsync, cnt_replay.nsync);
+    assert_true(cnt.ntsdus > 0);
+    assert_int_equal(cnt.ntsdus, cnt_replay.ntsdus);
+    assert_true(cnt.tsdu_hash == cnt_replay.tsdu_hash);
+    for (int i = 0; i < 256; ++i) {
+        assert_int_equal(metrics.tsdus[i], metrics_replay.tsdus[i]);
+    }
+
+    fclose(f);
+}
+
+static void test_invalid(void **state)
+{
+    (void) state;   // unused
+
+    capture_reader_t cr;
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    assert_int_equal(-1, capture_reader_init(&cr, f));
+
+    const tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_VHF,
+        .dir = DIR_UPLINK,
+        .radio_ch_type = TETRAPOL_RADIO_TCH,
+    };
+    tetrapol_t *tetrapol = tetrapol_create(&cfg);
+    assert_non_null(tetrapol);
+    assert_null(capture_writer_create(f, 0, tetrapol));
+
+    // capture of filtered events would not be lossless
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+    assert_int_equal(0, filter_parse(&filter, "frame=DATA"));
+    assert_true(tetrapol_set_filter(tetrapol, &filter));
+    assert_null(capture_writer_create(f, CAPTURE_LEVEL_FRAME, tetrapol));
+    assert_true(tetrapol_set_filter(tetrapol, NULL));
+
+    capture_writer_t *cw = capture_writer_create(f, CAPTURE_LEVEL_FRAME,
+            tetrapol);
+    assert_non_null(cw);
+    assert_int_equal(0, capture_writer_destroy(cw));
+    tetrapol_destroy(tetrapol);
+
+    // truncated record
+    const uint8_t rec[] = { 20, 0, CAPTURE_REC_SYNC, 0xff, 0, 0, 0, 0, 1, };
+    assert_int_equal(1, fwrite(rec, sizeof(rec), 1, f));
+
+    rewind(f);
+    assert_int_equal(0, capture_reader_init(&cr, f));
+    assert_int_equal(CAPTURE_LEVEL_FRAME, cr.hdr.level);
+    assert_int_equal(TETRAPOL_BAND_VHF, cr.hdr.cfg.band);
+    assert_int_equal(DIR_UPLINK, cr.hdr.cfg.dir);
+    assert_int_equal(TETRAPOL_RADIO_TCH, cr.hdr.cfg.radio_ch_type);
+    capture_rec_t r;
+    assert_int_equal(-1, capture_read(&cr, &r));
+
+    fclose(f);
+}
+
+/// rx_offs moved backward by base record, replay must not wrap the timer
+static void test_backward(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    tetrapol_t *tetrapol = tetrapol_create(&test_sim_cfg);
+    assert_non_null(tetrapol);
+    capture_writer_t *cw = capture_writer_create(f, CAPTURE_LEVEL_FRAME,
+            tetrapol);
+    assert_non_null(cw);
+    assert_int_equal(0, capture_writer_destroy(cw));
+    tetrapol_destroy(tetrapol);
+
+    const uint8_t recs[] = {
+        9, 0, CAPTURE_REC_SYNC, 0xff, 0x40, 0x42, 0x0f, 0x00, 1,
+        16, 0, CAPTURE_REC_BASE, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        9, 0, CAPTURE_REC_SYNC, 0xff, 0, 0, 0, 0, 0,
+    };
+    assert_int_equal(1, fwrite(recs, sizeof(recs), 1, f));
+
+    rewind(f);
+    capture_reader_t cr;
+    assert_int_equal(0, capture_reader_init(&cr, f));
+    capture_rec_t rec;
+    assert_int_equal(1, capture_read(&cr, &rec));
+    assert_int_equal(CAPTURE_REC_SYNC, rec.type);
+    assert_true(rec.rx_offs == 1000000);
+    assert_int_equal(-1, capture_read(&cr, &rec));
+
+    // phys_ch does not tick timer back when replayed position goes backward
+    tetrapol = tetrapol_create(&test_sim_cfg);
+    assert_non_null(tetrapol);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    tetrapol_phys_ch_replay_sync(phys_ch, false, 1000000);
+    tpol_t *tpol = tetrapol_get_tpol(tetrapol);
+    const uint64_t now = tp_timer_now(tpol->tp_timer);
+    tetrapol_phys_ch_replay_sync(phys_ch, false, 0);
+    assert_true(now == tp_timer_now(tpol->tp_timer));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    fclose(f);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_frame_level),
+        unit_test(test_hdlc_level),
+        unit_test(test_invalid),
+        unit_test(test_backward),
+    };
+
+    return run_tests(tests);
+}
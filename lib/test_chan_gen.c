@@ -0,0 +1,317 @@
+#include <tetrapol/chan_gen.h>
+#include <tetrapol/tetrapol.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    NFRAMES = 64,
+    NEVTS_MAX = 8 * NFRAMES,
+};
+
+typedef struct {
+    chan_gen_evt_t evt;
+    frame_t fr;
+} evt_rec_t;
+
+typedef struct {
+    int nevts;
+    evt_rec_t evts[NEVTS_MAX];
+    int len;
+    uint8_t *bits;
+} stream_t;
+
+static void evt_cb(const chan_gen_evt_t *evt, void *ptr)
+{
+    stream_t *s = ptr;
+
+    assert_true(s->nevts < NEVTS_MAX);
+    evt_rec_t *rec = &s->evts[s->nevts++];
+    memcpy(&rec->evt, evt, sizeof(*evt));
+    if (evt->type == CHAN_GEN_EVT_FRAME) {
+        memcpy(&rec->fr, evt->frame.fr, sizeof(rec->fr));
+        rec->evt.frame.fr = &rec->fr;
+    }
+}
+
+static stream_t *generate(const chan_gen_cfg_t *cfg)
+{
+    chan_gen_t *gen = chan_gen_create(cfg);
+    assert_non_null(gen);
+
+    stream_t *s = calloc(1, sizeof(stream_t));
+    assert_non_null(s);
+    s->bits = malloc(NFRAMES * chan_gen_frame_len_max(gen));
+    assert_non_null(s->bits);
+    chan_gen_set_evt_cb(gen, evt_cb, s);
+
+    for (int i = 0; i < NFRAMES; ++i) {
+        const int n = chan_gen_frame(gen, &s->bits[s->len]);
+        assert_true(n > 0);
+        s->len += n;
+    }
+    chan_gen_destroy(gen);
+
+    return s;
+}
+
+static void stream_destroy(stream_t *s)
+{
+    free(s->bits);
+    free(s);
+}
+
+// do the same as phys_ch for frame on known possition
+static void decode(const chan_gen_cfg_t *cfg, frame_t *fr, const uint8_t *bits)
+{
+    uint8_t fr_data[FRAME_DATA_LEN];
+    uint8_t prev = 0;
+    for (int i = 0; i < FRAME_DATA_LEN; ++i) {
+        uint8_t b = bits[FRAME_HDR_LEN + i] ^ (cfg->dir == DIR_UPLINK);
+        prev = fr_data[i] = b ^ prev;
+    }
+
+    frame_decoder_t *fd = frame_decoder_create(cfg->band, cfg->scr, cfg->fr_type);
+    assert_non_null(fd);
+    frame_decoder_decode(fd, fr, fr_data);
+    frame_decoder_destroy(fd);
+}
+
+static void check_clean(const chan_gen_cfg_t *cfg)
+{
+    stream_t *s = generate(cfg);
+
+    assert_int_equal(NFRAMES, s->nevts);
+    assert_int_equal(NFRAMES * FRAME_LEN, s->len);
+    for (int i = 0; i < s->nevts; ++i) {
+        const chan_gen_evt_t *evt = &s->evts[i].evt;
+        assert_int_equal(CHAN_GEN_EVT_FRAME, evt->type);
+        assert_int_equal(i * FRAME_LEN, evt->offs);
+        assert_int_equal(i, evt->frame.seq);
+        assert_int_equal(0, evt->frame.bit_errs);
+
+        frame_t fr;
+        decode(cfg, &fr, &s->bits[evt->offs]);
+        assert_int_equal(0, fr.broken);
+        assert_int_equal(cfg->fr_type, fr.fr_type);
+        if (cfg->fr_type == FRAME_TYPE_DATA) {
+            assert_memory_equal(evt->frame.fr->data.data, fr.data.data,
+                    sizeof(fr.data.data));
+        } else {
+            assert_memory_equal(evt->frame.fr->voice.voice1, fr.voice.voice1,
+                    sizeof(fr.voice.voice1));
+            assert_memory_equal(evt->frame.fr->voice.voice2, fr.voice.voice2,
+                    sizeof(fr.voice.voice2));
+        }
+    }
+
+    stream_destroy(s);
+}
+
+static void test_clean(void **state)
+{
+    (void) state;   // unused
+
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .scr = 0,
+        .fr_type = FRAME_TYPE_DATA,
+    };
+    check_clean(&cfg);
+
+    cfg.scr = 37;
+    check_clean(&cfg);
+
+    cfg.band = TETRAPOL_BAND_VHF;
+    cfg.dir = DIR_UPLINK;
+    check_clean(&cfg);
+
+    cfg.fr_type = FRAME_TYPE_VOICE;
+    check_clean(&cfg);
+}
+
+static void test_ber_burst(void **state)
+{
+    (void) state;   // unused
+
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .fr_type = FRAME_TYPE_DATA,
+        .seed = 1234,
+    };
+    stream_t *clean = generate(&cfg);
+
+    cfg.ber = 0.01;
+    cfg.burst_rate = 0.25;
+    cfg.burst_len = 20;
+    stream_t *s = generate(&cfg);
+
+    assert_int_equal(clean->len, s->len);
+    int bit_errs = 0;
+    int nbursts = 0;
+    for (int i = 0; i < s->nevts; ++i) {
+        const chan_gen_evt_t *evt = &s->evts[i].evt;
+        if (evt->type == CHAN_GEN_EVT_FRAME) {
+            bit_errs += evt->frame.bit_errs;
+            // payload does not depend on impairments
+            assert_memory_equal(clean->evts[evt->frame.seq].fr.data.data,
+                    s->evts[i].fr.data.data, sizeof(s->evts[i].fr.data.data));
+        } else {
+            assert_int_equal(CHAN_GEN_EVT_BURST, evt->type);
+            assert_int_equal(cfg.burst_len, evt->burst.len);
+            ++nbursts;
+        }
+    }
+    assert_true(nbursts > 0);
+
+    int diff = 0;
+    for (int i = 0; i < s->len; ++i) {
+        diff += s->bits[i] ^ clean->bits[i];
+    }
+    assert_true(diff > 0);
+    assert_int_equal(bit_errs, diff);
+
+    stream_destroy(clean);
+    stream_destroy(s);
+}
+
+static void test_slip_gap(void **state)
+{
+    (void) state;   // unused
+
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .fr_type = FRAME_TYPE_DATA,
+        .slip_rate = 0.25,
+        .gap_rate = 0.25,
+        .gap_len = 1000,
+    };
+    stream_t *s = generate(&cfg);
+
+    int len = NFRAMES * FRAME_LEN;
+    int nslips = 0;
+    int ngaps = 0;
+    uint64_t offs = 0;
+    for (int i = 0; i < s->nevts; ++i) {
+        const chan_gen_evt_t *evt = &s->evts[i].evt;
+        assert_true(evt->offs >= offs);
+        offs = evt->offs;
+        switch (evt->type) {
+            case CHAN_GEN_EVT_FRAME:
+                assert_int_equal(0, evt->frame.bit_errs);
+                break;
+
+            case CHAN_GEN_EVT_SLIP:
+                assert_true(evt->slip.bits == 1 || evt->slip.bits == -1);
+                len += evt->slip.bits;
+                ++nslips;
+                break;
+
+            case CHAN_GEN_EVT_GAP:
+                assert_int_equal(cfg.gap_len, evt->gap.len);
+                len += evt->gap.len;
+                ++ngaps;
+                break;
+
+            default:
+                assert_true(false);
+        }
+    }
+    assert_true(nslips > 0);
+    assert_true(ngaps > 0);
+    assert_int_equal(len, s->len);
+
+    // frame without slip is intact after gap
+    for (int i = 0; i + 1 < s->nevts; ++i) {
+        const chan_gen_evt_t *evt = &s->evts[i].evt;
+        if (evt->type != CHAN_GEN_EVT_FRAME ||
+                s->evts[i + 1].evt.type == CHAN_GEN_EVT_SLIP) {
+            continue;
+        }
+        frame_t fr;
+        decode(&cfg, &fr, &s->bits[evt->offs]);
+        assert_int_equal(0, fr.broken);
+        assert_memory_equal(evt->frame.fr->data.data, fr.data.data,
+                sizeof(fr.data.data));
+    }
+
+    stream_destroy(s);
+}
+
+static void test_polarity(void **state)
+{
+    (void) state;   // unused
+
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .fr_type = FRAME_TYPE_DATA,
+    };
+    stream_t *clean = generate(&cfg);
+
+    cfg.polarity_rate = 0.25;
+    stream_t *s = generate(&cfg);
+
+    assert_int_equal(clean->len, s->len);
+    bool inverted = false;
+    int nflips = 0;
+    for (int i = 0; i < s->nevts; ++i) {
+        const chan_gen_evt_t *evt = &s->evts[i].evt;
+        if (evt->type == CHAN_GEN_EVT_POLARITY) {
+            inverted = !inverted;
+            ++nflips;
+            continue;
+        }
+        assert_int_equal(CHAN_GEN_EVT_FRAME, evt->type);
+        for (int j = 0; j < FRAME_LEN; ++j) {
+            assert_int_equal(clean->bits[evt->offs + j] ^ inverted,
+                    s->bits[evt->offs + j]);
+        }
+    }
+    assert_true(nflips > 0);
+
+    stream_destroy(clean);
+    stream_destroy(s);
+}
+
+static void test_invalid_cfg(void **state)
+{
+    (void) state;   // unused
+
+    chan_gen_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .fr_type = FRAME_TYPE_HR_DATA,
+    };
+    assert_null(chan_gen_create(&cfg));
+
+    cfg.fr_type = FRAME_TYPE_DATA;
+    cfg.ber = 1.5;
+    assert_null(chan_gen_create(&cfg));
+
+    cfg.ber = 0;
+    cfg.burst_rate = 0.1;
+    cfg.burst_len = FRAME_LEN + 1;
+    assert_null(chan_gen_create(&cfg));
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_clean),
+        unit_test(test_ber_burst),
+        unit_test(test_slip_gap),
+        unit_test(test_polarity),
+        unit_test(test_invalid_cfg),
+    };
+
+    return run_tests(tests);
+}
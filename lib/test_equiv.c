@@ -0,0 +1,715 @@
+/**
+  Differential tests of decoder kernels.
+
+  Reference implementations from frame.c, phys_ch.c and bit_utils are run
+  side by side with alternative kernels (packed, table-driven) on the same
+  inputs and any difference in results is reported. Inputs are synthetic
+  streams for both bands, both directions and every SCR, clean and with
+  impairments, random data and optionally recorded channel bits.
+
+  Without arguments only a short run suitable for CI is done, use
+  -s <ROUNDS> for soak run with more rounds of fresh pseudo-random input and
+  -i <PATH> to add recorded input in format of tetrapol_dump.
+  */
+#define _DEFAULT_SOURCE 1
+
+// include, we are testing static methods
+#include "frame.c"
+#undef LOG_PREFIX
+#include "phys_ch.c"
+
+#include <tetrapol/bit_utils.h>
+#include <tetrapol/chan_gen.h>
+#include <tetrapol/misc.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+enum {
+    NFRAMES = 6,            ///< frames per configuration and round
+    NSYNC_FRAMES = 64,      ///< length of stream for synchronization tests
+    NFCS = 2000,            ///< FCS checks per round
+    NGET_BITS = 20000,      ///< get_bits calls per round
+    NRECORDED_FRAMES = 32,  ///< frames taken from recorded input per round
+    NDIFFS_REPORTED = 8,
+    SYNC_WINDOW_MAX = 10 * FRAME_LEN - DATA_OFFS,
+    SYNC_PACKED = 0x65,     ///< frame synchronization { 1, 0, 1, 0, 0, 1, 1 }
+};
+
+static int soak_rounds = 1;
+static const char *recorded_path;
+static int ndiffs;
+
+static int log_discard(const char *fmt, va_list ap)
+{
+    return 0;
+}
+
+/// print only first few differences, all are counted
+static bool report_diff(void)
+{
+    return ndiffs++ < NDIFFS_REPORTED;
+}
+
+/**
+  Frame decoder kernels, the pipeline is the same as in
+  frame_decoder_decode() with replaceable stages.
+  */
+typedef struct {
+    const char *name;
+    void (*descramble)(uint8_t *fr_data_tmp, const uint8_t *fr_data, int scr);
+    void (*diff_dec)(uint8_t *fr_data);
+} frame_kernels_t;
+
+/// descramble using packed tables of encoder, 1 lookup per 8 bits
+static void frame_descramble_packed(uint8_t *fr_data_tmp,
+        const uint8_t *fr_data, int scr)
+{
+    if (scr == 0) {
+        memcpy(fr_data_tmp, fr_data, FRAME_DATA_LEN);
+        return;
+    }
+
+    const uint8_t *scr_table = &scramb_tables[scr % 8][scr / 8];
+    for (int i = 0; i < FRAME_DATA_LEN / 8; ++i) {
+        const uint8_t s = scr_table[i];
+        for (int j = 0; j < 8; ++j) {
+            fr_data_tmp[8*i + j] = fr_data[8*i + j] ^ ((s >> j) & 1);
+        }
+    }
+}
+
+/// differential decoding with precoded positions computed instead of table
+static void frame_diff_dec_arith(uint8_t *fr_data)
+{
+    for (int j = FRAME_DATA_LEN - 1; j > 0; --j) {
+        const bool precod = (j >= 7 && j <= 76 && (j - 7) % 3 == 0) ||
+            (j >= 83 && j <= 149 && (j - 83) % 3 == 0);
+        fr_data[j] ^= fr_data[j - 1 - precod];
+    }
+}
+
+static const frame_kernels_t frame_kernels[] = {
+    // checks the pipeline copy below against frame_decoder_decode()
+    { "reference", frame_descramble, frame_diff_dec, },
+    { "packed_scr", frame_descramble_packed, frame_diff_dec, },
+    { "arith_diff", frame_descramble, frame_diff_dec_arith, },
+};
+
+static void frame_decode_kernels(const frame_kernels_t *k, int band, int scr,
+        int fr_type, frame_t *fr, const uint8_t *fr_data)
+{
+    fr->bits_fixed = 0;
+
+    uint8_t fr_data_tmp[FRAME_DATA_LEN];
+
+    k->descramble(fr_data_tmp, fr_data, scr);
+    if (band == TETRAPOL_BAND_UHF) {
+        k->diff_dec(fr_data_tmp);
+    }
+
+    uint8_t fr_data_deint[FRAME_DATA_LEN];
+    uint8_t fr_errs[FRAME_DATA_LEN];
+
+    frame_deinterleave1(fr_data_deint, fr_data_tmp, band);
+    fr->broken = frame_decode1(fr->blob_, fr_errs, fr_data_deint, fr_type);
+    fr->syndromes = fr->broken;
+
+    fr->fr_type = (fr_type == FRAME_TYPE_AUTO) ? fr->d : fr_type;
+
+    if (fr->broken) {
+        fr->broken -= frame_fix_errs(fr->blob_, fr_errs, 26, &fr->bits_fixed);
+        if (fr->broken > 0) {
+            return;
+        }
+    }
+
+    frame_deinterleave2(fr_data_deint, fr_data_tmp, band, fr->fr_type);
+    fr->broken = frame_decode2(fr->blob_, fr_errs, fr_data_deint, fr->fr_type);
+    fr->syndromes += fr->broken;
+
+    if (fr->fr_type == FRAME_TYPE_VOICE) {
+        fr->broken = frame_check_crc(fr->blob_, fr->fr_type) ? 0 : -1;
+        return;
+    }
+
+    if (fr->broken) {
+        fr->broken -= frame_fix_errs(fr->blob_ + 26, fr_errs + 26, 50, &fr->bits_fixed);
+        if (fr->broken > 0) {
+            return;
+        }
+    }
+
+    fr->broken = frame_check_crc(fr->blob_, fr->fr_type) ? 0 : -1;
+}
+
+static void print_frame(const char *name, const frame_t *fr)
+{
+    fprintf(stderr, "  %-10s fr_type=%d broken=%d syndromes=%d bits_fixed=%d\n"
+            "             payload=", name, fr->fr_type, fr->broken,
+            fr->syndromes, fr->bits_fixed);
+    for (int i = 0; i < offsetof(frame_t, fr_type); ++i) {
+        fprintf(stderr, "%d", fr->blob_[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+static bool frame_equal(const frame_t *a, const frame_t *b)
+{
+    return a->fr_type == b->fr_type && a->broken == b->broken &&
+        a->syndromes == b->syndromes && a->bits_fixed == b->bits_fixed &&
+        !memcmp(a->blob_, b->blob_, offsetof(frame_t, fr_type));
+}
+
+/// decode fr_data by reference decoder and all kernels, compare results
+static void check_frame(int band, int scr, const uint8_t *fr_data)
+{
+    static const int fr_types[] = {
+        FRAME_TYPE_AUTO, FRAME_TYPE_VOICE, FRAME_TYPE_DATA,
+    };
+
+    for (int t = 0; t < ARRAY_LEN(fr_types); ++t) {
+        frame_decoder_t *fd = frame_decoder_create(band, scr, fr_types[t]);
+        assert_non_null(fd);
+        frame_t ref;
+        memset(&ref, 0, sizeof(ref));
+        frame_decoder_decode(fd, &ref, fr_data);
+        frame_decoder_destroy(fd);
+
+        for (int i = 0; i < ARRAY_LEN(frame_kernels); ++i) {
+            frame_t fr;
+            memset(&fr, 0, sizeof(fr));
+            frame_decode_kernels(&frame_kernels[i], band, scr, fr_types[t],
+                    &fr, fr_data);
+            if (!frame_equal(&ref, &fr) && report_diff()) {
+                fprintf(stderr, "frame kernel '%s' differs, band=%d scr=%d "
+                        "fr_type=%d\n", frame_kernels[i].name, band, scr,
+                        fr_types[t]);
+                print_frame("reference", &ref);
+                print_frame(frame_kernels[i].name, &fr);
+            }
+        }
+    }
+}
+
+/// take frame data from channel bits as phys_ch does
+static void get_fr_data(uint8_t *fr_data, const uint8_t *bits, int dir)
+{
+    uint8_t prev = 0;
+    for (int i = 0; i < FRAME_DATA_LEN; ++i) {
+        const uint8_t b = bits[FRAME_HDR_LEN + i] ^ (dir == DIR_UPLINK);
+        prev = fr_data[i] = b ^ prev;
+    }
+}
+
+typedef struct {
+    int nframes;
+    uint64_t offs[NSYNC_FRAMES];
+} frame_offs_t;
+
+static void frame_offs_cb(const chan_gen_evt_t *evt, void *ptr)
+{
+    frame_offs_t *fo = ptr;
+
+    if (evt->type == CHAN_GEN_EVT_FRAME && fo->nframes < NSYNC_FRAMES) {
+        fo->offs[fo->nframes++] = evt->offs;
+    }
+}
+
+/// generate stream, return number of bits, offsets of frames are optional
+static int mk_stream(uint8_t *bits, int nframes, const chan_gen_cfg_t *cfg,
+        frame_offs_t *fo)
+{
+    chan_gen_t *gen = chan_gen_create(cfg);
+    assert_non_null(gen);
+    if (fo) {
+        fo->nframes = 0;
+        chan_gen_set_evt_cb(gen, frame_offs_cb, fo);
+    }
+
+    int len = 0;
+    for (int i = 0; i < nframes; ++i) {
+        const int n = chan_gen_frame(gen, &bits[len]);
+        assert_true(n > 0);
+        len += n;
+    }
+    chan_gen_destroy(gen);
+
+    return len;
+}
+
+static void test_frame_synthetic(void **state)
+{
+    (void) state;   // unused
+
+    static const chan_gen_cfg_t impairments[] = {
+        { .ber = 0, },
+        { .ber = 0.02, },
+        { .ber = 0.002, .burst_rate = 0.5, .burst_len = 12, },
+    };
+    static const int bands[] = { TETRAPOL_BAND_UHF, TETRAPOL_BAND_VHF, };
+    static const int dirs[] = { DIR_DOWNLINK, DIR_UPLINK, };
+    static const int fr_types[] = { FRAME_TYPE_DATA, FRAME_TYPE_VOICE, };
+
+    uint8_t bits[NFRAMES * 2 * FRAME_LEN];
+    ndiffs = 0;
+    for (int round = 0; round < soak_rounds; ++round)
+    for (int b = 0; b < ARRAY_LEN(bands); ++b)
+    for (int d = 0; d < ARRAY_LEN(dirs); ++d)
+    for (int t = 0; t < ARRAY_LEN(fr_types); ++t)
+    for (int i = 0; i < ARRAY_LEN(impairments); ++i)
+    for (int scr = 0; scr < 128; ++scr) {
+        chan_gen_cfg_t cfg = impairments[i];
+        cfg.band = bands[b];
+        cfg.dir = dirs[d];
+        cfg.fr_type = fr_types[t];
+        cfg.scr = scr;
+        cfg.seed = 1 + scr + 128 * round;
+        frame_offs_t fo;
+        mk_stream(bits, NFRAMES, &cfg, &fo);
+
+        for (int j = 0; j < fo.nframes; ++j) {
+            uint8_t fr_data[FRAME_DATA_LEN];
+            get_fr_data(fr_data, &bits[fo.offs[j]], cfg.dir);
+            check_frame(cfg.band, scr, fr_data);
+        }
+    }
+
+    assert_int_equal(0, ndiffs);
+}
+
+static void test_frame_random(void **state)
+{
+    (void) state;   // unused
+
+    uint32_t rnd = 0x2545f491;
+    ndiffs = 0;
+    for (int round = 0; round < soak_rounds; ++round)
+    for (int band = TETRAPOL_BAND_VHF; band <= TETRAPOL_BAND_UHF; ++band)
+    for (int scr = 0; scr < 128; ++scr)
+    for (int i = 0; i < NFRAMES; ++i) {
+        uint8_t fr_data[FRAME_DATA_LEN];
+        for (int j = 0; j < FRAME_DATA_LEN; ++j) {
+            fr_data[j] = rand_next(&rnd) & 1;
+        }
+        check_frame(band, scr, fr_data);
+    }
+
+    assert_int_equal(0, ndiffs);
+}
+
+/// frame synchronization compared as 7 bit word, popcount of difference
+static int cmp_frame_sync_packed(const uint8_t *data)
+{
+    uint32_t w = 0;
+    for (int i = 0; i < 7; ++i) {
+        w |= data[i + 1] << i;
+    }
+
+    return __builtin_popcount(w ^ SYNC_PACKED);
+}
+
+/**
+  Search for 2 consecutive frame synchronizations, synchronization windows
+  are kept packed in shift registers.
+
+  @return position of first frame or -1 when not found
+  */
+static int find_frame_sync_packed(const uint8_t *data, int len)
+{
+    const int end = len - FRAME_LEN - FRAME_HDR_LEN;
+    if (end < 0) {
+        return -1;
+    }
+
+    uint32_t w1 = 0;
+    uint32_t w2 = 0;
+    for (int i = 0; i < 6; ++i) {
+        w1 |= data[i + 1] << i;
+        w2 |= data[FRAME_LEN + i + 1] << i;
+    }
+
+    for (int pos = 0; pos <= end; ++pos) {
+        w1 |= data[pos + 7] << 6;
+        w2 |= data[pos + FRAME_LEN + 7] << 6;
+        const int sync_err = __builtin_popcount(w1 ^ SYNC_PACKED) +
+            __builtin_popcount(w2 ^ SYNC_PACKED);
+        if (sync_err <= MAX_FRAME_SYNC_ERR) {
+            return pos;
+        }
+        w1 >>= 1;
+        w2 >>= 1;
+    }
+
+    return -1;
+}
+
+/// run reference find_frame_sync() on data, return the same as packed kernel
+static int find_frame_sync_ref(phys_ch_t *phys_ch, const uint8_t *data,
+        int len)
+{
+    assert_true(len <= SYNC_WINDOW_MAX);
+    memcpy(phys_ch->data + DATA_OFFS, data, len);
+    phys_ch->data_begin = phys_ch->data + DATA_OFFS;
+    phys_ch->data_end = phys_ch->data_begin + len;
+    const int64_t rx_offs = phys_ch->tpol->rx_offs;
+
+    const int found = find_frame_sync(phys_ch);
+    const int pos = phys_ch->data_begin - (phys_ch->data + DATA_OFFS);
+    assert_int_equal(pos, phys_ch->tpol->rx_offs - rx_offs);
+
+    return found ? pos : -1;
+}
+
+typedef struct {
+    tetrapol_t *tetrapol;
+    phys_ch_t *phys_ch;
+} sync_ctx_t;
+
+static void sync_ctx_init(sync_ctx_t *ctx)
+{
+    tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+    };
+    ctx->tetrapol = tetrapol_create(&cfg);
+    assert_non_null(ctx->tetrapol);
+    ctx->phys_ch = tetrapol_phys_ch_create(ctx->tetrapol);
+    assert_non_null(ctx->phys_ch);
+}
+
+static void sync_ctx_deinit(sync_ctx_t *ctx)
+{
+    tetrapol_phys_ch_destroy(ctx->phys_ch);
+    tetrapol_destroy(ctx->tetrapol);
+}
+
+/// compare synchronization kernels on all positions and windows of stream
+static void check_sync(phys_ch_t *phys_ch, const uint8_t *bits, int len,
+        int *nfound)
+{
+    for (int i = 0; i + FRAME_HDR_LEN <= len; ++i) {
+        const int ref = cmp_frame_sync(&bits[i]);
+        const int alt = cmp_frame_sync_packed(&bits[i]);
+        if (ref != alt && report_diff()) {
+            fprintf(stderr, "sync kernel 'packed' differs at %d: "
+                    "reference=%d packed=%d\n", i, ref, alt);
+        }
+    }
+
+    static const int windows[] = {
+        FRAME_LEN + FRAME_HDR_LEN,
+        2 * FRAME_LEN + FRAME_HDR_LEN - 1,
+        3 * FRAME_LEN,
+        SYNC_WINDOW_MAX,
+    };
+    for (int w = 0; w < ARRAY_LEN(windows); ++w) {
+        for (int i = 0; i < len; i += 7) {
+            const int wlen = (len - i < windows[w]) ? len - i : windows[w];
+            const int ref = find_frame_sync_ref(phys_ch, &bits[i], wlen);
+            const int alt = find_frame_sync_packed(&bits[i], wlen);
+            if (ref != alt && report_diff()) {
+                fprintf(stderr, "sync search 'packed' differs at %d, "
+                        "window %d: reference=%d packed=%d\n",
+                        i, wlen, ref, alt);
+            }
+            *nfound += (ref >= 0);
+        }
+    }
+}
+
+static void test_sync(void **state)
+{
+    (void) state;   // unused
+
+    static const chan_gen_cfg_t impairments[] = {
+        { .ber = 0, },
+        { .ber = 0.01, .slip_rate = 0.2, },
+        { .ber = 0.005, .gap_rate = 0.3, .gap_len = 37, .polarity_rate = 0.1, },
+        { .burst_rate = 0.5, .burst_len = 40, .slip_rate = 0.1, },
+    };
+
+    sync_ctx_t ctx;
+    sync_ctx_init(&ctx);
+
+    uint8_t *bits = malloc(NSYNC_FRAMES * 2 * FRAME_LEN);
+    assert_non_null(bits);
+    ndiffs = 0;
+    int nfound = 0;
+    for (int round = 0; round < soak_rounds; ++round)
+    for (int band = TETRAPOL_BAND_VHF; band <= TETRAPOL_BAND_UHF; ++band)
+    for (int i = 0; i < ARRAY_LEN(impairments); ++i) {
+        chan_gen_cfg_t cfg = impairments[i];
+        cfg.band = band;
+        cfg.dir = DIR_DOWNLINK;
+        cfg.fr_type = FRAME_TYPE_DATA;
+        cfg.scr = (17 * (i + 1) + round) % 128;
+        cfg.seed = 0x5eed + round;
+        const int len = mk_stream(bits, NSYNC_FRAMES, &cfg, NULL);
+        check_sync(ctx.phys_ch, bits, len, &nfound);
+    }
+
+    // random data, synchronization is found only by chance
+    uint32_t rnd = 0x9e3779b9;
+    for (int round = 0; round < soak_rounds; ++round) {
+        const int len = NSYNC_FRAMES * FRAME_LEN;
+        for (int i = 0; i < len; ++i) {
+            bits[i] = rand_next(&rnd) & 1;
+        }
+        check_sync(ctx.phys_ch, bits, len, &nfound);
+    }
+
+    free(bits);
+    sync_ctx_deinit(&ctx);
+
+    assert_true(nfound > 0);
+    assert_int_equal(0, ndiffs);
+}
+
+static uint16_t crc_table[256];
+
+static void crc_table_init(void)
+{
+    for (int i = 0; i < 256; ++i) {
+        uint32_t crc = i << 16;
+        for (int j = 23; j >= 16; --j) {
+            if (crc & (1 << j)) {
+                crc ^= 0x11021 << (j - 16);
+            }
+        }
+        crc_table[i] = crc;
+    }
+}
+
+static uint8_t rev8(uint8_t b)
+{
+    b = (b & 0xf0) >> 4 | (b & 0x0f) << 4;
+    b = (b & 0xcc) >> 2 | (b & 0x33) << 2;
+    b = (b & 0xaa) >> 1 | (b & 0x55) << 1;
+
+    return b;
+}
+
+/**
+  Table-driven check_fcs(), CRC register is updated by whole bytes.
+
+  Bits are sent LSB first, so bytes are reversed before shifted into CRC.
+  */
+static bool check_fcs_table(const uint8_t *data, int nbits)
+{
+    uint32_t crc = ((rev8(data[0]) << 8) | rev8(data[1])) ^ 0xffff;
+
+    nbits -= 16;
+    data += 2;
+    for ( ; nbits >= 8; nbits -= 8, ++data) {
+        crc = (((crc << 8) & 0xffff) | rev8(*data)) ^ crc_table[crc >> 8];
+    }
+    for (int offs = 0; offs < nbits; ++offs) {
+        crc = (crc << 1) | ((*data >> offs) & 1);
+        if (crc & 0x10000) {
+            crc ^= 0x11021;
+        }
+    }
+
+    return !(crc ^ 0xffff);
+}
+
+static void test_fcs(void **state)
+{
+    (void) state;   // unused
+
+    crc_table_init();
+
+    uint32_t rnd = 0x1b873593;
+    ndiffs = 0;
+    int nvalid = 0;
+    for (int round = 0; round < soak_rounds; ++round)
+    for (int i = 0; i < NFCS; ++i) {
+        uint8_t data[64];
+        const int nbytes = 3 + rand_next(&rnd) % (sizeof(data) - 2);
+        for (int j = 0; j < nbytes; ++j) {
+            data[j] = rand_next(&rnd);
+        }
+        int nbits = 8 * nbytes;
+        switch (i % 3) {
+            case 0:
+                // valid FCS
+                set_fcs(data, nbits);
+                break;
+
+            case 1:
+                // valid FCS with bit error
+                set_fcs(data, nbits);
+                data[rand_next(&rnd) % nbytes] ^= 1 << (rand_next(&rnd) % 8);
+                break;
+
+            case 2:
+                // random length, not aligned to bytes
+                nbits -= rand_next(&rnd) % 8;
+                break;
+        }
+
+        const bool ref = check_fcs(data, nbits);
+        const bool alt = check_fcs_table(data, nbits);
+        nvalid += ref;
+        if (ref != alt && report_diff()) {
+            fprintf(stderr, "FCS kernel 'table' differs, nbits=%d: "
+                    "reference=%d table=%d\n", nbits, ref, alt);
+        }
+    }
+
+    assert_true(nvalid > 0);
+    assert_int_equal(0, ndiffs);
+}
+
+/// get_bits() bit by bit
+static uint32_t get_bits_bitwise(int len, const uint8_t *data, int skip)
+{
+    uint32_t r = 0;
+    for (int i = skip; i < skip + len; ++i) {
+        r = (r << 1) | ((data[i / 8] >> (7 - i % 8)) & 1);
+    }
+
+    return r;
+}
+
+static void test_get_bits(void **state)
+{
+    (void) state;   // unused
+
+    uint32_t rnd = 0x85ebca6b;
+    ndiffs = 0;
+    for (int round = 0; round < soak_rounds; ++round)
+    for (int i = 0; i < NGET_BITS; ++i) {
+        uint8_t data[16];
+        for (int j = 0; j < sizeof(data); ++j) {
+            data[j] = rand_next(&rnd);
+        }
+        const int len = 1 + rand_next(&rnd) % 32;
+        const int skip = rand_next(&rnd) % (8 * sizeof(data) - len + 1);
+
+        const uint32_t ref = get_bits(len, data, skip);
+        const uint32_t alt = get_bits_bitwise(len, data, skip);
+        if (ref != alt && report_diff()) {
+            fprintf(stderr, "get_bits kernel 'bitwise' differs, len=%d "
+                    "skip=%d: reference=0x%x bitwise=0x%x\n",
+                    len, skip, ref, alt);
+        }
+    }
+
+    assert_int_equal(0, ndiffs);
+}
+
+/// recorded channel bits, one bit per byte as read by tetrapol_dump
+static void test_recorded(void **state)
+{
+    (void) state;   // unused
+
+    if (!recorded_path) {
+        return;
+    }
+
+    FILE *f = fopen(recorded_path, "rb");
+    assert_non_null(f);
+    assert_int_equal(0, fseek(f, 0, SEEK_END));
+    const long len = ftell(f);
+    assert_true(len > 0);
+    rewind(f);
+    uint8_t *bits = malloc(len);
+    assert_non_null(bits);
+    assert_int_equal(len, fread(bits, 1, len, f));
+    fclose(f);
+    for (long i = 0; i < len; ++i) {
+        bits[i] &= 1;
+    }
+
+    sync_ctx_t ctx;
+    sync_ctx_init(&ctx);
+    ndiffs = 0;
+    int nfound = 0;
+    check_sync(ctx.phys_ch, bits, len, &nfound);
+    sync_ctx_deinit(&ctx);
+
+    // frames on positions of synchronization, downlink and uplink polarity
+    int nframes = 0;
+    for (long i = 0; i + FRAME_LEN <= len &&
+            nframes < NRECORDED_FRAMES * soak_rounds; ++i) {
+        const int dir = (cmp_frame_sync(&bits[i]) == 0) ? DIR_DOWNLINK :
+            (cmp_frame_sync(&bits[i]) == 7) ? DIR_UPLINK : -1;
+        if (dir < 0) {
+            continue;
+        }
+        uint8_t fr_data[FRAME_DATA_LEN];
+        get_fr_data(fr_data, &bits[i], dir);
+        for (int scr = 0; scr < 128; ++scr) {
+            check_frame(TETRAPOL_BAND_UHF, scr, fr_data);
+            check_frame(TETRAPOL_BAND_VHF, scr, fr_data);
+        }
+        ++nframes;
+    }
+    fprintf(stderr, "recorded: %ld bits, %d frames, %d sync found\n",
+            len, nframes, nfound);
+    free(bits);
+
+    assert_int_equal(0, ndiffs);
+}
+
+static void print_help(const char *prg_name)
+{
+    fprintf(stderr, "Differential tests of decoder kernels.\n");
+    fprintf(stderr, "Usage: %s [OPTIONS ...]\n", prg_name);
+    fprintf(stderr, "    -s <ROUNDS>             soak, repeat with fresh input\n");
+    fprintf(stderr, "    -i <PATH>               recorded channel bits\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "hi:s:")) != -1) {
+        int err = 0;
+        switch (opt) {
+            case 'h':
+                print_help(argv[0]);
+                exit(0);
+                break;
+
+            case 'i':
+                recorded_path = optarg;
+                break;
+
+            case 's':
+                soak_rounds = atoi(optarg);
+                err = (soak_rounds <= 0) ? -1 : 0;
+                break;
+
+            default:
+                err = -1;
+                break;
+        }
+        if (err) {
+            print_help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    log_set_backend(log_discard);
+
+    const UnitTest tests[] = {
+        unit_test(test_frame_synthetic),
+        unit_test(test_frame_random),
+        unit_test(test_sync),
+        unit_test(test_fcs),
+        unit_test(test_get_bits),
+        unit_test(test_recorded),
+    };
+
+    return run_tests(tests);
+}
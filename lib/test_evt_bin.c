@@ -0,0 +1,214 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/evt_bin.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+static void mk_evt(tetrapol_evt_t *evt, int type, uint64_t rx_offs,
+        uint64_t rx_time)
+{
+    memset(evt, 0, sizeof(*evt));
+    evt->type = type;
+    evt->rx_offs = rx_offs;
+    evt->rx_time = rx_time;
+    evt->frame_no = FRAME_NO_UNKNOWN;
+}
+
+/// events are written and read back without loss of information
+static void test_round_trip(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+
+    evt_bin_ctx_t ctx;
+    evt_bin_ctx_init(&ctx);
+    assert_int_equal(evt_bin_write_file_hdr(f), 0);
+
+    frame_t fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.fr_type = FRAME_TYPE_DATA;
+    fr.syndromes = 3;
+    fr.bits_fixed = 2;
+    fr.data.asb[1] = 1;
+    fr.data.data[0] = 1;
+    for (int i = 2; i < 66; i += 3) {
+        fr.data.data[i] = 1;
+    }
+    tetrapol_evt_t evt;
+    mk_evt(&evt, TETRAPOL_EVT_FRAME, 1000, 1500000000123456);
+    evt.frame_no = 42;
+    evt.frame.fr = &fr;
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    mk_evt(&evt, TETRAPOL_EVT_SCR, 1160, 1500000000143456);
+    evt.scr.scr = 97;
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    // time goes backward, base record must be inserted
+    const uint8_t data[] = { 0x90, 0x01, 0x02, 0x03, };
+    tpol_tsdu_t tsdu = {
+        .log_ch = LOG_CH_SDCH,
+        .addr = { .z = 0, .y = 1, .x = 0x123, },
+        .tpdu_type = TPDU_TYPE_TPDU,
+        .prio = 1,
+        .tsap_id = 5,
+        .tsap_ref_swmi = 17,
+        .tsap_ref_rt = TSAP_REF_UNKNOWN,
+        .data_len = sizeof(data),
+        .data = data,
+    };
+    mk_evt(&evt, TETRAPOL_EVT_TSDU, 1320, 1400000000000000);
+    evt.tsdu.tsdu = &tsdu;
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    const uint8_t pch_data[16] = { 0x80, 0x01, [15] = 0xff, };
+    mk_evt(&evt, TETRAPOL_EVT_PCH, 1400, 1400000000010000);
+    evt.frame_no = 99;
+    evt.pch.data = pch_data;
+    evt.pch.len = sizeof(pch_data);
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    mk_evt(&evt, TETRAPOL_EVT_REPEAT, 1440, 1400000000015000);
+    evt.repeat.log_ch = LOG_CH_RCH;
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    // not supported by binary format
+    mk_evt(&evt, TETRAPOL_EVT_SYNC, 1480, 1400000000020000);
+    assert_int_equal(evt_bin_write(f, &ctx, &evt), 0);
+
+    rewind(f);
+    evt_bin_ctx_init(&ctx);
+    evt_bin_rec_t *rec = malloc(sizeof(evt_bin_rec_t));
+    assert_non_null(rec);
+    assert_int_equal(evt_bin_read_file_hdr(f), 0);
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_FRAME);
+    assert_int_equal(rec->evt.frame_no, 42);
+    assert_true(rec->evt.rx_offs == 1000);
+    assert_true(rec->evt.rx_time == 1500000000123456);
+    assert_int_equal(rec->fr.fr_type, FRAME_TYPE_DATA);
+    assert_int_equal(rec->fr.broken, 0);
+    assert_int_equal(rec->fr.syndromes, 3);
+    assert_int_equal(rec->fr.bits_fixed, 2);
+    assert_memory_equal(rec->fr.data.asb, fr.data.asb, sizeof(fr.data.asb));
+    assert_memory_equal(rec->fr.data.data, fr.data.data,
+            sizeof(fr.data.data));
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_SCR);
+    assert_int_equal(rec->evt.frame_no, FRAME_NO_UNKNOWN);
+    assert_true(rec->evt.rx_offs == 1160);
+    assert_true(rec->evt.rx_time == 1500000000143456);
+    assert_int_equal(rec->evt.scr.scr, 97);
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_TSDU);
+    assert_true(rec->evt.rx_offs == 1320);
+    assert_true(rec->evt.rx_time == 1400000000000000);
+    const tpol_tsdu_t *tsdu2 = rec->evt.tsdu.tsdu;
+    assert_int_equal(tsdu2->log_ch, LOG_CH_SDCH);
+    assert_int_equal(tsdu2->addr.y, 1);
+    assert_int_equal(tsdu2->addr.x, 0x123);
+    assert_int_equal(tsdu2->tpdu_type, TPDU_TYPE_TPDU);
+    assert_int_equal(tsdu2->prio, 1);
+    assert_int_equal(tsdu2->tsap_id, 5);
+    assert_int_equal(tsdu2->tsap_ref_swmi, 17);
+    assert_int_equal(tsdu2->tsap_ref_rt, TSAP_REF_UNKNOWN);
+    assert_int_equal(tsdu2->data_len, sizeof(data));
+    assert_memory_equal(tsdu2->data, data, sizeof(data));
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_PCH);
+    assert_int_equal(rec->evt.frame_no, 99);
+    assert_true(rec->evt.rx_offs == 1400);
+    assert_int_equal(rec->evt.pch.len, sizeof(pch_data));
+    assert_memory_equal(rec->evt.pch.data, pch_data, sizeof(pch_data));
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_REPEAT);
+    assert_true(rec->evt.rx_time == 1400000000015000);
+    assert_int_equal(rec->evt.repeat.log_ch, LOG_CH_RCH);
+
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 0);
+
+    free(rec);
+    fclose(f);
+}
+
+/// evt_bin_write produces same stream as evt_bin_encode
+static void test_write_encode(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    uint8_t *buf = malloc(2 * EVT_BIN_ENCODE_MAX);
+    uint8_t *buf2 = malloc(2 * EVT_BIN_ENCODE_MAX);
+    uint8_t *data = calloc(1, EVT_BIN_REC_MAX);
+    assert_non_null(buf);
+    assert_non_null(buf2);
+    assert_non_null(data);
+
+    evt_bin_ctx_t ctx_write;
+    evt_bin_ctx_t ctx_encode;
+    evt_bin_ctx_init(&ctx_write);
+    evt_bin_ctx_init(&ctx_encode);
+
+    // TSDU too long for single record is truncated
+    data[0] = 0x90;
+    data[EVT_BIN_REC_MAX - 1] = 0xff;
+    tpol_tsdu_t tsdu = {
+        .log_ch = LOG_CH_SDCH,
+        .data_len = EVT_BIN_REC_MAX,
+        .data = data,
+    };
+    tetrapol_evt_t evt;
+    mk_evt(&evt, TETRAPOL_EVT_TSDU, 1000, 1500000000000000);
+    evt.tsdu.tsdu = &tsdu;
+    assert_int_equal(evt_bin_write(f, &ctx_write, &evt), 0);
+    int len = evt_bin_encode(buf, EVT_BIN_ENCODE_MAX, &ctx_encode, &evt);
+    assert_true(len > EVT_BIN_REC_MAX);
+    assert_true(len <= EVT_BIN_ENCODE_MAX);
+
+    // buffer too small, context is not modified
+    const uint8_t rch_data[8] = { 0x01, [7] = 0x80, };
+    mk_evt(&evt, TETRAPOL_EVT_RCH, 1100, 1500000000010000);
+    evt.rch.data = rch_data;
+    evt.rch.len = sizeof(rch_data);
+    assert_int_equal(-1, evt_bin_encode(&buf[len], EVT_BIN_REC_HDR_LEN + 4,
+                &ctx_encode, &evt));
+    assert_true(ctx_encode.rx_offs == 1000);
+    assert_int_equal(evt_bin_write(f, &ctx_write, &evt), 0);
+    const int len2 = evt_bin_encode(&buf[len], EVT_BIN_ENCODE_MAX,
+            &ctx_encode, &evt);
+    assert_int_equal(EVT_BIN_REC_HDR_LEN + sizeof(rch_data), len2);
+    len += len2;
+    assert_true(ctx_write.rx_offs == ctx_encode.rx_offs);
+    assert_true(ctx_write.rx_time == ctx_encode.rx_time);
+
+    rewind(f);
+    assert_int_equal(len, fread(buf2, 1, 2 * EVT_BIN_ENCODE_MAX, f));
+    assert_memory_equal(buf, buf2, len);
+
+    free(data);
+    free(buf2);
+    free(buf);
+    fclose(f);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_round_trip),
+        unit_test(test_write_encode),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,156 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/evt_bus.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static const char SOCK_PATH[] = "test_evt_bus.sock";
+
+static int subscribe(const char *req)
+{
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    strcpy(sa.sun_path, SOCK_PATH);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert_true(fd >= 0);
+    assert_int_equal(connect(fd, (struct sockaddr *)&sa, sizeof(sa)), 0);
+    assert_int_equal(write(fd, req, strlen(req)), strlen(req));
+
+    return fd;
+}
+
+static void mk_scr(tetrapol_evt_t *evt, int scr)
+{
+    memset(evt, 0, sizeof(*evt));
+    evt->type = TETRAPOL_EVT_SCR;
+    evt->rx_offs = 160 * scr;
+    evt->rx_time = 1500000000000000 + 20000 * scr;
+    evt->frame_no = FRAME_NO_UNKNOWN;
+    evt->scr.scr = scr;
+}
+
+/// subscriber receives only events matching subscription
+static void test_subscribe(void **state)
+{
+    (void) state;   // unused
+
+    evt_bus_t *bus = evt_bus_create(SOCK_PATH, EVT_BUS_QUEUE_SIZE_DEFAULT);
+    assert_non_null(bus);
+
+    const int fd = subscribe("events=SCR,FRAME frame=VOICE\n");
+    evt_bus_poll(bus);
+
+    tetrapol_evt_t evt;
+    mk_scr(&evt, 7);
+    evt_bus_publish(bus, &evt);
+
+    frame_t fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.fr_type = FRAME_TYPE_DATA;
+    evt.type = TETRAPOL_EVT_FRAME;
+    evt.frame.fr = &fr;
+    evt_bus_publish(bus, &evt);
+
+    const uint8_t pch_data[16] = { 0x80, };
+    evt.type = TETRAPOL_EVT_PCH;
+    evt.pch.data = pch_data;
+    evt.pch.len = sizeof(pch_data);
+    evt_bus_publish(bus, &evt);
+
+    evt_bus_stats_t stats;
+    evt_bus_get_stats(bus, &stats);
+    assert_true(stats.clients == 1);
+    assert_true(stats.published == 3);
+    assert_true(stats.queued == 1);
+    assert_true(stats.dropped == 0);
+
+    evt_bus_poll(bus);
+    evt_bus_destroy(bus);
+
+    FILE *f = fdopen(fd, "rb");
+    assert_non_null(f);
+    evt_bin_ctx_t ctx;
+    evt_bin_ctx_init(&ctx);
+    evt_bin_rec_t *rec = malloc(sizeof(evt_bin_rec_t));
+    assert_non_null(rec);
+    assert_int_equal(evt_bin_read_file_hdr(f), 0);
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 1);
+    assert_int_equal(rec->evt.type, TETRAPOL_EVT_SCR);
+    assert_int_equal(rec->evt.scr.scr, 7);
+    assert_int_equal(evt_bin_read(f, &ctx, rec), 0);
+
+    free(rec);
+    fclose(f);
+}
+
+/// publisher does not block on subscriber which does not read
+static void test_slow_subscriber(void **state)
+{
+    (void) state;   // unused
+
+    evt_bus_t *bus = evt_bus_create(SOCK_PATH, EVT_BIN_ENCODE_MAX);
+    assert_non_null(bus);
+
+    const int fd_drop = subscribe("\n");
+    const int fd_disconnect = subscribe("policy=disconnect\n");
+    evt_bus_poll(bus);
+
+    const int n = 200000;
+    tetrapol_evt_t evt;
+    for (int i = 0; i < n; ++i) {
+        mk_scr(&evt, i % 128);
+        evt_bus_publish(bus, &evt);
+    }
+
+    evt_bus_stats_t stats;
+    evt_bus_get_stats(bus, &stats);
+    assert_true(stats.clients == 2);
+    assert_true(stats.published == n);
+    assert_true(stats.disconnected == 1);
+    assert_true(stats.dropped > 1);
+    assert_true(stats.queued + stats.dropped < 2 * n);
+    assert_true(stats.queued + stats.dropped > n);
+
+    evt_bus_destroy(bus);
+
+    // stream of slow subscriber is still consistent
+    FILE *f = fdopen(fd_drop, "rb");
+    assert_non_null(f);
+    evt_bin_ctx_t ctx;
+    evt_bin_ctx_init(&ctx);
+    evt_bin_rec_t *rec = malloc(sizeof(evt_bin_rec_t));
+    assert_non_null(rec);
+    assert_int_equal(evt_bin_read_file_hdr(f), 0);
+    int nrecs = 0;
+    while (evt_bin_read(f, &ctx, rec) == 1) {
+        assert_int_equal(rec->evt.type, TETRAPOL_EVT_SCR);
+        assert_true(rec->evt.rx_offs == 160 * rec->evt.scr.scr);
+        ++nrecs;
+    }
+    assert_true(nrecs > 0);
+    assert_true(nrecs < n);
+
+    free(rec);
+    fclose(f);
+    close(fd_disconnect);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_subscribe),
+        unit_test(test_slow_subscriber),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,134 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/evt_delta.h>
+
+#include <string.h>
+
+enum {
+    KEYFRAME_INTERVAL = 10 * 1000000,
+    SUPERFRAME_BITS = 200 * 160,    ///< 4 s
+};
+
+/// broadcast events are replaced by repeat and expanded back
+static void test_delta_expand(void **state)
+{
+    (void) state;   // unused
+
+    evt_delta_t *delta = evt_delta_create(KEYFRAME_INTERVAL);
+    assert_non_null(delta);
+    evt_expand_t *expand = evt_expand_create();
+    assert_non_null(expand);
+
+    uint8_t bch_data[] = { 0x90, 0x01, 0x02, 0x03, };
+    tpol_tsdu_t bch = {
+        .log_ch = LOG_CH_BCH,
+        .addr = { .z = 1, .y = 7, .x = 0xfff, },
+        .tpdu_type = TPDU_TYPE_TPDU_UI,
+        .tsap_id = 0,
+        .tsap_ref_swmi = TSAP_REF_UNKNOWN,
+        .tsap_ref_rt = TSAP_REF_UNKNOWN,
+        .data_len = sizeof(bch_data),
+        .data = bch_data,
+    };
+    const uint8_t sdch_data[] = { 0x44, };
+    tpol_tsdu_t sdch = bch;
+    sdch.log_ch = LOG_CH_SDCH;
+    sdch.data = sdch_data;
+    sdch.data_len = sizeof(sdch_data);
+    uint8_t pch_data[16] = { 0x01, };
+
+    int nrepeats = 0;
+    int nfull = 0;
+    for (int i = 0; i < 20; ++i) {
+        if (i == 7) {
+            // content change
+            bch_data[3] = 0x04;
+        }
+
+        tetrapol_evt_t evts[3];
+        memset(evts, 0, sizeof(evts));
+        for (int j = 0; j < 3; ++j) {
+            evts[j].rx_offs = i * SUPERFRAME_BITS + j * 160;
+            evts[j].rx_time = 1500000000000000 + evts[j].rx_offs * 125;
+            evts[j].frame_no = (j == 2) ? FRAME_NO_UNKNOWN : j;
+        }
+        evts[0].type = TETRAPOL_EVT_TSDU;
+        evts[0].tsdu.tsdu = &bch;
+        evts[1].type = TETRAPOL_EVT_PCH;
+        evts[1].pch.data = pch_data;
+        evts[1].pch.len = sizeof(pch_data);
+        evts[2].type = TETRAPOL_EVT_TSDU;
+        evts[2].tsdu.tsdu = &sdch;
+
+        for (int j = 0; j < 3; ++j) {
+            tetrapol_evt_t repeat;
+            const tetrapol_evt_t *d = evt_delta_push(delta, &evts[j], &repeat);
+            if (d == &repeat) {
+                ++nrepeats;
+                assert_int_equal(TETRAPOL_EVT_REPEAT, d->type);
+                assert_int_equal(j ? LOG_CH_PCH : LOG_CH_BCH, d->repeat.log_ch);
+                assert_true(j < 2);
+            } else {
+                ++nfull;
+                assert_true(d == &evts[j]);
+            }
+
+            const tetrapol_evt_t *e = evt_expand_push(expand, d);
+            assert_non_null(e);
+            assert_int_equal(evts[j].type, e->type);
+            assert_int_equal(evts[j].rx_offs, e->rx_offs);
+            assert_int_equal(evts[j].rx_time, e->rx_time);
+            assert_int_equal(evts[j].frame_no, e->frame_no);
+            if (e->type == TETRAPOL_EVT_PCH) {
+                assert_int_equal(sizeof(pch_data), e->pch.len);
+                assert_memory_equal(pch_data, e->pch.data, sizeof(pch_data));
+            } else {
+                const tpol_tsdu_t *exp = evts[j].tsdu.tsdu;
+                const tpol_tsdu_t *tsdu = e->tsdu.tsdu;
+                assert_int_equal(exp->log_ch, tsdu->log_ch);
+                assert_int_equal(exp->tpdu_type, tsdu->tpdu_type);
+                assert_int_equal(exp->addr.x, tsdu->addr.x);
+                assert_int_equal(exp->data_len, tsdu->data_len);
+                assert_memory_equal(exp->data, tsdu->data, exp->data_len);
+            }
+        }
+    }
+
+    // all 20 SDCH; BCH in superframes 0, 3, 6, 7 (change), 10, 13, 16, 19;
+    // PCH in superframes 0, 3, 6, 9, 12, 15, 18
+    assert_int_equal(20 + 8 + 7, nfull);
+    assert_int_equal(60 - nfull, nrepeats);
+
+    evt_expand_destroy(expand);
+    evt_delta_destroy(delta);
+}
+
+/// repeat without preceeding full event can not be expanded
+static void test_expand_no_state(void **state)
+{
+    (void) state;   // unused
+
+    evt_expand_t *expand = evt_expand_create();
+    assert_non_null(expand);
+
+    tetrapol_evt_t evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = TETRAPOL_EVT_REPEAT;
+    evt.repeat.log_ch = LOG_CH_RCH;
+    assert_null(evt_expand_push(expand, &evt));
+
+    evt_expand_destroy(expand);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_delta_expand),
+        unit_test(test_expand_no_state),
+    };
+
+    return run_tests(tests);
+}
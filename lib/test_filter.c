@@ -0,0 +1,329 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+#include "test_sim.h"
+
+#include <tetrapol/filter.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/tetrapol_int.h>
+
+enum {
+    NFRAMES = 5 * 200,
+};
+
+typedef struct {
+    int nframes;
+    int nhdlc;
+    int nlsdu;
+    int npch;
+    int nrch;
+    int ntsdus;
+    int ntsdus_codop[256];
+} evt_cnt_t;
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    evt_cnt_t *cnt = ptr;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            ++cnt->nframes;
+            break;
+
+        case TETRAPOL_EVT_HDLC:
+            ++cnt->nhdlc;
+            break;
+
+        case TETRAPOL_EVT_LSDU:
+            ++cnt->nlsdu;
+            break;
+
+        case TETRAPOL_EVT_PCH:
+            ++cnt->npch;
+            break;
+
+        case TETRAPOL_EVT_RCH:
+            ++cnt->nrch;
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            ++cnt->ntsdus;
+            if (evt->tsdu.tsdu->data_len > 0) {
+                ++cnt->ntsdus_codop[evt->tsdu.tsdu->data[0]];
+            }
+            break;
+    }
+}
+
+static void test_parse(void **state)
+{
+    (void) state;   // unused
+
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+
+    assert_int_equal(0, filter_parse(&filter, "log_ch=SDCH,BCH"));
+    assert_int_equal((1 << LOG_CH_SDCH) | (1 << LOG_CH_BCH), filter.log_ch_mask);
+
+    assert_int_equal(0, filter_parse(&filter, "frame=DATA"));
+    assert_int_equal(1 << FRAME_TYPE_DATA, filter.fr_type_mask);
+
+    assert_int_equal(0, filter_parse(&filter, "codop=0x4e,13"));
+    assert_int_equal(2, filter.ncodops);
+    assert_int_equal(0x4e, filter.codops[0]);
+    assert_int_equal(13, filter.codops[1]);
+
+    assert_int_equal(0, filter_parse(&filter, "addr=1.7.0xfff,0.1.0-0.1.0xff"));
+    assert_int_equal(2, filter.naddr_ranges);
+    assert_int_equal(TETRAPOL_ADDR(1, 7, 0xfff), filter.addr_ranges[0].first);
+    assert_int_equal(TETRAPOL_ADDR(1, 7, 0xfff), filter.addr_ranges[0].last);
+    assert_int_equal(TETRAPOL_ADDR(0, 1, 0), filter.addr_ranges[1].first);
+    assert_int_equal(TETRAPOL_ADDR(0, 1, 0xff), filter.addr_ranges[1].last);
+}
+
+static void test_parse_invalid(void **state)
+{
+    (void) state;   // unused
+
+    const char *exprs[] = {
+        "log_ch",
+        "log_ch=",
+        "log_ch=FOO",
+        "log_ch=SDCH,",
+        "codop=0x100",
+        "codop=-1",
+        "codop=1x",
+        "addr=1.7",
+        "addr=2.0.0",
+        "addr=0.8.0",
+        "addr=0.0.0x1000",
+        "addr=0.1.5-0.1.4",
+        "frame=FOO",
+        "foo=1",
+    };
+
+    for (int i = 0; i < sizeof(exprs) / sizeof(exprs[0]); ++i) {
+        tetrapol_filter_t filter;
+        filter_init(&filter);
+        assert_int_equal(-1, filter_parse(&filter, exprs[i]));
+    }
+}
+
+static void check_filtered(tetrapol_t *tetrapol, uint64_t log_ch,
+        uint64_t codop, uint64_t addr, uint64_t fr_type)
+{
+    tetrapol_stats_t stats;
+    tetrapol_get_stats(tetrapol, &stats);
+    assert_true(stats.filtered_log_ch == log_ch);
+    assert_true(stats.filtered_codop == codop);
+    assert_true(stats.filtered_addr == addr);
+    assert_true(stats.filtered_fr_type == fr_type);
+}
+
+static void test_evt(void **state)
+{
+    (void) state;   // unused
+
+    tetrapol_t *tetrapol = tetrapol_create(&test_sim_cfg);
+    assert_non_null(tetrapol);
+    tpol_t *tpol = tetrapol_get_tpol(tetrapol);
+    evt_cnt_t cnt;
+    memset(&cnt, 0, sizeof(cnt));
+    assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_FRAME |
+                TETRAPOL_EVT_HDLC | TETRAPOL_EVT_LSDU | TETRAPOL_EVT_PCH |
+                TETRAPOL_EVT_RCH | TETRAPOL_EVT_TSDU, evt_cb, &cnt));
+
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+    assert_int_equal(0, filter_parse(&filter, "log_ch=SDCH"));
+    assert_int_equal(0, filter_parse(&filter, "codop=0x4e"));
+    assert_int_equal(0, filter_parse(&filter, "addr=0.1.0-0.1.0xff"));
+    assert_int_equal(0, filter_parse(&filter, "frame=DATA"));
+    assert_true(tetrapol_set_filter(tetrapol, &filter));
+    assert_true(tetrapol_has_filter(tetrapol));
+
+    frame_t fr;
+    memset(&fr, 0, sizeof(fr));
+    fr.fr_type = FRAME_TYPE_DATA;
+    tetrapol_evt_frame(tpol, &fr);
+    fr.fr_type = FRAME_TYPE_VOICE;
+    tetrapol_evt_frame(tpol, &fr);
+    assert_int_equal(1, cnt.nframes);
+    check_filtered(tetrapol, 0, 0, 0, 1);
+
+    hdlc_frame_t hdlc_fr;
+    memset(&hdlc_fr, 0, sizeof(hdlc_fr));
+    hdlc_fr.addr.y = 1;
+    hdlc_fr.addr.x = 5;
+    tetrapol_evt_hdlc(tpol, LOG_CH_SDCH, &hdlc_fr);
+    tetrapol_evt_lsdu(tpol, LOG_CH_SDCH, &hdlc_fr);
+    tetrapol_evt_hdlc(tpol, LOG_CH_DCH, &hdlc_fr);
+    tetrapol_evt_lsdu(tpol, LOG_CH_DCH, &hdlc_fr);
+    assert_int_equal(1, cnt.nhdlc);
+    assert_int_equal(1, cnt.nlsdu);
+    check_filtered(tetrapol, 2, 0, 0, 1);
+    hdlc_fr.addr.y = 2;
+    tetrapol_evt_hdlc(tpol, LOG_CH_SDCH, &hdlc_fr);
+    tetrapol_evt_lsdu(tpol, LOG_CH_SDCH, &hdlc_fr);
+    assert_int_equal(1, cnt.nhdlc);
+    assert_int_equal(1, cnt.nlsdu);
+    check_filtered(tetrapol, 2, 0, 2, 1);
+
+    uint8_t data[] = { 0x4e, 0x00, };
+    tpol_tsdu_t tsdu = {
+        .log_ch = LOG_CH_SDCH,
+        .addr = { .y = 1, .x = 0xff, },
+        .data_len = sizeof(data),
+        .data = data,
+    };
+    tetrapol_evt_tsdu(tpol, &tsdu);
+    assert_int_equal(1, cnt.ntsdus);
+    data[0] = 0x4f;
+    tetrapol_evt_tsdu(tpol, &tsdu);
+    data[0] = 0x4e;
+    tsdu.addr.x = 0x100;
+    tetrapol_evt_tsdu(tpol, &tsdu);
+    tsdu.log_ch = LOG_CH_PCH;
+    tetrapol_evt_tsdu(tpol, &tsdu);
+    assert_int_equal(1, cnt.ntsdus);
+    check_filtered(tetrapol, 3, 1, 3, 1);
+
+    // PCH and RCH blocks are not on SDCH
+    const uint8_t block[8] = { 0, };
+    tetrapol_evt_pch(tpol, block, sizeof(block));
+    tetrapol_evt_rch(tpol, block, sizeof(block));
+    assert_int_equal(0, cnt.npch);
+    assert_int_equal(0, cnt.nrch);
+    check_filtered(tetrapol, 5, 1, 3, 1);
+
+    tetrapol_filter_t filter_blocks;
+    filter_init(&filter_blocks);
+    assert_int_equal(0, filter_parse(&filter_blocks, "log_ch=PCH,RCH"));
+    assert_true(tetrapol_set_filter(tetrapol, &filter_blocks));
+    tetrapol_evt_pch(tpol, block, sizeof(block));
+    tetrapol_evt_rch(tpol, block, sizeof(block));
+    assert_int_equal(1, cnt.npch);
+    assert_int_equal(1, cnt.nrch);
+    check_filtered(tetrapol, 5, 1, 3, 1);
+
+    // filter evaluated for already created events (evt_bus) is the same
+    tetrapol_evt_t evt;
+    memset(&evt, 0, sizeof(evt));
+    evt.type = TETRAPOL_EVT_PCH;
+    assert_false(filter_match(&filter, &evt));
+    assert_true(filter_match(&filter_blocks, &evt));
+    evt.type = TETRAPOL_EVT_RCH;
+    assert_false(filter_match(&filter, &evt));
+    assert_true(filter_match(&filter_blocks, &evt));
+    evt.type = TETRAPOL_EVT_TSDU;
+    evt.tsdu.tsdu = &tsdu;
+    assert_false(filter_match(&filter, &evt));
+    tsdu.log_ch = LOG_CH_SDCH;
+    assert_false(filter_match(&filter, &evt));
+    tsdu.addr.x = 0xff;
+    assert_true(filter_match(&filter, &evt));
+    data[0] = 0x4f;
+    assert_false(filter_match(&filter, &evt));
+    data[0] = 0x4e;
+    tsdu.data_len = 0;
+    assert_false(filter_match(&filter, &evt));
+    tsdu.data_len = sizeof(data);
+    tsdu.log_ch = LOG_CH_PCH;
+    tsdu.addr.x = 0x100;
+
+    // filter removed, counters are kept
+    assert_true(tetrapol_set_filter(tetrapol, NULL));
+    assert_false(tetrapol_has_filter(tetrapol));
+    tetrapol_evt_frame(tpol, &fr);
+    tetrapol_evt_hdlc(tpol, LOG_CH_DCH, &hdlc_fr);
+    tetrapol_evt_lsdu(tpol, LOG_CH_DCH, &hdlc_fr);
+    tetrapol_evt_tsdu(tpol, &tsdu);
+    tetrapol_evt_pch(tpol, block, sizeof(block));
+    assert_int_equal(2, cnt.nframes);
+    assert_int_equal(2, cnt.nhdlc);
+    assert_int_equal(2, cnt.nlsdu);
+    assert_int_equal(2, cnt.npch);
+    assert_int_equal(2, cnt.ntsdus);
+    check_filtered(tetrapol, 5, 1, 3, 1);
+
+    tetrapol_destroy(tetrapol);
+}
+
+/// decode simulated traffic
+static tetrapol_t *decode(uint8_t *bits, const tetrapol_filter_t *filter,
+        evt_cnt_t *cnt)
+{
+    tetrapol_t *tetrapol = tetrapol_create(&test_sim_cfg);
+    assert_non_null(tetrapol);
+    memset(cnt, 0, sizeof(*cnt));
+    assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_TSDU, evt_cb, cnt));
+    assert_true(tetrapol_set_filter(tetrapol, filter));
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+
+    for (int i = 0; i < NFRAMES; ++i) {
+        assert_int_equal(FRAME_LEN,
+                tetrapol_phys_ch_recv(phys_ch, &bits[i * FRAME_LEN], FRAME_LEN));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+    tetrapol_phys_ch_destroy(phys_ch);
+
+    return tetrapol;
+}
+
+static void test_decode(void **state)
+{
+    (void) state;   // unused
+
+    uint8_t *bits = test_sim_gen_bits(NFRAMES);
+    evt_cnt_t *cnt = malloc(sizeof(evt_cnt_t));
+    evt_cnt_t *cnt_filtered = malloc(sizeof(evt_cnt_t));
+    assert_non_null(cnt);
+    assert_non_null(cnt_filtered);
+
+    tetrapol_t *tetrapol = decode(bits, NULL, cnt);
+    tetrapol_destroy(tetrapol);
+    int codop = 0;
+    for (int i = 0; i < 256; ++i) {
+        if (cnt->ntsdus_codop[i] > cnt->ntsdus_codop[codop]) {
+            codop = i;
+        }
+    }
+    assert_true(cnt->ntsdus_codop[codop] > 0);
+    assert_true(cnt->ntsdus_codop[codop] < cnt->ntsdus);
+
+    // only TSDUs with the most frequent codop are reported
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+    char expr[32];
+    snprintf(expr, sizeof(expr), "codop=%d", codop);
+    assert_int_equal(0, filter_parse(&filter, expr));
+    tetrapol = decode(bits, &filter, cnt_filtered);
+    assert_int_equal(cnt->ntsdus_codop[codop], cnt_filtered->ntsdus);
+    assert_int_equal(cnt->ntsdus_codop[codop],
+            cnt_filtered->ntsdus_codop[codop]);
+    check_filtered(tetrapol, 0, cnt->ntsdus - cnt->ntsdus_codop[codop], 0, 0);
+    tetrapol_destroy(tetrapol);
+
+    free(cnt_filtered);
+    free(cnt);
+    free(bits);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_parse),
+        unit_test(test_parse_invalid),
+        unit_test(test_evt),
+        unit_test(test_decode),
+    };
+
+    return run_tests(tests);
+}
@@ -278,6 +278,44 @@ static void test_frame_encode2(void **state)
     assert_memory_equal(frame_dec2+26, frame_dec+26, 50);
 }
 
+// both parts encoded into the same buffer as done by frame encoder, the last
+// bit of the first part is set, it must not spill into the second part
+static void test_frame_encode_roundtrip(void **state)
+{
+    const uint8_t frame_dec[26+50] = {
+        1, 0, 1, 1, 0, 1, 1, 0,
+        0, 1, 1, 0, 1, 0, 0, 1,
+        1, 1, 0, 0, 1, 0, 1, 1,
+        1, 1,
+        0, 1, 1, 0, 1, 0, 0, 1,
+        1, 1, 0, 0, 0, 1, 0, 1,
+        0, 1, 0, 1, 1, 0, 1, 0,
+        0, 0, 1, 0, 1, 1, 1, 1,
+        1, 0, 0, 0, 0, 0, 1, 1,
+        0, 0, 0, 1, 0, 0, 1, 0,
+        0, 0
+    };
+    uint8_t frame_enc[19];
+    memset(frame_enc, 0, sizeof(frame_enc));
+    frame_encode1(frame_enc, frame_dec);
+    frame_encode2(frame_enc, frame_dec);
+
+    uint8_t bits[152];
+    for (int i = 0; i < sizeof(bits); ++i) {
+        bits[i] = (frame_enc[i / 8] >> (i % 8)) & 1;
+    }
+
+    uint8_t frame_dec2[26+50], frame_errs[26+50];
+    uint8_t fr_errs_exp[26+50];
+    memset(fr_errs_exp, 0, sizeof(fr_errs_exp));
+    assert_int_equal(0,
+            frame_decode1(frame_dec2, frame_errs, bits, FRAME_TYPE_DATA));
+    assert_int_equal(0,
+            frame_decode2(frame_dec2, frame_errs, bits, FRAME_TYPE_DATA));
+    assert_memory_equal(fr_errs_exp, frame_errs, sizeof(fr_errs_exp));
+    assert_memory_equal(frame_dec, frame_dec2, sizeof(frame_dec));
+}
+
 int main(void)
 {
     const UnitTest tests[] = {
@@ -289,6 +327,7 @@ int main(void)
         unit_test(test_mk_crc5),
         unit_test(test_frame_encode1),
         unit_test(test_frame_encode2),
+        unit_test(test_frame_encode_roundtrip),
     };
 
     return run_tests(tests);
@@ -0,0 +1,105 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/json_writer.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// check buffered output against printf, writer is never flushed here
+static void check_buf(json_writer_t *jw, const char *expected)
+{
+    assert_int_equal(strlen(expected), jw->len);
+    assert_memory_equal(expected, jw->buf, jw->len);
+    jw->len = 0;
+}
+
+static void test_int(void **state)
+{
+    (void) state;   // unused
+
+    const int64_t vals[] = {
+        0, 1, 9, 10, 99, 100, 101, 999, 1000, 12345, 65535, -1, -10, -99,
+        -100, -32768, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN,
+    };
+    json_writer_t *jw = json_writer_create(-1);
+    assert_non_null(jw);
+
+    char buf[64];
+    for (int i = 0; i < sizeof(vals) / sizeof(vals[0]); ++i) {
+        json_writer_int(jw, vals[i]);
+        sprintf(buf, "%" PRId64, vals[i]);
+        check_buf(jw, buf);
+
+        json_writer_uint(jw, vals[i]);
+        sprintf(buf, "%" PRIu64, (uint64_t)vals[i]);
+        check_buf(jw, buf);
+    }
+
+    json_writer_destroy(jw);
+}
+
+static void test_hex(void **state)
+{
+    (void) state;   // unused
+
+    uint8_t data[256];
+    char buf[2*sizeof(data) + 1];
+    for (int i = 0; i < sizeof(data); ++i) {
+        data[i] = i;
+        sprintf(&buf[2*i], "%02x", i);
+    }
+
+    json_writer_t *jw = json_writer_create(-1);
+    assert_non_null(jw);
+
+    json_writer_hex(jw, data, sizeof(data));
+    check_buf(jw, buf);
+    json_writer_hex(jw, data, 0);
+    check_buf(jw, "");
+
+    json_writer_destroy(jw);
+}
+
+static void test_time(void **state)
+{
+    (void) state;   // unused
+
+    const uint64_t times[] = {
+        0, 999999, 1000000, 1456789012345678ULL, 1456789012999999ULL,
+        1456789013000000ULL, 1456789013000001ULL, 1456789012000000ULL,
+        4102444799999999ULL,
+    };
+    json_writer_t *jw = json_writer_create(-1);
+    assert_non_null(jw);
+
+    char buf[64];
+    for (int i = 0; i < sizeof(times) / sizeof(times[0]); ++i) {
+        const time_t sec = times[i] / 1000000;
+        const long usec = times[i] % 1000000;
+        struct tm gmt;
+        gmtime_r(&sec, &gmt);
+        sprintf(buf, "%4d-%02d-%02dT%02d-%02d-%02d.%06ld",
+                gmt.tm_year + 1900, gmt.tm_mon + 1, gmt.tm_mday,
+                gmt.tm_hour, gmt.tm_min, gmt.tm_sec, usec);
+
+        json_writer_time(jw, times[i]);
+        check_buf(jw, buf);
+    }
+
+    json_writer_destroy(jw);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_int),
+        unit_test(test_hex),
+        unit_test(test_time),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,144 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#define LOG_PREFIX "test"
+#include <tetrapol/log.h>
+#include <tetrapol/log_async.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/// redirect stderr into temporary file, return original stderr
+static int stderr_capture(FILE **f)
+{
+    *f = tmpfile();
+    assert_non_null(*f);
+    const int fd = dup(STDERR_FILENO);
+    assert_true(fd >= 0);
+    assert_true(dup2(fileno(*f), STDERR_FILENO) >= 0);
+
+    return fd;
+}
+
+/// restore stderr, return captured output
+static char *stderr_restore(int fd, FILE *f)
+{
+    fflush(stderr);
+    assert_true(dup2(fd, STDERR_FILENO) >= 0);
+    close(fd);
+
+    const long len = ftell(f);
+    assert_true(len >= 0);
+    char *s = malloc(len + 1);
+    assert_non_null(s);
+    rewind(f);
+    assert_int_equal(fread(s, 1, len, f), len);
+    s[len] = 0;
+    fclose(f);
+
+    return s;
+}
+
+/// output is the same as output of synchronous logging
+static void test_format(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f;
+    const int fd = stderr_capture(&f);
+
+    const char data[] = { 'a', 'b', 'c', };
+    for (int async = 0; async < 2; ++async) {
+        if (async) {
+            assert_int_equal(log_async_start(), 0);
+        }
+        LOG(ERR, "%d %i %02x %04X %o %u", -7, 42, 0xab, 0xcd, 8, 3000000000u);
+        LOGF("%s|%10s|%-4s|%.2s|%.*s|%*d\n", "str", "right", "l", "xyz",
+                (int)sizeof(data), data, 5, 12);
+        LOGF("%zu %llu %ld %hhx %c %% %5.1f %g %p\n", (size_t)123,
+                (unsigned long long)UINT64_MAX, -1234567890L, 0x1ff, 'q',
+                3.14159, 1e-10, (void *)0x1234);
+        LOGF("no newline, ");
+        LOGF("continued\n");
+        if (async) {
+            log_async_stop();
+        }
+    }
+
+    char *s = stderr_restore(fd, f);
+    const int len = strlen(s);
+    assert_true(len % 2 == 0);
+    assert_memory_equal(s, s + len / 2, len / 2);
+    assert_non_null(strstr(s, "|abc|   12\n"));
+    free(s);
+}
+
+enum {
+    THREAD_MSGS = 5000,
+};
+
+static void *log_thread(void *arg)
+{
+    const int id = *(int *)arg;
+    for (int i = 0; i < THREAD_MSGS; ++i) {
+        LOGF("%d %d\n", id, i);
+    }
+
+    return NULL;
+}
+
+/// messages of each thread are kept in order, lost messages are counted
+static void test_threads(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f;
+    const int fd = stderr_capture(&f);
+
+    const uint64_t dropped = log_async_dropped();
+    assert_int_equal(log_async_start(), 0);
+    pthread_t threads[2];
+    int ids[2] = { 0, 1, };
+    for (int i = 0; i < 2; ++i) {
+        assert_int_equal(pthread_create(&threads[i], NULL, log_thread,
+                    &ids[i]), 0);
+    }
+    for (int i = 0; i < 2; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    log_async_stop();
+
+    char *s = stderr_restore(fd, f);
+    int last[2] = { -1, -1, };
+    int nmsgs = 0;
+    char *saveptr;
+    for (char *line = strtok_r(s, "\n", &saveptr); line;
+            line = strtok_r(NULL, "\n", &saveptr)) {
+        int id, i;
+        if (sscanf(line, "%d %d", &id, &i) != 2) {
+            continue;
+        }
+        assert_in_range(id, 0, 1);
+        assert_true(i > last[id]);
+        last[id] = i;
+        ++nmsgs;
+    }
+    assert_int_equal(nmsgs + log_async_dropped() - dropped, 2 * THREAD_MSGS);
+
+    free(s);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_format),
+        unit_test(test_threads),
+    };
+
+    return run_tests(tests);
+}
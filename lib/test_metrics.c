@@ -0,0 +1,87 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/frame.h>
+#include <tetrapol/metrics.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void test_hist(void **state)
+{
+    (void) state;   // unused
+
+    tetrapol_hist_t hist;
+    memset(&hist, 0, sizeof(hist));
+    metric_hist_add(&hist, 0);
+    metric_hist_add(&hist, 1);
+    metric_hist_add(&hist, 2);
+    metric_hist_add(&hist, 3);
+    metric_hist_add(&hist, 4);
+    metric_hist_add(&hist, 100);
+    metric_hist_add(&hist, UINT64_MAX / 2);
+
+    assert_true(hist.buckets[0] == 2);
+    assert_true(hist.buckets[1] == 1);
+    assert_true(hist.buckets[2] == 2);
+    assert_true(hist.buckets[7] == 1);
+    assert_true(hist.buckets[TETRAPOL_HIST_BUCKETS - 1] == 1);
+    assert_true(hist.count == 7);
+    assert_true(hist.sum == 110 + UINT64_MAX / 2);
+}
+
+static void test_write_prom(void **state)
+{
+    (void) state;   // unused
+
+    tetrapol_metrics_t *metrics = calloc(1, sizeof(tetrapol_metrics_t));
+    assert_non_null(metrics);
+    metrics->bits = 32000;
+    metrics->frames[FRAME_TYPE_DATA] = 190;
+    metrics->frames_broken[FRAME_TYPE_DATA] = 10;
+    metrics->tsdus[0x4e] = 3;
+    metric_hist_add(&metrics->scr_detect, 60);
+    metrics->terminals_live = 5;
+
+    const char path[] = "test_metrics.prom";
+    assert_int_equal(metrics_write_prom(path, metrics), 0);
+    free(metrics);
+
+    FILE *f = fopen(path, "r");
+    assert_non_null(f);
+    char buf[16 * 1024];
+    const size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    buf[len] = 0;
+    fclose(f);
+    remove(path);
+
+    assert_non_null(strstr(buf, "\ntetrapol_bits_total 32000\n"));
+    assert_non_null(strstr(buf,
+                "\ntetrapol_frames_total{type=\"data\",state=\"ok\"} 190\n"));
+    assert_non_null(strstr(buf,
+                "\ntetrapol_frames_total{type=\"data\",state=\"broken\"} 10\n"));
+    assert_non_null(strstr(buf, "\ntetrapol_tsdus_total{codop=\"0x4e\"} 3\n"));
+    assert_null(strstr(buf, "codop=\"0x00\""));
+    assert_non_null(strstr(buf,
+                "\ntetrapol_scr_detect_frames_bucket{le=\"32\"} 0\n"));
+    assert_non_null(strstr(buf,
+                "\ntetrapol_scr_detect_frames_bucket{le=\"64\"} 1\n"));
+    assert_non_null(strstr(buf,
+                "\ntetrapol_scr_detect_frames_bucket{le=\"+Inf\"} 1\n"));
+    assert_non_null(strstr(buf, "\ntetrapol_scr_detect_frames_sum 60\n"));
+    assert_non_null(strstr(buf, "\ntetrapol_terminals_live 5\n"));
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_hist),
+        unit_test(test_write_prom),
+    };
+
+    return run_tests(tests);
+}
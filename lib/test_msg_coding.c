@@ -0,0 +1,78 @@
+#include <tetrapol/arena.h>
+#include <tetrapol/msg_coding.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdalign.h>
+#include <stdlib.h>
+#include <cmocka.h>
+
+static void test_address_list(void **state)
+{
+    (void) state;   // unused
+
+    alignas(max_align_t) uint8_t buf[1024];
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+
+    // RFSI 123-4-56-789 followed by not significant address
+    const uint8_t data[] = { 0x91, 0x23, 0x45, 0x67, 0x89, 0x00, };
+    address_list_t *addrs = NULL;
+    assert_int_equal(0, address_list_decode(&arena, &addrs, data));
+    assert_int_equal(2, addrs->nadrs);
+    assert_int_equal(ADDRESS_CNA_RFSI, addrs->called_adr[0].cna);
+    for (int i = 0; i < 9; ++i) {
+        assert_int_equal(i + 1, addrs->called_adr[0].rfsi.addr[i]);
+    }
+    assert_int_equal(ADDRESS_CNA_NOT_SIGNIFICANT, addrs->called_adr[1].cna);
+
+    // list is extended by next call
+    const uint8_t data2[] = { 0x33, 0x12, 0x30, };
+    assert_int_equal(0, address_list_decode(&arena, &addrs, data2));
+    assert_int_equal(3, addrs->nadrs);
+    assert_int_equal(ADDRESS_CNA_PABX, addrs->called_adr[2].cna);
+    assert_int_equal(3, addrs->called_adr[2].len);
+    assert_int_equal(3, addrs->called_adr[2].pabx[2]);
+}
+
+static void test_address_list_unsupported(void **state)
+{
+    (void) state;   // unused
+
+    // length of unsupported address is unknown, list ends with it even when
+    // LI says another address follows, arena would be exhausted otherwise
+    alignas(max_align_t) uint8_t buf[1024];
+    arena_t arena;
+    arena_init(&arena, buf, sizeof(buf));
+    for (int cna = ADDRESS_CNA_FUNCTIONAL; cna <= ADDRESS_CNA_ESCAPED_CODE;
+            ++cna) {
+        const uint8_t data[] = { 0x91, 0x23, 0x45, 0x67, 0x89,
+            0x80 | (cna << 4), 0xff, 0xff, };
+        address_list_t *addrs = NULL;
+        arena_reset(&arena);
+        assert_int_equal(0, address_list_decode(&arena, &addrs, data));
+        assert_int_equal(2, addrs->nadrs);
+        assert_int_equal(ADDRESS_CNA_RFSI, addrs->called_adr[0].cna);
+        assert_int_equal(cna, addrs->called_adr[1].cna);
+        assert_int_equal(0, addrs->called_adr[1].len);
+    }
+
+    // X.400 first, list allocated from heap
+    const uint8_t data[] = { 0x80 | (ADDRESS_CNA_X400 << 4), 0xff, };
+    address_list_t *addrs = NULL;
+    assert_int_equal(0, address_list_decode(NULL, &addrs, data));
+    assert_int_equal(1, addrs->nadrs);
+    assert_int_equal(ADDRESS_CNA_X400, addrs->called_adr[0].cna);
+    free(addrs);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_address_list),
+        unit_test(test_address_list_unsupported),
+    };
+
+    return run_tests(tests);
+}
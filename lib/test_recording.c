@@ -0,0 +1,300 @@
+#define _DEFAULT_SOURCE 1
+
+#include "test_sim.h"
+
+#include <tetrapol/filter.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/recording.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+enum {
+    NFRAMES = 5 * 200,
+    MAX_TSDUS = 4096,
+    SEEK_SETTLE_FRAMES = 200,   ///< TSDUs started before seek are complete
+};
+
+typedef struct {
+    uint64_t rx_offs;
+    int frame_no;
+    uint64_t hash;      ///< hash of TSDU content
+} tsdu_rec_t;
+
+typedef struct {
+    int nframes;
+    uint64_t first_rx_offs;     ///< position of first frame
+    int first_frame_no;
+    int ntsdus;
+    tsdu_rec_t tsdus[MAX_TSDUS];
+} evt_log_t;
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    evt_log_t *log = ptr;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            if (!log->nframes++) {
+                log->first_rx_offs = evt->rx_offs - FRAME_LEN;
+                log->first_frame_no = evt->frame_no;
+            }
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            assert_true(log->ntsdus < MAX_TSDUS);
+            tsdu_rec_t *r = &log->tsdus[log->ntsdus++];
+            r->rx_offs = evt->rx_offs;
+            r->frame_no = evt->frame_no;
+            r->hash = 0;
+            for (int i = 0; i < evt->tsdu.tsdu->data_len; ++i) {
+                r->hash = (r->hash ^ evt->tsdu.tsdu->data[i]) * 0x100000001b3ULL;
+            }
+            break;
+    }
+}
+
+static tetrapol_t *create(const tetrapol_cfg_t *cfg, evt_log_t *log)
+{
+    tetrapol_t *tetrapol = tetrapol_create(cfg);
+    assert_non_null(tetrapol);
+    memset(log, 0, sizeof(*log));
+    assert_true(tetrapol_subscribe(tetrapol,
+                TETRAPOL_EVT_FRAME | TETRAPOL_EVT_TSDU, evt_cb, log));
+
+    return tetrapol;
+}
+
+/// decode simulated traffic, recording is written into f
+static void decode(FILE *f, evt_log_t *log)
+{
+    uint8_t *bits = test_sim_gen_bits(NFRAMES);
+    tetrapol_t *tetrapol = create(&test_sim_cfg, log);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    recording_writer_t *rw = recording_writer_create(f, 430000000, tetrapol);
+    assert_non_null(rw);
+
+    for (int i = 0; i < NFRAMES; ++i) {
+        uint8_t *fr_bits = &bits[i * FRAME_LEN];
+        assert_int_equal(0, recording_writer_write(rw, fr_bits, FRAME_LEN));
+        assert_int_equal(FRAME_LEN,
+                tetrapol_phys_ch_recv(phys_ch, fr_bits, FRAME_LEN));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+
+    assert_int_equal(0, recording_writer_destroy(rw));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+    free(bits);
+}
+
+/// decode recording from index entry e
+static void decode_from(int fd, const recording_hdr_t *hdr,
+        const recording_idx_t *e, evt_log_t *log)
+{
+    tetrapol_t *tetrapol = create(&hdr->cfg, log);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    tetrapol_phys_ch_seek(phys_ch, e->rx_offs, e->frame_no, e->scr);
+
+    uint8_t bits[FRAME_LEN];
+    for (uint64_t offs = e->rx_offs; offs < hdr->nbits; offs += FRAME_LEN) {
+        assert_int_equal(FRAME_LEN,
+                pread(fd, bits, FRAME_LEN, RECORDING_HDR_LEN + offs));
+        assert_int_equal(FRAME_LEN,
+                tetrapol_phys_ch_recv(phys_ch, bits, FRAME_LEN));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+}
+
+static void test_seek(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    evt_log_t *log = malloc(sizeof(evt_log_t));
+    evt_log_t *log_seek = malloc(sizeof(evt_log_t));
+    assert_non_null(log);
+    assert_non_null(log_seek);
+
+    decode(f, log);
+    assert_true(log->ntsdus > 0);
+
+    const int fd = fileno(f);
+    assert_int_equal(0, lseek(fd, 0, SEEK_SET));
+    recording_hdr_t hdr;
+    assert_int_equal(1, recording_read_hdr(fd, &hdr));
+    assert_int_equal(RECORDING_FMT_BITS, hdr.sample_fmt);
+    assert_int_equal(TETRAPOL_BAND_UHF, hdr.cfg.band);
+    assert_int_equal(DIR_DOWNLINK, hdr.cfg.dir);
+    assert_int_equal(TETRAPOL_RADIO_CCH, hdr.cfg.radio_ch_type);
+    assert_true(hdr.cfg.start_time == test_sim_cfg.start_time);
+    assert_true(hdr.freq == 430000000);
+    assert_true(hdr.nbits == NFRAMES * FRAME_LEN);
+    assert_true(hdr.index_offs == RECORDING_HDR_LEN + hdr.nbits);
+
+    recording_idx_t *idx;
+    const int nidx = recording_read_index(fd, &hdr, &idx);
+    assert_true(nidx >= NFRAMES / 100);
+    for (int i = 0; i < nidx; ++i) {
+        assert_int_equal(0, idx[i].rx_offs % FRAME_LEN);
+        assert_int_equal(TEST_SIM_SCR, idx[i].scr);
+        if (i) {
+            assert_true(idx[i - 1].rx_offs < idx[i].rx_offs);
+        }
+    }
+    const recording_idx_t *last = &idx[nidx - 1];
+    assert_int_equal(0, last->frame_no % 100);
+    assert_true(last->has_cell_id);
+
+    // seek into the middle of recording
+    const recording_idx_t *e = recording_find(idx, nidx, hdr.nbits / 2);
+    assert_non_null(e);
+    assert_true(e->rx_offs <= hdr.nbits / 2);
+    assert_true(e->frame_no != FRAME_NO_UNKNOWN);
+    decode_from(fd, &hdr, e, log_seek);
+
+    assert_int_equal((hdr.nbits - e->rx_offs) / FRAME_LEN, log_seek->nframes);
+    assert_true(log_seek->first_rx_offs == e->rx_offs);
+    assert_int_equal(e->frame_no, log_seek->first_frame_no);
+
+    // TSDUs after seek are the same as from decoding of the whole recording,
+    // only TSDUs received partially before seek point can be missing
+    assert_true(log_seek->ntsdus > log->ntsdus / 4);
+    int i = 0;
+    for (int j = 0; j < log_seek->ntsdus; ++j, ++i) {
+        while (log->tsdus[i].rx_offs != log_seek->tsdus[j].rx_offs ||
+                log->tsdus[i].hash != log_seek->tsdus[j].hash) {
+            assert_true(log->tsdus[i].rx_offs <
+                    e->rx_offs + SEEK_SETTLE_FRAMES * FRAME_LEN);
+            ++i;
+            assert_true(i < log->ntsdus);
+        }
+        assert_int_equal(log->tsdus[i].frame_no, log_seek->tsdus[j].frame_no);
+    }
+    assert_int_equal(log->ntsdus, i);
+
+    free(idx);
+    free(log_seek);
+    free(log);
+    fclose(f);
+}
+
+static void test_find(void **state)
+{
+    (void) state;   // unused
+
+    const recording_idx_t idx[] = {
+        { .rx_offs = 160, },
+        { .rx_offs = 320, },
+        { .rx_offs = 16000, },
+    };
+
+    assert_null(recording_find(idx, 0, 1000));
+    assert_null(recording_find(idx, 3, 159));
+    assert_true(&idx[0] == recording_find(idx, 3, 160));
+    assert_true(&idx[0] == recording_find(idx, 3, 319));
+    assert_true(&idx[1] == recording_find(idx, 3, 320));
+    assert_true(&idx[2] == recording_find(idx, 3, 16000));
+    assert_true(&idx[2] == recording_find(idx, 3, UINT64_MAX));
+}
+
+static void test_invalid(void **state)
+{
+    (void) state;   // unused
+
+    recording_hdr_t hdr;
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    const int fd = fileno(f);
+
+    // .bits file is not a recording
+    const uint8_t bits[] = { 0, 1, 1, 0, 1, 0, 0, 1, };
+    assert_int_equal(1, fwrite(bits, sizeof(bits), 1, f));
+    fflush(f);
+    assert_int_equal(0, lseek(fd, 0, SEEK_SET));
+    assert_int_equal(0, recording_read_hdr(fd, &hdr));
+    assert_int_equal(0, lseek(fd, 0, SEEK_CUR));
+
+    // truncated header
+    rewind(f);
+    assert_int_equal(1, fwrite("TPRC", 4, 1, f));
+    fflush(f);
+    assert_int_equal(0, lseek(fd, 0, SEEK_SET));
+    assert_int_equal(-1, recording_read_hdr(fd, &hdr));
+
+    fclose(f);
+
+    // interrupted writing, samples up to the end of file and no index
+    f = tmpfile();
+    assert_non_null(f);
+    tetrapol_t *tetrapol = tetrapol_create(&test_sim_cfg);
+    assert_non_null(tetrapol);
+
+    // index can not be built from filtered events
+    tetrapol_filter_t filter;
+    filter_init(&filter);
+    assert_int_equal(0, filter_parse(&filter, "codop=0x90"));
+    assert_true(tetrapol_set_filter(tetrapol, &filter));
+    assert_null(recording_writer_create(f, 0, tetrapol));
+    assert_true(tetrapol_set_filter(tetrapol, NULL));
+
+    recording_writer_t *rw = recording_writer_create(f, 0, tetrapol);
+    assert_non_null(rw);
+    assert_int_equal(0, recording_writer_write(rw, bits, sizeof(bits)));
+    fflush(f);
+    assert_int_equal(0, lseek(fileno(f), 0, SEEK_SET));
+    assert_int_equal(1, recording_read_hdr(fileno(f), &hdr));
+    assert_true(hdr.nbits == sizeof(bits));
+    assert_int_equal(0, hdr.nindex);
+    assert_int_equal(0, recording_writer_destroy(rw));
+    tetrapol_destroy(tetrapol);
+
+    fclose(f);
+}
+
+static void test_pipe(void **state)
+{
+    (void) state;   // unused
+
+    // pipe is not probed, even when data looks like a recording
+    int fds[2];
+    assert_int_equal(0, pipe(fds));
+    const uint8_t data[] = { 'T', 'P', 'R', 'C', 0, 1, 1, 0, };
+    assert_int_equal(sizeof(data), write(fds[1], data, sizeof(data)));
+    close(fds[1]);
+
+    recording_hdr_t hdr;
+    assert_int_equal(0, recording_read_hdr(fds[0], &hdr));
+    uint8_t buf[2 * sizeof(data)];
+    assert_int_equal(sizeof(data), read(fds[0], buf, sizeof(buf)));
+    assert_memory_equal(data, buf, sizeof(data));
+
+    close(fds[0]);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_seek),
+        unit_test(test_find),
+        unit_test(test_invalid),
+        unit_test(test_pipe),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,100 @@
+#include "test_sim.h"
+
+#include <tetrapol/frame.h>
+#include <tetrapol/swmi_sim.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+const tetrapol_cfg_t test_sim_cfg = {
+    .band = TETRAPOL_BAND_UHF,
+    .dir = DIR_DOWNLINK,
+    .radio_ch_type = TETRAPOL_RADIO_CCH,
+    .start_time = 1234567890123456ULL,
+};
+
+uint64_t test_sim_hash(uint64_t hash, uint64_t v)
+{
+    return (hash ^ v) * 0x100000001b3ULL;
+}
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    test_sim_cnt_t *cnt = ptr;
+
+    cnt->hash = test_sim_hash(cnt->hash, evt->type);
+    cnt->hash = test_sim_hash(cnt->hash, evt->rx_offs);
+    cnt->hash = test_sim_hash(cnt->hash, evt->rx_time);
+    cnt->hash = test_sim_hash(cnt->hash, evt->frame_no);
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_FRAME:
+            ++cnt->nframes;
+            break;
+
+        case TETRAPOL_EVT_SYNC:
+            ++cnt->nsync;
+            break;
+
+        case TETRAPOL_EVT_PCH:
+            ++cnt->npch;
+            break;
+
+        case TETRAPOL_EVT_TSDU:
+            ++cnt->ntsdus;
+            cnt->tsdu_hash = test_sim_hash(cnt->tsdu_hash, evt->rx_offs);
+            cnt->tsdu_hash = test_sim_hash(cnt->tsdu_hash, evt->frame_no);
+            for (int i = 0; i < evt->tsdu.tsdu->data_len; ++i) {
+                cnt->hash = test_sim_hash(cnt->hash, evt->tsdu.tsdu->data[i]);
+                cnt->tsdu_hash =
+                    test_sim_hash(cnt->tsdu_hash, evt->tsdu.tsdu->data[i]);
+            }
+            break;
+    }
+}
+
+tetrapol_t *test_sim_create(const tetrapol_cfg_t *cfg, test_sim_cnt_t *cnt)
+{
+    tetrapol_t *tetrapol = tetrapol_create(cfg);
+    assert_non_null(tetrapol);
+    memset(cnt, 0, sizeof(*cnt));
+    assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_FRAME |
+                TETRAPOL_EVT_SYNC | TETRAPOL_EVT_PCH | TETRAPOL_EVT_TSDU,
+                evt_cb, cnt));
+
+    return tetrapol;
+}
+
+uint8_t *test_sim_gen_bits(int nframes)
+{
+    const swmi_sim_cfg_t sim_cfg = {
+        .nterminals = 500,
+        .reg_rate = 2,
+        .call_rate = 0.5,
+        .ui_data_rate = 0.5,
+        .co_data_rate = 0.5,
+        .data_len = 300,
+    };
+    swmi_sim_t *sim = swmi_sim_create(&sim_cfg);
+    assert_non_null(sim);
+    frame_encoder_t *fe = frame_encoder_create(test_sim_cfg.band,
+            TEST_SIM_SCR, test_sim_cfg.dir);
+    assert_non_null(fe);
+
+    uint8_t *bits = malloc((size_t)nframes * FRAME_LEN);
+    assert_non_null(bits);
+    for (int i = 0; i < nframes; ++i) {
+        assert_int_equal(0, swmi_sim_bits(sim, fe, &bits[i * FRAME_LEN]));
+    }
+
+    frame_encoder_destroy(fe);
+    swmi_sim_destroy(sim);
+
+    return bits;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <tetrapol/tetrapol.h>
+
+#include <stdint.h>
+
+/**
+  Fixture shared by tests which decode simulated CCH traffic (capture,
+  recording, snapshot, ...). Traffic is generated by swmi_sim with fixed
+  population of terminals and mix of transactions, it is deterministic.
+  */
+
+enum {
+    TEST_SIM_SCR = 17,
+};
+
+/// Configuration of decoder for simulated traffic, UHF downlink CCH.
+extern const tetrapol_cfg_t test_sim_cfg;
+
+typedef struct {
+    uint64_t nframes;
+    uint64_t nsync;
+    uint64_t npch;
+    uint64_t ntsdus;
+    uint64_t hash;      ///< hash of all events, their position and content
+    uint64_t tsdu_hash; ///< hash of TSDUs, their position and content
+} test_sim_cnt_t;
+
+/// FNV-1a style hash step.
+uint64_t test_sim_hash(uint64_t hash, uint64_t v);
+
+/**
+  Create decoder with counter subscribed for FRAME, SYNC, PCH and TSDU
+  events, counter is cleared.
+  */
+tetrapol_t *test_sim_create(const tetrapol_cfg_t *cfg, test_sim_cnt_t *cnt);
+
+/**
+  Generate nframes of simulated traffic encoded with TEST_SIM_SCR.
+
+  @return channel bits, one bit per byte, free() them
+  */
+uint8_t *test_sim_gen_bits(int nframes);
@@ -0,0 +1,269 @@
+#include "test_sim.h"
+
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/snapshot.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    NFRAMES = 4 * 200,
+    NBITS = NFRAMES * FRAME_LEN,
+    CHUNK = 1000,       ///< not aligned to frames, phys_ch keeps some data
+    SPLIT = 97,         ///< chunk before which snapshot is taken
+};
+
+static uint8_t *bits;
+
+/// feed bits from chunk first up to chunk last (exclusive)
+static void feed(phys_ch_t *phys_ch, int first, int last)
+{
+    if (!bits) {
+        bits = test_sim_gen_bits(NFRAMES);
+    }
+    for (int i = first; i < last && i * CHUNK < NBITS; ++i) {
+        int len = (NBITS - i * CHUNK < CHUNK) ? NBITS - i * CHUNK : CHUNK;
+        assert_int_equal(len,
+                tetrapol_phys_ch_recv(phys_ch, &bits[i * CHUNK], len));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+}
+
+static void assert_cnt_equal(const test_sim_cnt_t *a,
+        const test_sim_cnt_t *b)
+{
+    assert_int_equal(a->nframes, b->nframes);
+    assert_int_equal(a->nsync, b->nsync);
+    assert_int_equal(a->npch, b->npch);
+    assert_int_equal(a->ntsdus, b->ntsdus);
+    assert_true(a->hash == b->hash);
+}
+
+static void test_resume(void **state)
+{
+    (void) state;   // unused
+
+    // uninterrupted decoding, events after SPLIT are counted separately
+    test_sim_cnt_t cnt_ref;
+    tetrapol_t *tetrapol = test_sim_create(&test_sim_cfg, &cnt_ref);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, 0, SPLIT);
+    memset(&cnt_ref, 0, sizeof(cnt_ref));
+    feed(phys_ch, SPLIT, NBITS / CHUNK + 1);
+    tetrapol_metrics_t metrics_ref;
+    tetrapol_get_metrics(tetrapol, &metrics_ref);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // decoding interrupted at SPLIT
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    test_sim_cnt_t cnt;
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, 0, SPLIT);
+    assert_true(cnt.ntsdus > 0);
+    assert_int_equal(0, tetrapol_snapshot_save(phys_ch, f));
+    const uint64_t in_offs = tetrapol_phys_ch_get_in_offs(phys_ch);
+    assert_true(in_offs == (uint64_t)SPLIT * CHUNK);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // resumed from snapshot
+    rewind(f);
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(0, tetrapol_snapshot_load(phys_ch, f));
+    assert_int_equal(TEST_SIM_SCR, tetrapol_phys_ch_get_scr(phys_ch));
+    assert_true(tetrapol_phys_ch_get_in_offs(phys_ch) == in_offs);
+    assert_int_equal(0, cnt.nframes + cnt.nsync + cnt.ntsdus);
+    feed(phys_ch, SPLIT, NBITS / CHUNK + 1);
+    tetrapol_metrics_t metrics;
+    tetrapol_get_metrics(tetrapol, &metrics);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    assert_true(cnt.ntsdus > 0);
+    assert_cnt_equal(&cnt_ref, &cnt);
+    assert_true(metrics.bits == metrics_ref.bits);
+    assert_true(metrics.terminals_live == metrics_ref.terminals_live);
+    assert_true(metrics.tpdu_timeouts == metrics_ref.tpdu_timeouts);
+    for (int i = 0; i < 256; ++i) {
+        assert_true(metrics.tsdus[i] == metrics_ref.tsdus[i]);
+    }
+
+    // cold restart loses SCR and synchronization
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, SPLIT, NBITS / CHUNK + 1);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+    assert_true(cnt.ntsdus < cnt_ref.ntsdus);
+
+    fclose(f);
+}
+
+static void test_rx_gap(void **state)
+{
+    (void) state;   // unused
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    test_sim_cnt_t cnt;
+    tetrapol_t *tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, 0, SPLIT);
+    assert_int_equal(0, tetrapol_snapshot_save(phys_ch, f));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // input continues later, SCR is kept and synchronization is regained
+    rewind(f);
+    const int gap = SPLIT + 10;
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(0, tetrapol_snapshot_load(phys_ch, f));
+    tetrapol_phys_ch_rx_gap(phys_ch, (uint64_t)gap * CHUNK);
+    assert_true(tetrapol_phys_ch_get_in_offs(phys_ch) ==
+            (uint64_t)gap * CHUNK);
+    assert_int_equal(1, cnt.nsync);
+    feed(phys_ch, gap, NBITS / CHUNK + 1);
+    assert_int_equal(TEST_SIM_SCR, tetrapol_phys_ch_get_scr(phys_ch));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    assert_int_equal(2, cnt.nsync);
+    assert_true(cnt.ntsdus > 0);
+
+    fclose(f);
+}
+
+static void test_invalid(void **state)
+{
+    (void) state;   // unused
+
+    test_sim_cnt_t cnt;
+    tetrapol_t *tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, 0, SPLIT);
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    assert_int_equal(-1, tetrapol_snapshot_load(phys_ch, f));
+    assert_int_equal(0, tetrapol_snapshot_save(phys_ch, f));
+    const long len = ftell(f);
+    assert_true(len > SNAPSHOT_HDR_LEN);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // different channel type
+    const tetrapol_cfg_t cfg_tch = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_TCH,
+    };
+    rewind(f);
+    tetrapol = test_sim_create(&cfg_tch, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(-1, tetrapol_snapshot_load(phys_ch, f));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // corrupted state
+    fseek(f, len / 2, SEEK_SET);
+    const int c = fgetc(f);
+    fseek(f, len / 2, SEEK_SET);
+    fputc(c ^ 0x10, f);
+    rewind(f);
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(-1, tetrapol_snapshot_load(phys_ch, f));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    // unsupported version
+    fseek(f, len / 2, SEEK_SET);
+    fputc(c, f);
+    fseek(f, 4, SEEK_SET);
+    fputc(SNAPSHOT_VERSION + 1, f);
+    rewind(f);
+    tetrapol = test_sim_create(&test_sim_cfg, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(-1, tetrapol_snapshot_load(phys_ch, f));
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    fclose(f);
+}
+
+static void test_tch(void **state)
+{
+    (void) state;   // unused
+
+    const tetrapol_cfg_t cfg_tch = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_TCH,
+    };
+    test_sim_cnt_t cnt_ref;
+    tetrapol_t *tetrapol = test_sim_create(&cfg_tch, &cnt_ref);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    feed(phys_ch, 0, SPLIT);
+
+    FILE *f = tmpfile();
+    assert_non_null(f);
+    assert_int_equal(0, tetrapol_snapshot_save(phys_ch, f));
+    memset(&cnt_ref, 0, sizeof(cnt_ref));
+    feed(phys_ch, SPLIT, NBITS / CHUNK + 1);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    rewind(f);
+    test_sim_cnt_t cnt;
+    tetrapol = test_sim_create(&cfg_tch, &cnt);
+    phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    assert_int_equal(0, tetrapol_snapshot_load(phys_ch, f));
+    feed(phys_ch, SPLIT, NBITS / CHUNK + 1);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+
+    assert_true(cnt.nframes > 0);
+    assert_cnt_equal(&cnt_ref, &cnt);
+
+    fclose(f);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_resume),
+        unit_test(test_rx_gap),
+        unit_test(test_invalid),
+        unit_test(test_tch),
+    };
+
+    const int r = run_tests(tests);
+    free(bits);
+
+    return r;
+}
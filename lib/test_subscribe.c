@@ -0,0 +1,181 @@
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    NSUBS = 64,
+};
+
+typedef struct sub_t {
+    tetrapol_t *tetrapol;
+    int nscr;
+    int nsync;
+    struct sub_t *unsub;    ///< unsubscribed from callback when set
+} sub_t;
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    sub_t *sub = ptr;
+
+    switch (evt->type) {
+        case TETRAPOL_EVT_SCR:
+            assert_int_equal(7, evt->scr.scr);
+            ++sub->nscr;
+            break;
+
+        case TETRAPOL_EVT_SYNC:
+            ++sub->nsync;
+            break;
+
+        default:
+            assert_true(false);
+    }
+
+    if (sub->unsub) {
+        tetrapol_unsubscribe(sub->tetrapol, evt_cb, sub->unsub);
+        sub->unsub = NULL;
+    }
+}
+
+static tetrapol_t *create(sub_t *subs, int nsubs)
+{
+    const tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+    };
+    tetrapol_t *tetrapol = tetrapol_create(&cfg);
+    assert_non_null(tetrapol);
+    memset(subs, 0, nsubs * sizeof(sub_t));
+    for (int i = 0; i < nsubs; ++i) {
+        subs[i].tetrapol = tetrapol;
+    }
+
+    return tetrapol;
+}
+
+static void test_mask(void **state)
+{
+    (void) state;   // unused
+
+    sub_t subs[2];
+    tetrapol_t *tetrapol = create(subs, 2);
+    tpol_t *tpol = tetrapol_get_tpol(tetrapol);
+    assert_false(tetrapol_evt_enabled(tpol, TETRAPOL_EVT_ALL));
+
+    assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_SCR, evt_cb,
+                &subs[0]));
+    assert_true(tetrapol_subscribe(tetrapol,
+                TETRAPOL_EVT_SCR | TETRAPOL_EVT_SYNC, evt_cb, &subs[1]));
+    assert_true(tetrapol_evt_enabled(tpol, TETRAPOL_EVT_SYNC));
+    assert_false(tetrapol_evt_enabled(tpol, TETRAPOL_EVT_FRAME));
+
+    tetrapol_evt_scr(tpol, 7);
+    tetrapol_evt_sync(tpol, true);
+    assert_int_equal(1, subs[0].nscr);
+    assert_int_equal(0, subs[0].nsync);
+    assert_int_equal(1, subs[1].nscr);
+    assert_int_equal(1, subs[1].nsync);
+
+    // subscribing again changes mask only
+    assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_SYNC, evt_cb,
+                &subs[1]));
+    assert_int_equal(2, tpol->nsubscribers);
+    tetrapol_evt_scr(tpol, 7);
+    assert_int_equal(2, subs[0].nscr);
+    assert_int_equal(1, subs[1].nscr);
+
+    tetrapol_unsubscribe(tetrapol, evt_cb, &subs[0]);
+    assert_false(tetrapol_evt_enabled(tpol, TETRAPOL_EVT_SCR));
+    tetrapol_evt_scr(tpol, 7);
+    assert_int_equal(2, subs[0].nscr);
+
+    // unknown subscriber is ignored
+    tetrapol_unsubscribe(tetrapol, evt_cb, &subs[0]);
+    tetrapol_unsubscribe(tetrapol, evt_cb, &subs[1]);
+    assert_int_equal(0, tpol->nsubscribers);
+    assert_false(tetrapol_evt_enabled(tpol, TETRAPOL_EVT_ALL));
+
+    tetrapol_destroy(tetrapol);
+}
+
+static void test_many(void **state)
+{
+    (void) state;   // unused
+
+    // number of subscribers is not limited
+    sub_t subs[NSUBS];
+    tetrapol_t *tetrapol = create(subs, NSUBS);
+    tpol_t *tpol = tetrapol_get_tpol(tetrapol);
+    for (int i = 0; i < NSUBS; ++i) {
+        assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_SCR, evt_cb,
+                    &subs[i]));
+    }
+    assert_int_equal(NSUBS, tpol->nsubscribers);
+
+    tetrapol_evt_scr(tpol, 7);
+    for (int i = 0; i < NSUBS; i += 2) {
+        tetrapol_unsubscribe(tetrapol, evt_cb, &subs[i]);
+    }
+    tetrapol_evt_scr(tpol, 7);
+    for (int i = 0; i < NSUBS; ++i) {
+        assert_int_equal((i % 2) ? 2 : 1, subs[i].nscr);
+    }
+
+    tetrapol_destroy(tetrapol);
+}
+
+static void test_unsubscribe_in_cb(void **state)
+{
+    (void) state;   // unused
+
+    sub_t subs[4];
+    tetrapol_t *tetrapol = create(subs, 4);
+    tpol_t *tpol = tetrapol_get_tpol(tetrapol);
+    for (int i = 0; i < 4; ++i) {
+        assert_true(tetrapol_subscribe(tetrapol, TETRAPOL_EVT_SCR, evt_cb,
+                    &subs[i]));
+    }
+
+    // itself, the next one still gets the event
+    subs[0].unsub = &subs[0];
+    tetrapol_evt_scr(tpol, 7);
+    assert_int_equal(1, subs[0].nscr);
+    assert_int_equal(1, subs[1].nscr);
+    assert_int_equal(1, subs[2].nscr);
+    assert_int_equal(1, subs[3].nscr);
+
+    // subscriber already called, others are not skipped
+    subs[2].unsub = &subs[1];
+    tetrapol_evt_scr(tpol, 7);
+    assert_int_equal(1, subs[0].nscr);
+    assert_int_equal(2, subs[1].nscr);
+    assert_int_equal(2, subs[2].nscr);
+    assert_int_equal(2, subs[3].nscr);
+
+    // subscriber not called yet does not get the event
+    subs[2].unsub = &subs[3];
+    tetrapol_evt_scr(tpol, 7);
+    assert_int_equal(2, subs[1].nscr);
+    assert_int_equal(3, subs[2].nscr);
+    assert_int_equal(2, subs[3].nscr);
+    assert_int_equal(1, tpol->nsubscribers);
+
+    tetrapol_destroy(tetrapol);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_mask),
+        unit_test(test_many),
+        unit_test(test_unsubscribe_in_cb),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,227 @@
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/swmi_sim.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tsdu.h>
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    SCR = 17,
+};
+
+typedef struct {
+    uint64_t npch;
+    uint64_t nrch;
+} evt_cnt_t;
+
+static void evt_cb(const tetrapol_evt_t *evt, void *ptr)
+{
+    evt_cnt_t *cnt = ptr;
+
+    cnt->npch += (evt->type == TETRAPOL_EVT_PCH);
+    cnt->nrch += (evt->type == TETRAPOL_EVT_RCH);
+}
+
+/// generate nframes, decode them and compare result with simulator stats
+static void run(const swmi_sim_cfg_t *sim_cfg, int nframes,
+        swmi_sim_stats_t *stats, tetrapol_metrics_t *metrics)
+{
+    swmi_sim_t *sim = swmi_sim_create(sim_cfg);
+    assert_non_null(sim);
+
+    tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+    };
+    tetrapol_t *tetrapol = tetrapol_create(&cfg);
+    assert_non_null(tetrapol);
+    phys_ch_t *phys_ch = tetrapol_phys_ch_create(tetrapol);
+    assert_non_null(phys_ch);
+    tetrapol_phys_ch_set_scr(phys_ch, SCR);
+    evt_cnt_t cnt = { 0, 0, };
+    assert_true(tetrapol_subscribe(tetrapol,
+                TETRAPOL_EVT_PCH | TETRAPOL_EVT_RCH, evt_cb, &cnt));
+
+    frame_encoder_t *fe = frame_encoder_create(TETRAPOL_BAND_UHF, SCR,
+            DIR_DOWNLINK);
+    assert_non_null(fe);
+
+    for (int i = 0; i < nframes; ++i) {
+        uint8_t bits[FRAME_LEN];
+
+        assert_int_equal(0, swmi_sim_bits(sim, fe, bits));
+        assert_int_equal(FRAME_LEN,
+                tetrapol_phys_ch_recv(phys_ch, bits, FRAME_LEN));
+        tetrapol_phys_ch_process(phys_ch);
+    }
+
+    swmi_sim_get_stats(sim, stats);
+    tetrapol_get_metrics(tetrapol, metrics);
+    assert_int_equal(nframes, stats->frames);
+    assert_int_equal(nframes, metrics->frames[FRAME_TYPE_DATA]);
+    assert_int_equal(0, metrics->frames_broken[FRAME_TYPE_DATA]);
+    assert_int_equal(0, metrics->data_frame_errs);
+    assert_int_equal(0, metrics->tpdu_timeouts);
+    assert_int_equal(stats->stuffing, metrics->hdlc_stuffing);
+    assert_int_equal(stats->pch_blocks, cnt.npch);
+    assert_int_equal(stats->rch_blocks, cnt.nrch);
+
+    frame_encoder_destroy(fe);
+    tetrapol_phys_ch_destroy(phys_ch);
+    tetrapol_destroy(tetrapol);
+    swmi_sim_destroy(sim);
+}
+
+static void test_decode(void **state)
+{
+    (void) state;   // unused
+
+    const int nframes = 3 * 200;
+    const swmi_sim_cfg_t cfg = {
+        .nterminals = 500,
+        .reg_rate = 2,
+        .call_rate = 0.5,
+        .ui_data_rate = 0.5,
+        .co_data_rate = 0.5,
+        .data_len = 300,
+    };
+    swmi_sim_stats_t stats;
+    tetrapol_metrics_t metrics;
+    run(&cfg, nframes, &stats, &metrics);
+
+    assert_int_equal(0, stats.dropped);
+    assert_true(stats.hdlc_frames > 0);
+    assert_true(stats.stuffing > 0);
+    assert_true(stats.pages > 0);
+    assert_true(stats.acks > 0);
+    const int codops[] = {
+        D_SYSTEM_INFO, D_REGISTRATION_ACK, D_CALL_SETUP, D_CONNECT_DCH,
+        D_DATAGRAM, D_DATA_MSG_DOWN,
+    };
+    for (int i = 0; i < sizeof(codops) / sizeof(codops[0]); ++i) {
+        assert_true(stats.tsdus[codops[i]] > 0);
+        assert_int_equal(stats.tsdus[codops[i]], metrics.tsdus[codops[i]]);
+    }
+    for (int i = 0; i < 256; ++i) {
+        assert_int_equal(stats.tsdus[i], metrics.tsdus[i]);
+    }
+}
+
+static void test_overload(void **state)
+{
+    (void) state;   // unused
+
+    const swmi_sim_cfg_t cfg = {
+        .nterminals = 20000,
+        .reg_rate = 20,
+        .call_rate = 5,
+        .ui_data_rate = 5,
+        .co_data_rate = 5,
+        .data_len = 1000,
+        .seed = 1234,
+    };
+    swmi_sim_stats_t stats;
+    tetrapol_metrics_t metrics;
+    run(&cfg, 2 * 200, &stats, &metrics);
+
+    assert_true(stats.dropped > 0);
+    assert_true(stats.queue_len > 0);
+    assert_true(metrics.terminals_live > 0);
+}
+
+static void test_churn(void **state)
+{
+    (void) state;   // unused
+
+    const swmi_sim_cfg_t cfg = {
+        .nterminals = 50,
+        .reg_rate = 2,
+        .call_rate = 0.5,
+        .ui_data_rate = 0.5,
+        .co_data_rate = 0.5,
+        .churn_rate = 10,
+    };
+    swmi_sim_stats_t stats;
+    tetrapol_metrics_t metrics;
+    run(&cfg, 3 * 200, &stats, &metrics);
+
+    // whole population is replaced, addresses are not reused
+    assert_true(stats.churned > cfg.nterminals);
+    assert_int_equal(cfg.nterminals, stats.nterminals);
+    for (int i = 0; i < 256; ++i) {
+        assert_int_equal(stats.tsdus[i], metrics.tsdus[i]);
+    }
+}
+
+static void test_set_nterminals(void **state)
+{
+    (void) state;   // unused
+
+    const swmi_sim_cfg_t cfg = {
+        .nterminals = 10,
+        .reg_rate = 50,
+    };
+    swmi_sim_t *sim = swmi_sim_create(&cfg);
+    assert_non_null(sim);
+
+    assert_int_equal(-1, swmi_sim_set_nterminals(sim, 0));
+    assert_int_equal(-1,
+            swmi_sim_set_nterminals(sim, SWMI_SIM_TERMINALS_MAX + 1));
+    assert_int_equal(0,
+            swmi_sim_set_nterminals(sim, SWMI_SIM_TERMINALS_MAX));
+
+    swmi_sim_stats_t stats;
+    swmi_sim_get_stats(sim, &stats);
+    assert_int_equal(SWMI_SIM_TERMINALS_MAX, stats.nterminals);
+    for (int i = 0; i < 200; ++i) {
+        frame_t fr;
+        swmi_sim_frame(sim, &fr);
+    }
+    swmi_sim_get_stats(sim, &stats);
+    assert_true(stats.acks > 0);
+    assert_int_equal(0, stats.churned);
+
+    swmi_sim_destroy(sim);
+}
+
+static void test_invalid_cfg(void **state)
+{
+    (void) state;   // unused
+
+    swmi_sim_cfg_t cfg = {
+        .nterminals = 0,
+    };
+    assert_null(swmi_sim_create(&cfg));
+
+    cfg.nterminals = 10;
+    cfg.call_rate = -1;
+    assert_null(swmi_sim_create(&cfg));
+
+    cfg.call_rate = 1;
+    cfg.data_len = 2;
+    assert_null(swmi_sim_create(&cfg));
+
+    cfg.data_len = 0;
+    cfg.churn_rate = -1;
+    assert_null(swmi_sim_create(&cfg));
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_decode),
+        unit_test(test_overload),
+        unit_test(test_churn),
+        unit_test(test_set_nterminals),
+        unit_test(test_invalid_cfg),
+    };
+
+    return run_tests(tests);
+}
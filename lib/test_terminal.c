@@ -0,0 +1,168 @@
+#include <tetrapol/terminal.h>
+#include <tetrapol/tetrapol.h>
+#include <tetrapol/tetrapol_int.h>
+#include <tetrapol/tp_timer.h>
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <string.h>
+#include <cmocka.h>
+
+enum {
+    IDLE_TIMEOUT = 2,       ///< seconds
+    TERMINALS_MAX = 3,
+    TICK_USEC = 20000,      ///< single frame
+};
+
+typedef struct {
+    tetrapol_t *tetrapol;
+    tpol_t *tpol;
+    terminal_list_t *tlist;
+} ctx_t;
+
+static void ctx_init(ctx_t *ctx)
+{
+    const tetrapol_cfg_t cfg = {
+        .band = TETRAPOL_BAND_UHF,
+        .dir = DIR_DOWNLINK,
+        .radio_ch_type = TETRAPOL_RADIO_CCH,
+        .terminal_idle_timeout = IDLE_TIMEOUT,
+        .terminals_max = TERMINALS_MAX,
+    };
+    ctx->tetrapol = tetrapol_create(&cfg);
+    assert_non_null(ctx->tetrapol);
+    ctx->tpol = tetrapol_get_tpol(ctx->tetrapol);
+    ctx->tlist = terminal_list_create(ctx->tpol, LOG_CH_SDCH);
+    assert_non_null(ctx->tlist);
+}
+
+static void ctx_deinit(ctx_t *ctx)
+{
+    terminal_list_destroy(ctx->tlist);
+    tetrapol_stats_t stats;
+    tetrapol_get_stats(ctx->tetrapol, &stats);
+    assert_true(stats.terminals_live == 0);
+    tetrapol_destroy(ctx->tetrapol);
+}
+
+static addr_t mk_addr(int x)
+{
+    const addr_t addr = {
+        .z = 0,
+        .y = 1,
+        .x = x,
+    };
+
+    return addr;
+}
+
+/// receive RR frame from terminal, it makes terminal the most recently used
+static void push(ctx_t *ctx, int x)
+{
+    hdlc_frame_t hdlc_fr;
+    memset(&hdlc_fr, 0, sizeof(hdlc_fr));
+    hdlc_fr.addr = mk_addr(x);
+    hdlc_fr.command.cmd = COMMAND_SUPERVISION_RR;
+    assert_int_equal(0, terminal_list_push_hdlc_frame(ctx->tlist, &hdlc_fr));
+}
+
+static bool has_terminal(ctx_t *ctx, int x)
+{
+    const addr_t addr = mk_addr(x);
+
+    return terminal_list_lookup(ctx->tlist, &addr) != NULL;
+}
+
+static void tick(ctx_t *ctx, int usec)
+{
+    for (; usec > 0; usec -= TICK_USEC) {
+        tp_timer_tick(ctx->tpol->tp_timer, false, TICK_USEC);
+    }
+}
+
+static void check_stats(ctx_t *ctx, uint64_t live, uint64_t evicted_idle,
+        uint64_t evicted_lru)
+{
+    tetrapol_stats_t stats;
+    tetrapol_get_stats(ctx->tetrapol, &stats);
+    assert_true(stats.terminals_live == live);
+    assert_true(stats.terminals_evicted_idle == evicted_idle);
+    assert_true(stats.terminals_evicted_lru == evicted_lru);
+
+    tetrapol_metrics_t metrics;
+    tetrapol_get_metrics(ctx->tetrapol, &metrics);
+    assert_true(metrics.terminals_live == live);
+}
+
+static void test_evict_lru(void **state)
+{
+    (void) state;   // unused
+
+    ctx_t ctx;
+    ctx_init(&ctx);
+
+    push(&ctx, 1);
+    push(&ctx, 2);
+    push(&ctx, 3);
+    check_stats(&ctx, 3, 0, 0);
+
+    // 1 is used again, 2 is the least recently used one
+    push(&ctx, 1);
+    push(&ctx, 4);
+    check_stats(&ctx, 3, 0, 1);
+    assert_true(has_terminal(&ctx, 1));
+    assert_false(has_terminal(&ctx, 2));
+    assert_true(has_terminal(&ctx, 3));
+    assert_true(has_terminal(&ctx, 4));
+
+    push(&ctx, 2);
+    check_stats(&ctx, 3, 0, 2);
+    assert_false(has_terminal(&ctx, 3));
+
+    ctx_deinit(&ctx);
+}
+
+static void test_evict_idle(void **state)
+{
+    (void) state;   // unused
+
+    ctx_t ctx;
+    ctx_init(&ctx);
+
+    push(&ctx, 1);
+    push(&ctx, 2);
+    tick(&ctx, 1000000);
+    push(&ctx, 2);
+
+    // 1 expires at 2 s, 2 is kept alive by frame received at 1 s
+    tick(&ctx, 1000000 - TICK_USEC);
+    check_stats(&ctx, 2, 0, 0);
+    tick(&ctx, 2 * TICK_USEC);
+    check_stats(&ctx, 1, 1, 0);
+    assert_false(has_terminal(&ctx, 1));
+    assert_true(has_terminal(&ctx, 2));
+
+    // 2 expires at 3 s
+    tick(&ctx, 1000000);
+    check_stats(&ctx, 0, 2, 0);
+    assert_false(has_terminal(&ctx, 2));
+
+    // terminal created again after eviction is tracked as new one
+    push(&ctx, 1);
+    check_stats(&ctx, 1, 2, 0);
+    tick(&ctx, IDLE_TIMEOUT * 1000000 + TICK_USEC);
+    check_stats(&ctx, 0, 3, 0);
+
+    ctx_deinit(&ctx);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_evict_lru),
+        unit_test(test_evict_idle),
+    };
+
+    return run_tests(tests);
+}
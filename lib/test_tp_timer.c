@@ -5,6 +5,7 @@
 
 // include, we are testing static methods
 #include "tp_timer.c"
+#include <tetrapol/misc.h>
 
 static struct timeval tv_exp1;
 void callback1(time_evt_t *te, void *ptr)
@@ -63,10 +64,73 @@ static void test_t1(void **state)
     tp_timer_destroy(timer);
 }
 
+static int entry_fired[4];
+static tp_timer_entry_t entries[4];
+void entries_callback(time_evt_t *te, void *ptr)
+{
+    const int i = (tp_timer_entry_t *)ptr - entries;
+    (void) te;  // unused
+
+    assert_false(tp_timer_is_armed(&entries[i]));
+    ++entry_fired[i];
+}
+
+/// test armed entries fire only after deadline, including cascaded ones
+static void test_wheel(void **state)
+{
+    (void) state;   // unused
+
+    memset(entry_fired, 0, sizeof(entry_fired));
+
+    tp_timer_t *timer = tp_timer_create();
+    assert_non_null(timer);
+
+    const uint64_t delays[ARRAY_LEN(entries)] = {
+        20000,              // next frame
+        10 * 1000000,       // T454, second level of wheel
+        100 * 1000000,      // third level of wheel
+        5 * 20000,          // disarmed before expiration
+    };
+    for (int i = 0; i < ARRAY_LEN(entries); ++i) {
+        tp_timer_entry_init(&entries[i], entries_callback, &entries[i]);
+        tp_timer_arm(timer, &entries[i], delays[i]);
+        assert_true(tp_timer_is_armed(&entries[i]));
+    }
+
+    tp_timer_tick(timer, false, 20000);
+    assert_int_equal(entry_fired[0], 1);
+    assert_false(tp_timer_is_armed(&entries[0]));
+
+    tp_timer_disarm(&entries[3]);
+    tp_timer_disarm(&entries[3]);
+
+    // rearm postpones expiration
+    tp_timer_tick(timer, false, 5 * 1000000);
+    tp_timer_arm(timer, &entries[1], 10 * 1000000);
+
+    for (uint64_t t = 20000 + 5 * 1000000; t < 15 * 1000000; t += 20000) {
+        assert_int_equal(entry_fired[1], 0);
+        tp_timer_tick(timer, false, 20000);
+    }
+    tp_timer_tick(timer, false, 20000);
+    assert_int_equal(entry_fired[1], 1);
+
+    for (uint64_t t = tp_timer_now(timer); t < 100 * 1000000; t += 20000) {
+        assert_int_equal(entry_fired[2], 0);
+        tp_timer_tick(timer, false, 20000);
+    }
+    assert_int_equal(entry_fired[2], 1);
+    assert_int_equal(entry_fired[3], 0);
+    assert_int_equal(entry_fired[0], 1);
+
+    tp_timer_destroy(timer);
+}
+
 int main(void)
 {
     const UnitTest tests[] = {
         unit_test(test_t1),
+        unit_test(test_wheel),
     };
 
     return run_tests(tests);
@@ -0,0 +1,139 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+// include, we are testing static methods
+#include "tpdu.c"
+
+static int ntsdus;
+static uint8_t tsdu_data[TPDU_SEGBUF_SIZE];
+static int tsdu_len;
+
+void tetrapol_evt_tsdu(tpol_t *tpol, const tpol_tsdu_t *tpol_tsdu)
+{
+    ++ntsdus;
+    tsdu_len = tpol_tsdu->data_len;
+    memcpy(tsdu_data, tpol_tsdu->data, tpol_tsdu->data_len);
+}
+
+static void tpol_init(tpol_t *tpol)
+{
+    memset(tpol, 0, sizeof(*tpol));
+    tpol->tp_timer = tp_timer_create();
+    assert_non_null(tpol->tp_timer);
+    assert_true(tpdu_pools_create(tpol));
+}
+
+static void tpol_deinit(tpol_t *tpol)
+{
+    tpdu_pools_destroy(tpol);
+    tp_timer_destroy(tpol->tp_timer);
+}
+
+// create UI DU segment, payload is filled by packet_num
+static void mk_ui_segment(hdlc_frame_t *hdlc_fr, int seg_ref, int packet_num,
+        bool last, int len)
+{
+    memset(hdlc_fr, 0, sizeof(*hdlc_fr));
+    hdlc_fr->command.cmd = COMMAND_UNNUMBERED_UI;
+    hdlc_fr->data[0] = 0x80 | (last ? 0 : 0x40) | 0x01;
+    hdlc_fr->data[1] = 0x80 | seg_ref;
+    hdlc_fr->data[2] = packet_num;
+    int n = 3;
+    if (last) {
+        hdlc_fr->data[n++] = len;
+    }
+    memset(&hdlc_fr->data[n], packet_num, len);
+    hdlc_fr->nbits = (n + len) * 8;
+}
+
+/// segments received out of order are composed into single TSDU
+static void test_ui_reassembly(void **state)
+{
+    (void) state;   // unused
+
+    tpol_t tpol;
+    tpol_init(&tpol);
+    tpdu_ui_t *tpdu = tpdu_ui_create(&tpol, FRAME_TYPE_DATA, LOG_CH_SDCH);
+    assert_non_null(tpdu);
+
+    hdlc_frame_t hdlc_fr;
+    ntsdus = 0;
+
+    mk_ui_segment(&hdlc_fr, 5, 2, true, 4);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    mk_ui_segment(&hdlc_fr, 5, 0, false, 8);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    // duplicate segment
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    assert_int_equal(ntsdus, 0);
+    assert_non_null(tpdu->seg_dus);
+
+    mk_ui_segment(&hdlc_fr, 5, 1, false, 8);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    assert_int_equal(ntsdus, 1);
+    assert_int_equal(tsdu_len, 8 + 8 + 4);
+    for (int i = 0; i < tsdu_len; ++i) {
+        assert_int_equal(tsdu_data[i], i < 8 ? 0 : (i < 16 ? 1 : 2));
+    }
+    assert_null(tpdu->seg_dus);
+
+    // reassembly buffer is reused, no new slab is allocated
+    pool_stats_t stats;
+    mk_ui_segment(&hdlc_fr, 6, 0, true, 4);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    assert_int_equal(ntsdus, 2);
+    pool_get_stats(tpol.seg_du_pool, &stats);
+    assert_int_equal(stats.nallocs, 2);
+    assert_int_equal(stats.in_use, 0);
+    assert_int_equal(stats.nslabs, 1);
+
+    tpdu_ui_destroy(tpdu);
+    tpol_deinit(&tpol);
+}
+
+/// incomplete DU is dropped when T454 expires
+static void test_ui_t454(void **state)
+{
+    (void) state;   // unused
+
+    tpol_t tpol;
+    tpol_init(&tpol);
+    tpdu_ui_t *tpdu = tpdu_ui_create(&tpol, FRAME_TYPE_DATA, LOG_CH_SDCH);
+    assert_non_null(tpdu);
+
+    hdlc_frame_t hdlc_fr;
+    ntsdus = 0;
+
+    mk_ui_segment(&hdlc_fr, 7, 0, false, 8);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+    mk_ui_segment(&hdlc_fr, 9, 0, false, 8);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+
+    for (int t = 0; t < SYS_PAR_T454 - 20000; t += 20000) {
+        tp_timer_tick(tpol.tp_timer, false, 20000);
+    }
+    // segment of second DU resets its timer
+    mk_ui_segment(&hdlc_fr, 9, 1, false, 8);
+    assert_int_equal(tpdu_ui_push_hdlc_frame(tpdu, &hdlc_fr, NULL), 0);
+
+    tp_timer_tick(tpol.tp_timer, false, 20000);
+    assert_null(tpdu_ui_segments_find(tpdu, 7));
+    assert_non_null(tpdu_ui_segments_find(tpdu, 9));
+    assert_int_equal(ntsdus, 0);
+
+    // pending DU is released on destroy
+    tpdu_ui_destroy(tpdu);
+    tpol_deinit(&tpol);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ui_reassembly),
+        unit_test(test_ui_t454),
+    };
+
+    return run_tests(tests);
+}
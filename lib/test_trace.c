@@ -0,0 +1,111 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <tetrapol/trace.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *path = "test_trace.json";
+
+static char *read_file(const char *fname)
+{
+    FILE *f = fopen(fname, "r");
+    assert_non_null(f);
+    assert_int_equal(fseek(f, 0, SEEK_END), 0);
+    const long len = ftell(f);
+    assert_true(len >= 0);
+    rewind(f);
+    char *s = malloc(len + 1);
+    assert_non_null(s);
+    assert_int_equal(fread(s, 1, len, f), len);
+    s[len] = 0;
+    fclose(f);
+
+    return s;
+}
+
+static int count(const char *s, const char *needle)
+{
+    int n = 0;
+    for (s = strstr(s, needle); s; s = strstr(s + 1, needle)) {
+        ++n;
+    }
+
+    return n;
+}
+
+/// trace points are no-op until tracing is started
+static void test_disabled(void **state)
+{
+    (void) state;   // unused
+
+    assert_false(trace_enabled);
+    TRACE_BEGIN(TRACE_SYNC);
+    TRACE_END(TRACE_SYNC);
+    trace_rx(100);
+    trace_tsdu(50);
+
+    trace_latency_t latency;
+    trace_get_latency(&latency);
+    assert_int_equal(latency.count, 0);
+    assert_int_equal(trace_write_chrome(path), -1);
+}
+
+static void test_export(void **state)
+{
+    (void) state;   // unused
+
+    assert_int_equal(trace_start(4), 0);
+    trace_rx(160);
+    trace_rx(320);
+    TRACE_BEGIN(TRACE_TSDU_DECODE);
+    TRACE_END(TRACE_TSDU_DECODE);
+    // last bit is in the second chunk
+    trace_tsdu(200);
+    // not received yet
+    trace_tsdu(400);
+
+    trace_latency_t latency;
+    trace_get_latency(&latency);
+    assert_int_equal(latency.count, 1);
+    assert_true(latency.max_ns <= latency.sum_ns);
+
+    assert_int_equal(trace_write_chrome(path), 0);
+    char *s = read_file(path);
+    assert_non_null(strstr(s, "{\"traceEvents\":["));
+    assert_int_equal(count(s, "\"name\":\"tsdu_decode\""), 2);
+    assert_int_equal(count(s, "\"ph\":\"B\""), 1);
+    assert_int_equal(count(s, "\"ph\":\"E\""), 1);
+    assert_int_equal(count(s, "\"name\":\"rx_to_tsdu\",\"ph\":\"C\""), 1);
+    free(s);
+
+    // ring keeps the last 4 events only
+    for (int i = 0; i < 3; ++i) {
+        TRACE_BEGIN(TRACE_OUTPUT);
+        TRACE_END(TRACE_OUTPUT);
+    }
+    assert_int_equal(trace_write_chrome(path), 0);
+    s = read_file(path);
+    assert_int_equal(count(s, "\"name\":\"output\""), 4);
+    assert_int_equal(count(s, "\"name\":"), 4);
+    free(s);
+
+    trace_stop();
+    assert_false(trace_enabled);
+    unlink(path);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_disabled),
+        unit_test(test_export),
+    };
+
+    return run_tests(tests);
+}
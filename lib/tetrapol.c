@@ -1,9 +1,15 @@
 #define LOG_PREFIX "tetrapol"
 
 #include <tetrapol/log.h>
+#include <tetrapol/filter.h>
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/link.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/terminal.h>
 #include <tetrapol/tetrapol_int.h>
-#include <tetrapol/tsdu_json.h>
-#include <tetrapol/tsdu_print.h>
+#include <tetrapol/tpdu.h>
+#include <tetrapol/trace.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -12,6 +18,11 @@ struct tetrapol_priv_t {
     tpol_t tpol;
 };
 
+enum {
+    // enough for the longest TSDU reassembled from segments
+    TSDU_ARENA_SIZE = 16 * 1024,
+};
+
 tetrapol_t *tetrapol_create(const tetrapol_cfg_t *cfg)
 {
     if (cfg->band != TETRAPOL_BAND_VHF && cfg->band != TETRAPOL_BAND_UHF) {
@@ -32,14 +43,76 @@ tetrapol_t *tetrapol_create(const tetrapol_cfg_t *cfg)
     }
 
     memcpy(&tetrapol->tpol.cfg, cfg, sizeof(tetrapol_cfg_t));
+    if (!tetrapol->tpol.cfg.terminal_idle_timeout) {
+        tetrapol->tpol.cfg.terminal_idle_timeout =
+            TETRAPOL_TERMINAL_IDLE_TIMEOUT_DEFAULT;
+    }
+    if (!tetrapol->tpol.cfg.terminals_max) {
+        tetrapol->tpol.cfg.terminals_max = TETRAPOL_TERMINALS_MAX_DEFAULT;
+    }
+    memset(&tetrapol->tpol.stats, 0, sizeof(tetrapol->tpol.stats));
+    memset(&tetrapol->tpol.metrics, 0, sizeof(tetrapol->tpol.metrics));
     tetrapol->tpol.rx_offs = 0;
     tetrapol->tpol.frame_no = FRAME_NO_UNKNOWN;
+    tetrapol->tpol.has_filter = false;
+    tetrapol->tpol.evt_mask = 0;
+    tetrapol->tpol.nsubscribers = 0;
+    tetrapol->tpol.subscribers = NULL;
+    tetrapol->tpol.emit_idx = -1;
+
+    tetrapol->tpol.tp_timer = tp_timer_create();
+    if (!tetrapol->tpol.tp_timer) {
+        goto err_timer;
+    }
+
+    void *arena_buf = malloc(TSDU_ARENA_SIZE);
+    if (!arena_buf) {
+        goto err_arena;
+    }
+    arena_init(&tetrapol->tpol.tsdu_arena, arena_buf, TSDU_ARENA_SIZE);
+
+    if (!terminal_pools_create(&tetrapol->tpol)) {
+        goto err_terminal_pools;
+    }
+
+    if (!link_pools_create(&tetrapol->tpol)) {
+        goto err_link_pools;
+    }
+
+    if (!tpdu_pools_create(&tetrapol->tpol)) {
+        goto err_tpdu_pools;
+    }
 
     return tetrapol;
+
+err_tpdu_pools:
+    link_pools_destroy(&tetrapol->tpol);
+
+err_link_pools:
+    terminal_pools_destroy(&tetrapol->tpol);
+
+err_terminal_pools:
+    free(tetrapol->tpol.tsdu_arena.buf);
+
+err_arena:
+    tp_timer_destroy(tetrapol->tpol.tp_timer);
+
+err_timer:
+    free(tetrapol);
+
+    return NULL;
 }
 
 void tetrapol_destroy(tetrapol_t *tetrapol)
 {
+    if (tetrapol) {
+        tpdu_pools_destroy(&tetrapol->tpol);
+        link_pools_destroy(&tetrapol->tpol);
+        terminal_pools_destroy(&tetrapol->tpol);
+        free(tetrapol->tpol.tsdu_arena.buf);
+        tp_timer_destroy(tetrapol->tpol.tp_timer);
+        free(tetrapol->tpol.subscribers);
+    }
     free(tetrapol);
 }
 
@@ -48,13 +121,322 @@ const tetrapol_cfg_t *tetrapol_get_cfg(tetrapol_t *tetrapol)
     return &tetrapol->tpol.cfg;
 }
 
+void tetrapol_get_stats(tetrapol_t *tetrapol, tetrapol_stats_t *stats)
+{
+    const tpol_t *tpol = &tetrapol->tpol;
+    memcpy(stats, &tpol->stats, sizeof(tetrapol_stats_t));
+
+    const pool_t *pools[] = {
+        tpol->terminal_pool,
+        tpol->link_pool,
+        tpol->tpdu_pool,
+        tpol->tpdu_ui_pool,
+        tpol->segbuf_pool,
+        tpol->seg_du_pool,
+    };
+    for (int i = 0; i < ARRAY_LEN(pools); ++i) {
+        pool_stats_t pool_stats;
+        pool_get_stats(pools[i], &pool_stats);
+        stats->pool_allocs += pool_stats.nallocs;
+        stats->pool_frees += pool_stats.nfrees;
+        stats->pool_in_use += pool_stats.in_use;
+        stats->pool_slabs += pool_stats.nslabs;
+        stats->pool_bytes += pool_stats.bytes;
+    }
+}
+
+void tetrapol_get_metrics(tetrapol_t *tetrapol, tetrapol_metrics_t *metrics)
+{
+    uint64_t *src = (uint64_t *)&tetrapol->tpol.metrics;
+    uint64_t *dst = (uint64_t *)metrics;
+    for (int i = 0; i < sizeof(tetrapol_metrics_t) / sizeof(uint64_t); ++i) {
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+    }
+}
+
 tpol_t *tetrapol_get_tpol(tetrapol_t *tetrapol)
 {
     return (tpol_t *)tetrapol;
 }
 
+static void update_evt_mask(tpol_t *tpol)
+{
+    tpol->evt_mask = 0;
+    for (int i = 0; i < tpol->nsubscribers; ++i) {
+        tpol->evt_mask |= tpol->subscribers[i].mask;
+    }
+}
+
+bool tetrapol_subscribe(tetrapol_t *tetrapol, int mask,
+        tetrapol_evt_cb_t func, void *ptr)
+{
+    tpol_t *tpol = &tetrapol->tpol;
+
+    for (int i = 0; i < tpol->nsubscribers; ++i) {
+        if (tpol->subscribers[i].func == func &&
+                tpol->subscribers[i].ptr == ptr) {
+            tpol->subscribers[i].mask = mask;
+            update_evt_mask(tpol);
+            return true;
+        }
+    }
+
+    tpol_subscriber_t *p = realloc(tpol->subscribers,
+            sizeof(tpol_subscriber_t[tpol->nsubscribers + 1]));
+    if (!p) {
+        LOG(ERR, "ERR OOM");
+        return false;
+    }
+    tpol->subscribers = p;
+    tpol->subscribers[tpol->nsubscribers].mask = mask;
+    tpol->subscribers[tpol->nsubscribers].func = func;
+    tpol->subscribers[tpol->nsubscribers].ptr = ptr;
+    ++tpol->nsubscribers;
+    update_evt_mask(tpol);
+
+    return true;
+}
+
+void tetrapol_unsubscribe(tetrapol_t *tetrapol,
+        tetrapol_evt_cb_t func, void *ptr)
+{
+    tpol_t *tpol = &tetrapol->tpol;
+
+    for (int i = 0; i < tpol->nsubscribers; ++i) {
+        if (tpol->subscribers[i].func == func &&
+                tpol->subscribers[i].ptr == ptr) {
+            --tpol->nsubscribers;
+            memmove(&tpol->subscribers[i], &tpol->subscribers[i + 1],
+                    sizeof(tpol_subscriber_t[tpol->nsubscribers - i]));
+            // called from callback, do not skip the next subscriber
+            if (i <= tpol->emit_idx) {
+                --tpol->emit_idx;
+            }
+            update_evt_mask(tpol);
+            return;
+        }
+    }
+}
+
+bool tetrapol_set_filter(tetrapol_t *tetrapol, const tetrapol_filter_t *filter)
+{
+    tpol_t *tpol = &tetrapol->tpol;
+
+    if (!filter) {
+        tpol->has_filter = false;
+        return true;
+    }
+
+    if (filter->ncodops < 0 || filter->ncodops > TETRAPOL_FILTER_CODOPS_MAX ||
+            filter->naddr_ranges < 0 ||
+            filter->naddr_ranges > TETRAPOL_FILTER_ADDR_RANGES_MAX) {
+        LOG(ERR, "Invalid filter ncodops=%d naddr_ranges=%d",
+                filter->ncodops, filter->naddr_ranges);
+        return false;
+    }
+
+    memcpy(&tpol->filter, filter, sizeof(tetrapol_filter_t));
+    tpol->has_filter = filter->log_ch_mask || filter->fr_type_mask ||
+        filter->ncodops || filter->naddr_ranges;
+
+    return true;
+}
+
+bool tetrapol_has_filter(tetrapol_t *tetrapol)
+{
+    return tetrapol->tpol.has_filter;
+}
+
+static bool filter_log_ch(tpol_t *tpol, int log_ch)
+{
+    if (!filter_log_ch_match(&tpol->filter, log_ch)) {
+        ++tpol->stats.filtered_log_ch;
+        return false;
+    }
+
+    return true;
+}
+
+static bool filter_addr(tpol_t *tpol, const addr_t *addr)
+{
+    if (!filter_addr_match(&tpol->filter, addr)) {
+        ++tpol->stats.filtered_addr;
+        return false;
+    }
+
+    return true;
+}
+
+static bool filter_codop(tpol_t *tpol, const uint8_t *data, int len)
+{
+    if (!filter_codop_match(&tpol->filter, data, len)) {
+        ++tpol->stats.filtered_codop;
+        return false;
+    }
+
+    return true;
+}
+
+/// Fill event members common for all event types.
+static void evt_stamp(const tpol_t *tpol, tetrapol_evt_t *evt)
+{
+    evt->rx_offs = tpol->rx_offs;
+    evt->rx_time = tetrapol_rx_time(tpol);
+    evt->frame_no = tpol->frame_no;
+}
+
+/// Deliver event to all subscribers of event type.
+static void evt_emit(tpol_t *tpol, tetrapol_evt_t *evt)
+{
+    evt_stamp(tpol, evt);
+
+    TRACE_BEGIN(TRACE_OUTPUT);
+    // subscriber might unsubscribe from callback, see tetrapol_unsubscribe()
+    for (tpol->emit_idx = 0; tpol->emit_idx < tpol->nsubscribers;
+            ++tpol->emit_idx) {
+        const tpol_subscriber_t *s = &tpol->subscribers[tpol->emit_idx];
+        if (s->mask & evt->type) {
+            s->func(evt, s->ptr);
+        }
+    }
+    tpol->emit_idx = -1;
+    TRACE_END(TRACE_OUTPUT);
+}
+
+void tetrapol_evt_frame(tpol_t *tpol, const struct frame_t *fr)
+{
+    if (fr->fr_type >= 0 && fr->fr_type < TETRAPOL_FR_TYPES) {
+        metric_inc(fr->broken ? &tpol->metrics.frames_broken[fr->fr_type] :
+                &tpol->metrics.frames[fr->fr_type]);
+    }
+    metric_add(&tpol->metrics.syndromes, fr->syndromes);
+    metric_add(&tpol->metrics.bits_fixed, fr->bits_fixed);
+
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_FRAME)) {
+        return;
+    }
+
+    if (tpol->has_filter && !filter_fr_type_match(&tpol->filter, fr->fr_type)) {
+        ++tpol->stats.filtered_fr_type;
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_FRAME;
+    evt.frame.fr = fr;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_scr(tpol_t *tpol, int scr)
+{
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_SCR)) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_SCR;
+    evt.scr.scr = scr;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_sync(tpol_t *tpol, bool has_sync)
+{
+    metric_inc(has_sync ? &tpol->metrics.sync_gained :
+            &tpol->metrics.sync_lost);
+
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_SYNC)) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_SYNC;
+    evt.sync.has_sync = has_sync;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_hdlc(tpol_t *tpol, int log_ch,
+        const struct hdlc_frame_t *hdlc_fr)
+{
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_HDLC)) {
+        return;
+    }
+
+    if (tpol->has_filter && (!filter_log_ch(tpol, log_ch) ||
+                !filter_addr(tpol, &hdlc_fr->addr))) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_HDLC;
+    evt.hdlc.log_ch = log_ch;
+    evt.hdlc.hdlc_fr = hdlc_fr;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_lsdu(tpol_t *tpol, int log_ch,
+        const struct hdlc_frame_t *hdlc_fr)
+{
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_LSDU)) {
+        return;
+    }
+
+    if (tpol->has_filter && (!filter_log_ch(tpol, log_ch) ||
+                !filter_addr(tpol, &hdlc_fr->addr))) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_LSDU;
+    evt.lsdu.log_ch = log_ch;
+    evt.lsdu.hdlc_fr = hdlc_fr;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_pch(tpol_t *tpol, const uint8_t *data, int len)
+{
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_PCH)) {
+        return;
+    }
+
+    if (tpol->has_filter && !filter_log_ch(tpol, LOG_CH_PCH)) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_PCH;
+    evt.pch.data = data;
+    evt.pch.len = len;
+    evt_emit(tpol, &evt);
+}
+
+void tetrapol_evt_rch(tpol_t *tpol, const uint8_t *data, int len)
+{
+    if (!tetrapol_evt_enabled(tpol, TETRAPOL_EVT_RCH)) {
+        return;
+    }
+
+    if (tpol->has_filter && !filter_log_ch(tpol, LOG_CH_RCH)) {
+        return;
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_RCH;
+    evt.rch.data = data;
+    evt.rch.len = len;
+    evt_emit(tpol, &evt);
+}
+
 void tetrapol_evt_tsdu(tpol_t *tpol, const tpol_tsdu_t *tpol_tsdu)
 {
+    if (tpol_tsdu->data_len > 0) {
+        metric_inc(&tpol->metrics.tsdus[tpol_tsdu->data[0]]);
+    }
+
+    const int mask = TETRAPOL_EVT_TSDU | TETRAPOL_EVT_TSDU_DECODED;
+    if (!tetrapol_evt_enabled(tpol, mask)) {
+        return;
+    }
+
     if (tpol_tsdu->log_ch == LOG_CH_BCH) {
         if (tpol_tsdu->data_len <= 0) {
             return;
@@ -65,16 +447,96 @@ void tetrapol_evt_tsdu(tpol_t *tpol, const tpol_tsdu_t *tpol_tsdu)
         }
     }
 
+    if (tpol->has_filter && (!filter_log_ch(tpol, tpol_tsdu->log_ch) ||
+                !filter_codop(tpol, tpol_tsdu->data, tpol_tsdu->data_len) ||
+                !filter_addr(tpol, &tpol_tsdu->addr))) {
+        return;
+    }
+
+    // TSDU is decoded only when somebody asks for it
+    const arena_mark_t mark = arena_mark(&tpol->tsdu_arena);
     tsdu_t *tsdu = NULL;
-    tsdu_decode(tpol_tsdu->data, tpol_tsdu->data_len, &tsdu);
-    if (tsdu) {
-        LOG_IF(INFO) {
-            LOG_("\n");
-            LOGF("\tTSAP_ID=%d\tPRIO=%d\n", tpol_tsdu->tsap_id, tpol_tsdu->prio);
-            tsdu_print(tsdu);
+    if (tetrapol_evt_enabled(tpol, TETRAPOL_EVT_TSDU_DECODED)) {
+        TRACE_BEGIN(TRACE_TSDU_DECODE);
+        tsdu_decode_arena(&tpol->tsdu_arena, tpol_tsdu->data,
+                tpol_tsdu->data_len, &tsdu);
+        TRACE_END(TRACE_TSDU_DECODE);
+    }
+
+    tetrapol_evt_t evt;
+    evt.type = TETRAPOL_EVT_TSDU;
+    evt_stamp(tpol, &evt);
+    evt.tsdu.tsdu = tpol_tsdu;
+    trace_tsdu(tpol->rx_offs);
+    TRACE_BEGIN(TRACE_OUTPUT);
+    for (tpol->emit_idx = 0; tpol->emit_idx < tpol->nsubscribers;
+            ++tpol->emit_idx) {
+        const tpol_subscriber_t *s = &tpol->subscribers[tpol->emit_idx];
+        if (s->mask & mask) {
+            evt.tsdu.decoded =
+                (s->mask & TETRAPOL_EVT_TSDU_DECODED) ? tsdu : NULL;
+            s->func(&evt, s->ptr);
         }
-        tsdu_destroy(tsdu);
     }
+    tpol->emit_idx = -1;
+    TRACE_END(TRACE_OUTPUT);
+
+    arena_rewind(&tpol->tsdu_arena, mark);
+}
+
+void tetrapol_state_save(const tpol_t *tpol, snapshot_t *snap)
+{
+    snapshot_put_u64(snap, tpol->rx_offs);
+    snapshot_put_u8(snap,
+            (tpol->frame_no == FRAME_NO_UNKNOWN) ? 0xff : tpol->frame_no);
+    snapshot_put_u64(snap, tpol->cfg.start_time);
+
+    const uint64_t *stats = (const uint64_t *)&tpol->stats;
+    snapshot_put_u32(snap, sizeof(tetrapol_stats_t) / sizeof(uint64_t));
+    for (int i = 0; i < sizeof(tetrapol_stats_t) / sizeof(uint64_t); ++i) {
+        snapshot_put_u64(snap, stats[i]);
+    }
+
+    const uint64_t *metrics = (const uint64_t *)&tpol->metrics;
+    snapshot_put_u32(snap, sizeof(tetrapol_metrics_t) / sizeof(uint64_t));
+    for (int i = 0; i < sizeof(tetrapol_metrics_t) / sizeof(uint64_t); ++i) {
+        snapshot_put_u64(snap, metrics[i]);
+    }
+}
+
+bool tetrapol_state_load(tpol_t *tpol, snapshot_t *snap)
+{
+    tpol->rx_offs = snapshot_get_u64(snap);
+    const uint8_t frame_no = snapshot_get_u8(snap);
+    tpol->frame_no = (frame_no == 0xff) ? FRAME_NO_UNKNOWN : frame_no;
+    tpol->cfg.start_time = snapshot_get_u64(snap);
+    if (tpol->frame_no >= 200) {
+        snapshot_invalid(snap, "frame number");
+        return false;
+    }
+
+    if (snapshot_get_u32(snap) != sizeof(tetrapol_stats_t) / sizeof(uint64_t)) {
+        snapshot_invalid(snap, "stats");
+        return false;
+    }
+    const uint64_t terminals_live = tpol->stats.terminals_live;
+    uint64_t *stats = (uint64_t *)&tpol->stats;
+    for (int i = 0; i < sizeof(tetrapol_stats_t) / sizeof(uint64_t); ++i) {
+        stats[i] = snapshot_get_u64(snap);
+    }
+    tpol->stats.terminals_live = terminals_live;
+
+    if (snapshot_get_u32(snap) !=
+            sizeof(tetrapol_metrics_t) / sizeof(uint64_t)) {
+        snapshot_invalid(snap, "metrics");
+        return false;
+    }
+    uint64_t *metrics = (uint64_t *)&tpol->metrics;
+    for (int i = 0; i < sizeof(tetrapol_metrics_t) / sizeof(uint64_t); ++i) {
+        metric_add(&metrics[i], snapshot_get_u64(snap) - metrics[i]);
+    }
+    metric_add(&tpol->metrics.terminals_live,
+            terminals_live - tpol->metrics.terminals_live);
 
-    tsdu_json(tpol, tpol_tsdu);
+    return !snap->err;
 }
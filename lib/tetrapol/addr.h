@@ -49,6 +49,12 @@ static inline bool addr_is_coi_all_st(const addr_t *addr)
     // x=0 for all stations? it is not a bug in specification?
 };
 
+/// Pack address into 16 bits, same as TETRAPOL_ADDR().
+static inline uint16_t addr_pack(const addr_t *addr)
+{
+    return (addr->z << 15) | (addr->y << 12) | addr->x;
+}
+
 static inline void addr_parse(addr_t *addr, const uint8_t *buf, int skip)
 {
     addr->z = get_bits(1,  buf, 0 + skip);
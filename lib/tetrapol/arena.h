@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+  Bump allocator over caller provided buffer. Objects allocated from arena
+  are not released one by one, whole arena is released by arena_reset() or
+  by arena_rewind() to previously taken mark.
+
+  All functions accept NULL arena, then standard heap (malloc/realloc/free)
+  is used. This allows single implementation of decoders for both heap
+  allocated and arena allocated results.
+  */
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t used;
+    size_t last;    ///< offset of last allocation, it can be resized in place
+} arena_t;
+
+typedef size_t arena_mark_t;
+
+void arena_init(arena_t *arena, void *buf, size_t size);
+
+/**
+  Release all objects allocated from arena.
+  */
+void arena_reset(arena_t *arena);
+
+/**
+  @return mark, which can be used for releasing all objects allocated after
+  this call.
+  */
+arena_mark_t arena_mark(const arena_t *arena);
+void arena_rewind(arena_t *arena, arena_mark_t mark);
+
+/**
+  Allocate memory from arena.
+
+  @return pointer to memory or NULL when arena is exhausted.
+  */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/**
+  Resize memory allocated from arena, memory is resized in place when it is
+  the last allocation from arena, copied otherwise. Original content is
+  preserved.
+  */
+void *arena_realloc(arena_t *arena, void *ptr, size_t size);
+
+/**
+  Free memory when allocated from heap (arena is NULL), do nothing otherwise.
+  */
+void arena_free(arena_t *arena, void *ptr);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <tetrapol/json_writer.h>
+#include <tetrapol/tetrapol_int.h>
+
+/**
+ * Dump PCH event (TETRAPOL_EVT_PCH) as a JSON string.
+ */
+void pch_json(json_writer_t *jw, const tetrapol_evt_t *evt);
+
+/**
+ * Dump RCH event (TETRAPOL_EVT_RCH) as a JSON string.
+ */
+void rch_json(json_writer_t *jw, const tetrapol_evt_t *evt);
+
+/**
+ * Dump repeat event (TETRAPOL_EVT_REPEAT) as a JSON string.
+ */
+void repeat_json(json_writer_t *jw, const tetrapol_evt_t *evt);
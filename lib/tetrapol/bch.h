@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
 #include <tetrapol/tetrapol_int.h>
 #include <tetrapol/tsdu.h>
 
@@ -9,4 +10,29 @@ typedef struct bch_priv_t bch_t;
 bch_t *bch_create(tpol_t *tpol);
 void bch_destroy(bch_t *bch);
 bool bch_push_frame(bch_t *bch, const frame_t *fr);
-tsdu_d_system_info_t *bch_get_tsdu(bch_t *bch);
+
+/**
+  Process HDLC frame with valid FCS received on BCH, skips data frame
+  reassembly. Used for replay of captured HDLC frames.
+
+  @return true when new D_SYSTEM_INFO was decoded
+  */
+bool bch_push_hdlc_frame(bch_t *bch, const hdlc_frame_t *hdlc_fr);
+
+/**
+  Get last D_SYSTEM_INFO received on BCH.
+
+  TSDU is owned by bch and must not be destroyed by caller. It remains valid
+  until bch_push_frame() returns true again or until bch_destroy() is called,
+  caller which needs the data for longer must copy them.
+
+  @return last D_SYSTEM_INFO or NULL if not received yet
+  */
+const tsdu_d_system_info_t *bch_get_tsdu(bch_t *bch);
+
+/**
+  Save state of data frame reassembly, last D_SYSTEM_INFO is not saved,
+  bch_get_tsdu() returns NULL until next one is received.
+  */
+void bch_save(const bch_t *bch, snapshot_t *snap);
+bool bch_load(bch_t *bch, snapshot_t *snap);
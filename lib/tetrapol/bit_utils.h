@@ -15,6 +15,14 @@
  */
 bool check_fcs(const uint8_t *data, int nbits);
 
+/**
+ * Compute TETRAPOL style FCS of the data block, inverse of check_fcs().
+ *
+ * @param data Data packed into bytes, FCS is stored in the last 2 bytes.
+ * @param nbits Lenght of data in bits including FCS, multiple of 8.
+ */
+void set_fcs(uint8_t *data, int nbits);
+
 /**
  * @brief get_bits Get int from byte array (bytes of TETRAPOL data frame).
  * @param len Bites used for extraction.
@@ -49,6 +57,59 @@ static inline int cmpzero(const void *data, int len)
     return true;
 }
 
+/**
+  Little endian integers in byte array, used by binary file formats.
+
+  put_u*() store value and return pointer just behind it.
+  */
+static inline uint8_t *put_u8(uint8_t *p, uint8_t v)
+{
+    *p = v;
+    return p + 1;
+}
+
+static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+static inline uint8_t *put_u32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = v >> (8 * i);
+    }
+    return p + 4;
+}
+
+static inline uint8_t *put_u64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        p[i] = v >> (8 * i);
+    }
+    return p + 8;
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t get_u64(const uint8_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
 /**
   Pack bits from one bit per byte into 8 bits per byte. First bit is held in
   LSB of firts byte.
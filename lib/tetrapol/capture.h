@@ -0,0 +1,151 @@
+#pragma once
+
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
+#include <tetrapol/phys_ch.h>
+#include <tetrapol/tetrapol.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+  Capture of decoded frames or HDLC frames, replay of capture skips frame
+  synchronization, SCR detection and frame decoding (and data frame
+  reassembly for HDLC level) which makes reprocessing of upper layers much
+  faster than decoding of the original bits.
+
+  Frames are captured losslessly, replay of frame level capture produces
+  the same events as decoding of the original bits. HDLC level capture
+  contains only frames with valid FCS, stuffing and broken frames are not
+  replayed. Capture can not be written from decoder with event filter
+  (tetrapol_set_filter()), filter can be applied when capture is replayed.
+
+  Stream starts with file header followed by records, all integers are
+  little endian.
+
+  File header (24 B):
+    char magic[4]       "TPCP"
+    uint8_t version     CAPTURE_VERSION
+    uint8_t level       CAPTURE_LEVEL_FRAME or CAPTURE_LEVEL_HDLC
+    uint8_t band        as in tetrapol_cfg_t
+    uint8_t dir
+    uint8_t radio_ch_type
+    uint8_t reserved[7]
+    uint64_t start_time
+
+  Record header (8 B):
+    uint16_t len        length of record including header
+    uint8_t type        CAPTURE_REC_*
+    uint8_t frame_no    CAPTURE_FRAME_NO_UNKNOWN when unknown
+    uint32_t rx_offs    difference to rx_offs of previous record
+
+  CAPTURE_REC_BASE payload, written when difference does not fit into
+  record header:
+    uint64_t rx_offs    absolute value, rx_offs in header is 0,
+                        must not be lower than rx_offs of previous record
+
+  CAPTURE_REC_FRAME payload:
+    uint8_t scr         SCR used for decoding
+    int8_t fr_type
+    int8_t broken       saturated to 127
+    uint8_t syndromes   saturated to 255
+    uint8_t bits_fixed  saturated to 255
+    uint8_t bits[]      crc_data packed LSB first, 9 B for data frame,
+                        16 B for voice frame (crc_data and voice2), none
+                        for other frame types
+
+  CAPTURE_REC_HDLC payload:
+    uint8_t log_ch
+    uint16_t addr       see addr_pack()
+    uint8_t cmd[4]      command.cmd followed by members of command variant
+    uint16_t nbits
+    uint8_t data[(nbits + 16 + 7) / 8]  data with FCS
+
+  CAPTURE_REC_SYNC payload:
+    uint8_t has_sync
+  */
+
+enum {
+    CAPTURE_VERSION = 1,
+    CAPTURE_FILE_HDR_LEN = 24,
+    CAPTURE_REC_HDR_LEN = 8,
+    CAPTURE_FRAME_NO_UNKNOWN = 0xff,
+};
+
+enum {
+    CAPTURE_LEVEL_FRAME = 1,
+    CAPTURE_LEVEL_HDLC = 2,
+};
+
+enum {
+    CAPTURE_REC_BASE = 1,
+    CAPTURE_REC_FRAME = 2,
+    CAPTURE_REC_HDLC = 3,
+    CAPTURE_REC_SYNC = 4,
+};
+
+typedef struct {
+    int level;          ///< CAPTURE_LEVEL_*
+    tetrapol_cfg_t cfg; ///< band, dir, radio_ch_type and start_time
+} capture_hdr_t;
+
+/**
+  Record read from capture, only members relevant for type are valid.
+  */
+typedef struct {
+    int type;           ///< CAPTURE_REC_FRAME, CAPTURE_REC_HDLC or _SYNC
+    uint64_t rx_offs;
+    int frame_no;       ///< FRAME_NO_UNKNOWN when unknown
+    int scr;
+    int log_ch;
+    bool has_sync;
+    frame_t fr;
+    hdlc_frame_t hdlc_fr;
+} capture_rec_t;
+
+typedef struct {
+    FILE *f;
+    capture_hdr_t hdr;
+    uint64_t rx_offs;   ///< rx_offs of last record
+} capture_reader_t;
+
+typedef struct capture_writer_priv_t capture_writer_t;
+
+/**
+  Create writer and subscribe it for events of tetrapol. File header is
+  written immediately, band, direction, channel type and start time are
+  taken from configuration of tetrapol.
+
+  @param level CAPTURE_LEVEL_FRAME or CAPTURE_LEVEL_HDLC
+
+  @return new writer or NULL on error or when tetrapol has filter set
+  */
+capture_writer_t *capture_writer_create(FILE *f, int level,
+        tetrapol_t *tetrapol);
+
+/**
+  Unsubscribe writer and destroy it, file is flushed but not closed.
+
+  @return 0 on success, -1 when any write failed
+  */
+int capture_writer_destroy(capture_writer_t *cw);
+
+/**
+  Initialize reader, read and check file header.
+
+  @return 0 on success, -1 on error
+  */
+int capture_reader_init(capture_reader_t *cr, FILE *f);
+
+/**
+  Read next record, records with unknown type are skipped.
+
+  @return 1 when record was read, 0 on end of file, -1 on error
+  */
+int capture_read(capture_reader_t *cr, capture_rec_t *rec);
+
+/**
+  Feed record into phys_ch created with configuration from capture header.
+  */
+void capture_replay(phys_ch_t *phys_ch, const capture_rec_t *rec);
@@ -1,7 +1,7 @@
 #pragma once
 #include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
 #include <tetrapol/tetrapol_int.h>
-#include <tetrapol/tp_timer.h>
 
 typedef struct cch_priv_t cch_t;
 
@@ -16,10 +16,24 @@ void cch_destroy(cch_t *cch);
   */
 int cch_push_frame(cch_t *cch, const frame_t *fr);
 
+/**
+  Process HDLC frame with valid FCS received on logical channel log_ch
+  (LOG_CH_BCH or LOG_CH_SDCH), skips data frame reassembly.
+
+  @return 0 on success, -1 on error
+  */
+int cch_push_hdlc_frame(cch_t *cch, int log_ch, const hdlc_frame_t *hdlc_fr);
+
 /**
   Anounce framing error to CCH, allows detection of potentional framing
   synchronization loss.
   */
 void cch_fr_error(cch_t *cch);
 
-void cch_tick(time_evt_t *te, void *cch);
+/**
+  Report RX glitch (lost data) to CCH.
+  */
+void cch_rx_glitch(cch_t *cch);
+
+void cch_save(const cch_t *cch, snapshot_t *snap);
+bool cch_load(cch_t *cch, snapshot_t *snap);
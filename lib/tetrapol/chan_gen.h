@@ -0,0 +1,88 @@
+#pragma once
+
+#include <tetrapol/frame.h>
+
+#include <stdint.h>
+
+/**
+  Synthetic channel generator, produces stream of encoded frames with
+  pseudo-random content and optional channel impairments. Output is the same
+  as expected by tetrapol_phys_ch_recv(), one bit per byte.
+
+  Impairments are applied to each frame independently, rates are
+  probabilities per frame except ber which is probability per bit. Payload
+  and impairments are generated from independent pseudo-random sequences, so
+  streams generated with the same seed differ only by impairments.
+
+  Each generated frame and each impairment is reported by event, this is
+  the ground truth for decoder tests.
+  */
+
+typedef struct {
+    int band;       ///< TETRAPOL_BAND_UHF or TETRAPOL_BAND_VHF
+    int dir;        ///< DIR_DOWNLINK or DIR_UPLINK
+    int scr;        ///< scrambling constant
+    int fr_type;    ///< FRAME_TYPE_DATA or FRAME_TYPE_VOICE
+    uint32_t seed;  ///< 0 for default
+    double ber;             ///< random bit errors
+    double burst_rate;      ///< burst of random bits inside of frame
+    int burst_len;
+    double slip_rate;       ///< bit deleted or inserted inside of frame
+    double polarity_rate;   ///< polarity of signal inverted from frame start
+    double gap_rate;        ///< noise inserted in front of frame
+    int gap_len;
+} chan_gen_cfg_t;
+
+typedef enum {
+    CHAN_GEN_EVT_FRAME,
+    CHAN_GEN_EVT_BURST,
+    CHAN_GEN_EVT_SLIP,
+    CHAN_GEN_EVT_POLARITY,
+    CHAN_GEN_EVT_GAP,
+} chan_gen_evt_type_t;
+
+typedef struct {
+    chan_gen_evt_type_t type;
+    uint64_t offs;      ///< position in output stream (bits)
+    union {
+        struct {
+            const frame_t *fr;  ///< frame before encoding
+            uint64_t seq;       ///< frame number in stream, from 0
+            int bit_errs;       ///< bits flipped by ber and burst
+        } frame;
+        struct {
+            int len;
+        } burst;
+        struct {
+            int bits;   ///< -1 for deleted bit, 1 for inserted bit
+        } slip;
+        struct {
+            int len;
+        } gap;
+    };
+} chan_gen_evt_t;
+
+typedef void (*chan_gen_evt_cb_t)(const chan_gen_evt_t *evt, void *ptr);
+
+typedef struct chan_gen_priv_t chan_gen_t;
+
+chan_gen_t *chan_gen_create(const chan_gen_cfg_t *cfg);
+void chan_gen_destroy(chan_gen_t *gen);
+
+/**
+  Set callback for ground truth events, events are reported before
+  chan_gen_frame() returns.
+  */
+void chan_gen_set_evt_cb(chan_gen_t *gen, chan_gen_evt_cb_t cb, void *ptr);
+
+/// Size of buffer sufficient for any output of chan_gen_frame().
+int chan_gen_frame_len_max(const chan_gen_t *gen);
+
+/**
+  Generate next frame including impairments.
+
+  @param bits Output buffer, at least chan_gen_frame_len_max() bytes.
+
+  @return number of bits written, -1 on error
+  */
+int chan_gen_frame(chan_gen_t *gen, uint8_t *bits);
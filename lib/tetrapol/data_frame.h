@@ -1,6 +1,9 @@
 #pragma once
 
 #include <tetrapol/frame.h>
+#include <tetrapol/snapshot_int.h>
+
+#include <stdbool.h>
 
 typedef struct data_frame_priv_t data_frame_t;
 
@@ -40,3 +43,7 @@ int data_frame_get_bytes(data_frame_t *data_fr, uint8_t *data);
 
 void data_frame_destroy(data_frame_t *data_fr);
 
+/** Save frames waiting for the rest of data frame. */
+void data_frame_save(const data_frame_t *data_fr, snapshot_t *snap);
+bool data_frame_load(data_frame_t *data_fr, snapshot_t *snap);
+
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <tetrapol/frame.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+  Compact binary format for frame, SCR and TSDU events.
+
+  Stream starts with file header followed by records, all integers are
+  little endian.
+
+  File header (8 B):
+    char magic[4]       "TPEV"
+    uint8_t version     EVT_BIN_VERSION
+    uint8_t reserved[3]
+
+  Record header (12 B):
+    uint16_t len        length of record including header
+    uint8_t type        TETRAPOL_EVT_FRAME, TETRAPOL_EVT_SCR, TETRAPOL_EVT_TSDU
+                        or EVT_BIN_REC_*
+    uint8_t frame_no    EVT_BIN_FRAME_NO_UNKNOWN when unknown
+    uint32_t rx_offs    difference to rx_offs of previous record
+    uint32_t rx_time    difference to rx_time of previous record
+
+  EVT_BIN_REC_BASE payload, written before first record and when difference
+  does not fit into record header (e.g. system time goes backward):
+    uint64_t rx_offs    absolute value, rx_offs in header is 0
+    uint64_t rx_time    absolute value, rx_time in header is 0
+
+  TETRAPOL_EVT_FRAME payload:
+    uint8_t fr_type
+    int8_t broken
+    uint8_t syndromes   saturated to 255
+    uint8_t bits_fixed  saturated to 255
+    uint8_t bits        asb[0], asb[1], fn[0], fn[1] in bits 0..3
+    uint8_t data[]      8 B for data, 15 B for voice frame, packed as in JSON
+
+  TETRAPOL_EVT_SCR payload:
+    uint8_t scr
+
+  TETRAPOL_EVT_TSDU payload:
+    uint8_t log_ch
+    uint8_t tpdu_type
+    int8_t prio
+    int8_t tsap_id
+    int16_t tsap_ref_swmi
+    int16_t tsap_ref_rt
+    uint8_t addr_z
+    uint8_t addr_y
+    uint16_t addr_x
+    uint16_t data_len
+    uint8_t data[data_len]
+
+  EVT_BIN_REC_PCH and EVT_BIN_REC_RCH payload:
+    uint8_t data[]      content of block
+
+  EVT_BIN_REC_REPEAT payload:
+    uint8_t log_ch
+  */
+
+enum {
+    EVT_BIN_VERSION = 1,
+    EVT_BIN_FILE_HDR_LEN = 8,
+    EVT_BIN_REC_HDR_LEN = 12,
+    EVT_BIN_REC_MAX = UINT16_MAX,
+    EVT_BIN_REC_BASE = 0x80,
+    EVT_BIN_REC_PCH = 0x81,
+    EVT_BIN_REC_RCH = 0x82,
+    EVT_BIN_REC_REPEAT = 0x83,
+    EVT_BIN_FRAME_NO_UNKNOWN = 0xff,
+    /// buffer size sufficient for any record produced by evt_bin_encode()
+    EVT_BIN_ENCODE_MAX = EVT_BIN_REC_MAX + 64,
+    /// base record and record without variable length data (TSDU, PCH, RCH)
+    EVT_BIN_ENCODE_FIXED_MAX = 2 * EVT_BIN_REC_HDR_LEN + 16 + 32,
+};
+
+/**
+  Values of last record in stream, required by both writer and reader.
+  */
+typedef struct {
+    bool has_base;
+    uint64_t rx_offs;
+    uint64_t rx_time;
+} evt_bin_ctx_t;
+
+/**
+  Event read from binary stream, members of evt point into this structure.
+  */
+typedef struct {
+    tetrapol_evt_t evt;
+    frame_t fr;
+    tpol_tsdu_t tsdu;
+    uint8_t data[EVT_BIN_REC_MAX];
+} evt_bin_rec_t;
+
+void evt_bin_ctx_init(evt_bin_ctx_t *ctx);
+
+/**
+  Encode file header into buf of EVT_BIN_FILE_HDR_LEN bytes.
+  */
+void evt_bin_encode_file_hdr(uint8_t *buf);
+
+/**
+  Write file header.
+
+  @return 0 on success, -1 on error
+  */
+int evt_bin_write_file_hdr(FILE *f);
+
+/**
+  Encode event as binary record into buf, base record is prepended when
+  required. Only frame, SCR, TSDU, PCH, RCH and repeat events are supported.
+
+  @param size Size of buf, EVT_BIN_ENCODE_MAX is always sufficient.
+
+  @return length of data in buf, 0 for unsupported event, -1 when buf is too
+    small (ctx is not modified)
+  */
+int evt_bin_encode(uint8_t *buf, int size, evt_bin_ctx_t *ctx,
+        const tetrapol_evt_t *evt);
+
+/**
+  Write event as binary record, only frame, SCR, TSDU, PCH, RCH and repeat
+  events are supported, other events are silently ignored.
+
+  @return 0 on success, -1 on error
+  */
+int evt_bin_write(FILE *f, evt_bin_ctx_t *ctx, const tetrapol_evt_t *evt);
+
+/**
+  Read and check file header.
+
+  @return 0 on success, -1 on error
+  */
+int evt_bin_read_file_hdr(FILE *f);
+
+/**
+  Read next record from stream, records with unknown type are skipped.
+
+  @return 1 when record was read, 0 on end of file, -1 on error
+  */
+int evt_bin_read(FILE *f, evt_bin_ctx_t *ctx, evt_bin_rec_t *rec);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <tetrapol/tetrapol.h>
+
+#include <stdint.h>
+
+/**
+  Publishing of events to local consumers over UNIX domain stream socket.
+
+  Consumer connects to the socket and sends subscription, single line of
+  space separated KEY=VALUES expressions terminated by '\n'. Empty line
+  subscribes for all events.
+
+    events=FRAME,SCR,TSDU,PCH,RCH   event types (default all)
+    policy=drop                     drop events when consumer is slow (default)
+    policy=disconnect               close connection when consumer is slow
+    log_ch=... codop=... addr=... frame=...
+                                    see filter_parse()
+
+  Reply is the binary event stream as written by tetrapol_dump -f BIN, file
+  header followed by records, see evt_bin.h. Records are collected in per
+  consumer queue and sent in batches by evt_bus_poll(). All sockets are
+  non-blocking, when queue of consumer is full the event is dropped (or
+  consumer disconnected) and publisher continues.
+  */
+
+typedef struct evt_bus_priv_t evt_bus_t;
+
+enum {
+    EVT_BUS_CLIENTS_MAX = 16,
+    EVT_BUS_QUEUE_SIZE_DEFAULT = 1024 * 1024,
+    EVT_BUS_REQ_MAX = 1024,     ///< max. length of subscription line
+};
+
+typedef struct {
+    uint64_t clients;       ///< subscribers connected since creation
+    uint64_t published;     ///< events passed to evt_bus_publish()
+    uint64_t queued;        ///< records queued for subscribers
+    uint64_t dropped;       ///< records dropped due to full queue
+    uint64_t disconnected;  ///< subscribers disconnected for being slow
+} evt_bus_stats_t;
+
+/**
+  Create listening socket, stale socket at path is replaced.
+
+  @param queue_size Size of queue for each subscriber in bytes.
+  */
+evt_bus_t *evt_bus_create(const char *path, int queue_size);
+
+/**
+  Close all connections and remove socket.
+  */
+void evt_bus_destroy(evt_bus_t *bus);
+
+/**
+  Accept new subscribers, read subscriptions and send queued records. Never
+  blocks, should be called regularly.
+  */
+void evt_bus_poll(evt_bus_t *bus);
+
+/**
+  Queue event for all matching subscribers. Supported are events which can
+  be written by evt_bin_write().
+  */
+void evt_bus_publish(evt_bus_t *bus, const tetrapol_evt_t *evt);
+
+void evt_bus_get_stats(evt_bus_t *bus, evt_bus_stats_t *stats);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+  Delta coding of broadcast events. BCH (D_SYSTEM_INFO TSDU), PCH and RCH
+  content is repeated every superframe, usually without any change. Event
+  with the same content as the last one written for its logical channel is
+  replaced by TETRAPOL_EVT_REPEAT event, which carries only time and log.
+  channel. Full event is written again at least once per keyframe interval,
+  so the stream can be decoded from any keyframe.
+
+  Expander restores the original stream by replacing repeat events with copy
+  of the last full event of the same logical channel.
+  */
+
+typedef struct evt_delta_priv_t evt_delta_t;
+typedef struct evt_expand_priv_t evt_expand_t;
+
+/**
+  @param keyframe_interval Max. time between two full events (us).
+  */
+evt_delta_t *evt_delta_create(uint64_t keyframe_interval);
+void evt_delta_destroy(evt_delta_t *delta);
+
+/**
+  Return event which should be written into delta stream.
+
+  @param evt Event to be written.
+  @param repeat Used for repeat event when evt is replaced.
+
+  @return evt or repeat
+  */
+const tetrapol_evt_t *evt_delta_push(evt_delta_t *delta,
+        const tetrapol_evt_t *evt, tetrapol_evt_t *repeat);
+
+evt_expand_t *evt_expand_create(void);
+void evt_expand_destroy(evt_expand_t *expand);
+
+/**
+  Return event of original stream for event from delta stream. Returned
+  pointer is valid until next call.
+
+  @return evt, full event for repeat event or NULL when repeat event
+    preceeds any full event of its logical channel
+  */
+const tetrapol_evt_t *evt_expand_push(evt_expand_t *expand,
+        const tetrapol_evt_t *evt);
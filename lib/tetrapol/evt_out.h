@@ -0,0 +1,52 @@
+#pragma once
+
+#include <tetrapol/evt_bin.h>
+#include <tetrapol/json_writer.h>
+#include <tetrapol/tetrapol_int.h>
+
+#include <stdio.h>
+
+/**
+  Output of events in format selected by user, JSON lines or binary format
+  (evt_bin.h) which can be converted by tetrapol_bin2json.
+  */
+
+enum {
+    EVT_OUT_JSON,
+    EVT_OUT_BIN,
+    EVT_OUT_NONE,
+};
+
+typedef struct {
+    int fmt;                ///< EVT_OUT_*
+    json_writer_t *jw;      ///< output for EVT_OUT_JSON
+    FILE *bin_f;            ///< output for EVT_OUT_BIN
+    evt_bin_ctx_t bin_ctx;
+} evt_out_t;
+
+/**
+  Initialize output, only jw or bin_f is used depending on format. File
+  header of binary format is not written.
+  */
+void evt_out_init(evt_out_t *out, int fmt, json_writer_t *jw, FILE *bin_f);
+
+/**
+  Parse format name: JSON, BIN or NONE.
+
+  @return EVT_OUT_* or -1 for unknown name
+  */
+int evt_out_parse_fmt(const char *name);
+
+/**
+  Write event, frame, SCR, TSDU, PCH, RCH and repeat events are supported,
+  other events are silently ignored.
+
+  @return 0 on success, -1 on error
+  */
+int evt_out_write(evt_out_t *out, const tetrapol_evt_t *evt);
+
+/**
+  Dump event as a JSON string, events listed in evt_out_write() are
+  supported, other events are silently ignored.
+  */
+void evt_json(json_writer_t *jw, const tetrapol_evt_t *evt);
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <tetrapol/addr.h>
+#include <tetrapol/tetrapol.h>
+
+/**
+  Initialize filter which passes all events.
+  */
+void filter_init(tetrapol_filter_t *filter);
+
+/**
+  Add criterion given as text into filter. Expression has form KEY=VALUES,
+  VALUES are separated by comma, event passes criterion when it matches any
+  of the values.
+
+    log_ch=BCH,SDCH             see LOG_CH_*
+    codop=0x4e,0x0d             TSDU codop, number in C notation
+    addr=1.7.0xfff,0.1.0-0.1.0xff
+                                address Z.Y.X or range of addresses
+    frame=DATA,VOICE            see FRAME_TYPE_*
+
+  @return 0 on success, -1 on error
+  */
+int filter_parse(tetrapol_filter_t *filter, const char *expr);
+
+/**
+  Criteria of filter evaluated separately, empty criterion passes.
+  */
+bool filter_log_ch_match(const tetrapol_filter_t *filter, int log_ch);
+bool filter_addr_match(const tetrapol_filter_t *filter, const addr_t *addr);
+/// data is TSDU, its first byte is codop
+bool filter_codop_match(const tetrapol_filter_t *filter, const uint8_t *data,
+        int len);
+bool filter_fr_type_match(const tetrapol_filter_t *filter, int fr_type);
+
+/**
+  Evaluate filter for already created event, criteria are applied as in
+  tetrapol_set_filter(). Events of other types than frame, HDLC, LSDU,
+  PCH, RCH and TSDU always pass.
+  */
+bool filter_match(const tetrapol_filter_t *filter, const tetrapol_evt_t *evt);
@@ -69,7 +69,7 @@ typedef struct {
     // TODO
 } frame_direct_emergecy_t;
 
-typedef struct {
+typedef struct frame_t {
     union {
         uint8_t d;
         uint8_t blob_[0];    ///< used to copy data into frame structure
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <tetrapol/frame.h>
+#include <tetrapol/json_writer.h>
 #include <tetrapol/tetrapol_int.h>
 
 /**
- * Dump frme as a JSON string.
+ * Dump frame event (TETRAPOL_EVT_FRAME) as a JSON string.
  */
-void frame_json(tpol_t *tpol, const frame_t *fr);
+void frame_json(json_writer_t *jw, const tetrapol_evt_t *evt);
 
+/**
+ * Dump SCR event (TETRAPOL_EVT_SCR) as a JSON string.
+ */
+void scr_json(json_writer_t *jw, const tetrapol_evt_t *evt);
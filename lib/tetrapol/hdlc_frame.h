@@ -63,7 +63,7 @@ typedef struct {
     };
 } command_t;
 
-typedef struct {
+typedef struct hdlc_frame_t {
     addr_t addr;
     command_t command;
     int nbits;          ///< lenght is in bits
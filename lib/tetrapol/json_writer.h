@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+    JSON_WRITER_BUF_SIZE = 64 * 1024,
+};
+
+/**
+  Buffered writer for JSON output. Output is collected in large buffer and
+  written into file descriptor in batches, formatting is done without stdio.
+
+  Members are private, structure is public only to allow inlining.
+  */
+typedef struct {
+    int fd;
+    bool err;                   ///< write failed, output is discarded
+    int len;                    ///< used part of buf
+    time_t time_sec;            ///< second of cached time_prefix
+    int time_prefix_len;
+    char time_prefix[32];       ///< "YYYY-MM-DDTHH-MM-SS."
+    char buf[JSON_WRITER_BUF_SIZE];
+} json_writer_t;
+
+json_writer_t *json_writer_create(int fd);
+
+/**
+  Flush buffered data and destroy writer.
+  */
+void json_writer_destroy(json_writer_t *jw);
+
+/**
+  Write buffered data into file descriptor.
+
+  @return 0 on success, -1 on error
+  */
+int json_writer_flush(json_writer_t *jw);
+
+/// Write n bytes.
+void json_writer_mem(json_writer_t *jw, const char *s, int n);
+
+/// Write bytes as lower case hex, without spaces.
+void json_writer_hex(json_writer_t *jw, const uint8_t *data, int n);
+
+/// Write integer as decimal number.
+void json_writer_int(json_writer_t *jw, int64_t val);
+void json_writer_uint(json_writer_t *jw, uint64_t val);
+
+/**
+  Write time as "%4d-%02d-%02dT%02d-%02d-%02d.%06ld" in UTC.
+
+  @param t time in us since epoch
+  */
+void json_writer_time(json_writer_t *jw, uint64_t t);
+
+/// Write string constant, length is computed in compile time.
+#define json_writer_str(jw, s) json_writer_mem((jw), (s), sizeof(s) - 1)
+
+/// Write null terminated string.
+static inline void json_writer_cstr(json_writer_t *jw, const char *s)
+{
+    json_writer_mem(jw, s, strlen(s));
+}
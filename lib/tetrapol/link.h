@@ -1,14 +1,23 @@
 #pragma once
 
 #include <tetrapol/hdlc_frame.h>
-#include <tetrapol/tp_timer.h>
+#include <tetrapol/snapshot_int.h>
 #include <tetrapol/tetrapol_int.h>
 
 typedef struct link_priv_t link_t;
 
+/**
+  Create pool for links shared by all terminals of TETRAPOL instance.
+  */
+bool link_pools_create(tpol_t *tpol);
+void link_pools_destroy(tpol_t *tpol);
+
 link_t *link_create(tpol_t *tpol, int log_ch);
 void link_destroy(link_t *link);
 int link_push_hdlc_frame(link_t *link, const hdlc_frame_t *hdlc_fr);
 void link_rx_glitch(link_t *link);
-void link_tick(time_evt_t* te, link_t *link);
+
+/** Save sequence numbers and state of transport layer. */
+void link_save(const link_t *link, snapshot_t *snap);
+bool link_load(link_t *link, snapshot_t *snap);
 
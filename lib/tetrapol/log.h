@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdarg.h>
 #include <stdio.h>
 
 /**
@@ -10,6 +11,8 @@
   #define LOG_PREFIX "some_prefix"  // prefix used for logging (optional)
   #define LOG_LVL DBG               // override log level for this file
 
+  Messages are written to stderr by log_printf(), unless backend is set by
+  log_set_backend(), see tetrapol/log_async.h.
   */
 
 #define WTF 0
@@ -19,6 +22,17 @@
 
 extern int log_global_lvl;
 
+/**
+  Log output backend, fmt is always string literal from call site.
+
+  @return 0 when message was consumed, -1 to write it to stderr
+  */
+typedef int (*log_backend_t)(const char *fmt, va_list ap);
+
+void log_set_backend(log_backend_t backend);
+
+void log_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
 // define LOG_LVL to override log level for single file
 #ifndef LOG_LVL
 #define LOG_LOCAL_LVL(lvl) (0)
@@ -32,7 +46,7 @@ extern int log_global_lvl;
 
 #define LOG_STR_(s) #s
 
-#define LOGF(...) fprintf(stderr, ##__VA_ARGS__)
+#define LOGF(...) log_printf(__VA_ARGS__)
 
 #define LOG__(line, msg, ...) \
     LOGF(LOG_PREFIX ":" LOG_STR_(line) " " msg , ##__VA_ARGS__)
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+  Asynchronous backend for log.h.
+
+  Calling thread only stores format string pointer and copy of arguments
+  into its own lock-free ring, messages are formatted and written to stderr
+  by background thread. When ring is full, message is dropped and counted.
+  Order of messages is kept for each thread, not between threads.
+
+  Supported are conversions d i u o x X c e f g a s p with any flags, width,
+  precision and length modifiers, strings longer than LOG_ASYNC_REC_SIZE are
+  truncated. Messages with other conversions (%n) are written synchronously.
+  */
+
+enum {
+    LOG_ASYNC_RING_LEN = 1024,      ///< records per thread, power of 2
+    LOG_ASYNC_REC_SIZE = 256,       ///< bytes for arguments of one record
+    LOG_ASYNC_THREADS_MAX = 16,     ///< other threads log synchronously
+};
+
+/**
+  Start background thread and redirect log output into it. Must be called
+  before other threads start logging.
+
+  @return 0 on success, -1 on error
+  */
+int log_async_start(void);
+
+/**
+  Write all pending messages, stop background thread and return to
+  synchronous logging. Must be called when other threads do not log.
+  */
+void log_async_stop(void);
+
+/// Number of messages dropped due to full ring.
+uint64_t log_async_dropped(void);
@@ -90,5 +90,11 @@ typedef union {
  */
 int lsdu_cd_decode(const uint8_t *data, int len, lsdu_cd_t **lsdu);
 
+/**
+  Same as lsdu_cd_decode(), but result is stored into caller provided
+  structure, no allocation is done.
+  */
+int lsdu_cd_parse(const uint8_t *data, int len, lsdu_cd_t *lsdu);
+
 void lsdu_cd_print(const lsdu_cd_t *lsdu);
 void lsdu_cd_destroy(lsdu_cd_t *lsdu);
@@ -30,5 +30,10 @@ typedef struct {
 
 void lsdu_vch_destroy(lsdu_vch_t *lsdu);
 int lsdu_vch_decode_hdlc_frame(const hdlc_frame_t *hdlc_fr, lsdu_vch_t **lsdu);
+
+/**
+  Parse LSDU into caller provided structure, no allocation is done.
+  */
+int lsdu_vch_parse_hdlc_frame(const hdlc_frame_t *hdlc_fr, lsdu_vch_t *lsdu);
 void lsdu_vch_print(const lsdu_vch_t *lsdu);
 
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <tetrapol/tetrapol.h>
+
+/**
+  Write metrics in Prometheus text exposition format, suitable for textfile
+  collector of node_exporter. File is written under temporary name and
+  renamed, readers never see partial file.
+
+  @return 0 on success, -1 on error
+  */
+int metrics_write_prom(const char *path, const tetrapol_metrics_t *metrics);
@@ -1,10 +1,41 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define ARRAY_LEN(a) (sizeof(a) / sizeof(a[0]))
 #define SIZEOF(s, i) (sizeof(((s*)(NULL))->i))
 
+/// Default state of rand_next() used when no seed is configured.
+#define SEED_DEFAULT 0x7e7a9011
+
+/// Deterministic pseudo-random generator (xorshift32), state must not be 0.
+static inline uint32_t rand_next(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+/// Uniformly distributed number from interval [0, 1).
+static inline double rand_unit(uint32_t *state)
+{
+    return rand_next(state) / 4294967296.0;
+}
+
+/// Check rate (probability or events per second) is in range [0, max].
+static inline bool rate_is_valid(double rate, double max)
+{
+    return rate >= 0 && rate <= max;
+}
+
+/// Write bytes as lower case hex into str (2*n chars), no terminating null.
+void hex_encode(char *str, const uint8_t *bytes, int n);
+
 char *sprint_hex(char *str, const uint8_t *bytes, int n);
 
 /// Dump bytes as hex with no spaces inserted in output stream.
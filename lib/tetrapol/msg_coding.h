@@ -1,5 +1,7 @@
 #pragma once
 
+#include <tetrapol/arena.h>
+
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -486,4 +488,9 @@ enum {
 bool address_decode(address_t *address, const uint8_t **data_ptr);
 void address_print(const address_t *address);
 
-int address_list_decode(address_list_t **ptr_addrs, const uint8_t *data);
+/**
+  Decode address and append it into list, list is allocated from arena
+  (or heap when arena is NULL).
+  */
+int address_list_decode(arena_t *arena, address_list_t **ptr_addrs,
+        const uint8_t *data);
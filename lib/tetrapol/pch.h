@@ -13,3 +13,6 @@ void pch_destroy(pch_t *pch);
 void pch_reset(pch_t *pch);
 bool pch_push_frame(pch_t *pch, const frame_t* fr);
 void pch_print(pch_t *pch);
+
+void pch_save(const pch_t *pch, snapshot_t *snap);
+bool pch_load(pch_t *pch, snapshot_t *snap);
@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
 #include <tetrapol/tetrapol.h>
 
 #define PHYS_CH_SCR_DETECT -1
@@ -39,3 +41,59 @@ void tetrapol_phys_ch_set_scr_confidence(phys_ch_t *phys_ch, int scr_confidence)
 */
 int tetrapol_phys_ch_recv(phys_ch_t *phys_ch, uint8_t *buf, int len);
 
+/**
+  Restore frame synchronization at position rx_offs of input stream, e.g.
+  from index of recording (see tetrapol/recording.h). Buffered data are
+  dropped, data passed to following tetrapol_phys_ch_recv() must start at
+  rx_offs with frame synchronization sequence. Virtual time of timers
+  continues from the current position, skipped data do not expire them.
+
+  @param frame_no frame number or FRAME_NO_UNKNOWN
+  @param scr SCR or PHYS_CH_SCR_DETECT to keep current SCR
+  */
+void tetrapol_phys_ch_seek(phys_ch_t *phys_ch, uint64_t rx_offs,
+        int frame_no, int scr);
+
+/**
+  @return position in input stream just behind the last bit passed into
+    tetrapol_phys_ch_recv(), i.e. number of bits received so far
+  */
+uint64_t tetrapol_phys_ch_get_in_offs(phys_ch_t *phys_ch);
+
+/**
+  Report data lost before position rx_offs of input stream, e.g. when
+  decoding of live input continues after restart from snapshot (see
+  tetrapol/snapshot.h). Buffered data are dropped, frame synchronization is
+  lost, timers are advanced to rx_offs and expire as usual.
+  */
+void tetrapol_phys_ch_rx_gap(phys_ch_t *phys_ch, uint64_t rx_offs);
+
+/**
+  Replay decoded frame, skips frame synchronization, SCR detection and frame
+  decoding. Position in input stream and frame number are taken from capture
+  (see tetrapol/capture.h), timers are advanced accordingly.
+
+  @param scr SCR used for decoding of frame
+  @param rx_offs position of frame in input stream, must not go backward
+  @param frame_no frame number or FRAME_NO_UNKNOWN
+  */
+void tetrapol_phys_ch_replay_frame(phys_ch_t *phys_ch, const frame_t *fr,
+        int scr, uint64_t rx_offs, int frame_no);
+
+/**
+  Replay HDLC frame with valid FCS, skips also data frame reassembly.
+
+  @param log_ch LOG_CH_BCH or LOG_CH_SDCH for control channel, ignored for
+    traffic channel where frame is passed to SCH
+
+  @return 0 on success, -1 on error
+  */
+int tetrapol_phys_ch_replay_hdlc(phys_ch_t *phys_ch, int log_ch,
+        const hdlc_frame_t *hdlc_fr, uint64_t rx_offs, int frame_no);
+
+/**
+  Replay gain or loss of frame synchronization.
+  */
+void tetrapol_phys_ch_replay_sync(phys_ch_t *phys_ch, bool has_sync,
+        uint64_t rx_offs);
+
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+  Pool of fixed size objects. Objects are carved from slabs allocated in
+  bulk, released objects are kept on free list and reused by next
+  allocation. Memory returns to heap only when pool is destroyed, so steady
+  state decoding does not hit malloc at all.
+  */
+typedef struct pool_priv_t pool_t;
+
+typedef struct {
+    const char *name;
+    size_t obj_size;    ///< size of object including alignment padding
+    uint64_t nallocs;   ///< pool_alloc() calls
+    uint64_t nfrees;    ///< pool_free() calls
+    uint64_t in_use;    ///< objects currently held by pool users
+    uint64_t peak;      ///< maximal value of in_use
+    uint64_t nslabs;    ///< slabs allocated from heap
+    uint64_t bytes;     ///< heap memory held by pool
+} pool_stats_t;
+
+/**
+  @param name Static string used for reporting.
+  @param obj_size Size of single object.
+  */
+pool_t *pool_create(const char *name, size_t obj_size);
+
+/**
+  Destroy pool and all its slabs. All allocated objects must be returned
+  into pool first.
+  */
+void pool_destroy(pool_t *pool);
+
+/**
+  @return pointer to uninitialized object or NULL if allocation fails.
+  */
+void *pool_alloc(pool_t *pool);
+
+/**
+  Return object into pool, NULL is ignored.
+  */
+void pool_free(pool_t *pool, void *obj);
+
+void pool_get_stats(const pool_t *pool, pool_stats_t *stats);
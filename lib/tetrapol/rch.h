@@ -10,3 +10,6 @@ rch_t *rch_create(tpol_t *tpol);
 void rch_destroy(rch_t *rch);
 bool rch_push_frame(rch_t *rch, const frame_t *fr);
 void rch_print(const rch_t *rch);
+
+void rch_save(const rch_t *rch, snapshot_t *snap);
+bool rch_load(rch_t *rch, snapshot_t *snap);
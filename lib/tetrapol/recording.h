@@ -0,0 +1,138 @@
+#pragma once
+
+#include <tetrapol/msg_coding.h>
+#include <tetrapol/tetrapol.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+  Recording of demodulated channel with header and sparse index of frame
+  synchronization positions, allows to start decoding anywhere in long
+  recording without decoding it from the start.
+
+  Index is built from events of decoder while the recording is written, it
+  contains position of frame synchronization with frame number, SCR and cell
+  ID. Entry is added after synchronization is found, when SCR changes, for
+  every BCH frame (frame_no 0 and 100) and every RECORDING_IDX_INTERVAL
+  frames when frame number is unknown. Index requires all events, recording
+  can not be written from decoder with event filter (tetrapol_set_filter()).
+
+  All integers are little endian.
+
+  File header (64 B):
+    char magic[4]       "TPRC"
+    uint8_t version     RECORDING_VERSION
+    uint8_t sample_fmt  RECORDING_FMT_*
+    uint8_t band        as in tetrapol_cfg_t
+    uint8_t dir
+    uint8_t radio_ch_type
+    uint8_t reserved[7]
+    uint64_t freq       carrier frequency (Hz), 0 when unknown
+    uint64_t start_time
+    uint64_t nbits      number of samples
+    uint64_t index_offs file offset of index, 0 when recording is not
+                        finished, samples continue up to the end of file
+    uint32_t nindex     number of index entries
+    uint8_t reserved[12]
+
+  Samples follow the header, RECORDING_FMT_BITS is one bit per byte as in
+  .bits files.
+
+  Index entry (16 B):
+    uint64_t rx_offs    position of frame (synchronization sequence)
+    uint8_t frame_no    RECORDING_FRAME_NO_UNKNOWN when unknown
+    uint8_t scr         RECORDING_SCR_UNKNOWN when unknown
+    uint8_t flags       RECORDING_IDX_CELL_ID when cell ID is valid
+    uint8_t bs_id
+    uint8_t rsw_id
+    uint8_t reserved[3]
+  */
+
+enum {
+    RECORDING_VERSION = 1,
+    RECORDING_HDR_LEN = 64,
+    RECORDING_IDX_LEN = 16,
+    RECORDING_FMT_BITS = 1,
+    RECORDING_FRAME_NO_UNKNOWN = 0xff,
+    RECORDING_SCR_UNKNOWN = 0xff,
+    RECORDING_IDX_CELL_ID = 0x01,
+    RECORDING_IDX_INTERVAL = 100,   ///< frames between entries without frame_no
+};
+
+typedef struct {
+    int sample_fmt;     ///< RECORDING_FMT_*
+    tetrapol_cfg_t cfg; ///< band, dir, radio_ch_type and start_time
+    uint64_t freq;
+    uint64_t nbits;
+    uint64_t index_offs;
+    uint32_t nindex;
+} recording_hdr_t;
+
+typedef struct {
+    uint64_t rx_offs;
+    int frame_no;       ///< FRAME_NO_UNKNOWN when unknown
+    int scr;            ///< PHYS_CH_SCR_DETECT when unknown
+    bool has_cell_id;
+    cell_id_t cell_id;
+} recording_idx_t;
+
+typedef struct recording_writer_priv_t recording_writer_t;
+
+/**
+  Create writer and subscribe it for events of tetrapol, all samples passed
+  into decoder must be written by recording_writer_write(). Header is
+  written immediately and updated when writer is destroyed.
+
+  @param f Seekable file.
+  @param freq Carrier frequency (Hz), 0 when unknown.
+
+  @return new writer or NULL on error or when tetrapol has filter set
+  */
+recording_writer_t *recording_writer_create(FILE *f, uint64_t freq,
+        tetrapol_t *tetrapol);
+
+/**
+  Append samples, one bit per byte.
+
+  @return 0 on success, -1 on error
+  */
+int recording_writer_write(recording_writer_t *rw, const uint8_t *bits,
+        int len);
+
+/**
+  Unsubscribe writer, write index and final header and destroy writer.
+  File is flushed but not closed.
+
+  @return 0 on success, -1 when any write failed
+  */
+int recording_writer_destroy(recording_writer_t *rw);
+
+/**
+  Read header of recording from start of file. Only regular files are
+  probed, any other file (pipe, FIFO, ...) is not read and is reported as
+  not a recording. When file is not a recording, file offset is restored to
+  the start.
+
+  @return 1 when header was read, 0 when file is not a recording, -1 on error
+  */
+int recording_read_hdr(int fd, recording_hdr_t *hdr);
+
+/**
+  Read index of recording.
+
+  @param idx Array of entries allocated by malloc(), caller should free it.
+
+  @return number of entries or -1 on error
+  */
+int recording_read_index(int fd, const recording_hdr_t *hdr,
+        recording_idx_t **idx);
+
+/**
+  Find the last entry at or before position rx_offs.
+
+  @return index entry or NULL when there is no such entry
+  */
+const recording_idx_t *recording_find(const recording_idx_t *idx, int nidx,
+        uint64_t rx_offs);
@@ -1,8 +1,8 @@
 #pragma once
 
 #include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
 #include <tetrapol/tetrapol_int.h>
-#include <tetrapol/tp_timer.h>
 
 #include <stdbool.h>
 
@@ -11,4 +11,17 @@ typedef struct sdch_priv_t sdch_t;
 sdch_t *sdch_create(tpol_t *tpol);
 void sdch_destroy(sdch_t *sdch);
 bool sdch_dl_push_data_frame(sdch_t *sdch, const frame_t *fr);
-void sdch_tick(time_evt_t *te, void *sdch);
+
+/**
+  Process HDLC frame with valid FCS, skips data frame reassembly.
+  Used for replay of captured HDLC frames.
+  */
+bool sdch_push_hdlc_frame(sdch_t *sdch, const hdlc_frame_t *hdlc_fr);
+
+/**
+  Report RX glitch (lost data) to all terminals on SDCH.
+  */
+void sdch_rx_glitch(sdch_t *sdch);
+
+void sdch_save(const sdch_t *sdch, snapshot_t *snap);
+bool sdch_load(sdch_t *sdch, snapshot_t *snap);
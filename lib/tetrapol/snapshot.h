@@ -0,0 +1,59 @@
+#pragma once
+
+#include <tetrapol/phys_ch.h>
+
+#include <stdio.h>
+
+/**
+  Snapshot of the whole decoder state (phys_ch and tetrapol instance) which
+  allows to restart decoding without loss of frame synchronization, SCR,
+  frame number, link sequence numbers, TPDU connections and partially
+  reassembled segments.
+
+  Snapshot is bound to channel configuration (band, direction and channel
+  type) and to layout of this version of library, snapshot with other
+  version is rejected. Event subscribers, filter and SCR confidence are not
+  part of snapshot, start time and counters (stats, metrics) are.
+
+  All integers are little endian.
+
+  File header (16 B):
+    char magic[4]       "TPSN"
+    uint8_t version     SNAPSHOT_VERSION
+    uint8_t reserved[3]
+    uint32_t len        length of state
+    uint32_t checksum   FNV-1a of state
+
+  State follows the header, it is serialized by modules which own it in
+  order: channel configuration (band, direction, channel type), timer,
+  phys_ch (synchronization, SCR detection and unprocessed input), CCH (BCH,
+  PCH, RCH, SDCH) or TCH (SCH, VCH), tetrapol instance (position, frame
+  number, counters). Each SDCH holds data frame reassembly state and
+  terminals in LRU order with their link, TPDU connections and segmented
+  DUs.
+  */
+
+enum {
+    SNAPSHOT_VERSION = 1,
+    SNAPSHOT_HDR_LEN = 16,
+};
+
+/**
+  Write snapshot of decoder state into f. Snapshot should be taken between
+  calls of tetrapol_phys_ch_process(), input data passed into phys_ch and
+  not processed yet are included.
+
+  @return 0 on success, -1 on error
+  */
+int tetrapol_snapshot_save(phys_ch_t *phys_ch, FILE *f);
+
+/**
+  Load decoder state from snapshot. phys_ch must be freshly created, for
+  tetrapol instance with the same band, direction and channel type as used
+  for snapshot. No events are reported while state is loaded. Input should
+  continue at position tetrapol_phys_ch_get_in_offs(), use
+  tetrapol_phys_ch_rx_gap() when it does not.
+
+  @return 0 on success, -1 on error, phys_ch should be destroyed then
+  */
+int tetrapol_snapshot_load(phys_ch_t *phys_ch, FILE *f);
@@ -0,0 +1,57 @@
+#pragma once
+
+// Serialization of decoder state, used by *_save() and *_load() of modules
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+  Buffer for snapshot of decoder state. Integers are stored as little
+  endian. Writer appends to buffer growing on demand, reader consumes
+  buffer from pos. Any failure (allocation, read behind end of data or
+  invalid value) sets err, which is checked once at the end.
+  */
+typedef struct {
+    uint8_t *buf;
+    size_t len;     ///< length of data
+    size_t size;    ///< allocated size
+    size_t pos;     ///< read position
+    bool err;
+} snapshot_t;
+
+void snapshot_put_u8(snapshot_t *snap, uint8_t v);
+void snapshot_put_u16(snapshot_t *snap, uint16_t v);
+void snapshot_put_u32(snapshot_t *snap, uint32_t v);
+void snapshot_put_u64(snapshot_t *snap, uint64_t v);
+void snapshot_put_bytes(snapshot_t *snap, const void *data, size_t len);
+
+/// Store array of bits (one bit per byte) packed LSB first.
+void snapshot_put_bits(snapshot_t *snap, const uint8_t *bits, int nbits);
+
+// return 0 and set err when there are not enough data
+uint8_t snapshot_get_u8(snapshot_t *snap);
+uint16_t snapshot_get_u16(snapshot_t *snap);
+uint32_t snapshot_get_u32(snapshot_t *snap);
+uint64_t snapshot_get_u64(snapshot_t *snap);
+void snapshot_get_bytes(snapshot_t *snap, void *data, size_t len);
+void snapshot_get_bits(snapshot_t *snap, uint8_t *bits, int nbits);
+
+/// Mark snapshot as invalid, used by loaders for values out of range.
+void snapshot_invalid(snapshot_t *snap, const char *what);
+
+/**
+  Write file header and data of snapshot, see tetrapol/snapshot.h.
+
+  @return 0 on success, -1 on error
+  */
+int snapshot_write(const snapshot_t *snap, FILE *f);
+
+/**
+  Read and check file header, read data of snapshot into buffer allocated
+  by malloc(), caller should free it.
+
+  @return 0 on success, -1 on error
+  */
+int snapshot_read(snapshot_t *snap, FILE *f);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <tetrapol/frame.h>
+
+#include <stdint.h>
+
+/**
+  Virtual SwMI, generates downlink control channel (CCH) traffic for a cell
+  with population of terminals. Frames follow the default CCH multiplexing
+  expected by cch_push_frame(): BCH with D_SYSTEM_INFO in frames 0-3 of
+  each half of superframe, PCH in frames 98-99, RCH in frames 14, 39, 64, 89
+  and SDCH in all others.
+
+  Each transaction is composed as TSDU -> TPDU -> HDLC -> data frames:
+    - registration: RCH acknowledge, I frames with FCR carrying
+      D_REGISTRATION_ACK and DR
+    - call: paging on PCH, I frames with FCR carrying D_CALL_SETUP,
+      DT with D_CONNECT_DCH and DR
+    - UI data: D_DATAGRAM sent as segmented UI TPDU
+    - CO data: D_DATA_MSG_DOWN sent over connection as segmented DT TPDUs
+
+  Transactions arrive randomly with configured mean rates and are queued for
+  SDCH, when the queue is full the transaction is dropped. Unused SDCH frames
+  are filled with HDLC stuffing frames.
+
+  Population of terminals might grow by swmi_sim_set_nterminals() and churn,
+  leaving terminals are replaced by new ones with addresses not used
+  recently.
+  */
+
+enum {
+    /// RT addresses use y = 1..6, x = 1..0xfff
+    SWMI_SIM_TERMINALS_MAX = 6 * 0xfff,
+};
+
+typedef struct {
+    int nterminals;         ///< number of terminals in cell
+    double reg_rate;        ///< registrations per second
+    double call_rate;       ///< call setups per second
+    double ui_data_rate;    ///< UI datagrams per second
+    double co_data_rate;    ///< connection-oriented data messages per second
+    double churn_rate;      ///< terminals replaced by new ones per second
+    int data_len;           ///< length of data TSDUs, 0 for default
+    uint32_t seed;          ///< 0 for default
+} swmi_sim_cfg_t;
+
+typedef struct {
+    uint64_t frames;        ///< frames generated so far
+    uint64_t hdlc_frames;   ///< HDLC frames sent on SDCH
+    uint64_t stuffing;      ///< stuffing frames sent on SDCH
+    uint64_t pch_blocks;
+    uint64_t rch_blocks;
+    uint64_t pages;         ///< terminal addresses sent on PCH
+    uint64_t acks;          ///< terminal addresses sent on RCH
+    uint64_t dropped;       ///< transactions dropped, SDCH queue full
+    uint64_t churned;       ///< terminals replaced by new ones
+    int queue_len;          ///< HDLC frames waiting for SDCH
+    int nterminals;         ///< terminals currently in cell
+    /// TSDUs completely sent, index is codop
+    uint64_t tsdus[256];
+} swmi_sim_stats_t;
+
+typedef struct swmi_sim_priv_t swmi_sim_t;
+
+swmi_sim_t *swmi_sim_create(const swmi_sim_cfg_t *cfg);
+void swmi_sim_destroy(swmi_sim_t *sim);
+
+/**
+  Generate next data frame, the first one is frame 0 of superframe.
+
+  Frame is not encoded, use frame_encoder_encode() to get channel bits.
+  */
+void swmi_sim_frame(swmi_sim_t *sim, frame_t *fr);
+
+/**
+  Generate next frame and encode it into FRAME_LEN channel bits, one bit per
+  byte, as expected by tetrapol_phys_ch_recv().
+
+  @return 0 on success, -1 when frame encoding failed
+  */
+int swmi_sim_bits(swmi_sim_t *sim, frame_encoder_t *fe, uint8_t *bits);
+
+/// Change number of terminals in cell, return -1 when out of range.
+int swmi_sim_set_nterminals(swmi_sim_t *sim, int nterminals);
+
+void swmi_sim_get_stats(const swmi_sim_t *sim, swmi_sim_stats_t *stats);
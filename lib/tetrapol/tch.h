@@ -1,12 +1,25 @@
 #pragma once
 
 #include <tetrapol/frame.h>
+#include <tetrapol/hdlc_frame.h>
 #include <tetrapol/tetrapol_int.h>
-#include <tetrapol/tp_timer.h>
 
 typedef struct tch_priv_t tch_t;
 
 tch_t *tch_create(tpol_t *tpol);
 void tch_destroy(tch_t *tch);
 int tch_push_frame(tch_t *tch, const frame_t *fr);
-void tch_tick(time_evt_t *te, void *tch);
+
+/**
+  Process HDLC frame with valid FCS received on SCH, skips data frame
+  reassembly.
+  */
+int tch_push_hdlc_frame(tch_t *tch, const hdlc_frame_t *hdlc_fr);
+
+/**
+  Report RX glitch (lost data) to TCH.
+  */
+void tch_rx_glitch(tch_t *tch);
+
+void tch_save(const tch_t *tch, snapshot_t *snap);
+bool tch_load(tch_t *tch, snapshot_t *snap);
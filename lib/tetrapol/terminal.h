@@ -2,11 +2,18 @@
 
 #include <tetrapol/addr.h>
 #include <tetrapol/hdlc_frame.h>
-#include <tetrapol/tp_timer.h>
+#include <tetrapol/snapshot_int.h>
 #include <tetrapol/tetrapol_int.h>
 
 typedef struct terminal_priv_t terminal_t;
 
+/**
+  Create pool for terminals shared by all terminal lists of TETRAPOL
+  instance.
+  */
+bool terminal_pools_create(tpol_t *tpol);
+void terminal_pools_destroy(tpol_t *tpol);
+
 /**
   Push HDLC frame into terminal.
 
@@ -49,14 +56,15 @@ int terminal_list_push_hdlc_frame(terminal_list_t* tlist,
         const hdlc_frame_t *hdlc_fr);
 
 /**
-  Report RX glitch to all terminals.
+  Report RX glitch to all terminals. Terminals are notified lazily when next
+  HDLC frame is pushed into them.
   */
 void terminal_list_rx_glitch(terminal_list_t* tlist);
 
 /**
-  Call periodicaly to expire old sessions.
-  @param tlist list with all terminals.
-  @param te passing time event.
+  Save all terminals with state of their links, LRU order and idle time is
+  kept when loaded.
   */
-void terminal_list_tick(terminal_list_t* tlist, time_evt_t *te);
+void terminal_list_save(const terminal_list_t *tlist, snapshot_t *snap);
+bool terminal_list_load(terminal_list_t *tlist, snapshot_t *snap);
 
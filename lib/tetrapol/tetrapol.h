@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -24,18 +25,241 @@ enum {
     TETRAPOL_RADIO_TCH = 2,
 };
 
+enum {
+    TETRAPOL_BIT_USEC = 125,    ///< duration of single bit (us)
+};
+
+/** Defaults used for zero values in tetrapol_cfg_t. */
+enum {
+    TETRAPOL_TERMINAL_IDLE_TIMEOUT_DEFAULT = 600,
+    TETRAPOL_TERMINALS_MAX_DEFAULT = 10000,
+};
+
 typedef struct {
     uint8_t band;
     uint8_t dir;
     uint8_t radio_ch_type;
+    /// seconds without any HDLC frame after which terminal state is dropped
+    uint32_t terminal_idle_timeout;
+    /// max. number of tracked terminals per channel, least recently used
+    /// terminal is dropped when limit is reached
+    uint32_t terminals_max;
+    /// reception time of the first bit of input stream (us since epoch),
+    /// time of events is derived from position in stream
+    uint64_t start_time;
 } tetrapol_cfg_t;
 
+typedef struct {
+    uint64_t terminals_live;            ///< currently tracked terminals
+    uint64_t terminals_created;
+    uint64_t terminals_evicted_idle;    ///< dropped by idle timeout
+    uint64_t terminals_evicted_lru;     ///< dropped by terminals_max limit
+    uint64_t pool_allocs;   ///< objects allocated from memory pools
+    uint64_t pool_frees;    ///< objects returned into memory pools
+    uint64_t pool_in_use;   ///< objects currently allocated from pools
+    uint64_t pool_slabs;    ///< heap allocations done by memory pools
+    uint64_t pool_bytes;    ///< heap memory held by memory pools
+    uint64_t filtered_log_ch;   ///< events dropped by log_ch_mask
+    uint64_t filtered_codop;    ///< events dropped by codops
+    uint64_t filtered_addr;     ///< events dropped by addr_ranges
+    uint64_t filtered_fr_type;  ///< events dropped by fr_type_mask
+} tetrapol_stats_t;
+
+enum {
+    TETRAPOL_HIST_BUCKETS = 16,
+    TETRAPOL_FR_TYPES = 7,      ///< number of FRAME_TYPE_* values
+};
+
+/**
+  Histogram, bucket i counts values <= 2^i not counted by lower buckets,
+  the last bucket counts all remaining values.
+  */
+typedef struct {
+    uint64_t buckets[TETRAPOL_HIST_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+} tetrapol_hist_t;
+
+/**
+  Decoder health metrics, all members are uint64_t. Counters are updated
+  only by thread which runs the decoder, using relaxed atomic stores.
+  */
+typedef struct {
+    uint64_t bits;              ///< bits passed to decoder
+    uint64_t sync_gained;
+    uint64_t sync_lost;
+    uint64_t frames[TETRAPOL_FR_TYPES];         ///< by FRAME_TYPE_*
+    uint64_t frames_broken[TETRAPOL_FR_TYPES];  ///< by FRAME_TYPE_*
+    uint64_t syndromes;         ///< sum of frame syndromes
+    uint64_t bits_fixed;        ///< sum of bits fixed by frame decoder
+    tetrapol_hist_t scr_detect; ///< frames required to detect SCR
+    uint64_t data_frame_errs;   ///< multiblock data frames lost by errors
+    uint64_t hdlc_fcs_errs;     ///< HDLC frames with invalid FCS
+    uint64_t hdlc_stuffing;     ///< HDLC stuffing frames
+    uint64_t tpdu_timeouts;     ///< segmented TPDUs lost by T454 expiration
+    uint64_t tsdus[256];        ///< TSDUs by codop
+    uint64_t terminals_live;    ///< currently tracked terminals
+} tetrapol_metrics_t;
+
+enum {
+    TETRAPOL_FILTER_CODOPS_MAX = 32,
+    TETRAPOL_FILTER_ADDR_RANGES_MAX = 16,
+};
+
+/// Address Z.Y.X packed into 16 bits, used for address ranges.
+#define TETRAPOL_ADDR(z, y, x) ((uint16_t)(((z) << 15) | ((y) << 12) | (x)))
+
+typedef struct {
+    uint16_t first;     ///< TETRAPOL_ADDR(), inclusive
+    uint16_t last;      ///< TETRAPOL_ADDR(), inclusive
+} tetrapol_addr_range_t;
+
+/**
+  Event filter, event must pass all criteria which apply to its type. Empty
+  criterion (zero mask or count) passes all events.
+
+  log_ch_mask       HDLC, LSDU, PCH, RCH and TSDU events
+  codops            TSDU events, codop is the first byte of TSDU
+  addr_ranges       HDLC, LSDU and TSDU events
+  fr_type_mask      frame events
+  */
+typedef struct {
+    uint32_t log_ch_mask;   ///< bits (1 << LOG_CH_*) from tetrapol_int.h
+    uint32_t fr_type_mask;  ///< bits (1 << FRAME_TYPE_*) from frame.h
+    int ncodops;
+    uint8_t codops[TETRAPOL_FILTER_CODOPS_MAX];
+    int naddr_ranges;
+    tetrapol_addr_range_t addr_ranges[TETRAPOL_FILTER_ADDR_RANGES_MAX];
+} tetrapol_filter_t;
+
 typedef struct tetrapol_priv_t tetrapol_t;
 
+struct frame_t;
+struct hdlc_frame_t;
+struct tpol_tsdu_t;
+struct tsdu_base_t;
+
+/** Event types, values are used as bits of subscription mask. */
+enum {
+    TETRAPOL_EVT_FRAME          = 0x01, ///< frame decoded (might be broken)
+    TETRAPOL_EVT_SCR            = 0x02, ///< SCR (scrambling constant) changed
+    TETRAPOL_EVT_SYNC           = 0x04, ///< frame sync. gained or lost
+    TETRAPOL_EVT_HDLC           = 0x08, ///< valid HDLC frame received
+    TETRAPOL_EVT_TSDU           = 0x10, ///< TSDU composed by transport layer
+    TETRAPOL_EVT_LSDU           = 0x20, ///< LSDU received in UI_CD or UI_VCH
+    /// same as TETRAPOL_EVT_TSDU, but TSDU is also decoded
+    TETRAPOL_EVT_TSDU_DECODED   = 0x40,
+    TETRAPOL_EVT_PCH            = 0x80, ///< PCH block received
+    TETRAPOL_EVT_RCH            = 0x100,    ///< RCH block received
+    TETRAPOL_EVT_ALL            = 0x1ff,
+    /// unchanged broadcast event, produced by evt_delta, never by library
+    TETRAPOL_EVT_REPEAT         = 0x200,
+};
+
+/**
+  Event reported to subscribers. Event and all data it points to are valid
+  only during callback, structures pointed to are declared in tetrapol/frame.h,
+  tetrapol/hdlc_frame.h, tetrapol/tetrapol_int.h and tetrapol/tsdu.h.
+  */
+typedef struct {
+    int type;           ///< TETRAPOL_EVT_*, TSDU is always TETRAPOL_EVT_TSDU
+    uint64_t rx_offs;   ///< position in input stream (bits)
+    uint64_t rx_time;   ///< start_time + rx_offs * TETRAPOL_BIT_USEC
+    int frame_no;       ///< frame number in superframe, -1 when unknown
+    union {
+        struct {
+            const struct frame_t *fr;
+        } frame;
+        struct {
+            int scr;
+        } scr;
+        struct {
+            bool has_sync;
+        } sync;
+        struct {
+            int log_ch;
+            const struct hdlc_frame_t *hdlc_fr;
+        } hdlc;
+        struct {
+            /// raw TSDU data with transport layer parameters
+            const struct tpol_tsdu_t *tsdu;
+            /// decoded TSDU for TETRAPOL_EVT_TSDU_DECODED subscribers,
+            /// NULL otherwise or when decoding fails
+            const struct tsdu_base_t *decoded;
+        } tsdu;
+        struct {
+            int log_ch;
+            const struct hdlc_frame_t *hdlc_fr;   ///< LSDU is in data
+        } lsdu;
+        struct {
+            /// activation bitmap (8 B) followed by 4 paged addresses (8 B)
+            const uint8_t *data;
+            int len;
+        } pch;
+        struct {
+            /// 3 acknowledged addresses followed by FCS (8 B)
+            const uint8_t *data;
+            int len;
+        } rch;
+        struct {
+            int log_ch;     ///< LOG_CH_BCH, LOG_CH_PCH or LOG_CH_RCH
+        } repeat;
+    };
+} tetrapol_evt_t;
+
+typedef void (*tetrapol_evt_cb_t)(const tetrapol_evt_t *evt, void *ptr);
+
 tetrapol_t *tetrapol_create(const tetrapol_cfg_t *cfg);
 void tetrapol_destroy(tetrapol_t *tetrapol);
 const tetrapol_cfg_t *tetrapol_get_cfg(tetrapol_t *tetrapol);
 
+/**
+  Get snapshot of instance counters.
+  */
+void tetrapol_get_stats(tetrapol_t *tetrapol, tetrapol_stats_t *stats);
+
+/**
+  Get snapshot of metrics, might be called from other than decoding thread.
+  Each value is read atomically, but snapshot as a whole is not consistent.
+  */
+void tetrapol_get_metrics(tetrapol_t *tetrapol, tetrapol_metrics_t *metrics);
+
+/**
+  Subscribe for events, work required only for events without subscribers
+  is skipped. Subscribing again with the same func and ptr changes the mask.
+  Must not be called from event callback.
+
+  @param mask Combination of TETRAPOL_EVT_* values.
+
+  @return true on success, false on failure
+  */
+bool tetrapol_subscribe(tetrapol_t *tetrapol, int mask,
+        tetrapol_evt_cb_t func, void *ptr);
+
+/**
+  Unsubscribe from events, might be called from event callback (for any
+  subscriber), remaining subscribers still get the event being delivered.
+  */
+void tetrapol_unsubscribe(tetrapol_t *tetrapol,
+        tetrapol_evt_cb_t func, void *ptr);
+
+/**
+  Set filter applied to events of all subscribers. Filter is evaluated
+  before the event is created, filtered TSDUs are not decoded. Number of
+  filtered events is reported in tetrapol_stats_t.
+
+  Capture and recording writers need all events, they can not be created
+  while filter is set and filter must not be set while they exist.
+
+  @param filter Filter is copied, NULL removes filter.
+
+  @return true on success, false when filter is invalid
+  */
+bool tetrapol_set_filter(tetrapol_t *tetrapol, const tetrapol_filter_t *filter);
+
+/// Return true when filter which drops some events is set.
+bool tetrapol_has_filter(tetrapol_t *tetrapol);
+
 #ifdef __cplusplus
 }
 #endif
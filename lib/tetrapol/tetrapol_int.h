@@ -3,7 +3,11 @@
 // Internal library functions of tetrapol.c
 
 #include <tetrapol/addr.h>
+#include <tetrapol/arena.h>
+#include <tetrapol/pool.h>
+#include <tetrapol/snapshot_int.h>
 #include <tetrapol/tetrapol.h>
+#include <tetrapol/tp_timer.h>
 
 enum {
     FRAME_NO_UNKNOWN = -1,
@@ -29,18 +33,81 @@ enum {
     TSAP_REF_UNKNOWN = -1,
 };
 
+typedef struct {
+    int mask;       ///< TETRAPOL_EVT_* bits
+    tetrapol_evt_cb_t func;
+    void *ptr;
+} tpol_subscriber_t;
+
 typedef struct {
     tetrapol_cfg_t cfg;
     uint64_t rx_offs;
     int frame_no;
+    tp_timer_t *tp_timer;
+    tetrapol_stats_t stats;
+    tetrapol_metrics_t metrics;     ///< update by metric_*() only
+    // per-instance object pools, see *_pools_create()
+    pool_t *terminal_pool;
+    pool_t *link_pool;
+    pool_t *tpdu_pool;
+    pool_t *tpdu_ui_pool;
+    pool_t *segbuf_pool;    ///< TPDU reassembly buffers
+    pool_t *seg_du_pool;    ///< TPDU DU reassembly buffers
+    arena_t tsdu_arena;     ///< scratch memory for TSDU decoded in events
+    bool has_filter;
+    tetrapol_filter_t filter;
+    int evt_mask;           ///< union of all subscriber masks
+    int nsubscribers;
+    tpol_subscriber_t *subscribers;
+    int emit_idx;           ///< subscriber being called, -1 when none
 } tpol_t;
 
+/**
+  Get time of reception of the last bit processed (us since epoch), time is
+  derived from position in the input stream, not from the wall clock.
+  */
+static inline uint64_t tetrapol_rx_time(const tpol_t *tpol)
+{
+    return tpol->cfg.start_time + tpol->rx_offs * TETRAPOL_BIT_USEC;
+}
+
+/**
+  Add to metric. Only decoding thread writes metrics, load and store are
+  atomic to allow readers in other threads, but not locked as increment.
+  */
+static inline void metric_add(uint64_t *metric, uint64_t n)
+{
+    __atomic_store_n(metric, __atomic_load_n(metric, __ATOMIC_RELAXED) + n,
+            __ATOMIC_RELAXED);
+}
+
+static inline void metric_inc(uint64_t *metric)
+{
+    metric_add(metric, 1);
+}
+
+static inline void metric_sub(uint64_t *metric, uint64_t n)
+{
+    metric_add(metric, -n);
+}
+
+static inline void metric_hist_add(tetrapol_hist_t *hist, uint64_t val)
+{
+    int i = 0;
+    while (i < TETRAPOL_HIST_BUCKETS - 1 && val > (1ull << i)) {
+        ++i;
+    }
+    metric_inc(&hist->buckets[i]);
+    metric_inc(&hist->count);
+    metric_add(&hist->sum, val);
+}
+
 enum {
     TPDU_TYPE_TPDU,
     TPDU_TYPE_TPDU_UI,
 };
 
-typedef struct {
+typedef struct tpol_tsdu_t {
     int log_ch;
     addr_t addr;
     uint8_t tpdu_type;
@@ -53,4 +120,34 @@ typedef struct {
 } tpol_tsdu_t;
 
 tpol_t *tetrapol_get_tpol(tetrapol_t *tetrapol);
+
+/**
+  Check if any subscriber is interested in events. Used to skip work
+  required only for event generation.
+
+  @param mask TETRAPOL_EVT_* bits
+  */
+static inline bool tetrapol_evt_enabled(const tpol_t *tpol, int mask)
+{
+    return tpol->evt_mask & mask;
+}
+
+// Report events to subscribers, see tetrapol_evt_t for description.
+void tetrapol_evt_frame(tpol_t *tpol, const struct frame_t *fr);
+void tetrapol_evt_scr(tpol_t *tpol, int scr);
+void tetrapol_evt_sync(tpol_t *tpol, bool has_sync);
+void tetrapol_evt_hdlc(tpol_t *tpol, int log_ch,
+        const struct hdlc_frame_t *hdlc_fr);
+void tetrapol_evt_lsdu(tpol_t *tpol, int log_ch,
+        const struct hdlc_frame_t *hdlc_fr);
 void tetrapol_evt_tsdu(tpol_t *tpol, const tpol_tsdu_t *tpol_tsdu);
+void tetrapol_evt_pch(tpol_t *tpol, const uint8_t *data, int len);
+void tetrapol_evt_rch(tpol_t *tpol, const uint8_t *data, int len);
+
+/**
+  Save position in input stream, frame number, start time and counters.
+  Loaded stats and metrics replace current values, except of number of
+  live terminals which is given by terminals already loaded.
+  */
+void tetrapol_state_save(const tpol_t *tpol, snapshot_t *snap);
+bool tetrapol_state_load(tpol_t *tpol, snapshot_t *snap);
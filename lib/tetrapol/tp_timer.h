@@ -1,6 +1,10 @@
 #pragma once
 
+#include <tetrapol/snapshot_int.h>
+
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/time.h>
 
 typedef struct {
@@ -11,12 +15,78 @@ typedef struct tp_timer_priv_t tp_timer_t;
 
 typedef void (*timer_callback_t)(time_evt_t *te, void *ptr);
 
+/**
+  Timer entry, should be embedded into structure which owns the deadline.
+  Members are private to tp_timer, use tp_timer_entry_init() to initialize.
+  */
+typedef struct tp_timer_entry_t {
+    struct tp_timer_entry_t *next;
+    struct tp_timer_entry_t **pprev;    ///< NULL when entry is not armed
+    uint64_t expires;                   ///< deadline in timer ticks
+    timer_callback_t func;
+    void *ptr;
+} tp_timer_entry_t;
+
 tp_timer_t *tp_timer_create(void);
 void tp_timer_destroy(tp_timer_t *timer);
+
+/**
+  Advance virtual time, fire expired timer entries and call all registered
+  callbacks.
+
+  Time is virtual, phys_ch derives it from position in input stream, so
+  timeouts do not depend on speed of processing.
+
+  @param rx_glitch Signalize some data were lost since last tick.
+  @param usec Time elapsed since last tick.
+  */
 void tp_timer_tick(tp_timer_t *timer, bool rx_glitch, int usec);
+
+/**
+  Register callback called on each tick. Prefer tp_timer_arm() for deadlines.
+  */
 bool tp_timer_register(tp_timer_t *timer, timer_callback_t timer_func, void *ptr);
 void tp_timer_cancel(tp_timer_t *timer, timer_callback_t timer_func, void *ptr);
 
+/**
+  @return virtual time elapsed since timer creation (us)
+  */
+uint64_t tp_timer_now(const tp_timer_t *timer);
+
+void tp_timer_entry_init(tp_timer_entry_t *entry, timer_callback_t func, void *ptr);
+
+/**
+  Arm timer entry to expire after usec of virtual time. Entry which is already
+  armed is rescheduled. Callback is called from tp_timer_tick(), the entry
+  is disarmed before callback is called so it might be armed again.
+  */
+void tp_timer_arm(tp_timer_t *timer, tp_timer_entry_t *entry, uint64_t usec);
+
+/**
+  Disarm timer entry, it is safe to disarm entry which is not armed.
+  */
+void tp_timer_disarm(tp_timer_entry_t *entry);
+
+static inline bool tp_timer_is_armed(const tp_timer_entry_t *entry)
+{
+    return entry->pprev != NULL;
+}
+
+/**
+  @return virtual time remaining until armed entry expires (us), arming
+    entry again with this value keeps its deadline
+  */
+uint64_t tp_timer_remaining(const tp_timer_t *timer,
+        const tp_timer_entry_t *entry);
+
+void tp_timer_save(const tp_timer_t *timer, snapshot_t *snap);
+
+/**
+  Restore virtual time, no entry can be armed, entries owned by other
+  modules are armed again when they are loaded.
+  */
+bool tp_timer_load(tp_timer_t *timer, snapshot_t *snap);
+
 /**
  * @brief time_delta Compute difference in two timestamps (us)
  * @param tv1
@@ -2,9 +2,9 @@
 
 #include <tetrapol/hdlc_frame.h>
 #include <tetrapol/data_frame.h>
+#include <tetrapol/snapshot_int.h>
 #include <tetrapol/tetrapol_int.h>
 #include <tetrapol/tsdu.h>
-#include <tetrapol/tp_timer.h>
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -12,6 +12,13 @@
 typedef struct tpdu_priv_t tpdu_t;
 typedef struct tpdu_priv_ui_t tpdu_ui_t;
 
+/**
+  Create pools for TPDU objects and reassembly buffers shared by all
+  terminals of TETRAPOL instance.
+  */
+bool tpdu_pools_create(tpol_t *tpol);
+void tpdu_pools_destroy(tpol_t *tpol);
+
 tpdu_t *tpdu_create(tpol_t *tpol, int log_ch);
 int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr);
 
@@ -23,7 +30,10 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr);
 void tpdu_rx_glitch(tpdu_t *tpdu);
 
 void tpdu_destroy(tpdu_t *tpdu);
-void tpdu_du_tick(time_evt_t *te, void *tpdu_du);
+
+/** Save state of connections including partially received TSDUs. */
+void tpdu_save(const tpdu_t *tpdu, snapshot_t *snap);
+bool tpdu_load(tpdu_t *tpdu, snapshot_t *snap);
 
 tpdu_ui_t *tpdu_ui_create(tpol_t *tpol, frame_type_t fr_type, int log_ch);
 void tpdu_ui_destroy(tpdu_ui_t *tpdu);
@@ -44,8 +54,17 @@ int tpdu_ui_push_hdlc_frame(tpdu_ui_t *tpdu, const hdlc_frame_t *hdlc_fr, tsdu_t
  * Process HDLC frame, does not allow segmented frames.
  * @param tpdu
  * @param hdlc_fr
+ * @param arena TSDU is decoded into this arena, heap is used when NULL.
  * @param tsdu Set to pointer to decoded TSDU if available, NULL otherwise.
  *
  * @return 0 on sucess, -1 on error
  */
-int tpdu_ui_push_hdlc_frame2(tpdu_ui_t *tpdu, const hdlc_frame_t *hdlc_fr, tsdu_t **tsdu);
+int tpdu_ui_push_hdlc_frame2(tpdu_ui_t *tpdu, const hdlc_frame_t *hdlc_fr,
+        arena_t *arena, tsdu_t **tsdu);
+
+/**
+  Save segmented DUs waiting for missing segments, T454 continues with
+  remaining time when loaded.
+  */
+void tpdu_ui_save(const tpdu_ui_t *tpdu, snapshot_t *snap);
+bool tpdu_ui_load(tpdu_ui_t *tpdu, snapshot_t *snap);
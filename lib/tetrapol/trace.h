@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+  Trace points for profiling of decoding stages.
+
+  Trace points are always compiled in, but cost only a test of trace_enabled
+  until trace_start() is called. Begin and end of each stage is recorded with
+  TSC timestamp into ring buffer, the oldest records are overwritten. Trace
+  is global, it supports single decoding thread only.
+
+  Latency from reception of the last bit of TSDU (tetrapol_phys_ch_recv())
+  to emission of TSDU event is measured as well.
+  */
+
+enum {
+    TRACE_SYNC,             ///< search for frame synchronization
+    TRACE_DETECT_SCR,
+    TRACE_FRAME_DECODE,     ///< frame_decoder_decode()
+    TRACE_DATA_FRAME,       ///< data_frame_push_frame()
+    TRACE_HDLC_PARSE,       ///< hdlc_frame_parse()
+    TRACE_LINK,             ///< link and TPDU layer
+    TRACE_TSDU_DECODE,      ///< tsdu_decode()
+    TRACE_OUTPUT,           ///< event subscribers
+    TRACE_STAGES,
+};
+
+enum {
+    TRACE_EVENTS_DEFAULT = 1024 * 1024,
+};
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+} trace_latency_t;
+
+extern bool trace_enabled;
+
+/// Fallback timestamp (ns) for platforms without TSC.
+uint64_t trace_clock(void);
+
+static inline uint64_t trace_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return trace_clock();
+#endif
+}
+
+/// Record begin ('B') or end ('E') of stage.
+void trace_rec(int stage, char phase);
+
+/**
+  Inform tracer that input up to rx_offs (exclusive) is received now.
+  */
+void trace_rx(uint64_t rx_offs);
+
+/**
+  Record emission of TSDU, rx_offs is position of its last bit.
+  */
+void trace_tsdu(uint64_t rx_offs);
+
+#define TRACE_BEGIN(stage) \
+    do { if (trace_enabled) trace_rec((stage), 'B'); } while (0)
+
+#define TRACE_END(stage) \
+    do { if (trace_enabled) trace_rec((stage), 'E'); } while (0)
+
+/**
+  Enable tracing.
+
+  @param nevents Capacity of ring buffer.
+
+  @return 0 on success, -1 on error
+  */
+int trace_start(int nevents);
+
+/**
+  Disable tracing and free recorded data.
+  */
+void trace_stop(void);
+
+/**
+  Write recorded events in Chrome trace event format (JSON), the file can
+  be opened in chrome://tracing or Perfetto UI.
+
+  @return 0 on success, -1 on error
+  */
+int trace_write_chrome(const char *path);
+
+void trace_get_latency(trace_latency_t *latency);
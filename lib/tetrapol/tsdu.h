@@ -1,6 +1,7 @@
 #pragma once
 
 #include <tetrapol/addr.h>
+#include <tetrapol/arena.h>
 #include <tetrapol/msg_coding.h>
 
 #include <stdbool.h>
@@ -132,8 +133,9 @@ enum {
 };
 
 // do not use directly, this struct must be first member of each TSDU structure
-typedef struct {
+typedef struct tsdu_base_t {
     codop_t codop;
+    bool in_arena;      ///< decoded into arena, tsdu_destroy() does nothing
     int noptionals;     ///< number of optionals
     /**
       In subclassed TSDU structure, noptionals pointers should be present.
@@ -543,6 +545,9 @@ typedef struct {
 // this might change in future
 typedef tsdu_base_t tsdu_t;
 
+/**
+  Free heap allocated TSDU, does nothing for TSDU decoded into arena.
+  */
 void tsdu_destroy(tsdu_base_t *tsdu);
 
 /**
@@ -555,3 +560,12 @@ void tsdu_destroy(tsdu_base_t *tsdu);
  */
 int tsdu_decode(const uint8_t *data, int len, tsdu_t **tsdu);
 
+/**
+  Same as tsdu_decode() but TSDU and all its members are allocated from
+  arena, no heap allocation is done. TSDU is valid until the arena is reset
+  or rewound below its mark, caller which wants to keep TSDU for longer must
+  own the arena. When arena is NULL heap is used.
+  */
+int tsdu_decode_arena(arena_t *arena, const uint8_t *data, int len,
+        tsdu_t **tsdu);
+
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <tetrapol/json_writer.h>
 #include <tetrapol/tetrapol_int.h>
 
-void tsdu_json(const tpol_t *tpol, const tpol_tsdu_t *tsdu);
-
+/**
+ * Dump TSDU event (TETRAPOL_EVT_TSDU) as a JSON string.
+ */
+void tsdu_json(json_writer_t *jw, const tetrapol_evt_t *evt);
@@ -5,6 +5,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+/**
+  Timer entries are kept in hierarchical timing wheel. Each level has
+  WHEEL_SIZE slots, slot of level N covers WHEEL_SIZE^N ticks. Entries from
+  higher levels are cascaded into lower levels as the time passes, so the cost
+  of tick does not depend on number of armed entries.
+  */
+enum {
+    TICK_USEC = 20000,  ///< timer resolution, duration of single frame
+    WHEEL_BITS = 6,
+    WHEEL_SIZE = 1 << WHEEL_BITS,
+    WHEEL_MASK = WHEEL_SIZE - 1,
+    WHEEL_LEVELS = 4,
+};
+
+#define WHEEL_MAX_DELTA ((UINT64_C(1) << (WHEEL_BITS * WHEEL_LEVELS)) - 1)
+
 typedef struct {
     timer_callback_t func;
     void *ptr;
@@ -14,6 +30,9 @@ struct tp_timer_priv_t {
     int ncallbacks;
     callback_t *callbacks;
     time_evt_t te;
+    uint64_t now;       ///< virtual time (us)
+    uint64_t jiffies;   ///< last processed tick
+    tp_timer_entry_t *wheel[WHEEL_LEVELS][WHEEL_SIZE];
 };
 
 tp_timer_t *tp_timer_create(void)
@@ -35,13 +54,109 @@ void tp_timer_destroy(tp_timer_t *timer)
     free(timer);
 }
 
+static void entry_link(tp_timer_entry_t **head, tp_timer_entry_t *entry)
+{
+    entry->next = *head;
+    if (entry->next) {
+        entry->next->pprev = &entry->next;
+    }
+    entry->pprev = head;
+    *head = entry;
+}
+
+static void entry_unlink(tp_timer_entry_t *entry)
+{
+    *entry->pprev = entry->next;
+    if (entry->next) {
+        entry->next->pprev = entry->pprev;
+    }
+    entry->next = NULL;
+    entry->pprev = NULL;
+}
+
+static void wheel_add(tp_timer_t *timer, tp_timer_entry_t *entry)
+{
+    uint64_t expires = entry->expires;
+    if (expires < timer->jiffies) {
+        expires = timer->jiffies;
+    }
+
+    uint64_t delta = expires - timer->jiffies;
+    if (delta > WHEEL_MAX_DELTA) {
+        // will be cascaded again when the top level slot is reached
+        delta = WHEEL_MAX_DELTA;
+        expires = timer->jiffies + delta;
+    }
+
+    int lvl = 0;
+    while (lvl < WHEEL_LEVELS - 1 &&
+            delta >= (UINT64_C(1) << (WHEEL_BITS * (lvl + 1)))) {
+        ++lvl;
+    }
+
+    const int idx = (expires >> (WHEEL_BITS * lvl)) & WHEEL_MASK;
+    entry_link(&timer->wheel[lvl][idx], entry);
+}
+
+// move entries from slot of higher level into lower levels
+static void wheel_cascade(tp_timer_t *timer, int lvl, int idx)
+{
+    tp_timer_entry_t *entry = timer->wheel[lvl][idx];
+    timer->wheel[lvl][idx] = NULL;
+
+    while (entry) {
+        tp_timer_entry_t *next = entry->next;
+        wheel_add(timer, entry);
+        entry = next;
+    }
+}
+
+static void wheel_run(tp_timer_t *timer)
+{
+    ++timer->jiffies;
+
+    for (int lvl = 1; lvl < WHEEL_LEVELS; ++lvl) {
+        const uint64_t mask = (UINT64_C(1) << (WHEEL_BITS * lvl)) - 1;
+        if (timer->jiffies & mask) {
+            break;
+        }
+        wheel_cascade(timer, lvl,
+                (timer->jiffies >> (WHEEL_BITS * lvl)) & WHEEL_MASK);
+    }
+
+    // callback might arm/disarm any entry, so detach expired entries first
+    tp_timer_entry_t *expired = NULL;
+    tp_timer_entry_t **slot = &timer->wheel[0][timer->jiffies & WHEEL_MASK];
+    if (*slot) {
+        expired = *slot;
+        expired->pprev = &expired;
+        *slot = NULL;
+    }
+
+    while (expired) {
+        tp_timer_entry_t *entry = expired;
+        entry_unlink(entry);
+        if (entry->expires > timer->jiffies) {
+            wheel_add(timer, entry);
+            continue;
+        }
+        entry->func(&timer->te, entry->ptr);
+    }
+}
+
 void tp_timer_tick(tp_timer_t *timer, bool rx_glitch, int usec)
 {
+    timer->now += usec;
     timer->te.tv.tv_usec += usec;
     timer->te.tv.tv_sec += timer->te.tv.tv_usec / 1000000;
     timer->te.tv.tv_usec %= 1000000;
     timer->te.rx_glitch = rx_glitch;
 
+    const uint64_t jiffies = timer->now / TICK_USEC;
+    while (timer->jiffies < jiffies) {
+        wheel_run(timer);
+    }
+
     for (int i = 0; i < timer->ncallbacks; ++i) {
         timer->callbacks[i].func(&timer->te, timer->callbacks[i].ptr);
     }
@@ -85,6 +200,64 @@ void tp_timer_cancel(tp_timer_t *timer, timer_callback_t timer_func, void *ptr)
     LOG(WTF, "callback not found");
 }
 
+uint64_t tp_timer_now(const tp_timer_t *timer)
+{
+    return timer->now;
+}
+
+void tp_timer_entry_init(tp_timer_entry_t *entry, timer_callback_t func, void *ptr)
+{
+    entry->next = NULL;
+    entry->pprev = NULL;
+    entry->expires = 0;
+    entry->func = func;
+    entry->ptr = ptr;
+}
+
+void tp_timer_arm(tp_timer_t *timer, tp_timer_entry_t *entry, uint64_t usec)
+{
+    if (tp_timer_is_armed(entry)) {
+        entry_unlink(entry);
+    }
+
+    entry->expires = (timer->now + usec + TICK_USEC - 1) / TICK_USEC;
+    // current tick is already processed
+    if (entry->expires <= timer->jiffies) {
+        entry->expires = timer->jiffies + 1;
+    }
+    wheel_add(timer, entry);
+}
+
+void tp_timer_disarm(tp_timer_entry_t *entry)
+{
+    if (tp_timer_is_armed(entry)) {
+        entry_unlink(entry);
+    }
+}
+
+uint64_t tp_timer_remaining(const tp_timer_t *timer,
+        const tp_timer_entry_t *entry)
+{
+    const uint64_t expires = entry->expires * TICK_USEC;
+
+    return (expires > timer->now) ? expires - timer->now : 0;
+}
+
+void tp_timer_save(const tp_timer_t *timer, snapshot_t *snap)
+{
+    snapshot_put_u64(snap, timer->now);
+}
+
+bool tp_timer_load(tp_timer_t *timer, snapshot_t *snap)
+{
+    timer->now = snapshot_get_u64(snap);
+    timer->jiffies = timer->now / TICK_USEC;
+    timer->te.tv.tv_sec = timer->now / 1000000;
+    timer->te.tv.tv_usec = timer->now % 1000000;
+
+    return !snap->err;
+}
+
 int timeval_abs_delta(const struct timeval *tv1, const struct timeval *tv2)
 {
     int d = tv2->tv_usec - tv1->tv_usec;
@@ -1,9 +1,9 @@
 #define LOG_PREFIX "tpdu"
 #include <tetrapol/log.h>
 #include <tetrapol/misc.h>
+#include <tetrapol/pool.h>
 #include <tetrapol/tsdu.h>
 #include <tetrapol/tpdu.h>
-#include <tetrapol/misc.h>
 
 #include <stdlib.h>
 #include <string.h>
@@ -21,12 +21,25 @@ enum {
 
 #define TPDU_CODE_PREFIX_MASK (0x18)
 
-typedef struct {
-    struct timeval tv;
+enum {
+    // max. TPDU DU payload carried by single HDLC frame
+    SEG_DU_PAYLOAD_MAX = SIZEOF(hdlc_frame_t, data) - 3,
+    // max. size of TSDU composed from TPDU segments
+    TPDU_SEGBUF_SIZE = 2000,
+};
+
+/// Reassembly buffer, exists only while segmented DU is in flight.
+typedef struct segmented_du_t {
+    struct segmented_du_t *next;
+    tp_timer_entry_t t454;  ///< T454, reassembly timeout
+    struct tpdu_priv_ui_t *tpdu;
+    uint8_t seg_ref;
     uint8_t id_tsap;
     uint8_t prio;
     uint8_t nsegments;  ///< total amount of segments (HDLC frames) in DU
-    hdlc_frame_t *hdlc_frs[SYS_PAR_N452];
+    uint64_t received;  ///< bitmap of received segments
+    uint8_t seg_len[SYS_PAR_N452];
+    uint8_t seg_data[SYS_PAR_N452][SEG_DU_PAYLOAD_MAX];
 } segmented_du_t;
 
 typedef enum {
@@ -37,12 +50,13 @@ typedef enum {
 } connection_state_t;
 
 typedef struct {
-    connection_state_t state;
+    uint8_t state;      ///< connection_state_t
     int8_t tsap_id;
     int8_t tsap_ref_swmi;
     int8_t tsap_ref_rt;
-    int seg_len;
-    uint8_t segbuf[2000];
+    uint16_t seg_len;
+    /// TPDU_SEGBUF_SIZE bytes from tpol_t.segbuf_pool, NULL when not used
+    uint8_t *segbuf;
 } connection_t;
 
 struct tpdu_priv_t {
@@ -55,24 +69,81 @@ struct tpdu_priv_t {
 
 struct tpdu_priv_ui_t {
     frame_type_t fr_type;
-    segmented_du_t *seg_du[128];
+    segmented_du_t *seg_dus;    ///< DUs waiting for missing segments
     int log_ch;
     tpol_t *tpol;
 };
 
-static void connection_reset(connection_t *conn)
+bool tpdu_pools_create(tpol_t *tpol)
 {
-    conn->state = CONNECTION_STATE_NC;
+    tpol->tpdu_pool = pool_create("tpdu", sizeof(tpdu_t));
+    tpol->tpdu_ui_pool = pool_create("tpdu_ui", sizeof(tpdu_ui_t));
+    tpol->segbuf_pool = pool_create("tpdu_segbuf", TPDU_SEGBUF_SIZE);
+    tpol->seg_du_pool = pool_create("tpdu_seg_du", sizeof(segmented_du_t));
+    if (!tpol->tpdu_pool || !tpol->tpdu_ui_pool ||
+            !tpol->segbuf_pool || !tpol->seg_du_pool) {
+        tpdu_pools_destroy(tpol);
+        return false;
+    }
+
+    return true;
+}
+
+void tpdu_pools_destroy(tpol_t *tpol)
+{
+    pool_destroy(tpol->tpdu_pool);
+    pool_destroy(tpol->tpdu_ui_pool);
+    pool_destroy(tpol->segbuf_pool);
+    pool_destroy(tpol->seg_du_pool);
+    tpol->tpdu_pool = NULL;
+    tpol->tpdu_ui_pool = NULL;
+    tpol->segbuf_pool = NULL;
+    tpol->seg_du_pool = NULL;
+}
+
+static void connection_segbuf_release(tpdu_t *tpdu, connection_t *conn)
+{
+    pool_free(tpdu->tpol->segbuf_pool, conn->segbuf);
+    conn->segbuf = NULL;
     conn->seg_len = 0;
 }
 
-static void connection_fcr(connection_t *conn, int tsap_id, int tsap_ref)
+static bool connection_segbuf_append(tpdu_t *tpdu, connection_t *conn,
+        const uint8_t *data, int len)
+{
+    if (len < 0) {
+        LOG(WTF, "Invalid TPDU length %d", len);
+        return false;
+    }
+    if (conn->seg_len + len > TPDU_SEGBUF_SIZE) {
+        LOG(WTF, "Too large TPDU, increase buffer size");
+        return false;
+    }
+    if (!conn->segbuf) {
+        conn->segbuf = pool_alloc(tpdu->tpol->segbuf_pool);
+        if (!conn->segbuf) {
+            return false;
+        }
+    }
+    memcpy(&conn->segbuf[conn->seg_len], data, len);
+    conn->seg_len += len;
+
+    return true;
+}
+
+static void connection_reset(tpdu_t *tpdu, connection_t *conn)
+{
+    conn->state = CONNECTION_STATE_NC;
+    connection_segbuf_release(tpdu, conn);
+}
+
+static void connection_fcr(tpdu_t *tpdu, connection_t *conn, int tsap_id, int tsap_ref)
 {
     LOG(INFO, "FCR TSAP_ref: %d TSAP_id: %d", tsap_ref, tsap_id);
 
     if (conn->state != CONNECTION_STATE_NC) {
         LOG(INFO, "closing existing connection");
-        connection_reset(conn);
+        connection_reset(tpdu, conn);
     }
 
     conn->state = CONNECTION_STATE_CONNECTED;
@@ -81,13 +152,13 @@ static void connection_fcr(connection_t *conn, int tsap_id, int tsap_ref)
     conn->tsap_ref_rt = tsap_ref;
 }
 
-static void connection_cr(connection_t *conn, int tsap_id, int tsap_ref)
+static void connection_cr(tpdu_t *tpdu, connection_t *conn, int tsap_id, int tsap_ref)
 {
     LOG(INFO, "CR TSAP_ref: %d TSAP_id: %d", tsap_ref, tsap_id);
 
     if (conn->state != CONNECTION_STATE_NC) {
         LOG(INFO, "closing existing connection");
-        connection_reset(conn);
+        connection_reset(tpdu, conn);
     }
 
     conn->state = CONNECTION_STATE_CR;
@@ -96,13 +167,13 @@ static void connection_cr(connection_t *conn, int tsap_id, int tsap_ref)
     conn->tsap_ref_rt = TSAP_REF_UNKNOWN;
 }
 
-static void connection_cc(connection_t *conn, int tsap_ref_swmi, int tsap_ref_rt)
+static void connection_cc(tpdu_t *tpdu, connection_t *conn, int tsap_ref_swmi, int tsap_ref_rt)
 {
     LOG(INFO, "CC TSAP_ref_SwMI=%d TSAP_ref_RT=%d", tsap_ref_swmi, tsap_ref_rt);
 
     if (conn->state != CONNECTION_STATE_NC) {
         LOG(INFO, "closing existing connection");
-        connection_reset(conn);
+        connection_reset(tpdu, conn);
     }
 
     conn->state = CONNECTION_STATE_CONNECTED;
@@ -181,16 +252,17 @@ static void connection_broken(connection_t *conn)
 
 tpdu_t *tpdu_create(tpol_t *tpol, int log_ch)
 {
-    tpdu_t *tpdu = calloc(1, sizeof(tpdu_t));
+    tpdu_t *tpdu = pool_alloc(tpol->tpdu_pool);
     if (!tpdu) {
         return NULL;
     }
+    memset(tpdu, 0, sizeof(tpdu_t));
 
-    for (int i = 0; i < ARRAY_LEN(tpdu->conns); ++i) {
-        connection_reset(&tpdu->conns[i]);
-    }
     tpdu->tpol = tpol;
     tpdu->log_ch = log_ch;
+    for (int i = 0; i < ARRAY_LEN(tpdu->conns); ++i) {
+        connection_reset(tpdu, &tpdu->conns[i]);
+    }
 
     return tpdu;
 }
@@ -251,7 +323,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
 
         switch(code_prefix) {
             case TPDU_CODE_CR:
-                connection_cr(conn, dest_ref, par_field);
+                connection_cr(tpdu, conn, dest_ref, par_field);
                 // TODO: decode bs_ref, rt_ref, call_priority
                 payload += 2;
                 payload_len -= 2;
@@ -263,7 +335,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
                 break;
 
             case TPDU_CODE_CC:
-                connection_cc(conn, par_field, dest_ref);
+                connection_cc(tpdu, conn, par_field, dest_ref);
                 if (payload_len != 1) {
                     LOG(WTF, "Invalid CC lenght=%d", payload_len)
                     return -1;
@@ -273,7 +345,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
                 return 0;
 
             case TPDU_CODE_FCR:
-                connection_fcr(conn, dest_ref, par_field);
+                connection_fcr(tpdu, conn, dest_ref, par_field);
                 break;
 
             default:
@@ -288,7 +360,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
             case TPDU_CODE_DC:
                 ret_val = connection_dc_dr_fdr(conn, par_field, dest_ref);
                 if (ret_val == -1) {
-                    connection_reset(conn);
+                    connection_reset(tpdu, conn);
                     return 0;
                 }
                 if (ret_val == -2) {
@@ -309,23 +381,17 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
     }
 
     if (seg) {
-        if (conn->seg_len + payload_len > SIZEOF(connection_t, segbuf)) {
-            LOG(WTF, "Too large TPDU, increase buffer size");
+        if (!connection_segbuf_append(tpdu, conn, payload, payload_len)) {
             return -1;
         }
-        memcpy(&conn->segbuf[conn->seg_len], payload, payload_len);
-        conn->seg_len += payload_len;
         LOG(INFO, "Segmentation part len=%d seg_len=%d dest_ref=%d",
                 payload_len, conn->seg_len, dest_ref);
     } else {
         if (conn->seg_len) {
-            if (conn->seg_len + payload_len > SIZEOF(connection_t, segbuf)) {
-                conn->seg_len = 0;
-                LOG(WTF, "Too large TPDU, increase buffer size");
+            if (!connection_segbuf_append(tpdu, conn, payload, payload_len)) {
+                connection_segbuf_release(tpdu, conn);
                 return -1;
             }
-            memcpy(&conn->segbuf[conn->seg_len], payload, payload_len);
-            conn->seg_len += payload_len;
             LOG(INFO, "Segmentation complete len=%d seg_len=%d dest_ref=%d",
                     payload_len, conn->seg_len, dest_ref);
             // TODO: prio, qos
@@ -335,7 +401,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
             tpol_tsdu.data = conn->segbuf;
             tetrapol_evt_tsdu(tpdu->tpol, &tpol_tsdu);
 
-            conn->seg_len = 0;
+            connection_segbuf_release(tpdu, conn);
         } else {
             if (d) {
                 // TODO: prio, qos
@@ -353,7 +419,7 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
             case TPDU_CODE_DR:
             case TPDU_CODE_FDR:
             case TPDU_CODE_DC:
-                connection_reset(conn);
+                connection_reset(tpdu, conn);
                 break;
 
             case TPDU_CODE_DT:
@@ -368,17 +434,91 @@ int tpdu_push_hdlc_frame(tpdu_t *tpdu, const hdlc_frame_t *hdlc_fr)
     return 0;
 }
 
+void tpdu_save(const tpdu_t *tpdu, snapshot_t *snap)
+{
+    for (int i = 0; i < ARRAY_LEN(tpdu->conns); ++i) {
+        const connection_t *conn = &tpdu->conns[i];
+        snapshot_put_u8(snap, conn->state);
+        snapshot_put_u8(snap, conn->tsap_id);
+        snapshot_put_u8(snap, conn->tsap_ref_swmi);
+        snapshot_put_u8(snap, conn->tsap_ref_rt);
+        snapshot_put_u16(snap, conn->seg_len);
+        snapshot_put_bytes(snap, conn->segbuf, conn->seg_len);
+    }
+}
+
+bool tpdu_load(tpdu_t *tpdu, snapshot_t *snap)
+{
+    for (int i = 0; i < ARRAY_LEN(tpdu->conns); ++i) {
+        connection_t *conn = &tpdu->conns[i];
+        connection_reset(tpdu, conn);
+        conn->state = snapshot_get_u8(snap);
+        conn->tsap_id = (int8_t)snapshot_get_u8(snap);
+        conn->tsap_ref_swmi = (int8_t)snapshot_get_u8(snap);
+        conn->tsap_ref_rt = (int8_t)snapshot_get_u8(snap);
+        const int seg_len = snapshot_get_u16(snap);
+        if (conn->state > CONNECTION_STATE_BROKEN ||
+                seg_len > TPDU_SEGBUF_SIZE) {
+            snapshot_invalid(snap, "TPDU connection");
+            return false;
+        }
+        if (!seg_len) {
+            continue;
+        }
+
+        conn->segbuf = pool_alloc(tpdu->tpol->segbuf_pool);
+        if (!conn->segbuf) {
+            return false;
+        }
+        snapshot_get_bytes(snap, conn->segbuf, seg_len);
+        conn->seg_len = seg_len;
+    }
+
+    return !snap->err;
+}
+
 void tpdu_destroy(tpdu_t *tpdu)
 {
-    free(tpdu);
+    if (!tpdu) {
+        return;
+    }
+
+    for (int i = 0; i < ARRAY_LEN(tpdu->conns); ++i) {
+        connection_segbuf_release(tpdu, &tpdu->conns[i]);
+    }
+    pool_free(tpdu->tpol->tpdu_pool, tpdu);
+}
+
+static segmented_du_t *tpdu_ui_segments_find(tpdu_ui_t *tpdu, uint8_t seg_ref)
+{
+    segmented_du_t *du = tpdu->seg_dus;
+    while (du && du->seg_ref != seg_ref) {
+        du = du->next;
+    }
+
+    return du;
 }
 
-static void tpdu_ui_segments_destroy(segmented_du_t *du)
+static void tpdu_ui_segments_destroy(tpdu_ui_t *tpdu, segmented_du_t *du)
 {
-    for (int i = 0; i < SYS_PAR_N452; ++i) {
-        free(du->hdlc_frs[i]);
+    segmented_du_t **pdu = &tpdu->seg_dus;
+    while (*pdu != du) {
+        pdu = &(*pdu)->next;
     }
-    free(du);
+    *pdu = du->next;
+
+    tp_timer_disarm(&du->t454);
+    pool_free(tpdu->tpol->seg_du_pool, du);
+}
+
+static void tpdu_ui_t454_expired(time_evt_t *te, void *ptr)
+{
+    segmented_du_t *du = ptr;
+
+    // TODO: report error to application layer
+    LOG(INFO, "T454 expired SEGM_REF=%d", du->seg_ref);
+    metric_inc(&du->tpdu->tpol->metrics.tpdu_timeouts);
+    tpdu_ui_segments_destroy(du->tpdu, du);
 }
 
 tpdu_ui_t *tpdu_ui_create(tpol_t *tpol, frame_type_t fr_type, int log_ch)
@@ -388,10 +528,11 @@ tpdu_ui_t *tpdu_ui_create(tpol_t *tpol, frame_type_t fr_type, int log_ch)
         return NULL;
     }
 
-    tpdu_ui_t *tpdu = calloc(1, sizeof(tpdu_ui_t));
+    tpdu_ui_t *tpdu = pool_alloc(tpol->tpdu_ui_pool);
     if (!tpdu) {
         return NULL;
     }
+    tpdu->seg_dus = NULL;
     tpdu->tpol = tpol;
     tpdu->fr_type = fr_type;
     tpdu->log_ch = log_ch;
@@ -401,17 +542,19 @@ tpdu_ui_t *tpdu_ui_create(tpol_t *tpol, frame_type_t fr_type, int log_ch)
 
 void tpdu_ui_destroy(tpdu_ui_t *tpdu)
 {
-    for (int i = 0; i < ARRAY_LEN(tpdu->seg_du); ++i) {
-        if (!tpdu->seg_du[i]) {
-            continue;
-        }
-        tpdu_ui_segments_destroy(tpdu->seg_du[i]);
+    if (!tpdu) {
+        return;
+    }
+
+    while (tpdu->seg_dus) {
+        tpdu_ui_segments_destroy(tpdu, tpdu->seg_dus);
     }
-    free(tpdu);
+    pool_free(tpdu->tpol->tpdu_ui_pool, tpdu);
 }
 
 static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
-        const hdlc_frame_t *hdlc_fr, tsdu_t **tsdu, bool allow_seg)
+        const hdlc_frame_t *hdlc_fr, arena_t *arena, tsdu_t **tsdu,
+        bool allow_seg)
 {
     if (tsdu) {
         *tsdu = NULL;
@@ -449,7 +592,7 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
             tetrapol_evt_tsdu(tpdu->tpol, &tpol_tsdu);
 
             if (tsdu) {
-                return tsdu_decode(hdlc_fr->data + 2, len, tsdu);
+                return tsdu_decode_arena(arena, hdlc_fr->data + 2, len, tsdu);
             }
             return 0;
         }
@@ -461,7 +604,7 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
         tetrapol_evt_tsdu(tpdu->tpol, &tpol_tsdu);
 
         if (tsdu) {
-            return tsdu_decode(hdlc_fr->data + 1, len, tsdu);
+            return tsdu_decode_arena(arena, hdlc_fr->data + 1, len, tsdu);
         }
         return 0;
     }
@@ -496,36 +639,65 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
     }
     LOG(DBG, "UI SEGM_REF=%d, PACKET_NUM=%d", seg_ref, packet_num);
 
-    segmented_du_t *seg_du = tpdu->seg_du[seg_ref];
-    if (seg_du == NULL) {
-        seg_du = calloc(1, sizeof(segmented_du_t));
+    segmented_du_t *seg_du = tpdu_ui_segments_find(tpdu, seg_ref);
+    if (seg_du && (seg_du->received & (UINT64_C(1) << packet_num))) {
+        // segment already recieved
+        return 0;
+    }
+
+    // payload of segment, skip ext headers
+    int n_ext = 1;
+    while (n_ext < hdlc_fr->nbits / 8 &&
+            get_bits(1, hdlc_fr->data + n_ext - 1, 0)) {
+        ++n_ext;
+    }
+    int n = 0;
+    if (tpdu->fr_type == FRAME_TYPE_DATA) {
+        if (seg == 0) {
+            n = hdlc_fr->data[n_ext++];
+            if (n > hdlc_fr->nbits / 8) {
+                LOG(WTF, "hdlc_fr.len=%d < tsdu_payload_len=%d",
+                        hdlc_fr->nbits / 8, n);
+                return -1;
+            }
+        } else {
+            n = (hdlc_fr->nbits / 8) - n_ext;
+        }
+        if (n < 0 || n > SIZEOF(hdlc_frame_t, data) - n_ext) {
+            LOG(WTF, "invalid segment length %d", n);
+            return -1;
+        }
+    } else {    // FRAME_TYPE_HR_DATA
+        LOG(WTF, "FRAME_TYPE_HR_DATA not implemented");
+        // TODO
+    }
+
+    if (!seg_du) {
+        seg_du = pool_alloc(tpdu->tpol->seg_du_pool);
         if (!seg_du) {
             return -1;
         }
-        tpdu->seg_du[seg_ref] = seg_du;
+        tp_timer_entry_init(&seg_du->t454, tpdu_ui_t454_expired, seg_du);
+        seg_du->tpdu = tpdu;
+        seg_du->seg_ref = seg_ref;
         seg_du->id_tsap = id_tsap;
         seg_du->prio = prio;
+        seg_du->nsegments = 0;
+        seg_du->received = 0;
+        seg_du->next = tpdu->seg_dus;
+        tpdu->seg_dus = seg_du;
     }
 
-    if (seg_du->hdlc_frs[packet_num]) {
-        // segment already recieved
-        return 0;
-    }
-
-    seg_du->hdlc_frs[packet_num] = malloc(sizeof(hdlc_frame_t));
-    if (!seg_du->hdlc_frs[packet_num]) {
-        LOG(ERR, "ERR OOM");
-        return -1;
-    }
-    memcpy(seg_du->hdlc_frs[packet_num], hdlc_fr, sizeof(hdlc_frame_t));
+    seg_du->received |= UINT64_C(1) << packet_num;
+    seg_du->seg_len[packet_num] = n;
+    memcpy(seg_du->seg_data[packet_num], &hdlc_fr->data[n_ext], n);
 
     if (seg == 0) {
         seg_du->nsegments = packet_num + 1;
     }
 
     // reset T454 timer
-    seg_du->tv.tv_sec = 0;
-    seg_du->tv.tv_usec = 0;
+    tp_timer_arm(tpdu->tpol->tp_timer, &seg_du->t454, SYS_PAR_T454);
 
     // last segment is still missing
     if (!seg_du->nsegments) {
@@ -533,47 +705,21 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
     }
 
     // check if we have all segments
-    for (int i = 0; i < seg_du->nsegments; ++i) {
-        if (!seg_du->hdlc_frs[i]) {
-            return 0;
-        }
+    const uint64_t all = (seg_du->nsegments == SYS_PAR_N452) ?
+        UINT64_MAX : (UINT64_C(1) << seg_du->nsegments) - 1;
+    if ((seg_du->received & all) != all) {
+        return 0;
     }
 
-    // max_segments * (sizeof(hdlc_frame_t->data) - TPDU_DU_header)
-    uint8_t data[SYS_PAR_N452 * (sizeof(((hdlc_frame_t*)NULL)->data) - 3)];
+    uint8_t data[SYS_PAR_N452 * SEG_DU_PAYLOAD_MAX];
     int data_len = 0;
     // collect data from all segments
-    if (tpdu->fr_type == FRAME_TYPE_DATA) {
-        uint8_t *d = data;
-        for (int i = 0; i < seg_du->nsegments; ++i) {
-            hdlc_frame_t *hfr = seg_du->hdlc_frs[i];
-            int n_ext = 1;
-            // skip ext headers
-            while (get_bits(1, hfr->data + n_ext - 1, 0)) {
-                ++n_ext;
-            }
-            int n;
-            if (i == (seg_du->nsegments - 1)) {
-                n = hfr->data[n_ext++];
-                if (n > hfr->nbits / 8) {
-                    LOG(WTF, "hdlc_fr.len=%d < tsdu_payload_len=%d",
-                            hfr->nbits / 8, n);
-                    return -1;
-                }
-            } else {
-                n = (hfr->nbits / 8) - n_ext;
-            }
-            data_len += n;
-            memcpy(d, &hfr->data[n_ext], n);
-            d += n;
-        }
-    } else {    // FRAME_TYPE_HR_DATA
-        LOG(WTF, "FRAME_TYPE_HR_DATA not implemented");
-        // TODO
+    for (int i = 0; i < seg_du->nsegments; ++i) {
+        memcpy(&data[data_len], seg_du->seg_data[i], seg_du->seg_len[i]);
+        data_len += seg_du->seg_len[i];
     }
 
-    tpdu_ui_segments_destroy(seg_du);
-    tpdu->seg_du[seg_ref] = NULL;
+    tpdu_ui_segments_destroy(tpdu, seg_du);
 
     memcpy(&tpol_tsdu.addr, &hdlc_fr->addr, sizeof(tpol_tsdu.addr));
     tpol_tsdu.data_len = data_len;
@@ -581,7 +727,7 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
     tetrapol_evt_tsdu(tpdu->tpol, &tpol_tsdu);
 
     if (tsdu) {
-        return tsdu_decode(data, data_len, tsdu);
+        return tsdu_decode_arena(arena, data, data_len, tsdu);
     }
     return 0;
 }
@@ -589,13 +735,13 @@ static int tpdu_ui_push_hdlc_frame_(tpdu_ui_t *tpdu,
 int tpdu_ui_push_hdlc_frame(tpdu_ui_t *tpdu, const hdlc_frame_t *hdlc_fr,
         tsdu_t **tsdu)
 {
-    return tpdu_ui_push_hdlc_frame_(tpdu, hdlc_fr, tsdu, true);
+    return tpdu_ui_push_hdlc_frame_(tpdu, hdlc_fr, NULL, tsdu, true);
 }
 
 int tpdu_ui_push_hdlc_frame2(tpdu_ui_t *tpdu, const hdlc_frame_t *hdlc_fr,
-        tsdu_t **tsdu)
+        arena_t *arena, tsdu_t **tsdu)
 {
-    return tpdu_ui_push_hdlc_frame_(tpdu, hdlc_fr, tsdu, false);
+    return tpdu_ui_push_hdlc_frame_(tpdu, hdlc_fr, arena, tsdu, false);
 }
 
 void tpdu_rx_glitch(tpdu_t *tpdu)
@@ -607,28 +753,73 @@ void tpdu_rx_glitch(tpdu_t *tpdu)
     }
 }
 
-void tpdu_du_tick(time_evt_t *te, void *tpdu_du)
+void tpdu_ui_save(const tpdu_ui_t *tpdu, snapshot_t *snap)
 {
-    tpdu_ui_t *tpdu = tpdu_du;
-
-    // set/check T454 timer
-    for (int i = 0; i < ARRAY_LEN(tpdu->seg_du); ++i) {
-        if (!tpdu->seg_du[i]) {
-            continue;
+    int nseg_dus = 0;
+    for (const segmented_du_t *du = tpdu->seg_dus; du; du = du->next) {
+        ++nseg_dus;
+    }
+    snapshot_put_u8(snap, nseg_dus);
+
+    for (const segmented_du_t *du = tpdu->seg_dus; du; du = du->next) {
+        snapshot_put_u8(snap, du->seg_ref);
+        snapshot_put_u8(snap, du->id_tsap);
+        snapshot_put_u8(snap, du->prio);
+        snapshot_put_u8(snap, du->nsegments);
+        snapshot_put_u64(snap, du->received);
+        snapshot_put_u64(snap, tp_timer_remaining(tpdu->tpol->tp_timer,
+                    &du->t454));
+        for (int i = 0; i < SYS_PAR_N452; ++i) {
+            if (du->received & (UINT64_C(1) << i)) {
+                snapshot_put_u8(snap, du->seg_len[i]);
+                snapshot_put_bytes(snap, du->seg_data[i], du->seg_len[i]);
+            }
         }
+    }
+}
 
-        if (!tpdu->seg_du[i]->tv.tv_sec && !tpdu->seg_du[i]->tv.tv_usec) {
-            tpdu->seg_du[i]->tv.tv_sec = te->tv.tv_sec;
-            tpdu->seg_du[i]->tv.tv_usec = te->tv.tv_usec;
-            continue;
-        }
+bool tpdu_ui_load(tpdu_ui_t *tpdu, snapshot_t *snap)
+{
+    // keep order of list
+    segmented_du_t **pdu = &tpdu->seg_dus;
+    while (*pdu) {
+        pdu = &(*pdu)->next;
+    }
 
-        if (timeval_abs_delta(&tpdu->seg_du[i]->tv, &te->tv) < SYS_PAR_T454) {
-            continue;
+    const int nseg_dus = snapshot_get_u8(snap);
+    for (int n = 0; n < nseg_dus && !snap->err; ++n) {
+        segmented_du_t *du = pool_alloc(tpdu->tpol->seg_du_pool);
+        if (!du) {
+            return false;
         }
-
-        // TODO: report error to application layer
-        tpdu_ui_segments_destroy(tpdu->seg_du[i]);
-        tpdu->seg_du[i] = NULL;
+        tp_timer_entry_init(&du->t454, tpdu_ui_t454_expired, du);
+        du->next = NULL;
+        du->tpdu = tpdu;
+        du->seg_ref = snapshot_get_u8(snap);
+        du->id_tsap = snapshot_get_u8(snap);
+        du->prio = snapshot_get_u8(snap);
+        du->nsegments = snapshot_get_u8(snap);
+        du->received = snapshot_get_u64(snap);
+        const uint64_t t454 = snapshot_get_u64(snap);
+        *pdu = du;
+        pdu = &du->next;
+
+        if (du->nsegments > SYS_PAR_N452) {
+            snapshot_invalid(snap, "segmented DU");
+            return false;
+        }
+        for (int i = 0; i < SYS_PAR_N452; ++i) {
+            if (du->received & (UINT64_C(1) << i)) {
+                du->seg_len[i] = snapshot_get_u8(snap);
+                if (du->seg_len[i] > SEG_DU_PAYLOAD_MAX) {
+                    snapshot_invalid(snap, "segment");
+                    return false;
+                }
+                snapshot_get_bytes(snap, du->seg_data[i], du->seg_len[i]);
+            }
+        }
+        tp_timer_arm(tpdu->tpol->tp_timer, &du->t454, t454);
     }
+
+    return !snap->err;
 }
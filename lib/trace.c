@@ -0,0 +1,235 @@
+#define _DEFAULT_SOURCE 1
+#define LOG_PREFIX "trace"
+
+#include <tetrapol/json_writer.h>
+#include <tetrapol/log.h>
+#include <tetrapol/misc.h>
+#include <tetrapol/trace.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+enum {
+    RX_CHUNKS = 64,     ///< remembered input chunks for latency measurement
+};
+
+typedef struct {
+    uint64_t ts;
+    uint64_t arg;       ///< latency in ticks for 'C'
+    uint8_t stage;
+    char phase;         ///< 'B', 'E' or 'C' (TSDU latency)
+} trace_evt_t;
+
+typedef struct {
+    uint64_t rx_offs;   ///< end of chunk
+    uint64_t ts;
+} rx_chunk_t;
+
+static struct {
+    trace_evt_t *evts;
+    int nevents;
+    uint64_t n;         ///< number of recorded events, including overwritten
+    uint64_t ts0;       ///< trace_now() at trace_start()
+    uint64_t ns0;       ///< trace_clock() at trace_start()
+    rx_chunk_t rx[RX_CHUNKS];
+    int rx_pos;         ///< next slot in rx
+    uint64_t latency_count;
+    uint64_t latency_sum;   ///< ticks
+    uint64_t latency_max;   ///< ticks
+} trace;
+
+bool trace_enabled = false;
+
+static const char *stage_names[TRACE_STAGES] = {
+    "sync",
+    "detect_scr",
+    "frame_decoder_decode",
+    "data_frame_push_frame",
+    "hdlc_frame_parse",
+    "link",
+    "tsdu_decode",
+    "output",
+};
+
+uint64_t trace_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void trace_push(int stage, char phase, uint64_t ts, uint64_t arg)
+{
+    trace_evt_t *evt = &trace.evts[trace.n % trace.nevents];
+    evt->ts = ts;
+    evt->arg = arg;
+    evt->stage = stage;
+    evt->phase = phase;
+    ++trace.n;
+}
+
+void trace_rec(int stage, char phase)
+{
+    trace_push(stage, phase, trace_now(), 0);
+}
+
+void trace_rx(uint64_t rx_offs)
+{
+    if (!trace_enabled) {
+        return;
+    }
+
+    trace.rx[trace.rx_pos].rx_offs = rx_offs;
+    trace.rx[trace.rx_pos].ts = trace_now();
+    trace.rx_pos = (trace.rx_pos + 1) % RX_CHUNKS;
+}
+
+void trace_tsdu(uint64_t rx_offs)
+{
+    if (!trace_enabled) {
+        return;
+    }
+
+    // find the oldest chunk which contains the bit
+    int idx = -1;
+    for (int i = 0; i < RX_CHUNKS; ++i) {
+        const rx_chunk_t *chunk = &trace.rx[(trace.rx_pos + i) % RX_CHUNKS];
+        if (chunk->ts && chunk->rx_offs >= rx_offs) {
+            idx = (trace.rx_pos + i) % RX_CHUNKS;
+            break;
+        }
+    }
+    if (idx == -1) {
+        return;
+    }
+
+    const uint64_t now = trace_now();
+    const uint64_t latency = now - trace.rx[idx].ts;
+    ++trace.latency_count;
+    trace.latency_sum += latency;
+    if (latency > trace.latency_max) {
+        trace.latency_max = latency;
+    }
+    trace_push(0, 'C', now, latency);
+}
+
+int trace_start(int nevents)
+{
+    if (nevents <= 0) {
+        return -1;
+    }
+
+    trace_stop();
+    trace.evts = malloc(nevents * sizeof(trace_evt_t));
+    if (!trace.evts) {
+        return -1;
+    }
+    trace.nevents = nevents;
+    trace.ts0 = trace_now();
+    trace.ns0 = trace_clock();
+    trace_enabled = true;
+
+    return 0;
+}
+
+void trace_stop(void)
+{
+    trace_enabled = false;
+    free(trace.evts);
+    memset(&trace, 0, sizeof(trace));
+}
+
+/// ticks of trace_now() per ns, measured since trace_start()
+static double ticks_per_ns(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    const uint64_t ns = trace_clock() - trace.ns0;
+    const uint64_t ticks = trace_now() - trace.ts0;
+
+    return (ns && ticks) ? (double)ticks / ns : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+void trace_get_latency(trace_latency_t *latency)
+{
+    const double tpn = ticks_per_ns();
+    latency->count = trace.latency_count;
+    latency->sum_ns = trace.latency_sum / tpn;
+    latency->max_ns = trace.latency_max / tpn;
+}
+
+/// write time in us with ns resolution
+static void write_us(json_writer_t *jw, uint64_t ns)
+{
+    char frac[4] = {
+        '.',
+        '0' + (ns / 100) % 10,
+        '0' + (ns / 10) % 10,
+        '0' + ns % 10,
+    };
+    json_writer_uint(jw, ns / 1000);
+    json_writer_mem(jw, frac, sizeof(frac));
+}
+
+int trace_write_chrome(const char *path)
+{
+    if (!trace.evts) {
+        return -1;
+    }
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        LOG(ERR, "Failed to open '%s', errno=%d", path, errno);
+        return -1;
+    }
+    json_writer_t *jw = json_writer_create(fd);
+    if (!jw) {
+        close(fd);
+        return -1;
+    }
+
+    const double tpn = ticks_per_ns();
+    const uint64_t first = (trace.n > trace.nevents) ?
+        trace.n - trace.nevents : 0;
+    json_writer_str(jw, "{\"traceEvents\":[\n");
+    for (uint64_t i = first; i < trace.n; ++i) {
+        const trace_evt_t *evt = &trace.evts[i % trace.nevents];
+        if (i != first) {
+            json_writer_str(jw, ",\n");
+        }
+        json_writer_str(jw, "{\"name\":\"");
+        if (evt->phase == 'C') {
+            json_writer_str(jw, "rx_to_tsdu");
+        } else {
+            json_writer_cstr(jw, stage_names[evt->stage]);
+        }
+        json_writer_str(jw, "\",\"ph\":\"");
+        json_writer_mem(jw, &evt->phase, 1);
+        json_writer_str(jw, "\",\"ts\":");
+        write_us(jw, (evt->ts - trace.ts0) / tpn);
+        json_writer_str(jw, ",\"pid\":1,\"tid\":1");
+        if (evt->phase == 'C') {
+            json_writer_str(jw, ",\"args\":{\"latency_us\":");
+            write_us(jw, evt->arg / tpn);
+            json_writer_str(jw, "}");
+        }
+        json_writer_str(jw, "}");
+    }
+    json_writer_str(jw, "\n]}\n");
+
+    const int ret = json_writer_flush(jw);
+    json_writer_destroy(jw);
+    if (close(fd) || ret) {
+        LOG(ERR, "Failed to write '%s'", path);
+        return -1;
+    }
+
+    return 0;
+}
@@ -27,28 +27,30 @@ const int CELL_RADIO_PARAM_RX_LEV_ACCESS_TO_DBM[16] = {
     -60, -56, -52, -48, -44, -40, -36, -32,
 };
 
-static void tsdu_base_set_nopts(tsdu_base_t *tsdu, int noptionals)
+static void tsdu_base_init(tsdu_base_t *tsdu, arena_t *arena, int noptionals)
 {
+    tsdu->in_arena = arena != NULL;
     tsdu->noptionals = noptionals;
     memset(tsdu->optionals, 0, sizeof(void *[noptionals]));
 }
 
-#define tsdu_create(TSDU_TYPE, noptionals) \
-    (TSDU_TYPE *) tsdu_create_(sizeof(TSDU_TYPE), noptionals)
+#define tsdu_create(arena, TSDU_TYPE, noptionals) \
+    (TSDU_TYPE *) tsdu_create_(arena, sizeof(TSDU_TYPE), noptionals)
 
-static tsdu_t *tsdu_create_(int size, int noptionals)
+static tsdu_t *tsdu_create_(arena_t *arena, int size, int noptionals)
 {
-    tsdu_t *tsdu = malloc(size);
+    tsdu_t *tsdu = arena_alloc(arena, size);
     if (!tsdu) {
         return NULL;
     }
-    tsdu_base_set_nopts(tsdu, noptionals);
+    tsdu_base_init(tsdu, arena, noptionals);
     return tsdu;
 }
 
 void tsdu_destroy(tsdu_base_t *tsdu)
 {
-    if (!tsdu) {
+    // arena is released as whole by its owner
+    if (!tsdu || tsdu->in_arena) {
         return;
     }
     for (int i = 0; i < tsdu->noptionals; ++i) {
@@ -97,9 +99,9 @@ static void cell_id_decode2(cell_id_t *cell_id, const uint8_t *data)
 }
 
 static tsdu_d_authentication_t *
-d_authentication_decode(const uint8_t *data, int len)
+d_authentication_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_authentication_t *tsdu = tsdu_create(tsdu_d_authentication_t, 0);
+    tsdu_d_authentication_t *tsdu = tsdu_create(arena, tsdu_d_authentication_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -112,11 +114,11 @@ d_authentication_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_crisis_notification_t *d_crisis_notification_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 10, NULL);
 
-    tsdu_d_crisis_notification_t *tsdu = tsdu_create(
+    tsdu_d_crisis_notification_t *tsdu = tsdu_create(arena,
             tsdu_d_crisis_notification_t, 0);
     if (!tsdu) {
         return NULL;
@@ -145,11 +147,11 @@ static tsdu_d_crisis_notification_t *d_crisis_notification_decode(
     return tsdu;
 }
 
-static tsdu_d_group_reject_t *d_group_reject_decode(const uint8_t *data, int len)
+static tsdu_d_group_reject_t *d_group_reject_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 6, NULL);
 
-    tsdu_d_group_reject_t *tsdu = tsdu_create(tsdu_d_group_reject_t, 0);
+    tsdu_d_group_reject_t *tsdu = tsdu_create(arena, tsdu_d_group_reject_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -166,20 +168,20 @@ static tsdu_d_group_reject_t *d_group_reject_decode(const uint8_t *data, int len
     return tsdu;
 }
 
-static tsdu_d_cch_open_t *d_cch_open_decode(const uint8_t *data, int len)
+static tsdu_d_cch_open_t *d_cch_open_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len != 1) {
         LOG(WTF, "Invalid len 1 != %d", len);
         return NULL;
     }
-    return tsdu_create(tsdu_d_cch_open_t, 0);
+    return tsdu_create(arena, tsdu_d_cch_open_t, 0);
 }
 
-static tsdu_d_refusal_t *d_refusal_decode(const uint8_t *data, int len)
+static tsdu_d_refusal_t *d_refusal_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 2, NULL);
 
-    tsdu_d_refusal_t *tsdu = tsdu_create(tsdu_d_refusal_t, 0);
+    tsdu_d_refusal_t *tsdu = tsdu_create(arena, tsdu_d_refusal_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -188,11 +190,11 @@ static tsdu_d_refusal_t *d_refusal_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_reject_t *d_reject_decode(const uint8_t *data, int len)
+static tsdu_d_reject_t *d_reject_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 2, NULL);
 
-    tsdu_d_reject_t *tsdu = tsdu_create(tsdu_d_reject_t, 0);
+    tsdu_d_reject_t *tsdu = tsdu_create(arena, tsdu_d_reject_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -201,17 +203,17 @@ static tsdu_d_reject_t *d_reject_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_call_alert_t *d_call_alert_decode(const uint8_t *data, int len)
+static tsdu_d_call_alert_t *d_call_alert_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    return tsdu_create(tsdu_d_call_alert_t, 0);
+    return tsdu_create(arena, tsdu_d_call_alert_t, 0);
 }
 
 static tsdu_d_hook_on_invitation_t *d_hook_on_invitation_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 2, NULL);
 
-    tsdu_d_hook_on_invitation_t *tsdu = tsdu_create(tsdu_d_hook_on_invitation_t, 0);
+    tsdu_d_hook_on_invitation_t *tsdu = tsdu_create(arena, tsdu_d_hook_on_invitation_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -220,11 +222,11 @@ static tsdu_d_hook_on_invitation_t *d_hook_on_invitation_decode(
     return tsdu;
 }
 
-static tsdu_d_release_t *d_release_decode(const uint8_t *data, int len)
+static tsdu_d_release_t *d_release_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 2, NULL);
 
-    tsdu_d_release_t *tsdu = tsdu_create(tsdu_d_release_t, 0);
+    tsdu_d_release_t *tsdu = tsdu_create(arena, tsdu_d_release_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -234,31 +236,31 @@ static tsdu_d_release_t *d_release_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_additional_participants_t *d_additional_participants_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 7, NULL);
 
-    tsdu_d_additional_participants_t *tsdu = tsdu_create(
+    tsdu_d_additional_participants_t *tsdu = tsdu_create(arena,
             tsdu_d_additional_participants_t, 1);
     if (!tsdu) {
         return NULL;
     }
 
     tsdu->coverage_id = data[1];
-    if (address_list_decode(&tsdu->calling_adr, &data[2]) == -1) {
+    if (address_list_decode(arena, &tsdu->calling_adr, &data[2]) == -1) {
         tsdu_destroy(&tsdu->base);
         return NULL;
     }
 
     if (len >= 8) {
-        if (address_list_decode(&tsdu->calling_adr, &data[7]) == -1) {
+        if (address_list_decode(arena, &tsdu->calling_adr, &data[7]) == -1) {
             tsdu_destroy(&tsdu->base);
             return NULL;
         }
     }
 
     if (len >= 13) {
-        if (address_list_decode(&tsdu->calling_adr, &data[12]) == -1) {
+        if (address_list_decode(arena, &tsdu->calling_adr, &data[12]) == -1) {
             tsdu_destroy(&tsdu->base);
             return NULL;
         }
@@ -267,11 +269,11 @@ static tsdu_d_additional_participants_t *d_additional_participants_decode(
     return tsdu;
 }
 
-static tsdu_d_call_setup_t *d_call_setup_decode(const uint8_t *data, int len)
+static tsdu_d_call_setup_t *d_call_setup_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 6, NULL);
 
-    tsdu_d_call_setup_t *tsdu = tsdu_create(tsdu_d_call_setup_t, 0);
+    tsdu_d_call_setup_t *tsdu = tsdu_create(arena, tsdu_d_call_setup_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -294,14 +296,14 @@ static tsdu_d_call_setup_t *d_call_setup_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_ability_mngt_t *d_ability_mngt_decode(const uint8_t *data, int len)
+static tsdu_d_ability_mngt_t *d_ability_mngt_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len - 1 > SIZEOF(tsdu_d_ability_mngt_t, data)) {
         LOG(WTF, "Message too long %d", len - 1);
         return NULL;
     }
 
-    tsdu_d_ability_mngt_t *tsdu = tsdu_create(tsdu_d_ability_mngt_t, 0);
+    tsdu_d_ability_mngt_t *tsdu = tsdu_create(arena, tsdu_d_ability_mngt_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -312,21 +314,21 @@ static tsdu_d_ability_mngt_t *d_ability_mngt_decode(const uint8_t *data, int len
     return tsdu;
 }
 
-static tsdu_d_dch_open_t *d_dch_open_decode(const uint8_t *data, int len)
+static tsdu_d_dch_open_t *d_dch_open_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len != 1) {
         LOG(WTF, "Invalid len 1 != %d", len);
         return NULL;
     }
 
-    return tsdu_create(tsdu_d_dch_open_t, 0);
+    return tsdu_create(arena, tsdu_d_dch_open_t, 0);
 }
 
-static tsdu_d_data_request_t *d_data_request_decode(const uint8_t *data, int len)
+static tsdu_d_data_request_t *d_data_request_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 16, NULL);
 
-    tsdu_d_data_request_t *tsdu = tsdu_create(tsdu_d_data_request_t, 0);
+    tsdu_d_data_request_t *tsdu = tsdu_create(arena, tsdu_d_data_request_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -345,22 +347,22 @@ static tsdu_d_data_request_t *d_data_request_decode(const uint8_t *data, int len
     return tsdu;
 }
 
-static tsdu_d_connect_cch_t *d_connect_cch_decode(const uint8_t *data, int len)
+static tsdu_d_connect_cch_t *d_connect_cch_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len != 1) {
         LOG(WTF, "Invalid len 1 != %d", len);
         return NULL;
     }
 
-    return tsdu_create(tsdu_d_connect_cch_t, 0);
+    return tsdu_create(arena, tsdu_d_connect_cch_t, 0);
 }
 
 static tsdu_d_data_authentication_t *d_data_authentication_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 11, NULL);
 
-    tsdu_d_data_authentication_t *tsdu = tsdu_create(tsdu_d_data_authentication_t, 0);
+    tsdu_d_data_authentication_t *tsdu = tsdu_create(arena, tsdu_d_data_authentication_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -371,7 +373,7 @@ static tsdu_d_data_authentication_t *d_data_authentication_decode(
     return tsdu;
 }
 
-static tsdu_d_data_msg_down_t *d_data_msg_down_decode(const uint8_t *data, int len)
+static tsdu_d_data_msg_down_t *d_data_msg_down_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len - 1 > SIZEOF(tsdu_d_data_msg_down_t, data)) {
         LOG(WTF, "Message too large %d > %d",
@@ -379,7 +381,7 @@ static tsdu_d_data_msg_down_t *d_data_msg_down_decode(const uint8_t *data, int l
         return NULL;
     }
 
-    tsdu_d_data_msg_down_t *tsdu = tsdu_create(tsdu_d_data_msg_down_t, 0);
+    tsdu_d_data_msg_down_t *tsdu = tsdu_create(arena, tsdu_d_data_msg_down_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -391,9 +393,9 @@ static tsdu_d_data_msg_down_t *d_data_msg_down_decode(const uint8_t *data, int l
 }
 
 static tsdu_d_authorisation_t *
-d_authorisation_decode(const uint8_t *data, int len)
+d_authorisation_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_authorisation_t *tsdu = tsdu_create(tsdu_d_authorisation_t, 0);
+    tsdu_d_authorisation_t *tsdu = tsdu_create(arena, tsdu_d_authorisation_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -407,9 +409,9 @@ d_authorisation_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_group_paging_t *d_group_paging_decode(const uint8_t *data, int len)
+static tsdu_d_group_paging_t *d_group_paging_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_group_paging_t *tsdu = tsdu_create(tsdu_d_group_paging_t, 0);
+    tsdu_d_group_paging_t *tsdu = tsdu_create(arena, tsdu_d_group_paging_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -424,9 +426,9 @@ static tsdu_d_group_paging_t *d_group_paging_decode(const uint8_t *data, int len
 }
 
 static tsdu_d_forced_registration_t *
-d_forced_registration_decode(const uint8_t *data, int len)
+d_forced_registration_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_forced_registration_t *tsdu = tsdu_create(tsdu_d_forced_registration_t, 0);
+    tsdu_d_forced_registration_t *tsdu = tsdu_create(arena, tsdu_d_forced_registration_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -440,9 +442,9 @@ d_forced_registration_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_group_activation_t *
-d_group_activation_decode(const uint8_t *data, int len)
+d_group_activation_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_group_activation_t *tsdu = tsdu_create(tsdu_d_group_activation_t, 0);
+    tsdu_d_group_activation_t *tsdu = tsdu_create(arena, tsdu_d_group_activation_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -482,9 +484,9 @@ d_group_activation_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_group_list_t *d_group_list_decode(const uint8_t *data, int len)
+static tsdu_d_group_list_t *d_group_list_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_group_list_t *tsdu = tsdu_create(tsdu_d_group_list_t, 3);
+    tsdu_d_group_list_t *tsdu = tsdu_create(arena, tsdu_d_group_list_t, 3);
     if (!tsdu) {
         return NULL;
     }
@@ -518,7 +520,8 @@ static tsdu_d_group_list_t *d_group_list_decode(const uint8_t *data, int len)
         if (type_nb.type == TYPE_NB_TYPE_EMERGENCY) {
             const int n = tsdu->nemergency + type_nb.number;
             const int l = sizeof(tsdu_d_group_list_emergency_t[n]);
-            tsdu_d_group_list_emergency_t *p = realloc(tsdu->emergency, l);
+            tsdu_d_group_list_emergency_t *p =
+                arena_realloc(arena, tsdu->emergency, l);
             if (!p) {
                 tsdu_destroy(&tsdu->base);
                 return NULL;
@@ -542,7 +545,8 @@ static tsdu_d_group_list_t *d_group_list_decode(const uint8_t *data, int len)
         if (type_nb.type == TYPE_NB_TYPE_OPEN) {
             const int n = tsdu->nopen + type_nb.number;
             const int l = sizeof(tsdu_d_group_list_open_t[n]);
-            tsdu_d_group_list_open_t *p = realloc(tsdu->open, l);
+            tsdu_d_group_list_open_t *p =
+                arena_realloc(arena, tsdu->open, l);
             if (!p) {
                 tsdu_destroy(&tsdu->base);
                 return NULL;
@@ -570,7 +574,8 @@ static tsdu_d_group_list_t *d_group_list_decode(const uint8_t *data, int len)
         if (type_nb.type == TYPE_NB_TYPE_TALK_GROUP) {
             const int n = tsdu->ngroup + type_nb.number;
             const int l = sizeof(tsdu_d_group_list_talk_group_t[n]);
-            tsdu_d_group_list_talk_group_t *p = realloc(tsdu->group, l);
+            tsdu_d_group_list_talk_group_t *p =
+                arena_realloc(arena, tsdu->group, l);
             if (!p) {
                 tsdu_destroy(&tsdu->base);
                 return NULL;
@@ -601,9 +606,9 @@ static tsdu_d_group_list_t *d_group_list_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_group_composition_t *d_group_composition_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_group_composition_t *tsdu = tsdu_create(tsdu_d_group_composition_t, 0);
+    tsdu_d_group_composition_t *tsdu = tsdu_create(arena, tsdu_d_group_composition_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -624,12 +629,12 @@ static tsdu_d_group_composition_t *d_group_composition_decode(
     return tsdu;
 }
 
-static cell_id_list_t *iei_cell_id_list_decode(cell_id_list_t *cell_ids,
-        const uint8_t *data, int len)
+static cell_id_list_t *iei_cell_id_list_decode(arena_t *arena,
+        cell_id_list_t *cell_ids, const uint8_t *data, int len)
 {
     int n = cell_ids ? cell_ids->len : 0;
     n += len / 2;
-    cell_id_list_t *p = realloc(cell_ids,
+    cell_id_list_t *p = arena_realloc(arena, cell_ids,
             sizeof(cell_id_list_t) + sizeof(cell_id_t[n]));
     if (!p) {
         LOG(ERR, "ERR OOM");
@@ -648,12 +653,12 @@ static cell_id_list_t *iei_cell_id_list_decode(cell_id_list_t *cell_ids,
     return cell_ids;
 }
 
-cell_bn_list_t *iei_cell_bn_list_decode(
+static cell_bn_list_t *iei_cell_bn_list_decode(arena_t *arena,
         cell_bn_list_t *cell_bns, const uint8_t *data, int len)
 {
     int n = cell_bns ? cell_bns->len : 0;
     n +=  len * 2 / 3;
-    cell_bn_list_t *p = realloc(cell_bns,
+    cell_bn_list_t *p = arena_realloc(arena, cell_bns,
             sizeof(cell_bn_list_t) + sizeof(cell_bn_t[n]));
     if (!p) {
         LOG(ERR, "ERR OOM");
@@ -672,9 +677,9 @@ cell_bn_list_t *iei_cell_bn_list_decode(
     return cell_bns;
 }
 
-static tsdu_d_neighbouring_cell_t *d_neighbouring_cell_decode(const uint8_t *data, int len)
+static tsdu_d_neighbouring_cell_t *d_neighbouring_cell_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_neighbouring_cell_t *tsdu = tsdu_create(tsdu_d_neighbouring_cell_t, 2);
+    tsdu_d_neighbouring_cell_t *tsdu = tsdu_create(arena, tsdu_d_neighbouring_cell_t, 2);
     if (!tsdu) {
         return NULL;
     }
@@ -717,14 +722,14 @@ static tsdu_d_neighbouring_cell_t *d_neighbouring_cell_decode(const uint8_t *dat
         len -= 2;
         CHECK_LEN(len, ie_len, tsdu);
         if (iei == IEI_CELL_ID_LIST && ie_len) {
-            cell_id_list_t *p = iei_cell_id_list_decode(
+            cell_id_list_t *p = iei_cell_id_list_decode(arena,
                     tsdu->cell_ids, data, ie_len);
             if (!p) {
                 break;
             }
             tsdu->cell_ids = p;
         } else if (iei == IEI_ADJACENT_BN_LIST && ie_len) {
-            cell_bn_list_t *p = iei_cell_bn_list_decode(
+            cell_bn_list_t *p = iei_cell_bn_list_decode(arena,
                     tsdu->cell_bns, data, ie_len);
             if (!p) {
                 break;
@@ -742,9 +747,9 @@ static tsdu_d_neighbouring_cell_t *d_neighbouring_cell_decode(const uint8_t *dat
     return tsdu;
 }
 
-static tsdu_d_system_info_t *d_system_info_decode(const uint8_t *data, int len)
+static tsdu_d_system_info_t *d_system_info_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_system_info_t *tsdu = tsdu_create(tsdu_d_system_info_t, 0);
+    tsdu_d_system_info_t *tsdu = tsdu_create(arena, tsdu_d_system_info_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -797,9 +802,9 @@ static tsdu_d_system_info_t *d_system_info_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_registration_nak_t *d_registration_nak_decode(const uint8_t *data, int len)
+static tsdu_d_registration_nak_t *d_registration_nak_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_registration_nak_t *tsdu = tsdu_create(tsdu_d_registration_nak_t, 0);
+    tsdu_d_registration_nak_t *tsdu = tsdu_create(arena, tsdu_d_registration_nak_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -817,9 +822,9 @@ static tsdu_d_registration_nak_t *d_registration_nak_decode(const uint8_t *data,
     return tsdu;
 }
 
-static tsdu_d_registration_ack_t *d_registration_ack_decode(const uint8_t *data, int len)
+static tsdu_d_registration_ack_t *d_registration_ack_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_registration_ack_t *tsdu = tsdu_create(tsdu_d_registration_ack_t, 0);
+    tsdu_d_registration_ack_t *tsdu = tsdu_create(arena, tsdu_d_registration_ack_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -854,9 +859,9 @@ static tsdu_d_registration_ack_t *d_registration_ack_decode(const uint8_t *data,
     return tsdu;
 }
 
-static tsdu_d_connect_dch_t *d_connect_dch_decode(const uint8_t *data, int len)
+static tsdu_d_connect_dch_t *d_connect_dch_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_connect_dch_t *tsdu = tsdu_create(tsdu_d_connect_dch_t, 0);
+    tsdu_d_connect_dch_t *tsdu = tsdu_create(arena, tsdu_d_connect_dch_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -871,9 +876,9 @@ static tsdu_d_connect_dch_t *d_connect_dch_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_return_t *d_return_decode(const uint8_t *data, int len)
+static tsdu_d_return_t *d_return_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_return_t *tsdu = tsdu_create(tsdu_d_return_t, 0);
+    tsdu_d_return_t *tsdu = tsdu_create(arena, tsdu_d_return_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -885,9 +890,9 @@ static tsdu_d_return_t *d_return_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_group_idle_t *d_group_idle_decode(const uint8_t *data, int len)
+static tsdu_d_group_idle_t *d_group_idle_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_group_idle_t *tsdu = tsdu_create(tsdu_d_group_idle_t, 0);
+    tsdu_d_group_idle_t *tsdu = tsdu_create(arena, tsdu_d_group_idle_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -900,12 +905,12 @@ static tsdu_d_group_idle_t *d_group_idle_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_location_activity_ack_t *d_location_activity_ack_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 2, NULL);
 
     tsdu_d_location_activity_ack_t *tsdu =
-        tsdu_create(tsdu_d_location_activity_ack_t, 0);
+        tsdu_create(arena, tsdu_d_location_activity_ack_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -915,9 +920,9 @@ static tsdu_d_location_activity_ack_t *d_location_activity_ack_decode(
     return tsdu;
 }
 
-static tsdu_d_ech_overload_id_t *d_ech_overload_id_decode(const uint8_t *data, int len)
+static tsdu_d_ech_overload_id_t *d_ech_overload_id_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_ech_overload_id_t *tsdu = tsdu_create(tsdu_d_ech_overload_id_t, 0);
+    tsdu_d_ech_overload_id_t *tsdu = tsdu_create(arena, tsdu_d_ech_overload_id_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -933,9 +938,9 @@ static tsdu_d_ech_overload_id_t *d_ech_overload_id_decode(const uint8_t *data, i
     return tsdu;
 }
 
-static tsdu_unknown_codop_t *d_unknown_parse(const uint8_t *data, int len)
+static tsdu_unknown_codop_t *d_unknown_parse(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_unknown_codop_t *tsdu = tsdu_create(tsdu_unknown_codop_t, 1);
+    tsdu_unknown_codop_t *tsdu = tsdu_create(arena, tsdu_unknown_codop_t, 1);
     if (!tsdu) {
         return NULL;
     }
@@ -945,7 +950,7 @@ static tsdu_unknown_codop_t *d_unknown_parse(const uint8_t *data, int len)
         return tsdu;
     }
 
-    tsdu->data = malloc(len);
+    tsdu->data = arena_alloc(arena, len);
     if (!tsdu->data) {
         tsdu_destroy(&tsdu->base);
         return NULL;
@@ -956,9 +961,9 @@ static tsdu_unknown_codop_t *d_unknown_parse(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_data_end_t *d_data_end_decode(const uint8_t *data, int len)
+static tsdu_d_data_end_t *d_data_end_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_data_end_t *tsdu = tsdu_create(tsdu_d_data_end_t, 0);
+    tsdu_d_data_end_t *tsdu = tsdu_create(arena, tsdu_d_data_end_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -969,9 +974,9 @@ static tsdu_d_data_end_t *d_data_end_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_datagram_notify_t *d_datagram_notify_decode(const uint8_t *data, int len)
+static tsdu_d_datagram_notify_t *d_datagram_notify_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_datagram_notify_t *tsdu = tsdu_create(tsdu_d_datagram_notify_t, 0);
+    tsdu_d_datagram_notify_t *tsdu = tsdu_create(arena, tsdu_d_datagram_notify_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -991,7 +996,7 @@ static tsdu_d_datagram_notify_t *d_datagram_notify_decode(const uint8_t *data, i
     return tsdu;
 }
 
-static tsdu_d_datagram_t *d_datagram_decode(const uint8_t *data, int len)
+static tsdu_d_datagram_t *d_datagram_decode(arena_t *arena, const uint8_t *data, int len)
 {
     if (len < 5) {
         LOG(WTF, "too short");
@@ -999,12 +1004,13 @@ static tsdu_d_datagram_t *d_datagram_decode(const uint8_t *data, int len)
     }
     len -= 5;
 
-    tsdu_d_datagram_t *tsdu = malloc(sizeof(tsdu_d_datagram_t) + len);
+    tsdu_d_datagram_t *tsdu =
+        arena_alloc(arena, sizeof(tsdu_d_datagram_t) + len);
     if (!tsdu) {
         return NULL;
     }
 
-    tsdu_base_set_nopts(&tsdu->base, 0);
+    tsdu_base_init(&tsdu->base, arena, 0);
 
     tsdu->call_priority = get_bits(4, data + 1, 4);
     tsdu->message_reference = data[2] | (data[3] << 8);
@@ -1016,7 +1022,7 @@ static tsdu_d_datagram_t *d_datagram_decode(const uint8_t *data, int len)
 }
 
 static tsdu_d_explicit_short_data_t *d_explicit_short_data_decode(
-        const uint8_t *data, int len)
+        arena_t *arena, const uint8_t *data, int len)
 {
     if (len < 1) {
         LOG(WTF, "too short");
@@ -1024,13 +1030,13 @@ static tsdu_d_explicit_short_data_t *d_explicit_short_data_decode(
     }
     len -= 1;
 
-    tsdu_d_explicit_short_data_t *tsdu = malloc(
+    tsdu_d_explicit_short_data_t *tsdu = arena_alloc(arena,
             sizeof(tsdu_d_explicit_short_data_t) + len);
     if (!tsdu) {
         LOG(ERR, "ERR OOM");
         return NULL;
     }
-    tsdu_base_set_nopts(&tsdu->base, 0);
+    tsdu_base_init(&tsdu->base, arena, 0);
 
     tsdu->len = len;
     memcpy(tsdu->data, data + 1, len);
@@ -1038,9 +1044,9 @@ static tsdu_d_explicit_short_data_t *d_explicit_short_data_decode(
     return tsdu;
 }
 
-static tsdu_d_call_start_t *d_call_start_decode(const uint8_t *data, int len)
+static tsdu_d_call_start_t *d_call_start_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_call_start_t *tsdu = tsdu_create(tsdu_d_call_start_t, 0);
+    tsdu_d_call_start_t *tsdu = tsdu_create(arena, tsdu_d_call_start_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1091,9 +1097,9 @@ static tsdu_d_call_start_t *d_call_start_decode(const uint8_t *data, int len)
     return tsdu;
 }
 
-static tsdu_d_call_connect_t *d_call_connect_decode(const uint8_t *data, int len)
+static tsdu_d_call_connect_t *d_call_connect_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_d_call_connect_t *tsdu = tsdu_create(tsdu_d_call_connect_t, 0);
+    tsdu_d_call_connect_t *tsdu = tsdu_create(arena, tsdu_d_call_connect_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1116,9 +1122,9 @@ static tsdu_d_call_connect_t *d_call_connect_decode(const uint8_t *data, int len
     return tsdu;
 }
 
-static tsdu_u_registration_req_t *u_registration_req_decode(const uint8_t *data, int len)
+static tsdu_u_registration_req_t *u_registration_req_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_u_registration_req_t *tsdu = tsdu_create(tsdu_u_registration_req_t, 0);
+    tsdu_u_registration_req_t *tsdu = tsdu_create(arena, tsdu_u_registration_req_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1144,11 +1150,11 @@ static tsdu_u_registration_req_t *u_registration_req_decode(const uint8_t *data,
     return tsdu;
 }
 
-static tsdu_u_data_request_t *u_data_request_decode(const uint8_t *data, int len)
+static tsdu_u_data_request_t *u_data_request_decode(arena_t *arena, const uint8_t *data, int len)
 {
     CHECK_LEN(len, 5, NULL);
 
-    tsdu_u_data_request_t *tsdu = tsdu_create(tsdu_u_data_request_t, 0);
+    tsdu_u_data_request_t *tsdu = tsdu_create(arena, tsdu_u_data_request_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1161,9 +1167,9 @@ static tsdu_u_data_request_t *u_data_request_decode(const uint8_t *data, int len
 }
 
 static tsdu_u_authentication_t *
-u_authentication_decode(const uint8_t *data, int len)
+u_authentication_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_u_authentication_t *tsdu = tsdu_create(tsdu_u_authentication_t, 0);
+    tsdu_u_authentication_t *tsdu = tsdu_create(arena, tsdu_u_authentication_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1176,9 +1182,9 @@ u_authentication_decode(const uint8_t *data, int len)
 }
 
 static tsdu_u_terminate_t *
-u_terminate_decode(const uint8_t *data, int len)
+u_terminate_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_u_terminate_t *tsdu = tsdu_create(tsdu_u_terminate_t, 0);
+    tsdu_u_terminate_t *tsdu = tsdu_create(arena, tsdu_u_terminate_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1190,9 +1196,9 @@ u_terminate_decode(const uint8_t *data, int len)
 }
 
 static tsdu_u_call_connect_t *
-u_call_connect_decode(const uint8_t *data, int len)
+u_call_connect_decode(arena_t *arena, const uint8_t *data, int len)
 {
-    tsdu_u_call_connect_t *tsdu = tsdu_create(tsdu_u_call_connect_t, 0);
+    tsdu_u_call_connect_t *tsdu = tsdu_create(arena, tsdu_u_call_connect_t, 0);
     if (!tsdu) {
         return NULL;
     }
@@ -1205,6 +1211,12 @@ u_call_connect_decode(const uint8_t *data, int len)
 }
 
 int tsdu_decode(const uint8_t *data, int len, tsdu_t **tsdu)
+{
+    return tsdu_decode_arena(NULL, data, len, tsdu);
+}
+
+int tsdu_decode_arena(arena_t *arena, const uint8_t *data, int len,
+        tsdu_t **tsdu)
 {
     if (len < 1) {
         LOG(ERR, "%d data too short %d < %d", __LINE__, len, 1);
@@ -1220,175 +1232,175 @@ int tsdu_decode(const uint8_t *data, int len, tsdu_t **tsdu)
     *tsdu = NULL;
     switch (codop) {
         case D_ABILITY_MNGT:
-            *tsdu = (tsdu_t *)d_ability_mngt_decode(data, len);
+            *tsdu = (tsdu_t *)d_ability_mngt_decode(arena, data, len);
             break;
 
         case D_ADDITIONAL_PARTICIPANTS:
-            *tsdu = (tsdu_t *)d_additional_participants_decode(data, len);
+            *tsdu = (tsdu_t *)d_additional_participants_decode(arena, data, len);
             break;
 
         case D_AUTHENTICATION:
-            *tsdu = (tsdu_t *)d_authentication_decode(data, len);
+            *tsdu = (tsdu_t *)d_authentication_decode(arena, data, len);
             break;
 
         case D_AUTHORISATION:
-            *tsdu = (tsdu_t *)d_authorisation_decode(data, len);
+            *tsdu = (tsdu_t *)d_authorisation_decode(arena, data, len);
             break;
 
         case D_CALL_ALERT:
-            *tsdu = (tsdu_t *)d_call_alert_decode(data, len);
+            *tsdu = (tsdu_t *)d_call_alert_decode(arena, data, len);
             break;
 
         case D_CALL_CONNECT:
-            *tsdu = (tsdu_t *)d_call_connect_decode(data, len);
+            *tsdu = (tsdu_t *)d_call_connect_decode(arena, data, len);
             break;
 
         case D_CALL_START:
-            *tsdu = (tsdu_t *)d_call_start_decode(data, len);
+            *tsdu = (tsdu_t *)d_call_start_decode(arena, data, len);
             break;
 
         case D_CALL_SETUP:
-            *tsdu = (tsdu_t *)d_call_setup_decode(data, len);
+            *tsdu = (tsdu_t *)d_call_setup_decode(arena, data, len);
             break;
 
         case D_CCH_OPEN:
-            *tsdu = (tsdu_t *)d_cch_open_decode(data, len);
+            *tsdu = (tsdu_t *)d_cch_open_decode(arena, data, len);
             break;
 
         case D_CONNECT_CCH:
-            *tsdu = (tsdu_t *)d_connect_cch_decode(data, len);
+            *tsdu = (tsdu_t *)d_connect_cch_decode(arena, data, len);
             break;
 
         case D_CRISIS_NOTIFICATION:
-            *tsdu = (tsdu_t *)d_crisis_notification_decode(data, len);
+            *tsdu = (tsdu_t *)d_crisis_notification_decode(arena, data, len);
             break;
 
         case D_DATA_AUTHENTICATION:
-            *tsdu = (tsdu_t *)d_data_authentication_decode(data, len);
+            *tsdu = (tsdu_t *)d_data_authentication_decode(arena, data, len);
             break;
 
         case D_DATA_END:
-            *tsdu = (tsdu_t *)d_data_end_decode(data, len);
+            *tsdu = (tsdu_t *)d_data_end_decode(arena, data, len);
             break;
 
         case D_DATA_MSG_DOWN:
-            *tsdu = (tsdu_t *)d_data_msg_down_decode(data, len);
+            *tsdu = (tsdu_t *)d_data_msg_down_decode(arena, data, len);
             break;
 
         case D_DATA_REQUEST:
-            *tsdu = (tsdu_t *)d_data_request_decode(data, len);
+            *tsdu = (tsdu_t *)d_data_request_decode(arena, data, len);
             break;
 
         case D_DATAGRAM:
-            *tsdu = (tsdu_t *)d_datagram_decode(data, len);
+            *tsdu = (tsdu_t *)d_datagram_decode(arena, data, len);
             break;
 
         case D_DATAGRAM_NOTIFY:
-            *tsdu = (tsdu_t *)d_datagram_notify_decode(data, len);
+            *tsdu = (tsdu_t *)d_datagram_notify_decode(arena, data, len);
             break;
 
         case D_DCH_OPEN:
-            *tsdu = (tsdu_t *)d_dch_open_decode(data, len);
+            *tsdu = (tsdu_t *)d_dch_open_decode(arena, data, len);
             break;
 
         case D_ECH_OVERLOAD_ID:
-            *tsdu = (tsdu_t *)d_ech_overload_id_decode(data, len);
+            *tsdu = (tsdu_t *)d_ech_overload_id_decode(arena, data, len);
             break;
 
         case D_EXPLICIT_SHORT_DATA:
-            *tsdu = (tsdu_t *)d_explicit_short_data_decode(data, len);
+            *tsdu = (tsdu_t *)d_explicit_short_data_decode(arena, data, len);
             break;
 
         case D_FORCED_REGISTRATION:
-            *tsdu = (tsdu_t *)d_forced_registration_decode(data, len);
+            *tsdu = (tsdu_t *)d_forced_registration_decode(arena, data, len);
             break;
 
         case D_GROUP_ACTIVATION:
-            *tsdu = (tsdu_t *)d_group_activation_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_activation_decode(arena, data, len);
             break;
 
         case D_GROUP_COMPOSITION:
-            *tsdu = (tsdu_t *)d_group_composition_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_composition_decode(arena, data, len);
             break;
 
         case D_GROUP_LIST:
-            *tsdu = (tsdu_t *)d_group_list_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_list_decode(arena, data, len);
             break;
 
         case D_GROUP_PAGING:
-            *tsdu = (tsdu_t *)d_group_paging_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_paging_decode(arena, data, len);
             break;
 
         case D_GROUP_REJECT:
-            *tsdu = (tsdu_t *)d_group_reject_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_reject_decode(arena, data, len);
             break;
 
         case D_HOOK_ON_INVITATION:
-            *tsdu = (tsdu_t *)d_hook_on_invitation_decode(data, len);
+            *tsdu = (tsdu_t *)d_hook_on_invitation_decode(arena, data, len);
             break;
 
         case D_LOCATION_ACTIVITY_ACK:
-            *tsdu = (tsdu_t *)d_location_activity_ack_decode(data, len);
+            *tsdu = (tsdu_t *)d_location_activity_ack_decode(arena, data, len);
             break;
 
         case D_NEIGHBOURING_CELL:
-            *tsdu = (tsdu_t *)d_neighbouring_cell_decode(data, len);
+            *tsdu = (tsdu_t *)d_neighbouring_cell_decode(arena, data, len);
             break;
 
         case D_SYSTEM_INFO:
-            *tsdu = (tsdu_t *)d_system_info_decode(data, len);
+            *tsdu = (tsdu_t *)d_system_info_decode(arena, data, len);
             break;
 
         case D_REGISTRATION_NAK:
-            *tsdu = (tsdu_t *)d_registration_nak_decode(data, len);
+            *tsdu = (tsdu_t *)d_registration_nak_decode(arena, data, len);
             break;
 
         case D_REGISTRATION_ACK:
-            *tsdu = (tsdu_t *)d_registration_ack_decode(data, len);
+            *tsdu = (tsdu_t *)d_registration_ack_decode(arena, data, len);
             break;
 
         case D_CONNECT_DCH:
-            *tsdu = (tsdu_t *)d_connect_dch_decode(data, len);
+            *tsdu = (tsdu_t *)d_connect_dch_decode(arena, data, len);
             break;
 
         case D_REFUSAL:
-            *tsdu = (tsdu_t *)d_refusal_decode(data, len);
+            *tsdu = (tsdu_t *)d_refusal_decode(arena, data, len);
             break;
 
         case D_REJECT:
-            *tsdu = (tsdu_t *)d_reject_decode(data, len);
+            *tsdu = (tsdu_t *)d_reject_decode(arena, data, len);
             break;
 
         case D_RELEASE:
-            *tsdu = (tsdu_t *)d_release_decode(data, len);
+            *tsdu = (tsdu_t *)d_release_decode(arena, data, len);
             break;
 
         case D_RETURN:
-            *tsdu = (tsdu_t *)d_return_decode(data, len);
+            *tsdu = (tsdu_t *)d_return_decode(arena, data, len);
             break;
 
         case D_GROUP_IDLE:
-            *tsdu = (tsdu_t *)d_group_idle_decode(data, len);
+            *tsdu = (tsdu_t *)d_group_idle_decode(arena, data, len);
             break;
 
         case U_AUTHENTICATION:
-            *tsdu = (tsdu_t *)u_authentication_decode(data, len);
+            *tsdu = (tsdu_t *)u_authentication_decode(arena, data, len);
             break;
 
         case U_CALL_CONNECT:
-            *tsdu = (tsdu_t *)u_call_connect_decode(data, len);
+            *tsdu = (tsdu_t *)u_call_connect_decode(arena, data, len);
             break;
 
         case U_DATA_REQUEST:
-            *tsdu = (tsdu_t *)u_data_request_decode(data, len);
+            *tsdu = (tsdu_t *)u_data_request_decode(arena, data, len);
             break;
 
         case U_REGISTRATION_REQ:
-            *tsdu = (tsdu_t *)u_registration_req_decode(data, len);
+            *tsdu = (tsdu_t *)u_registration_req_decode(arena, data, len);
             break;
 
         case U_TERMINATE:
-            *tsdu = (tsdu_t *)u_terminate_decode(data, len);
+            *tsdu = (tsdu_t *)u_terminate_decode(arena, data, len);
             break;
 
         case D_ACCESS_DISABLED:
@@ -1448,12 +1460,12 @@ int tsdu_decode(const uint8_t *data, int len, tsdu_t **tsdu)
         case U_OCH_SETUP:
         case U_TRANSFER_REQ:
             LOG(ERR, "Unsupported codop 0x%02x", codop);
-            *tsdu = (tsdu_t *)d_unknown_parse(data, len);
+            *tsdu = (tsdu_t *)d_unknown_parse(arena, data, len);
             break;
 
         default:
             LOG(WTF, "Unknown codop=0x%02x", codop);
-            *tsdu = (tsdu_t *)d_unknown_parse(data, len);
+            *tsdu = (tsdu_t *)d_unknown_parse(arena, data, len);
             break;
     }
 
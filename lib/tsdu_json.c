@@ -1,35 +1,46 @@
 #define LOG_PREFIX "tsdu_json"
 
 #include <tetrapol/log.h>
-#include <tetrapol/misc.h>
 #include <tetrapol/tsdu_json.h>
 
 enum {
-    /// buffer large enough to satisfy all internal sprintf
-    SPRINTF_BUF_LEN = 32768,
+    /// longest data dumped as hex, longer data are written as null
+    DATA_HEX_LEN_MAX = 16383,
 };
 
-static const char *addr_json(char *buf, const addr_t *addr)
+static void addr_json(json_writer_t *jw, const addr_t *addr)
 {
-    sprintf(buf, "{ \"z\": %d, \"y\": %d, \"x\": %d }",
-            addr->z, addr->y, addr->x);
-    return buf;
+    json_writer_str(jw, "{ \"z\": ");
+    json_writer_int(jw, addr->z);
+    json_writer_str(jw, ", \"y\": ");
+    json_writer_int(jw, addr->y);
+    json_writer_str(jw, ", \"x\": ");
+    json_writer_int(jw, addr->x);
+    json_writer_str(jw, " }");
 }
 
-void tsdu_json(const tpol_t *tpol, const tpol_tsdu_t *tsdu)
+static void int_or_null_json(json_writer_t *jw, int val, bool is_null)
 {
-    printf("{ \"event\": \"tsdu\", ");
-    printf("\"rx_offs\": %lu, ", tpol->rx_offs);
+    if (is_null) {
+        json_writer_str(jw, "null, ");
+    } else {
+        json_writer_int(jw, val);
+        json_writer_str(jw, ", ");
+    }
+}
 
-    printf("\"tsdu\": { ");
-    {
-        char buf[SPRINTF_BUF_LEN];  ///< buffer for sprintf
+void tsdu_json(json_writer_t *jw, const tetrapol_evt_t *evt)
+{
+    const tpol_tsdu_t *tsdu = evt->tsdu.tsdu;
 
-        if (tpol->frame_no != FRAME_NO_UNKNOWN) {
-            printf("\"frame_no\": %d, ", tpol->frame_no);
-        } else {
-            printf("\"frame_no\": null, ");
-        }
+    json_writer_str(jw, "{ \"event\": \"tsdu\", \"rx_offs\": ");
+    json_writer_uint(jw, evt->rx_offs);
+    json_writer_str(jw, ", ");
+
+    json_writer_str(jw, "\"tsdu\": { ");
+    {
+        json_writer_str(jw, "\"frame_no\": ");
+        int_or_null_json(jw, evt->frame_no, evt->frame_no == FRAME_NO_UNKNOWN);
 
         const char *log_ch_str;
         switch (tsdu->log_ch) {
@@ -45,8 +56,11 @@ void tsdu_json(const tpol_t *tpol, const tpol_tsdu_t *tsdu)
             default:
                 log_ch_str = "FIXME";
         };
-        printf("\"log_ch\": \"%s\", ", log_ch_str);
-        printf("\"addr\": %s, ", addr_json(buf, &tsdu->addr));
+        json_writer_str(jw, "\"log_ch\": \"");
+        json_writer_cstr(jw, log_ch_str);
+        json_writer_str(jw, "\", \"addr\": ");
+        addr_json(jw, &tsdu->addr);
+        json_writer_str(jw, ", ");
 
         const char *tpdu_type;
         switch (tsdu->tpdu_type) {
@@ -54,36 +68,29 @@ void tsdu_json(const tpol_t *tpol, const tpol_tsdu_t *tsdu)
             case TPDU_TYPE_TPDU_UI: tpdu_type = "TPDU_UI";  break;
             default:                tpdu_type = "FIXME";
         };
-        printf("\"tpdu_type\": \"%s\", ", tpdu_type);
+        json_writer_str(jw, "\"tpdu_type\": \"");
+        json_writer_cstr(jw, tpdu_type);
+        json_writer_str(jw, "\", ");
 
-        if (tsdu->tsap_id != TSAP_ID_UNKNOWN) {
-            printf("\"tsap_id\": %d, ", tsdu->tsap_id);
-        } else {
-            printf("\"tsap_id\": null, ");
-        }
+        json_writer_str(jw, "\"tsap_id\": ");
+        int_or_null_json(jw, tsdu->tsap_id, tsdu->tsap_id == TSAP_ID_UNKNOWN);
 
         if (tsdu->tpdu_type == TPDU_TYPE_TPDU) {
-            if (tsdu->tsap_ref_swmi != TSAP_REF_UNKNOWN) {
-                printf("\"tsap_ref_swmi\": %d, ", tsdu->tsap_ref_swmi);
-            } else {
-                printf("\"tsap_ref_swmi\": null, ");
-            }
-            if (tsdu->tsap_ref_rt != TSAP_REF_UNKNOWN) {
-                printf("\"tsap_ref_rt\": %d, ", tsdu->tsap_ref_rt);
-            } else {
-                printf("\"tsap_ref_rt\": null, ");
-            }
-        } else if (tsdu->tpdu_type == TPDU_TYPE_TPDU_UI) {
+            json_writer_str(jw, "\"tsap_ref_swmi\": ");
+            int_or_null_json(jw, tsdu->tsap_ref_swmi,
+                    tsdu->tsap_ref_swmi == TSAP_REF_UNKNOWN);
+            json_writer_str(jw, "\"tsap_ref_rt\": ");
+            int_or_null_json(jw, tsdu->tsap_ref_rt,
+                    tsdu->tsap_ref_rt == TSAP_REF_UNKNOWN);
         }
 
-        if ( (2 * tsdu->data_len + 1) <= sizeof(buf)) {
-            printf("\"data\": { \"encoding\": \"hex\", \"value\": \"%s\" } ",
-                    sprint_hex2(buf, tsdu->data, tsdu->data_len));
+        if (tsdu->data_len <= DATA_HEX_LEN_MAX) {
+            json_writer_str(jw, "\"data\": { \"encoding\": \"hex\", \"value\": \"");
+            json_writer_hex(jw, tsdu->data, tsdu->data_len);
+            json_writer_str(jw, "\" } ");
         } else {
-            printf("\"data\": null");
+            json_writer_str(jw, "\"data\": null");
         }
     }
-    printf("} ");
-
-    printf("}\n");
+    json_writer_str(jw, "} }\n");
 }